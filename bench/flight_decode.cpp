@@ -0,0 +1,41 @@
+/**
+ * Flight log decoder. Reads a log written by the flight recorder of the
+ * competition state and writes its control ticks as CSV for plotting,
+ * one row per tick. Gaps in the seq column are ticks dropped when the
+ * flush fell behind.
+ *
+ * Usage: flight-decode log [csv]
+ */
+
+#include <code/utility/flight_recorder.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        fprintf(stderr, "Usage: %s log [csv]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    std::ifstream in(argv[1], std::ios::binary);
+    std::vector<nrg::flight_record> records;
+    if (!in || !nrg::read_flight_log(in, records)) {
+        fprintf(stderr, "%s is not a flight log\n", argv[1]);
+        return EXIT_FAILURE;
+    }
+    if (argc < 3) {
+        nrg::write_flight_csv(std::cout, records);
+        return EXIT_SUCCESS;
+    }
+    std::ofstream out(argv[2]);
+    if (!out) {
+        fprintf(stderr, "Could not write %s\n", argv[2]);
+        return EXIT_FAILURE;
+    }
+    nrg::write_flight_csv(out, records);
+    fprintf(stderr, "Wrote %zu ticks to %s\n", records.size(), argv[2]);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,53 @@
+/**
+ * Parameter autotuner. Searches the procedure parameters against the
+ * default simulated scenarios, running the episodes of each generation
+ * across all cores, and writes the best candidate as a profile that
+ * the parameter box loads.
+ *
+ * Exits with a failure if no candidate finished every episode. An
+ * object move fails when the robot ends up against the object where
+ * it cannot get around it.
+ *
+ * Usage: param-tune [profile] [generations] [population]
+ */
+
+#include <code/simulator/autotuner.h>
+#include <code/utility/logger.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+
+int main(int argc, char **argv) {
+    const char *profile = argc > 1 ? argv[1] : "tuned.profile";
+    AutoTuner tuner;
+    if (argc > 2) { tuner.config().generations = static_cast<std::size_t>(atoi(argv[2])); }
+    if (argc > 3) { tuner.config().population = static_cast<std::size_t>(atoi(argv[3])); }
+    tuner.config().sim.noise = 1.0;
+    Logger::setSilent();
+
+    typedef std::chrono::steady_clock clock;
+    clock::time_point t0 = clock::now();
+    AutoTuner::Candidate best = tuner.tune();
+    double ms = std::chrono::duration<double, std::milli>(clock::now() - t0).count();
+
+    printf("%-10s %12s %10s %10s\n", "generation", "cost_ms", "failures", "feasible");
+    for (std::size_t g = 0; g < tuner.history().size(); ++g) {
+        const AutoTuner::Candidate &c = tuner.history()[g];
+        printf("%-10zu %12.1f %10zu %10s\n", g, c.cost, c.failures, c.feasible ? "yes" : "no");
+    }
+    printf("Tuned in %.0f ms\n", ms);
+    for (std::size_t i = 0; i < tuner.dimensions().size(); ++i) {
+        printf("  %-18s %10.3f\n", tuner.dimensions()[i].name.c_str(), best.values[i]);
+    }
+
+    std::ofstream out(profile);
+    if (!out) {
+        fprintf(stderr, "Could not write %s\n", profile);
+        return EXIT_FAILURE;
+    }
+    tuner.write_profile(out, best);
+    printf("Wrote %s\n", profile);
+    return best.feasible ? EXIT_SUCCESS : EXIT_FAILURE;
+}
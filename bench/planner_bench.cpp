@@ -0,0 +1,422 @@
+/**
+ * Grid planner benchmark. Generates maze, random-obstacle, open-field
+ * and corridor maps at several sizes, runs every planner on each map
+ * and reports wall time, expansions, heap allocations and path cost.
+ * Planners with a planner context are run a second time on the same
+ * query, and that run must not allocate.
+ *
+ * Every path is checked against an exact reference search, and the
+ * benchmark exits with a failure if a planner returns an invalid path,
+ * misses a reachable destination or exceeds its cost bound.
+ *
+ * Usage: planner-bench [max_side]
+ */
+
+#include <code/compstate/compstate.h>
+#include <code/controller/arastar.h>
+#include <code/controller/astar.h>
+#include <code/controller/hpastar.h>
+#include <code/controller/penaltyfield.h>
+#include <code/controller/plancontext.h>
+#include <code/controller/thetastar.h>
+#include <code/gui/griddisplay.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <new>
+#include <queue>
+#include <random>
+#include <string>
+
+static std::atomic<std::size_t> s_allocations(0);
+
+void *operator new(std::size_t size) {
+    ++s_allocations;
+    if (void *p = std::malloc(size ? size : 1)) { return p; }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void *p, std::size_t) noexcept {
+    std::free(p);
+}
+
+enum {
+    // Selected grid values, as produced by GridDisplay
+    OPEN = -1,
+    // Default wall penalties from param_manager
+    WALL_PENALTY_0 = 233,
+    WALL_PENALTY_1 = 16,
+    WALL_PENALTY_2 = 4
+};
+
+typedef std::mt19937 rng_t;
+typedef std::function<void(array2d<int> &, rng_t &)> map_generator;
+
+static int wall() {
+    return GridDisplay::default_weight();
+}
+
+static void fill(array2d<int> &grid, int value) {
+    for (std::size_t x = 0; x < grid.x(); ++x) {
+        std::fill(grid[x].get(), grid[x].get() + grid.y(), value);
+    }
+}
+
+static void gen_open(array2d<int> &grid, rng_t &rng) {
+    int nx = static_cast<int>(grid.x());
+    int ny = static_cast<int>(grid.y());
+    fill(grid, OPEN);
+    // A few scattered rectangular blocks
+    for (int i = 0; i < 8; ++i) {
+        int w = 1 + static_cast<int>(rng() % (nx / 8 + 1));
+        int h = 1 + static_cast<int>(rng() % (ny / 8 + 1));
+        int x0 = static_cast<int>(rng() % nx);
+        int y0 = static_cast<int>(rng() % ny);
+        for (int x = x0; x < std::min(nx, x0 + w); ++x) {
+            for (int y = y0; y < std::min(ny, y0 + h); ++y) {
+                grid[x][y] = wall();
+            }
+        }
+    }
+}
+
+static void gen_random(array2d<int> &grid, rng_t &rng) {
+    for (std::size_t x = 0; x < grid.x(); ++x) {
+        for (std::size_t y = 0; y < grid.y(); ++y) {
+            grid[x][y] = rng() % 4 == 0 ? wall() : OPEN;
+        }
+    }
+}
+
+static void gen_maze(array2d<int> &grid, rng_t &rng) {
+    // Recursive backtracker on rooms of three cells separated by
+    // walls one cell thick, with a few walls knocked out for loops
+    enum { PITCH = 4 };
+    int nx = static_cast<int>(grid.x());
+    int ny = static_cast<int>(grid.y());
+    int rx = (nx - 1) / PITCH;
+    int ry = (ny - 1) / PITCH;
+    fill(grid, wall());
+    if (rx <= 0 || ry <= 0) { return; }
+    auto carve = [&grid, nx, ny](int x0, int y0, int x1, int y1) {
+        for (int x = x0; x <= x1 && x < nx; ++x) {
+            for (int y = y0; y <= y1 && y < ny; ++y) {
+                grid[x][y] = OPEN;
+            }
+        }
+    };
+    std::vector<bool> seen(static_cast<std::size_t>(rx * ry), false);
+    std::vector<int> stack = {0};
+    seen[0] = true;
+    carve(1, 1, PITCH - 1, PITCH - 1);
+    while (!stack.empty()) {
+        int r = stack.back();
+        int x = r % rx;
+        int y = r / rx;
+        int xs[] = {x - 1, x + 1, x, x};
+        int ys[] = {y, y, y - 1, y + 1};
+        int options[4];
+        int count = 0;
+        for (int i = 0; i < 4; ++i) {
+            if (xs[i] < 0 || ys[i] < 0 || xs[i] >= rx || ys[i] >= ry) { continue; }
+            if (!seen[xs[i] + ys[i] * rx]) { options[count++] = i; }
+        }
+        if (count == 0) {
+            stack.pop_back();
+            continue;
+        }
+        int i = options[rng() % count];
+        int n = xs[i] + ys[i] * rx;
+        seen[n] = true;
+        stack.push_back(n);
+        int ax = std::min(x, xs[i]) * PITCH + 1;
+        int ay = std::min(y, ys[i]) * PITCH + 1;
+        int bx = std::max(x, xs[i]) * PITCH + PITCH - 1;
+        int by = std::max(y, ys[i]) * PITCH + PITCH - 1;
+        carve(ax, ay, bx, by);
+    }
+    for (int i = 0; i < rx * ry / 10; ++i) {
+        int x = static_cast<int>(rng() % rx) * PITCH + PITCH;
+        int y = static_cast<int>(rng() % ry) * PITCH + 1;
+        if (x < nx - 1) { carve(x, y, x, y + PITCH - 2); }
+    }
+}
+
+static void gen_corridor(array2d<int> &grid, rng_t &) {
+    // Serpentine corridors with the gap alternating between ends
+    enum { SPACING = 8, GAP = 4 };
+    int nx = static_cast<int>(grid.x());
+    int ny = static_cast<int>(grid.y());
+    fill(grid, OPEN);
+    bool left = false;
+    for (int y = SPACING; y < ny - 1; y += SPACING) {
+        int x0 = left ? GAP : 0;
+        int x1 = left ? nx : nx - GAP;
+        for (int x = x0; x < x1; ++x) { grid[x][y] = wall(); }
+        left = !left;
+    }
+}
+
+static vector2i open_near(array2d<int> &terrain, int cx, int cy) {
+    int nx = static_cast<int>(terrain.x());
+    int ny = static_cast<int>(terrain.y());
+    for (int r = 0; r < std::max(nx, ny); ++r) {
+        for (int x = std::max(0, cx - r); x <= std::min(nx - 1, cx + r); ++x) {
+            for (int y = std::max(0, cy - r); y <= std::min(ny - 1, cy + r); ++y) {
+                if (terrain[x][y] != TERRAIN_WALL) { return {x, y}; }
+            }
+        }
+    }
+    return {cx, cy};
+}
+
+/**
+ * Exact 4-connected Dijkstra where entering a cell costs one plus
+ * its terrain value, the model shared by the penalty planners.
+ */
+static bool reference_path(
+    array2d<int> &terrain,
+    const vector2i &start,
+    const vector2i &dest,
+    std::vector<vector2i> &path
+) {
+    int nx = static_cast<int>(terrain.x());
+    int ny = static_cast<int>(terrain.y());
+    auto num = static_cast<std::size_t>(nx * ny);
+    std::vector<long> dist(num, -1);
+    std::vector<int> parent(num, -1);
+    typedef std::pair<long, int> entry;
+    std::priority_queue<entry, std::vector<entry>, std::greater<entry>> open;
+    nrg::search_stats &stats = nrg::last_search_stats();
+    stats = {0, 1};
+    int s = start.x() * ny + start.y();
+    int d = dest.x() * ny + dest.y();
+    std::vector<long> best(num, -1);
+    best[s] = 0;
+    open.emplace(0, s);
+    while (!open.empty()) {
+        entry e = open.top();
+        open.pop();
+        int u = e.second;
+        if (dist[u] >= 0) { continue; }
+        dist[u] = e.first;
+        ++stats.expansions;
+        if (u == d) { break; }
+        int x = u / ny;
+        int y = u % ny;
+        int xs[] = {x - 1, x + 1, x, x};
+        int ys[] = {y, y, y - 1, y + 1};
+        for (int i = 0; i < 4; ++i) {
+            if (xs[i] < 0 || ys[i] < 0 || xs[i] >= nx || ys[i] >= ny) { continue; }
+            int t = terrain[xs[i]][ys[i]];
+            int v = xs[i] * ny + ys[i];
+            if (t == TERRAIN_WALL || dist[v] >= 0) { continue; }
+            long c = e.first + 1 + t;
+            if (best[v] >= 0 && best[v] <= c) { continue; }
+            best[v] = c;
+            parent[v] = u;
+            open.emplace(c, v);
+            ++stats.pushes;
+        }
+    }
+    if (dist[d] < 0) { return false; }
+    for (int v = d; v != s; v = parent[v]) { path.emplace_back(v / ny, v % ny); }
+    path.push_back(start);
+    std::reverse(path.begin(), path.end());
+    return true;
+}
+
+/**
+ * @return the 4-connected cost of a path, or a negative value if
+ *         the path is not a valid sequence of open neighbour cells
+ */
+static double grid_cost(array2d<int> &terrain, const std::vector<vector2i> &path) {
+    double cost = 0;
+    for (std::size_t i = 1; i < path.size(); ++i) {
+        const vector2i &a = path[i - 1];
+        const vector2i &b = path[i];
+        if (abs(a.x() - b.x()) + abs(a.y() - b.y()) != 1) { return -1; }
+        if (terrain[b.x()][b.y()] == TERRAIN_WALL) { return -1; }
+        cost += 1 + terrain[b.x()][b.y()];
+    }
+    return cost;
+}
+
+/**
+ * @return the any-angle cost of a path, or a negative value if
+ *         a segment is blocked
+ */
+static double line_path_cost(array2d<int> &terrain, const std::vector<vector2i> &path) {
+    double cost = 0;
+    for (std::size_t i = 1; i < path.size(); ++i) {
+        double c = nrg::line_cost(terrain, path[i - 1], path[i]);
+        if (c < 0) { return -1; }
+        cost += c;
+    }
+    return cost;
+}
+
+struct planner {
+    const char *name;
+    // Largest map, in cells, the planner is run on
+    std::size_t max_cells;
+    bool any_angle;
+    // Allowed ratio to the reference cost, or zero if the planner
+    // optimises a different cost model and is only reported
+    double bound;
+    // Legacy planners assume the destination is reachable
+    bool handles_unreachable;
+    // Repeated queries must not allocate
+    bool steady_no_allocs;
+    // Optional preprocessing of the terrain, timed apart from the search
+    std::function<void(array2d<int> &)> prepare;
+    std::function<bool(array2d<int> &, const vector2i &, const vector2i &, std::vector<vector2i> &)> run;
+};
+
+int main(int argc, char **argv) {
+    int max_side = argc > 1 ? atoi(argv[1]) : 2000;
+    struct map_size { int x; int y; };
+    const map_size sizes[] = {
+        {CompetitionState::wall_x, CompetitionState::wall_y},
+        {200, 100},
+        {500, 500},
+        {1000, 1000},
+        {2000, 2000}
+    };
+    struct map_kind { const char *name; map_generator generate; };
+    const map_kind kinds[] = {
+        {"open", gen_open},
+        {"random", gen_random},
+        {"maze", gen_maze},
+        {"corridor", gen_corridor}
+    };
+    nrg::hpa_planner hpa;
+    nrg::ara_planner ara;
+    nrg::planner_context context;
+    const planner planners[] = {
+        {"search_path", 250000, false, 0, true, true, nullptr, [&context](array2d<int> &t, const vector2i &s, const vector2i &d, std::vector<vector2i> &p) {
+            // The start is not part of the returned path
+            p.push_back(s);
+            nrg::search_path(context, t, s, d, p);
+            return p.size() > 1 || s == d;
+        }},
+        {"search_path_del", 250000, false, 0, true, true, nullptr, [&context](array2d<int> &t, const vector2i &s, const vector2i &d, std::vector<vector2i> &p) {
+            nrg::search_path_del(context, t, s, d, p);
+            return !p.empty() && p.back() == d;
+        }},
+        {"search_path_theta", 250000, true, 1.0, true, true, nullptr, [&context](array2d<int> &t, const vector2i &s, const vector2i &d, std::vector<vector2i> &p) {
+            return nrg::search_path_theta(context, t, s, d, p);
+        }},
+        {"hpa_planner", 4000000, false, 1.5, true, false, [&hpa](array2d<int> &t) {
+            hpa.set_terrain(t);
+        }, [&hpa](array2d<int> &, const vector2i &s, const vector2i &d, std::vector<vector2i> &p) {
+            return hpa.search(s, d, p);
+        }},
+        {"ara_planner_5ms", 1000000, false, 3.0, true, false, nullptr, [&ara](array2d<int> &t, const vector2i &s, const vector2i &d, std::vector<vector2i> &p) {
+            // Keep going past the budget only until the first path
+            ara.reset(t, s, d);
+            auto deadline = nrg::ara_planner::clock::now() + std::chrono::milliseconds(5);
+            while (!ara.improve(deadline) && ara.iterations() == 0) {
+                deadline = nrg::ara_planner::clock::now() + std::chrono::milliseconds(1);
+            }
+            return ara.path(p);
+        }}
+    };
+    typedef std::chrono::steady_clock clock;
+    auto elapsed_ms = [](clock::time_point since) {
+        return std::chrono::duration<double, std::milli>(clock::now() - since).count();
+    };
+    bool failed = false;
+    printf("%-9s %-10s %-18s %10s %11s %10s %12s %7s %7s\n",
+           "map", "size", "planner", "time_ms", "expansions", "allocs", "cost", "ratio", "steady");
+    for (const map_size &size : sizes) {
+        if (size.x > max_side || size.y > max_side) { continue; }
+        auto cells = static_cast<std::size_t>(size.x * size.y);
+        for (const map_kind &kind : kinds) {
+            rng_t rng(static_cast<rng_t::result_type>(size.x * 7919 + size.y));
+            array2d<int> selected(size.x, size.y);
+            kind.generate(selected, rng);
+            char dims[32];
+            snprintf(dims, sizeof(dims), "%dx%d", size.x, size.y);
+
+            std::size_t allocs = s_allocations;
+            clock::time_point t0 = clock::now();
+            array2d<int> terrain = nrg::grid_kernelize(selected, WALL_PENALTY_0, WALL_PENALTY_1, WALL_PENALTY_2);
+            printf("%-9s %-10s %-18s %10.2f %11s %10zu %12s %7s\n",
+                   kind.name, dims, "grid_kernelize", elapsed_ms(t0), "-",
+                   s_allocations - allocs, "-", "-");
+
+            vector2i start = open_near(terrain, 1, 1);
+            vector2i dest = open_near(terrain, size.x - 2, size.y - 2);
+            std::vector<vector2i> ref;
+            allocs = s_allocations;
+            t0 = clock::now();
+            bool reachable = reference_path(terrain, start, dest, ref);
+            double ref_ms = elapsed_ms(t0);
+            double ref_cost = grid_cost(terrain, ref);
+            double ref_line = line_path_cost(terrain, ref);
+            printf("%-9s %-10s %-18s %10.2f %11zu %10zu %12.0f %7s\n",
+                   kind.name, dims, "reference", ref_ms, nrg::last_search_stats().expansions,
+                   s_allocations - allocs, reachable ? ref_cost : -1.0, "1.000");
+
+            for (const planner &p : planners) {
+                if (cells > p.max_cells) { continue; }
+                if (!reachable && !p.handles_unreachable) { continue; }
+                if (p.prepare) {
+                    t0 = clock::now();
+                    p.prepare(terrain);
+                    printf("%-9s %-10s %-18s %10.2f\n", kind.name, dims, "  (prepare)", elapsed_ms(t0));
+                }
+                std::vector<vector2i> path;
+                allocs = s_allocations;
+                t0 = clock::now();
+                bool found = p.run(terrain, start, dest, path);
+                double ms = elapsed_ms(t0);
+                allocs = s_allocations - allocs;
+                std::size_t expansions = nrg::last_search_stats().expansions;
+                double cost = -1;
+                double ratio = 0;
+                std::string error;
+                if (found != reachable) {
+                    error = found ? "found unreachable path" : "missed reachable path";
+                } else if (found) {
+                    cost = p.any_angle ? line_path_cost(terrain, path) : grid_cost(terrain, path);
+                    double reference = p.any_angle ? ref_line : ref_cost;
+                    ratio = reference > 0 ? cost / reference : 1;
+                    if (cost < 0 || path.front() != start || path.back() != dest) {
+                        error = "invalid path";
+                    } else if (p.bound > 0 && cost > reference * p.bound + 1e-6) {
+                        error = "worse than reference";
+                    }
+                }
+                char steady[16] = "-";
+                if (p.steady_no_allocs) {
+                    // Same query again once the arena has merged any
+                    // blocks chained on during the first run
+                    path.clear();
+                    p.run(terrain, start, dest, path);
+                    path.clear();
+                    std::size_t before = s_allocations;
+                    p.run(terrain, start, dest, path);
+                    std::size_t repeat = s_allocations - before;
+                    snprintf(steady, sizeof(steady), "%zu", repeat);
+                    if (repeat > 0 && error.empty()) {
+                        error = "allocated in steady state";
+                    }
+                }
+                printf("%-9s %-10s %-18s %10.2f %11zu %10zu %12.0f %7.3f %7s%s%s\n",
+                       kind.name, dims, p.name, ms, expansions, allocs, cost, ratio, steady,
+                       error.empty() ? "" : "  FAIL: ", error.c_str());
+                failed |= !error.empty();
+            }
+        }
+    }
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
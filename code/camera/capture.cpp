@@ -53,7 +53,7 @@ void Capture::timerEvent(QTimerEvent *ev) {
     // Grab the frame from the video capture and emit
     cv::UMat frame;
     *m_video_capture >> frame;
-    Q_EMIT frame_ready(frame);
+    Q_EMIT frame_ready(frame, std::chrono::steady_clock::now());
 }
 
 int Capture::capture_width() const {
@@ -2,6 +2,7 @@
 #define MINOTAUR_CPP_CAPTURE_H
 
 #include <QObject>
+#include <chrono>
 #include <memory>
 
 // OpenCV forward declarations
@@ -32,9 +33,10 @@ public:
 
     /**
      * Signal emitted when a frame has been received
-     * by the Capture.
+     * by the Capture, with the time it was grabbed, from
+     * which the latency of the pipeline is measured.
      */
-    Q_SIGNAL void frame_ready(const cv::UMat &);
+    Q_SIGNAL void frame_ready(const cv::UMat &, std::chrono::steady_clock::time_point);
 
     Q_SLOT void start_capture(int cam);
 
@@ -10,6 +10,8 @@
 static QBasicTimer s_queue_timer;
 // Static instance of queue'd frame
 static cv::UMat s_frame;
+// Capture time of the queue'd frame
+static std::chrono::steady_clock::time_point s_frame_time;
 
 static void zoom(cv::UMat &src, cv::UMat &dest, double zoom_factor) {
     // Crop the image to the zoom area
@@ -37,14 +39,18 @@ struct PreprocessorDelegate {
      * Needed since some OpenCV functions do not accept const references
      * and Qt cannot handle non-const reference to Mat as a metatype.
      *
-     * @param frame frame to preprocess
+     * @param frame    frame to preprocess
+     * @param captured time the frame was captured
      */
-    static void preprocess_frame_delegate(Preprocessor *pp, cv::UMat frame);
+    static void preprocess_frame_delegate(Preprocessor *pp, cv::UMat frame, std::chrono::steady_clock::time_point captured);
 };
 
-void PreprocessorDelegate::preprocess_frame_delegate(Preprocessor *pp, cv::UMat frame) {
+void PreprocessorDelegate::preprocess_frame_delegate(Preprocessor *pp, cv::UMat frame, std::chrono::steady_clock::time_point captured) {
     // Modifier frame
-    if (pp->m_modifier) { pp->m_modifier->modify(frame); }
+    if (pp->m_modifier) {
+        pp->m_modifier->set_frame_time(captured);
+        pp->m_modifier->modify(frame);
+    }
     // Rotate frame
     rotate(frame, static_cast<double>(pp->m_rotation_angle), frame);
     // Frame zoom
@@ -78,16 +84,17 @@ void Preprocessor::use_modifier(const std::shared_ptr<VideoModifier> &modifier)
     m_modifier = modifier;
 }
 
-void Preprocessor::preprocess_frame(const cv::UMat &frame) {
+void Preprocessor::preprocess_frame(const cv::UMat &frame, std::chrono::steady_clock::time_point captured) {
     // Queue the frame unless all frames are to be processed
     if (m_process_all)
-    { PreprocessorDelegate::preprocess_frame_delegate(this, frame); }
-    else { queue_frame(frame); }
+    { PreprocessorDelegate::preprocess_frame_delegate(this, frame, captured); }
+    else { queue_frame(frame, captured); }
 }
 
-void Preprocessor::queue_frame(const cv::UMat &frame) {
+void Preprocessor::queue_frame(const cv::UMat &frame, std::chrono::steady_clock::time_point captured) {
     // Load the frame into the single-element queue
     s_frame = frame;
+    s_frame_time = captured;
     // If there is no current frame being processed, start the timer
     if (!s_queue_timer.isActive()) { s_queue_timer.start(0, this); }
 }
@@ -99,7 +106,7 @@ void Preprocessor::timerEvent(QTimerEvent *ev) {
     // execution time, which limits frame rate
 
     // Pass copy of pointer
-    PreprocessorDelegate::preprocess_frame_delegate(this, s_frame);
+    PreprocessorDelegate::preprocess_frame_delegate(this, s_frame, s_frame_time);
     s_frame.release();
     // Stop the timer so that the next received frame can be processed
     s_queue_timer.stop();
@@ -2,6 +2,7 @@
 #define MINOTAUR_CPP_PREPROCESSOR_H
 
 #include <QObject>
+#include <chrono>
 #include <memory>
 
 // Forward declarations
@@ -31,9 +32,10 @@ public:
     /**
      * Queue the frame to be preprocessed.
      *
-     * @param frame the frame to preprocess
+     * @param frame    the frame to preprocess
+     * @param captured time the frame was captured
      */
-    Q_SLOT void preprocess_frame(const cv::UMat &frame);
+    Q_SLOT void preprocess_frame(const cv::UMat &frame, std::chrono::steady_clock::time_point captured);
 
     Q_SLOT void zoom_changed(double zoom_factor);
 
@@ -66,8 +68,9 @@ private:
      * Queue a frame to be processed.
      *
      * @param frame
+     * @param captured
      */
-    void queue_frame(const cv::UMat &frame);
+    void queue_frame(const cv::UMat &frame, std::chrono::steady_clock::time_point captured);
 
     /**
      * Timer fired to trigger a frame processing.
@@ -3,6 +3,7 @@
 #include "../utility/font.h"
 #include "../utility/utility.h"
 
+#include <QTimerEvent>
 #include <QVBoxLayout>
 
 #ifndef NDEBUG
@@ -33,8 +34,21 @@ StatusLabel* StatusBox::add_label(const QString &initial) {
     return label;
 }
 
+StatusLabel *StatusBox::add_telemetry(std::shared_ptr<const nrg::telemetry_slot> slot, format_fn format) {
+    // Draw the current values straight away
+    std::uint32_t seen = nrg::telemetry_slot::UNSEEN;
+    nrg::telemetry_slot::values values{};
+    slot->read(values, seen);
+    StatusLabel *label = add_label(format(values));
+    m_telemetry.emplace(label->id(), telemetry{label, std::move(slot), std::move(format), seen});
+    if (!m_refresh.isActive()) { m_refresh.start(REFRESH_MS, this); }
+    return label;
+}
+
 void StatusBox::remove_label(StatusLabel *label) {
     if (!label) { return; }
+    m_telemetry.erase(label->id());
+    if (m_telemetry.empty()) { m_refresh.stop(); }
     // Find the label and remove it from the map
     auto it = m_labels.find(label->id());
     if (it != m_labels.end()) {
@@ -43,3 +57,20 @@ void StatusBox::remove_label(StatusLabel *label) {
         if (m_labels.empty()) { hide(); }
     }
 }
+
+void StatusBox::refresh(telemetry &entry) {
+    nrg::telemetry_slot::values values;
+    if (entry.slot->read(values, entry.seen)) {
+        entry.label->setText(entry.format(values));
+    }
+}
+
+void StatusBox::timerEvent(QTimerEvent *ev) {
+    if (ev->timerId() != m_refresh.timerId()) {
+        QDialog::timerEvent(ev);
+        return;
+    }
+    for (auto &entry : m_telemetry) {
+        refresh(entry.second);
+    }
+}
@@ -2,8 +2,11 @@
 #define MINOTAUR_CPP_STATUSBOX_H
 
 #include "../base/statuslabel.h"
+#include "../utility/telemetry.h"
 
+#include <QBasicTimer>
 #include <QDialog>
+#include <functional>
 #include <memory>
 #include <unordered_map>
 
@@ -15,6 +18,11 @@ class StatusLabel;
  * A Dialog instance to which any QObject can add a label, receive
  * a reference to that label, and modify its constents. The labels
  * are managed by this class.
+ *
+ * Labels may instead show a telemetry slot, to which another thread
+ * publishes numeric values. The box redraws the labels whose values
+ * have changed at a fixed rate, so producers neither format text nor
+ * cause repaints.
  */
 class StatusBox : public QDialog {
 Q_OBJECT
@@ -31,6 +39,17 @@ public:
      */
     StatusLabel *add_label(const QString &initial);
 
+    typedef std::function<QString(const nrg::telemetry_slot::values &)> format_fn;
+
+    /**
+     * Create a label showing the values of a telemetry slot.
+     *
+     * @param slot   slot to which the values are published
+     * @param format function turning the values into the label text
+     * @return reference to the label
+     */
+    StatusLabel *add_telemetry(std::shared_ptr<const nrg::telemetry_slot> slot, format_fn format);
+
     /**
      * Remove the label from the action box. Objects that manage
      * a label should call this in their destructors if the
@@ -40,7 +59,27 @@ public:
      */
     void remove_label(StatusLabel *label);
 
+    enum {
+        // Period of the telemetry redraw, about 10 Hz
+        REFRESH_MS = 100
+    };
+
 private:
+    struct telemetry {
+        StatusLabel *label;
+        std::shared_ptr<const nrg::telemetry_slot> slot;
+        format_fn format;
+        // Version of the values last drawn
+        std::uint32_t seen;
+    };
+
+    void timerEvent(QTimerEvent *ev) override;
+
+    /**
+     * Redraw a telemetry label if its values have changed.
+     */
+    static void refresh(telemetry &entry);
+
     /**
      * Incrementing ID value so that labels are easily tracked.
      */
@@ -53,6 +92,14 @@ private:
      * Map of ID to label pointer for easy lookup.
      */
     std::unordered_map<std::size_t, std::unique_ptr<base::StatusLabel>> m_labels;
+    /**
+     * Map of label ID to the telemetry shown by the label.
+     */
+    std::unordered_map<std::size_t, telemetry> m_telemetry;
+    /**
+     * Runs while any telemetry label is shown.
+     */
+    QBasicTimer m_refresh;
 };
 
 #endif //MINOTAUR_CPP_STATUSBOX_H
@@ -98,9 +98,9 @@ path2d algo::robot_object_path(
             graph.connect(start, nodes[i]);
         }
     }
-#ifndef NDEBUG
-    assert(graph.connections_of(start).size() >= 3);
-#endif
+    if (graph.connections_of(start).size() < 3) {
+        return {};
+    }
     // Determine the target node based on the side
     // The side integer value should scale as
     // [0, 1, 2, 3] -> [0, 2, 4, 6] -> [1, 3, 5, 7]
@@ -58,7 +58,9 @@ namespace algo {
      *
      * @param rob
      * @param obj
-     * @return
+     * @return the path, or an empty path if the robot is against the
+     *         object such that fewer than three of the points around it
+     *         can be reached
      */
     path2d robot_object_path(
         const rect2d &rob,
@@ -1,17 +1,30 @@
 #include "compstate.h"
+#include "common.h"
+#include "controlthread.h"
 #include "objectprocedure.h"
 #include "parammanager.h"
+#include "predictor.h"
 #include "procedure.h"
 
 #include "../camera/statusbox.h"
-#include "../camera/statuslabel.h"
 #include "../gui/global.h"
+#include "../utility/flight_recorder.h"
 #include "../utility/logger.h"
+#include "../utility/mailbox.h"
+#include "../utility/seqlock.h"
+#include "../utility/telemetry.h"
 #include "../utility/utility.h"
 #include "../utility/vector.h"
 
 #include <opencv2/core/types.hpp>
 
+#include <QDateTime>
+#include <QDir>
+#include <QTimer>
+
+#include <cstring>
+#include <limits>
+
 #ifndef NDEBUG
 #include <cassert>
 #include <QDebug>
@@ -39,53 +52,252 @@ static double acquisition_r(const cv::Rect2d &rect, double calibrated_area) {
     return fabs(area - calibrated_area) / (area > calibrated_area ? area : calibrated_area) * t;
 }
 
-static QString center_text(const cv::Rect2d &rect, const char *label) {
+static QString center_text(double x, double y, const char *label) {
+    QString text;
+    text.sprintf("%6s: (%6.1f , %6.1f )", label, x, y);
+    return text;
+}
+
+static QString latency_text(double latency_ms, double err, double unpredicted_err) {
     QString text;
-    text.sprintf("%6s: (%6.1f , %6.1f )", label, rect.x + rect.width / 2, rect.y + rect.height / 2);
+    text.sprintf("Latency: %5.1f ms PredE: %4.1f (%4.1f)", latency_ms, err, unpredicted_err);
     return text;
 }
 
+/**
+ * @return the box moved so that its center is at a predicted position,
+ *         unchanged if it is already there
+ */
+static cv::Rect2d moved_to(const cv::Rect2d &box, const vector2d &center) {
+    vector2d offset = center - algo::rect_center(box);
+    return {box.x + offset.x(), box.y + offset.y(), box.width, box.height};
+}
+
+static nrg::control_scheduler::clock::duration from_ms(double ms) {
+    return std::chrono::duration_cast<nrg::control_scheduler::clock::duration>(
+        std::chrono::duration<double, std::milli>(ms));
+}
+
+static std::int64_t to_ns(nrg::control_scheduler::clock::duration d) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(d).count();
+}
+
+template<typename val_t>
+static void copy_box(val_t (&out)[4], const cv::Rect2d &box) {
+    out[0] = static_cast<val_t>(box.x);
+    out[1] = static_cast<val_t>(box.y);
+    out[2] = static_cast<val_t>(box.width);
+    out[3] = static_cast<val_t>(box.height);
+}
+
+/**
+ * Copy a name into a fixed size field, cut to fit.
+ */
+template<std::size_t N>
+static void copy_name(char (&out)[N], const char *name) {
+    std::strncpy(out, name, N - 1);
+    out[N - 1] = '\0';
+}
+
 struct CompetitionState::Impl {
     cv::Rect2d box_robot;
     cv::Rect2d box_object;
     cv::Rect2d box_target;
+
+    // Boxes predicted for the commands of the current tick
+    cv::Rect2d predicted_robot;
+    cv::Rect2d predicted_object;
+    nrg::pose_predictor robot_predictor;
+    nrg::pose_predictor object_predictor;
+
+    nrg::control_scheduler scheduler;
+    // Lives on the control thread, with the scheduler it checks
+    QTimer watchdog;
+    // Boxes consumed during a control tick stay fresh until it ends,
+    // so the procedures ticked later in it still see them
+    bool ticking = false;
+    bool consume_robot = false;
+    bool consume_object = false;
+
+    nrg::mailbox ui_mailbox;
+
+    // Record of the current tick, filled in by the procedures
+    nrg::flight_recorder recorder;
+    nrg::flight_record record;
+    // The log is closed once the tick that ended the procedures is in
+    bool close_recorder = false;
+
+    // Next snapshot to publish, whose times and count are kept up to
+    // date as boxes arrive, and the last one published
+    Snapshot next{};
+    nrg::seqlock<Snapshot> snapshot;
 };
 
-CompetitionState::CompetitionState(MainWindow *parent) :
+CompetitionState::CompetitionState(MainWindow *parent, param_manager *parameters) :
     m_parent(parent),
+    m_params(parameters),
     m_impl(std::make_unique<Impl>()),
+    m_robot_loc(std::make_shared<nrg::telemetry_slot>()),
+    m_object_loc(std::make_shared<nrg::telemetry_slot>()),
+    m_latency(std::make_shared<nrg::telemetry_slot>()),
     m_tracking_robot(false),
     m_tracking_object(false),
     m_acquire_walls(false),
+    m_robot_box_fresh(false),
+    m_object_box_fresh(false),
     m_object_type(UNACQUIRED) {
+    connect(this, &CompetitionState::ui_posted, this, &CompetitionState::drain_ui, Qt::QueuedConnection);
+    if (!parent) { return; }
     if (auto lp = parent->status_box().lock()) {
-        m_robot_loc_label = lp->add_label(center_text(cv::Rect2d(), "Robot"));
-        m_object_loc_label = lp->add_label(center_text(cv::Rect2d(), "Object"));
+        lp->add_telemetry(m_robot_loc, [](const nrg::telemetry_slot::values &v) {
+            return center_text(v[0], v[1], "Robot");
+        });
+        lp->add_telemetry(m_object_loc, [](const nrg::telemetry_slot::values &v) {
+            return center_text(v[0], v[1], "Object");
+        });
+        lp->add_telemetry(m_latency, [](const nrg::telemetry_slot::values &v) {
+            return latency_text(v[0], v[1], v[2]);
+        });
     }
+    ControlThread &control = parent->control_thread();
+    m_impl->watchdog.moveToThread(&control);
+    connect(&m_impl->watchdog, &QTimer::timeout, &m_impl->watchdog, [this] {
+        if (m_impl->scheduler.check_watchdog()) {
+            log() << "Tracking lost, no box for " << params().watchdog_ms << " ms";
+        }
+    });
 }
 
 CompetitionState::~CompetitionState() = default;
 
-void CompetitionState::acquire_robot_box(const cv::Rect2d &robot_box) {
-#ifndef NDEBUG
-    assert(m_robot_loc_label != nullptr);
-#endif
-    m_robot_loc_label->setText(center_text(robot_box, "Robot"));
+void CompetitionState::acquire_robot_box(const cv::Rect2d &robot_box, nrg::control_scheduler::clock::time_point captured) {
+    auto received = nrg::control_scheduler::clock::now();
+    m_robot_loc->publish(robot_box.x + robot_box.width / 2, robot_box.y + robot_box.height / 2);
+    m_parent->control_thread().post([this, robot_box, captured, received] {
+        receive_robot_box(robot_box, captured, received);
+    });
+}
+
+void CompetitionState::acquire_object_box(const cv::Rect2d &object_box, nrg::control_scheduler::clock::time_point captured) {
+    auto received = nrg::control_scheduler::clock::now();
+    m_object_loc->publish(object_box.x + object_box.width / 2, object_box.y + object_box.height / 2);
+    m_parent->control_thread().post([this, object_box, captured, received] {
+        receive_object_box(object_box, captured, received);
+    });
+}
+
+void CompetitionState::receive_robot_box(
+    const cv::Rect2d &robot_box,
+    nrg::control_scheduler::clock::time_point captured,
+    nrg::control_scheduler::clock::time_point received,
+    nrg::control_scheduler::clock::time_point started
+) {
     m_impl->box_robot = robot_box;
+    m_impl->robot_predictor.observe(algo::rect_center(robot_box), captured, received);
     m_robot_box_fresh = true;
+    m_impl->next.robot_captured_ns = to_ns(captured.time_since_epoch());
+    m_impl->next.robot_received_ns = to_ns(received.time_since_epoch());
+    ++m_impl->next.seq;
+    run_control(nrg::flight_record::ROBOT_BOX, captured, received, started);
 }
 
-void CompetitionState::acquire_object_box(const cv::Rect2d &object_box) {
-#ifndef NDEBUG
-    assert(m_object_loc_label != nullptr);
-#endif
-    m_object_loc_label->setText(center_text(object_box, "Object"));
+void CompetitionState::receive_object_box(
+    const cv::Rect2d &object_box,
+    nrg::control_scheduler::clock::time_point captured,
+    nrg::control_scheduler::clock::time_point received,
+    nrg::control_scheduler::clock::time_point started
+) {
     m_impl->box_object = object_box;
+    m_impl->object_predictor.observe(algo::rect_center(object_box), captured, received);
     m_object_box_fresh = true;
+    m_impl->next.object_captured_ns = to_ns(captured.time_since_epoch());
+    m_impl->next.object_received_ns = to_ns(received.time_since_epoch());
+    ++m_impl->next.seq;
+    run_control(nrg::flight_record::OBJECT_BOX, captured, received, started);
+}
+
+void CompetitionState::predict_boxes(nrg::control_scheduler::clock::time_point received) {
+    // Commands sent in this tick act once the actuation delay is over
+    auto at = received + from_ms(params().actuation_ms);
+    auto max_horizon = from_ms(params().predict_max_ms);
+    nrg::pose_predictor &robot = m_impl->robot_predictor;
+    nrg::pose_predictor &object = m_impl->object_predictor;
+    // Predictions are scored even when not acted on
+    m_impl->predicted_robot = robot.has_estimate()
+        ? moved_to(m_impl->box_robot, robot.predict_scored(at, max_horizon))
+        : m_impl->box_robot;
+    m_impl->predicted_object = object.has_estimate()
+        ? moved_to(m_impl->box_object, object.predict_scored(at, max_horizon))
+        : m_impl->box_object;
+    m_latency->publish(robot.latency_ms(), robot.prediction_err(), robot.unpredicted_err());
+}
+
+void CompetitionState::run_control(
+    int source,
+    nrg::control_scheduler::clock::time_point captured,
+    nrg::control_scheduler::clock::time_point received,
+    nrg::control_scheduler::clock::time_point started
+) {
+    predict_boxes(received);
+    // Ticks are recorded while a procedure is scheduled, including
+    // those it skips for want of a fresh box
+    bool recording = m_impl->recorder.is_open() && m_impl->scheduler.size() > 0;
+    nrg::flight_record &record = m_impl->record;
+    if (recording) {
+        const float nan = std::numeric_limits<float>::quiet_NaN();
+        record = nrg::flight_record{};
+        record.captured_ns = to_ns(captured.time_since_epoch());
+        record.received_ns = to_ns(received.time_since_epoch());
+        copy_box(record.robot, m_impl->box_robot);
+        copy_box(record.object, m_impl->box_object);
+        vector2d predicted = algo::rect_center(m_impl->predicted_robot);
+        record.predicted[0] = static_cast<float>(predicted.x());
+        record.predicted[1] = static_cast<float>(predicted.y());
+        record.target[0] = record.target[1] = record.err = nan;
+        record.source = static_cast<std::uint8_t>(source);
+    }
+    auto timed = nrg::control_scheduler::clock::now();
+    m_impl->ticking = true;
+    m_impl->scheduler.tick(received, started);
+    m_impl->ticking = false;
+    if (recording) {
+        record.tick_ns = to_ns(nrg::control_scheduler::clock::now() - timed);
+        m_impl->recorder.record(record);
+    }
+    if (m_impl->close_recorder) {
+        m_impl->close_recorder = false;
+        stop_recording();
+    }
+    m_robot_box_fresh = m_robot_box_fresh && !m_impl->consume_robot;
+    m_object_box_fresh = m_object_box_fresh && !m_impl->consume_object;
+    m_impl->consume_robot = false;
+    m_impl->consume_object = false;
+    publish_snapshot();
+}
+
+void CompetitionState::publish_snapshot() {
+    Snapshot &next = m_impl->next;
+    copy_box(next.robot, m_impl->box_robot);
+    copy_box(next.object, m_impl->box_object);
+    copy_box(next.target, m_impl->box_target);
+    next.robot_fresh = m_robot_box_fresh;
+    next.object_fresh = m_object_box_fresh;
+    next.robot_valid = is_robot_box_valid();
+    next.object_valid = is_object_box_valid();
+    m_impl->snapshot.store(next);
+}
+
+CompetitionState::Snapshot CompetitionState::snapshot() const {
+    return m_impl->snapshot.load();
 }
 
 void CompetitionState::acquire_target_box(const cv::Rect2d &target_box) {
-    m_impl->box_target = target_box;
+    auto receive = [this, target_box] {
+        m_impl->box_target = target_box;
+        publish_snapshot();
+    };
+    if (m_parent) { m_parent->control_thread().post(receive); }
+    else { receive(); }
 }
 
 void CompetitionState::acquire_walls(std::shared_ptr<wall_arr> &walls) {
@@ -116,17 +328,27 @@ void CompetitionState::set_object_type(int object_type) {
     m_object_type = object_type;
 }
 
-cv::Rect2d &CompetitionState::get_robot_box(bool consume) {
-    m_robot_box_fresh = m_robot_box_fresh && !consume;
+const cv::Rect2d &CompetitionState::get_robot_box(bool consume) {
+    if (m_impl->ticking) {
+        m_impl->consume_robot = m_impl->consume_robot || consume;
+    } else {
+        m_robot_box_fresh = m_robot_box_fresh && !consume;
+    }
+    if (m_impl->ticking && params().predict_latency) { return m_impl->predicted_robot; }
     return m_impl->box_robot;
 }
 
-cv::Rect2d &CompetitionState::get_object_box(bool consume) {
-    m_object_box_fresh = m_object_box_fresh && !consume;
+const cv::Rect2d &CompetitionState::get_object_box(bool consume) {
+    if (m_impl->ticking) {
+        m_impl->consume_object = m_impl->consume_object || consume;
+    } else {
+        m_object_box_fresh = m_object_box_fresh && !consume;
+    }
+    if (m_impl->ticking && params().predict_latency) { return m_impl->predicted_object; }
     return m_impl->box_object;
 }
 
-cv::Rect2d &CompetitionState::get_target_box() {
+const cv::Rect2d &CompetitionState::get_target_box() const {
     return m_impl->box_target;
 }
 
@@ -139,11 +361,141 @@ bool CompetitionState::is_object_box_fresh() const {
 }
 
 bool CompetitionState::is_robot_box_valid() const {
-    return acquisition_r(m_impl->box_robot, g_pm->robot_calib_area) < g_pm->area_acq_r_sigma;
+    return acquisition_r(m_impl->box_robot, params().robot_calib_area) < params().area_acq_r_sigma;
 }
 
 bool CompetitionState::is_object_box_valid() const {
-    return acquisition_r(m_impl->box_object, g_pm->object_calib_area) < g_pm->area_acq_r_sigma;
+    return acquisition_r(m_impl->box_object, params().object_calib_area) < params().area_acq_r_sigma;
+}
+
+nrg::control_scheduler::handle CompetitionState::add_control_loop(nrg::control_scheduler::loop_fn loop) {
+    if (m_impl->scheduler.size() == 0) {
+        m_impl->scheduler.set_timeout(std::chrono::milliseconds(params().watchdog_ms));
+        m_impl->scheduler.reset_stats();
+        // A headless simulation has no event loop to run the timer
+        if (m_parent) { m_impl->watchdog.start(params().watchdog_poll_ms); }
+    }
+    return m_impl->scheduler.add(std::move(loop));
+}
+
+void CompetitionState::remove_control_loop(nrg::control_scheduler::handle &h) {
+    std::size_t active = m_impl->scheduler.size();
+    m_impl->scheduler.remove(h);
+    h = nrg::control_scheduler::NO_HANDLE;
+    if (active > 0 && m_impl->scheduler.size() == 0) {
+        m_impl->watchdog.stop();
+        log_control_stats();
+        if (m_impl->ticking) { m_impl->close_recorder = true; }
+        else { stop_recording(); }
+    }
+}
+
+const nrg::tick_stats &CompetitionState::control_stats() const {
+    return m_impl->scheduler.stats();
+}
+
+const nrg::pose_predictor &CompetitionState::robot_predictor() const {
+    return m_impl->robot_predictor;
+}
+
+const nrg::pose_predictor &CompetitionState::object_predictor() const {
+    return m_impl->object_predictor;
+}
+
+void CompetitionState::robot_commanded(const vector2d &dir) {
+    m_impl->robot_predictor.command(dir, m_impl->scheduler.last_box() + from_ms(params().actuation_ms));
+    nrg::flight_record &record = m_impl->record;
+    record.command[0] += static_cast<float>(dir.x());
+    record.command[1] += static_cast<float>(dir.y());
+    ++record.commands;
+}
+
+void CompetitionState::record_state(const char *procedure, const char *state) {
+    copy_name(m_impl->record.procedure, procedure);
+    copy_name(m_impl->record.state, state);
+}
+
+void CompetitionState::record_error(double err) {
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+    m_impl->record.target[0] = m_impl->record.target[1] = nan;
+    m_impl->record.err = static_cast<float>(err);
+}
+
+void CompetitionState::record_error(double err, const vector2d &target) {
+    m_impl->record.target[0] = static_cast<float>(target.x());
+    m_impl->record.target[1] = static_cast<float>(target.y());
+    m_impl->record.err = static_cast<float>(err);
+}
+
+bool CompetitionState::start_recording(const std::string &path) {
+    return m_impl->recorder.open(path);
+}
+
+void CompetitionState::stop_recording() {
+    nrg::flight_recorder &recorder = m_impl->recorder;
+    if (!recorder.is_open()) { return; }
+    // The flush thread writes out the log, off the control thread
+    recorder.close();
+    log() << "Flight record of " << recorder.recorded() << " ticks, "
+          << recorder.dropped() << " dropped, in " << recorder.path();
+}
+
+const nrg::flight_recorder &CompetitionState::recorder() const {
+    return m_impl->recorder;
+}
+
+void CompetitionState::start_flight_record() {
+    if (!params().flight_record || m_impl->recorder.is_open()) { return; }
+    QString name = "flight-" + QDateTime::currentDateTime().toString("yyyyMMdd-hhmmss") + ".bin";
+    std::string path = QDir::current().filePath(name).toStdString();
+    if (!start_recording(path)) {
+        log() << "Could not create flight record " << path;
+    }
+}
+
+param_manager &CompetitionState::params() const {
+    // The global parameters are created after the state
+    return m_params ? *m_params : *g_pm;
+}
+
+nrg::control_scheduler::clock::time_point CompetitionState::control_time() const {
+    return m_impl->scheduler.last_box();
+}
+
+void CompetitionState::log_control_stats() {
+    const nrg::tick_stats &stats = m_impl->scheduler.stats();
+    log() << "Control ticks " << stats.ticks
+          << ", latency mean " << stats.mean_latency_ms()
+          << " ms max " << stats.max_latency_ms()
+          << " ms, watchdog trips " << stats.watchdog_trips;
+    const nrg::pose_predictor &robot = m_impl->robot_predictor;
+    log() << "Box latency mean " << robot.latency_ms()
+          << " ms max " << robot.max_latency_ms()
+          << " ms, prediction error " << robot.prediction_err()
+          << " px against " << robot.unpredicted_err()
+          << " px unpredicted over " << robot.scored();
+    const nrg::histogram &interval = stats.interval;
+    if (!interval.count()) { return; }
+    log() << "Tick interval mean " << interval.mean()
+          << " ms, p50 " << interval.percentile(50)
+          << " ms p99 " << interval.percentile(99)
+          << " ms, min " << interval.min()
+          << " ms max " << interval.max() << " ms";
+    for (const std::string &row : interval.rows()) {
+        log() << row;
+    }
+}
+
+void CompetitionState::post_ui(std::function<void()> task) {
+    // Nothing drains the mailbox of a headless state
+    if (!m_parent) { return; }
+    if (m_impl->ui_mailbox.post(std::move(task))) {
+        Q_EMIT ui_posted();
+    }
+}
+
+void CompetitionState::drain_ui() {
+    m_impl->ui_mailbox.drain();
 }
 
 void CompetitionState::clear_path() {
@@ -162,19 +514,48 @@ const path2d &CompetitionState::get_path() const {
 }
 
 void CompetitionState::begin_traversal() {
-    m_procedure = std::make_unique<Procedure>(Main::get()->controller(), m_path);
-    m_procedure->start();
+    ControlThread &control = m_parent->control_thread();
+    control.configure(params().control_priority, params().control_cpu);
+    // The path and controller are copied, since the GUI may change them
+    std::weak_ptr<Controller> controller = m_parent->controller();
+    path2d path = m_path;
+    control.post([this, controller, path] {
+        // The old procedure goes first, since removing the last control
+        // loop stops the recording started for the new one
+        if (m_procedure) {
+            m_procedure->stop();
+            m_procedure.reset();
+        }
+        start_flight_record();
+        m_procedure = std::make_unique<Procedure>(*this, controller, path);
+        m_procedure->start();
+    });
 }
 
 void CompetitionState::halt_traversal() {
-    m_procedure->stop();
+    m_parent->control_thread().post([this] {
+        if (m_procedure) { m_procedure->stop(); }
+    });
 }
 
 void CompetitionState::begin_object_move() {
-    m_object_procedure = std::make_unique<ObjectProcedure>(Main::get()->controller(), m_path);
-    m_object_procedure->start();
+    ControlThread &control = m_parent->control_thread();
+    control.configure(params().control_priority, params().control_cpu);
+    std::weak_ptr<Controller> controller = m_parent->controller();
+    path2d path = m_path;
+    control.post([this, controller, path] {
+        if (m_object_procedure) {
+            m_object_procedure->stop();
+            m_object_procedure.reset();
+        }
+        start_flight_record();
+        m_object_procedure = std::make_unique<ObjectProcedure>(*this, controller, path);
+        m_object_procedure->start();
+    });
 }
 
 void CompetitionState::halt_object_move() {
-    m_object_procedure->stop();
+    m_parent->control_thread().post([this] {
+        if (m_object_procedure) { m_object_procedure->stop(); }
+    });
 }
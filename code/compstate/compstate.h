@@ -1,9 +1,14 @@
 #ifndef MINOTAUR_CPP_COMPSTATE_H
 #define MINOTAUR_CPP_COMPSTATE_H
 
+#include "controlscheduler.h"
+
 #include <QObject>
+#include <cstdint>
+#include <functional>
 #include <vector>
 #include <memory>
+#include <string>
 
 // Forward declarations
 namespace cv {
@@ -12,10 +17,13 @@ namespace cv {
 }
 namespace nrg {
     template<typename val_t> class vector;
+    class telemetry_slot;
+    class pose_predictor;
+    class flight_recorder;
 }
 template<typename val_t, typename size_t> class array2d;
 class MainWindow;
-class StatusLabel;
+class param_manager;
 class Procedure;
 class ObjectProcedure;
 typedef std::vector<nrg::vector<double>> path2d;
@@ -26,6 +34,22 @@ typedef std::vector<nrg::vector<double>> path2d;
  * running the robot and object at competition time.
  *
  * The global instance is held in the MainWindow.
+ *
+ * The procedures run on the control thread. Boxes from the trackers
+ * and requests to begin or halt a procedure are handed to the control
+ * thread, and the procedures update the GUI through the UI mailbox.
+ *
+ * Each control tick of a procedure may be recorded to a flight log,
+ * with the boxes, the commands sent, and the state of the innermost
+ * procedure, which decodes offline to CSV with flight-decode.
+ *
+ * The boxes, and whether they are fresh, are only touched on the
+ * control thread. Other threads, such as scripts, load a snapshot of
+ * them, published after each box without locks.
+ *
+ * Without a MainWindow the state is headless: boxes are handed over
+ * through receive_robot_box and receive_object_box on the calling
+ * thread, there is no watchdog timer, and UI tasks are dropped.
  */
 class CompetitionState : public QObject {
 Q_OBJECT
@@ -51,20 +75,81 @@ public:
         wall_y = 30
     };
 
-    explicit CompetitionState(MainWindow *parent);
+    /**
+     * One consistent view of the tracked boxes, published by the
+     * control thread once it has run the control loops for a box.
+     */
+    struct Snapshot {
+        // Boxes as tracked, as x, y, width and height
+        double robot[4];
+        double object[4];
+        double target[4];
+        // Times on the control clock, in nanoseconds from its epoch,
+        // at which the frames of the robot and object boxes were
+        // captured and the boxes received
+        std::int64_t robot_captured_ns;
+        std::int64_t robot_received_ns;
+        std::int64_t object_captured_ns;
+        std::int64_t object_received_ns;
+        // Boxes received, which increases with each publish
+        std::uint64_t seq;
+        bool robot_fresh;
+        bool object_fresh;
+        bool robot_valid;
+        bool object_valid;
+    };
+
+    /**
+     * @param parent the main window, or null for a headless state
+     * @param parameters parameters of the procedures, or null for the
+     *                   global parameters
+     */
+    explicit CompetitionState(MainWindow *parent, param_manager *parameters = nullptr);
     ~CompetitionState();
 
     Q_SIGNAL void request_robot_box();
     Q_SIGNAL void request_object_box();
 
-    Q_SLOT void acquire_robot_box(const cv::Rect2d &robot_box);
-    Q_SLOT void acquire_object_box(const cv::Rect2d &object_box);
+    /**
+     * Hand a new robot or object box to the control thread, which runs
+     * the control loops for it. May be called from any thread, so the
+     * trackers connect to these directly.
+     *
+     * @param captured time the frame of the box was captured
+     */
+    Q_SLOT void acquire_robot_box(const cv::Rect2d &robot_box, nrg::control_scheduler::clock::time_point captured);
+    Q_SLOT void acquire_object_box(const cv::Rect2d &object_box, nrg::control_scheduler::clock::time_point captured);
+    /**
+     * Hand a new target box to the control thread. May be called from
+     * any thread.
+     */
     Q_SLOT void acquire_target_box(const cv::Rect2d &target_box);
+
+    /**
+     * Store a new box and run the control loops for it. Called on the
+     * control thread, or directly by a headless simulation with the
+     * time of its virtual clock.
+     *
+     * @param captured time the frame of the box was captured
+     * @param received time at which the box arrived
+     * @param started  time at which the control tick starts
+     */
+    void receive_robot_box(
+        const cv::Rect2d &robot_box,
+        nrg::control_scheduler::clock::time_point captured,
+        nrg::control_scheduler::clock::time_point received,
+        nrg::control_scheduler::clock::time_point started = nrg::control_scheduler::clock::now());
+    void receive_object_box(
+        const cv::Rect2d &object_box,
+        nrg::control_scheduler::clock::time_point captured,
+        nrg::control_scheduler::clock::time_point received,
+        nrg::control_scheduler::clock::time_point started = nrg::control_scheduler::clock::now());
     Q_SLOT void acquire_walls(std::shared_ptr<wall_arr> &walls);
 
     Q_SLOT void clear_path();
     Q_SLOT void append_path(double x, double y);
 
+    // Procedures are started and stopped on the control thread
     Q_SLOT void begin_traversal();
     Q_SLOT void halt_traversal();
 
@@ -73,9 +158,22 @@ public:
 
     const path2d &get_path() const;
 
-    cv::Rect2d &get_robot_box(bool consume = false);
-    cv::Rect2d &get_object_box(bool consume = false);
-    cv::Rect2d &get_target_box();
+    /**
+     * Within a control tick, the robot and object boxes are predicted
+     * forward to when the commands of the tick act, unless disabled by
+     * the predict_latency parameter. Otherwise they are as tracked.
+     * Called on the control thread, as are the checks of whether the
+     * boxes are fresh and valid; other threads load snapshot().
+     */
+    const cv::Rect2d &get_robot_box(bool consume = false);
+    const cv::Rect2d &get_object_box(bool consume = false);
+    const cv::Rect2d &get_target_box() const;
+
+    /**
+     * @return the boxes as of the last one received, which may be
+     *         loaded from any thread
+     */
+    Snapshot snapshot() const;
 
     bool is_tracking_robot() const;
     void set_tracking_robot(bool tracking_robot);
@@ -92,18 +190,148 @@ public:
     bool is_robot_box_valid() const;
     bool is_object_box_valid() const;
 
+    /**
+     * Run a control loop every time a new robot or object box is
+     * received, while a watchdog checks that boxes keep arriving.
+     * Only the outermost procedure adds a loop, and ticks the
+     * procedures it starts. Called on the control thread.
+     *
+     * @param loop the movement loop of a procedure
+     * @return handle with which to remove the loop
+     */
+    nrg::control_scheduler::handle add_control_loop(nrg::control_scheduler::loop_fn loop);
+
+    /**
+     * Remove a control loop, if scheduled.
+     *
+     * @param h handle of the loop, reset to NO_HANDLE
+     */
+    void remove_control_loop(nrg::control_scheduler::handle &h);
+
+    const nrg::tick_stats &control_stats() const;
+
+    /**
+     * @return the estimators of the robot and object motion, with the
+     *         latency of the boxes and the error of the predictions
+     */
+    const nrg::pose_predictor &robot_predictor() const;
+    const nrg::pose_predictor &object_predictor() const;
+
+    /**
+     * Account a command sent to move the robot in the current control
+     * tick, whose displacement is predicted until a frame shows it.
+     *
+     * @param dir unit direction of the command
+     */
+    void robot_commanded(const nrg::vector<double> &dir);
+
+    /**
+     * Note in the flight record of the current control tick the state
+     * of a procedure. Procedures note their state as they step, so the
+     * innermost one to step last is recorded.
+     *
+     * @param procedure name of the procedure
+     * @param state     name of its state
+     */
+    void record_state(const char *procedure, const char *state);
+
+    /**
+     * Note in the flight record of the current control tick the error
+     * of the innermost procedure to its target.
+     */
+    void record_error(double err);
+    void record_error(double err, const nrg::vector<double> &target);
+
+    /**
+     * Record each control tick to a flight log until the last control
+     * loop is removed. Called on the control thread, and started with
+     * a procedure if the flight_record parameter is set.
+     *
+     * @param path file of the log
+     * @return false if the log could not be created
+     */
+    bool start_recording(const std::string &path);
+    void stop_recording();
+
+    const nrg::flight_recorder &recorder() const;
+
+    /**
+     * @return the parameters read by this state and its procedures,
+     *         which a simulation may give each state its own of
+     */
+    param_manager &params() const;
+
+    /**
+     * @return time at which the box of the current control tick was
+     *         received, on the virtual clock of a headless simulation
+     */
+    nrg::control_scheduler::clock::time_point control_time() const;
+
+    /**
+     * Run a task on the GUI thread, such as updating a widget. May be
+     * called from any thread, and tasks run in the order they were
+     * posted.
+     *
+     * @param task the task to run
+     */
+    void post_ui(std::function<void()> task);
+
+    Q_SIGNAL void ui_posted();
+
 private:
+    Q_SLOT void drain_ui();
+
+    /**
+     * Tick the outermost procedures for a new box. Boxes they consume
+     * are only marked stale once the tick is over.
+     *
+     * @param source   box that arrived, as in nrg::flight_record
+     * @param captured time the frame of the box was captured
+     * @param received time at which the box arrived
+     * @param started  time at which the tick starts
+     */
+    void run_control(
+        int source,
+        nrg::control_scheduler::clock::time_point captured,
+        nrg::control_scheduler::clock::time_point received,
+        nrg::control_scheduler::clock::time_point started);
+
+    /**
+     * Predict the robot and object boxes for the commands of a tick.
+     *
+     * @param received time at which the box of the tick arrived
+     */
+    void predict_boxes(nrg::control_scheduler::clock::time_point received);
+
+    void log_control_stats();
+
+    /**
+     * Publish the boxes for other threads. Called on the control
+     * thread.
+     */
+    void publish_snapshot();
+
+    /**
+     * Start a flight log named for the time, if the flight_record
+     * parameter is set.
+     */
+    void start_flight_record();
+
     // Pointer to MainWindow parent
     MainWindow *m_parent;
+    // Parameters given at construction, or null for g_pm
+    param_manager *m_params;
 
     // Impl pointer containing rectangles for robot, object, and target boxes
     class Impl;
     std::unique_ptr<Impl> m_impl;
 
-    // Status labels to display the robot and object positions
-    // based on rectangles posted to the object
-    StatusLabel *m_robot_loc_label;
-    StatusLabel *m_object_loc_label;
+    // Telemetry of the status labels displaying the robot and object
+    // positions, based on rectangles posted to the object
+    std::shared_ptr<nrg::telemetry_slot> m_robot_loc;
+    std::shared_ptr<nrg::telemetry_slot> m_object_loc;
+    // Telemetry of the box latency and the prediction error
+    std::shared_ptr<nrg::telemetry_slot> m_latency;
 
     bool m_tracking_robot;
     bool m_tracking_object;
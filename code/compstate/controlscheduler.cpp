@@ -0,0 +1,134 @@
+#include "controlscheduler.h"
+
+#include <algorithm>
+#include <initializer_list>
+
+typedef std::chrono::duration<double, std::milli> millis;
+
+nrg::tick_stats::tick_stats() :
+    ticks(0),
+    watchdog_trips(0),
+    total_latency(0),
+    max_latency(0),
+    last_latency(0),
+    interval(1, 100) {}
+
+double nrg::tick_stats::mean_latency_ms() const {
+    return ticks ? millis(total_latency).count() / ticks : 0;
+}
+
+double nrg::tick_stats::max_latency_ms() const {
+    return millis(max_latency).count();
+}
+
+double nrg::tick_stats::last_latency_ms() const {
+    return millis(last_latency).count();
+}
+
+nrg::control_scheduler::control_scheduler(clock::duration timeout) :
+    m_timeout(timeout),
+    m_next(NO_HANDLE + 1),
+    m_active(0),
+    m_running(false),
+    m_lost(false),
+    m_ticked(false),
+    m_last_box(clock::now()) {}
+
+nrg::control_scheduler::handle nrg::control_scheduler::add(loop_fn loop) {
+    if (m_active == 0) {
+        // The watchdog only counts from when loops are waiting on boxes
+        m_last_box = clock::now();
+        m_lost = false;
+        m_ticked = false;
+    }
+    handle id = m_next++;
+    (m_running ? m_added : m_loops).push_back({id, std::move(loop), true});
+    ++m_active;
+    return id;
+}
+
+void nrg::control_scheduler::remove(handle h) {
+    for (std::vector<entry> *loops : {&m_loops, &m_added}) {
+        for (entry &e : *loops) {
+            if (e.id == h && e.active) {
+                // The loop may be the one running, so it is only
+                // destroyed once the tick is over
+                e.active = false;
+                --m_active;
+                break;
+            }
+        }
+    }
+    if (!m_running) { compact(); }
+}
+
+void nrg::control_scheduler::compact() {
+    auto inactive = [](const entry &e) { return !e.active; };
+    m_loops.erase(std::remove_if(m_loops.begin(), m_loops.end(), inactive), m_loops.end());
+    for (entry &e : m_added) {
+        if (e.active) { m_loops.push_back(std::move(e)); }
+    }
+    m_added.clear();
+}
+
+std::size_t nrg::control_scheduler::size() const {
+    return m_active;
+}
+
+void nrg::control_scheduler::tick(clock::time_point received) {
+    tick(received, clock::now());
+}
+
+void nrg::control_scheduler::tick(clock::time_point received, clock::time_point started) {
+    m_last_box = received;
+    m_lost = false;
+    if (m_active == 0 || m_running) { return; }
+    m_running = true;
+    // Loops added during the tick wait for the next box
+    for (entry &e : m_loops) {
+        if (e.active) { e.loop(); }
+    }
+    m_running = false;
+    compact();
+
+    clock::duration latency = clock::now() - received;
+    ++m_stats.ticks;
+    m_stats.total_latency += latency;
+    m_stats.max_latency = std::max(m_stats.max_latency, latency);
+    m_stats.last_latency = latency;
+    if (m_ticked) {
+        // Measured from when ticks ran, not when their boxes arrived,
+        // so delays on the control thread show as jitter
+        m_stats.interval.add(millis(started - m_last_tick).count());
+    }
+    m_ticked = true;
+    m_last_tick = started;
+}
+
+bool nrg::control_scheduler::check_watchdog(clock::time_point now) {
+    if (m_active == 0 || m_lost || now - m_last_box <= m_timeout) { return false; }
+    m_lost = true;
+    ++m_stats.watchdog_trips;
+    return true;
+}
+
+bool nrg::control_scheduler::is_tracking_lost() const {
+    return m_lost;
+}
+
+nrg::control_scheduler::clock::time_point nrg::control_scheduler::last_box() const {
+    return m_last_box;
+}
+
+void nrg::control_scheduler::set_timeout(clock::duration timeout) {
+    m_timeout = timeout;
+}
+
+const nrg::tick_stats &nrg::control_scheduler::stats() const {
+    return m_stats;
+}
+
+void nrg::control_scheduler::reset_stats() {
+    m_stats = tick_stats();
+    m_ticked = false;
+}
@@ -0,0 +1,154 @@
+#ifndef MINOTAUR_CPP_CONTROLSCHEDULER_H
+#define MINOTAUR_CPP_CONTROLSCHEDULER_H
+
+#include "../utility/histogram.h"
+
+#include <chrono>
+#include <functional>
+#include <vector>
+
+namespace nrg {
+
+    /**
+     * Latency statistics of the control ticks. Latency is the time from
+     * the arrival of a tracker box to the end of the control loops it
+     * triggered. The interval between the starts of consecutive ticks
+     * is kept as a histogram in milliseconds, whose spread is the
+     * control jitter, including any delay in running the ticks.
+     */
+    struct tick_stats {
+        typedef std::chrono::steady_clock::duration duration;
+
+        tick_stats();
+
+        double mean_latency_ms() const;
+        double max_latency_ms() const;
+        double last_latency_ms() const;
+
+        // Ticks that ran at least one control loop
+        std::size_t ticks;
+        // Times tracking was declared lost by the watchdog
+        std::size_t watchdog_trips;
+        duration total_latency;
+        duration max_latency;
+        duration last_latency;
+        // Milliseconds between the starts of consecutive ticks
+        histogram interval;
+    };
+
+    /**
+     * Runs the control loops of the active procedures whenever the
+     * tracker delivers a new box, instead of each procedure polling on
+     * its own timer. Loops run in the order they were added, so an
+     * outer procedure runs before the procedures it has started.
+     *
+     * Loops may be added or removed from within a loop. Added loops
+     * first run on the next tick, and removed loops are not called
+     * again, even later in the same tick.
+     *
+     * A watchdog declares tracking lost when no box has arrived within
+     * a timeout while loops are active.
+     */
+    class control_scheduler {
+    public:
+        typedef std::chrono::steady_clock clock;
+        typedef std::function<void()> loop_fn;
+        typedef std::size_t handle;
+
+        enum {
+            // Handle that never refers to a loop
+            NO_HANDLE = 0,
+            DEFAULT_TIMEOUT_MS = 500
+        };
+
+        explicit control_scheduler(clock::duration timeout = std::chrono::milliseconds(DEFAULT_TIMEOUT_MS));
+
+        /**
+         * Add a control loop.
+         *
+         * @param loop function run on every tick
+         * @return handle with which to remove the loop
+         */
+        handle add(loop_fn loop);
+
+        /**
+         * Remove a control loop. Unknown handles are ignored.
+         *
+         * @param h handle returned by add
+         */
+        void remove(handle h);
+
+        /**
+         * @return number of active loops
+         */
+        std::size_t size() const;
+
+        /**
+         * Run every active loop for a newly received box, starting now.
+         *
+         * @param received time at which the box arrived
+         */
+        void tick(clock::time_point received = clock::now());
+
+        /**
+         * Run every active loop for a newly received box.
+         *
+         * @param received time at which the box arrived
+         * @param started  time at which the tick starts, such as on the
+         *                 virtual clock of a simulation
+         */
+        void tick(clock::time_point received, clock::time_point started);
+
+        /**
+         * Check whether tracking has been lost.
+         *
+         * @param now current time
+         * @return true only on the check that first finds the last box
+         *         older than the timeout
+         */
+        bool check_watchdog(clock::time_point now = clock::now());
+
+        /**
+         * @return true from a watchdog trip until the next tick
+         */
+        bool is_tracking_lost() const;
+
+        /**
+         * @return time at which the last box arrived, which is the
+         *         time of the current tick while loops run
+         */
+        clock::time_point last_box() const;
+
+        void set_timeout(clock::duration timeout);
+
+        const tick_stats &stats() const;
+
+        void reset_stats();
+
+    private:
+        struct entry {
+            handle id;
+            loop_fn loop;
+            bool active;
+        };
+
+        void compact();
+
+        clock::duration m_timeout;
+        std::vector<entry> m_loops;
+        // Loops added during a tick, kept apart so that the list being
+        // run is never reallocated under a running loop
+        std::vector<entry> m_added;
+        handle m_next;
+        std::size_t m_active;
+        bool m_running;
+        bool m_lost;
+        bool m_ticked;
+        clock::time_point m_last_box;
+        clock::time_point m_last_tick;
+        tick_stats m_stats;
+    };
+
+}
+
+#endif //MINOTAUR_CPP_CONTROLSCHEDULER_H
@@ -0,0 +1,57 @@
+#include "controlthread.h"
+
+#include "../utility/logger.h"
+#include "../utility/realtime.h"
+
+ControlThread::ControlThread(QObject *parent) :
+    QThread(parent),
+    m_receiver(std::make_unique<QObject>()),
+    m_priority(0),
+    m_cpu(-1) {
+    m_receiver->moveToThread(this);
+    // Queued, so the mailbox is drained by the event loop of the thread
+    connect(this, &ControlThread::posted, m_receiver.get(), [this] {
+        m_mailbox.drain();
+    }, Qt::QueuedConnection);
+}
+
+ControlThread::~ControlThread() {
+    stop();
+}
+
+void ControlThread::post(task_fn task) {
+    if (m_mailbox.post(std::move(task))) {
+        Q_EMIT posted();
+    }
+}
+
+bool ControlThread::is_current() const {
+    return QThread::currentThread() == this;
+}
+
+void ControlThread::configure(int priority, int cpu) {
+    post([this, priority, cpu] {
+        // Failures are only reported once for each requested value
+        if (priority != m_priority) {
+            m_priority = priority;
+            if (nrg::set_realtime_priority(priority)) {
+                log() << "Control thread priority set to " << priority;
+            } else {
+                fatal() << "Failed to set control thread priority to " << priority;
+            }
+        }
+        if (cpu != m_cpu) {
+            m_cpu = cpu;
+            if (nrg::set_cpu_affinity(cpu)) {
+                log() << "Control thread pinned to CPU " << cpu;
+            } else {
+                fatal() << "Failed to pin control thread to CPU " << cpu;
+            }
+        }
+    });
+}
+
+void ControlThread::stop() {
+    quit();
+    wait();
+}
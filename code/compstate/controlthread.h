@@ -0,0 +1,69 @@
+#ifndef MINOTAUR_CPP_CONTROLTHREAD_H
+#define MINOTAUR_CPP_CONTROLTHREAD_H
+
+#include "../utility/mailbox.h"
+
+#include <QThread>
+#include <memory>
+
+/**
+ * Thread on which the procedures and controller commands run, so that
+ * repainting, mouse input and logging on the GUI thread do not delay
+ * the control loops. The thread runs a Qt event loop, so QObjects such
+ * as the serial port of the solenoid may be moved onto it, and other
+ * threads hand it work through a mailbox.
+ *
+ * The thread may optionally be given real-time priority and be pinned
+ * to a CPU.
+ */
+class ControlThread final : public QThread {
+Q_OBJECT
+
+public:
+    typedef nrg::mailbox::task_fn task_fn;
+
+    explicit ControlThread(QObject *parent = nullptr);
+
+    ~ControlThread() override;
+
+    /**
+     * Run a task on the control thread. May be called from any thread,
+     * and tasks run in the order they were posted.
+     *
+     * @param task the task to run
+     */
+    void post(task_fn task);
+
+    /**
+     * @return true if called from the control thread
+     */
+    bool is_current() const;
+
+    /**
+     * Set the scheduling of the control thread, if it differs from the
+     * last requested scheduling. Applied on the control thread, and
+     * failures are logged.
+     *
+     * @param priority SCHED_FIFO priority, or zero for the default policy
+     * @param cpu      CPU to pin the thread to, or negative for any
+     */
+    void configure(int priority, int cpu);
+
+    /**
+     * Stop the event loop and wait for the thread to finish. Tasks
+     * still queued are dropped.
+     */
+    void stop();
+
+    Q_SIGNAL void posted();
+
+private:
+    nrg::mailbox m_mailbox;
+    // Receives the posted signals on the control thread
+    std::unique_ptr<QObject> m_receiver;
+    // Scheduling last requested, only touched on the control thread
+    int m_priority;
+    int m_cpu;
+};
+
+#endif //MINOTAUR_CPP_CONTROLTHREAD_H
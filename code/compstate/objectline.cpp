@@ -3,16 +3,12 @@
 #include "objectmove.h"
 #include "parammanager.h"
 #include "readymove.h"
+#include "uilabel.h"
 
-#include "../camera/statusbox.h"
-#include "../camera/statuslabel.h"
-#include "../gui/global.h"
 #include "../utility/algorithm.h"
 #include "../utility/logger.h"
 #include "../utility/vector.h"
 
-#include <QBasicTimer>
-#include <QTimerEvent>
 #include <cassert>
 
 enum State {
@@ -31,47 +27,55 @@ enum State {
 
 class ObjectLine::Impl {
 public:
-    Impl(int t_dir, double t_target, double t_base, State t_state);
+    Impl(int t_dir, double t_target, double t_base);
     nrg::dir dir;
     double target;
     double base;
-    State state;
-    QBasicTimer timer;
+    // Handle of the movement loop while it is scheduled
+    nrg::control_scheduler::handle loop = nrg::control_scheduler::NO_HANDLE;
     nrg::dir correction_dir;
+    // State last written to the log, which is only written on a change
+    int logged_state = -1;
 };
 
-ObjectLine::Impl::Impl(int t_dir, double t_target, double t_base, State t_state) :
+ObjectLine::Impl::Impl(int t_dir, double t_target, double t_base) :
     dir(static_cast<nrg::dir>(t_dir)),
     target(t_target),
-    base(t_base),
-    state(t_state) {}
+    base(t_base) {}
 
 ObjectLine::ObjectLine(
+    CompetitionState &state,
     std::weak_ptr<Controller> sol,
     int dir,
     double target,
     double base
 ) :
+    // Names in the order of State
+    nrg::state_machine({
+        "REQUIRE_READY_MOVE", "DOING_READY_MOVE",
+        "REQUIRE_OBJECT_MOVE", "DOING_OBJECT_MOVE",
+        "REQUIRE_CORRECTION",
+        "REQUIRE_CORRECTION_READY_MOVE", "DOING_CORRECTION_READY_MOVE",
+        "REQUIRE_CORRECTION_OBJECT_MOVE", "DOING_CORRECTION_OBJECT_MOVE"
+    }),
+    m_compstate(state),
     m_sol(std::move(sol)),
-    m_impl(std::make_unique<Impl>(dir, target, base, State::REQUIRE_READY_MOVE)),
-    m_done(false) {
-    if (auto lp = Main::get()->status_box().lock()) {
-        m_state_label = lp->add_label("Line State: 0");
-    }
+    m_impl(std::make_unique<Impl>(dir, target, base)) {
+    m_state_label = std::make_unique<UiLabel>(m_compstate, [](const nrg::telemetry_slot::values &v) {
+        return "Line State: " + QString::number(v[0]);
+    });
 }
 
 ObjectLine::~ObjectLine() {
-    if (auto lp = Main::get()->status_box().lock()) {
-        lp->remove_label(m_state_label);
-    }
+    m_compstate.remove_control_loop(m_impl->loop);
 }
 
 void ObjectLine::start() {
-    m_impl->timer.start(g_pm->timer_fast, this);
+    m_impl->loop = m_compstate.add_control_loop([this] { tick(m_compstate.control_time()); });
 }
 
 void ObjectLine::stop() {
-    m_impl->timer.stop();
+    m_compstate.remove_control_loop(m_impl->loop);
     if (m_ready_move != nullptr) {
         m_ready_move->stop();
     }
@@ -80,28 +84,23 @@ void ObjectLine::stop() {
     }
 }
 
-bool ObjectLine::is_done() const {
-    return m_done;
+bool ObjectLine::ready() const {
+    CompetitionState &state = m_compstate;
+    return
+        state.is_robot_box_fresh() &&
+        state.is_robot_box_valid() &&
+        state.is_object_box_fresh() &&
+        state.is_object_box_valid();
 }
 
-void ObjectLine::timerEvent(QTimerEvent *ev) {
-    if (ev->timerId() == m_impl->timer.timerId()) {
-        movement_loop();
+void ObjectLine::step(int state) {
+    m_compstate.record_state("ObjectLine", state_name(state));
+    if (state != m_impl->logged_state) {
+        log() << "Line State: " << state;
+        m_impl->logged_state = state;
     }
-}
-
-void ObjectLine::movement_loop() {
-    CompetitionState &state = Main::get()->state();
-    if (
-        !state.is_robot_box_fresh() ||
-        !state.is_robot_box_valid() ||
-        !state.is_object_box_fresh() ||
-        !state.is_object_box_valid()
-    ) { return; }
-
-    log() << "Line State: " <<  m_impl->state;
-    m_state_label->setText("Line State: " + QString::number(m_impl->state));
-    switch (m_impl->state) {
+    m_state_label->publish(state);
+    switch (state) {
         case State::REQUIRE_READY_MOVE:
             do_require_ready_move();
             break;
@@ -137,10 +136,9 @@ void ObjectLine::movement_loop() {
 void ObjectLine::do_require_ready_move() {
     // Find the side of the object on which the robot needs to be
     nrg::dir side_dir = invert_dir(m_impl->dir);
-    m_ready_move = std::make_unique<ReadyMove>(m_sol, side_dir);
-    // Hand control over to ReadyMove
-    m_ready_move->start();
-    m_impl->state = State::DOING_READY_MOVE;
+    // Hand control over to ReadyMove, which is ticked from this procedure
+    m_ready_move = std::make_unique<ReadyMove>(m_compstate, m_sol, side_dir);
+    transition(State::DOING_READY_MOVE);
 }
 
 void ObjectLine::do_doing_ready_move() {
@@ -148,9 +146,15 @@ void ObjectLine::do_doing_ready_move() {
     assert(!!m_ready_move);
 #endif
     // When the ReadyMove is done, process the ObjectMove
+    m_ready_move->tick(now());
+    if (m_ready_move->is_failed()) {
+        m_compstate.remove_control_loop(m_impl->loop);
+        fail();
+        return;
+    }
     if (m_ready_move->is_done()) {
         m_ready_move.reset();
-        m_impl->state = State::REQUIRE_OBJECT_MOVE;
+        transition(State::REQUIRE_OBJECT_MOVE);
     }
 }
 
@@ -158,17 +162,17 @@ void ObjectLine::do_require_object_move() {
     nrg::dir dir = m_impl->dir;
     double target = m_impl->target;
     double norm_base = m_impl->base;
-    double norm_dev = g_pm->objline_move_dev;
+    double norm_dev = m_compstate.params().objline_move_dev;
     // Hand control over to the ObjectMove
-    m_object_move = std::make_unique<ObjectMove>(m_sol, dir, target, norm_base, norm_dev);
-    m_object_move->start();
-    m_impl->state = State::DOING_OBJECT_MOVE;
+    m_object_move = std::make_unique<ObjectMove>(m_compstate, m_sol, dir, target, norm_base, norm_dev);
+    transition(State::DOING_OBJECT_MOVE);
 }
 
 void ObjectLine::do_doing_object_move() {
 #ifndef NDEBUG
     assert(!!m_object_move);
 #endif
+    m_object_move->tick(now());
     if (!m_object_move->is_done()) {
         return;
     }
@@ -182,16 +186,19 @@ void ObjectLine::do_doing_object_move() {
     switch (stop_cond) {
         case ObjectMove::Stop::AT_TARGET:
             // If the ObjectMove is at the target, then this procedure is complete
-            m_impl->timer.stop();
-            m_done = true;
+            m_compstate.remove_control_loop(m_impl->loop);
+            finish();
+            for (const std::string &row : state_rows()) {
+                log() << "Line " << row;
+            }
             return;
         case ObjectMove::Stop::WRONG_SIDE:
             // Go back to needing a ReadyMove
-            m_impl->state = State::REQUIRE_READY_MOVE;
+            transition(State::REQUIRE_READY_MOVE);
             return;
         case ObjectMove::Stop::EXCEEDED_NORM:
             // Perform a correction
-            m_impl->state = State::REQUIRE_CORRECTION;
+            transition(State::REQUIRE_CORRECTION);
             return;
         default:
             return;
@@ -200,7 +207,7 @@ void ObjectLine::do_doing_object_move() {
 
 void ObjectLine::do_require_correction() {
     // Determine the correction direction
-    CompetitionState &state = Main::get()->state();
+    CompetitionState &state = m_compstate;
     vector2d obj_loc = rect2d(state.get_object_box(true)).center();
     switch (m_impl->dir) {
         case nrg::dir::RIGHT:
@@ -214,25 +221,30 @@ void ObjectLine::do_require_correction() {
         default:
             break;
     }
-    m_impl->state = State::REQUIRE_CORRECTION_READY_MOVE;
+    transition(State::REQUIRE_CORRECTION_READY_MOVE);
 }
 
 void ObjectLine::do_require_correction_ready_move() {
     nrg::dir side_dir = invert_dir(m_impl->correction_dir);
     // ReadyMove over to the correction side
-    m_ready_move = std::make_unique<ReadyMove>(m_sol, side_dir);
-    m_ready_move->start();
-    m_impl->state = State::DOING_CORRECTION_READY_MOVE;
+    m_ready_move = std::make_unique<ReadyMove>(m_compstate, m_sol, side_dir);
+    transition(State::DOING_CORRECTION_READY_MOVE);
 }
 
 void ObjectLine::do_doing_correction_ready_move() {
 #ifndef NDEBUG
     assert(!!m_ready_move);
 #endif
+    m_ready_move->tick(now());
+    if (m_ready_move->is_failed()) {
+        m_compstate.remove_control_loop(m_impl->loop);
+        fail();
+        return;
+    }
     if (m_ready_move->is_done()) {
         m_ready_move.reset();
         // Ready to perform correction move
-        m_impl->state = State::REQUIRE_CORRECTION_OBJECT_MOVE;
+        transition(State::REQUIRE_CORRECTION_OBJECT_MOVE);
     }
 }
 
@@ -242,16 +254,16 @@ void ObjectLine::do_require_correction_object_move() {
     // Base and deviation don't matter in this case
     double norm_base = 0;
     double norm_dev = std::numeric_limits<double>::max();
-    m_object_move = std::make_unique<ObjectMove>(m_sol, dir, target, norm_base, norm_dev);
+    m_object_move = std::make_unique<ObjectMove>(m_compstate, m_sol, dir, target, norm_base, norm_dev);
     // Hand over control
-    m_object_move->start();
-    m_impl->state = State::DOING_CORRECTION_OBJECT_MOVE;
+    transition(State::DOING_CORRECTION_OBJECT_MOVE);
 }
 
 void ObjectLine::do_doing_correction_object_move() {
 #ifndef NDEBUG
     assert(!!m_object_move);
 #endif
+    m_object_move->tick(now());
     if (!m_object_move->is_done()) {
         return;
     }
@@ -263,5 +275,5 @@ void ObjectLine::do_doing_correction_object_move() {
     assert(stop_cond != ObjectMove::Stop::EXCEEDED_NORM);
 #endif
     m_object_move.reset();
-    m_impl->state = State::REQUIRE_READY_MOVE;
+    transition(State::REQUIRE_READY_MOVE);
 }
@@ -1,11 +1,14 @@
 #ifndef MINOTAUR_CPP_OBJECTLINE_H
 #define MINOTAUR_CPP_OBJECTLINE_H
 
+#include "statemachine.h"
+
 #include <QObject>
 #include <memory>
 
+class CompetitionState;
 class Controller;
-class StatusLabel;
+class UiLabel;
 class ObjectMove;
 class ReadyMove;
 
@@ -20,23 +23,23 @@ class ReadyMove;
  * move the robot to a correction side and use ObjectMove to reduce the normal
  * deviation, without caring for displacement along the line of motion.
  */
-class ObjectLine : public QObject {
+class ObjectLine : public QObject, public nrg::state_machine {
 Q_OBJECT
 
 public:
-    explicit ObjectLine(std::weak_ptr<Controller> sol, int dir, double target, double base);
+    ObjectLine(CompetitionState &state, std::weak_ptr<Controller> sol, int dir, double target, double base);
     ~ObjectLine() override;
 
     void start();
     void stop();
 
-    bool is_done() const;
+protected:
+    void step(int state) override;
 
-private:
-    void timerEvent(QTimerEvent *ev) override;
+    bool ready() const override;
 
+private:
     class Impl;
-    void movement_loop();
 
     void do_require_ready_move();
     void do_doing_ready_move();
@@ -49,11 +52,11 @@ private:
     void do_require_correction_object_move();
     void do_doing_correction_object_move();
 
+    CompetitionState &m_compstate;
     std::weak_ptr<Controller> m_sol;
     std::unique_ptr<Impl> m_impl;
-    bool m_done;
 
-    StatusLabel *m_state_label;
+    std::unique_ptr<UiLabel> m_state_label;
 
     std::unique_ptr<ReadyMove> m_ready_move;
     std::unique_ptr<ObjectMove> m_object_move;
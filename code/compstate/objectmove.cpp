@@ -2,16 +2,11 @@
 #include "objectmove.h"
 #include "parammanager.h"
 #include "procedure.h"
+#include "uilabel.h"
 
-#include "../camera/statusbox.h"
-#include "../camera/statuslabel.h"
-#include "../gui/mainwindow.h"
-#include "../gui/global.h"
-#include "../utility/logger.h"
-#include "../utility/rect.h"
+#include "../controller/controller.h"
 
-#include <QBasicTimer>
-#include <QTimerEvent>
+#include "../utility/rect.h"
 
 static QString align_text(double align_err) {
     QString text;
@@ -31,6 +26,7 @@ public:
         double t_target,
         double t_norm_base,
         double t_norm_dev,
+        CompetitionState &state,
         std::weak_ptr<Controller> sol);
 
     nrg::dir dir;
@@ -38,9 +34,10 @@ public:
     double norm_base;
     double norm_dev;
     Procedure delegate;
-    QBasicTimer timer;
+    // Handle of the movement loop while it is scheduled
+    nrg::control_scheduler::handle loop = nrg::control_scheduler::NO_HANDLE;
 
-    void do_move(double delta);
+    void do_move();
     void correct(double delta);
 
     /**
@@ -90,39 +87,38 @@ ObjectMove::Impl::Impl(
     double t_target,
     double t_norm_base,
     double t_norm_dev,
+    CompetitionState &state,
     std::weak_ptr<Controller> sol) :
     dir(static_cast<nrg::dir>(t_dir)),
     target(t_target),
     norm_base(t_norm_base),
     norm_dev(t_norm_dev),
-    delegate(std::move(sol), {}) {}
+    delegate(state, std::move(sol), {}) {}
 
 ObjectMove::ObjectMove(
+    CompetitionState &state,
     std::weak_ptr<Controller> sol,
     int dir,
     double target,
     double norm_base,
     double norm_dev
 ) :
-    m_impl(std::make_unique<Impl>(dir, target, norm_base, norm_dev, sol)),
+    // The object is pushed in a single state
+    nrg::state_machine({"PUSH"}),
+    m_compstate(state),
+    m_impl(std::make_unique<Impl>(dir, target, norm_base, norm_dev, state, sol)),
     m_sol(sol),
-    m_done(false),
     m_stop(Stop::OKAY) {
-    if (auto lp = Main::get()->status_box().lock()) {
-        m_align_label = lp->add_label(align_text(0));
-        m_target_label = lp->add_label(target_text(0));
-    }
+    m_align_label = std::make_unique<UiLabel>(m_compstate, [](const nrg::telemetry_slot::values &v) {
+        return align_text(v[0]);
+    });
+    m_target_label = std::make_unique<UiLabel>(m_compstate, [](const nrg::telemetry_slot::values &v) {
+        return target_text(v[0]);
+    });
 }
 
 ObjectMove::~ObjectMove() {
-    if (auto lp = Main::get()->status_box().lock()) {
-        lp->remove_label(m_align_label);
-        lp->remove_label(m_target_label);
-    }
-}
-
-bool ObjectMove::is_done() const {
-    return m_done;
+    m_compstate.remove_control_loop(m_impl->loop);
 }
 
 ObjectMove::Stop ObjectMove::get_stop() const {
@@ -130,29 +126,25 @@ ObjectMove::Stop ObjectMove::get_stop() const {
 }
 
 void ObjectMove::start() {
-    m_impl->timer.start(g_pm->timer_reg, this);
+    m_impl->loop = m_compstate.add_control_loop([this] { tick(m_compstate.control_time()); });
 }
 
 void ObjectMove::stop() {
-    m_impl->timer.stop();
+    m_compstate.remove_control_loop(m_impl->loop);
 }
 
-void ObjectMove::timerEvent(QTimerEvent *ev) {
-    if (ev->timerId() == m_impl->timer.timerId()) {
-        movement_loop();
-    }
+bool ObjectMove::ready() const {
+    CompetitionState &state = m_compstate;
+    return
+        state.is_robot_box_fresh() &&
+        state.is_robot_box_valid() &&
+        state.is_object_box_fresh() &&
+        state.is_object_box_valid();
 }
 
-void ObjectMove::movement_loop() {
-    CompetitionState &state = Main::get()->state();
-    if (
-        !state.is_robot_box_fresh() ||
-        !state.is_robot_box_valid() ||
-        !state.is_object_box_fresh() ||
-        !state.is_object_box_valid()
-        ) {
-        return;
-    }
+void ObjectMove::step(int current) {
+    CompetitionState &state = m_compstate;
+    state.record_state("ObjectMove", state_name(current));
     rect2d rob = state.get_robot_box(true);
     rect2d obj = state.get_object_box(true);
     vector2d obj_loc = obj.center();
@@ -168,40 +160,40 @@ void ObjectMove::movement_loop() {
         m_stop = Stop::WRONG_SIDE;
     }
     if (m_stop != Stop::OKAY) {
-        m_impl->timer.stop();
-        m_done = true;
+        m_compstate.remove_control_loop(m_impl->loop);
+        finish();
         return;
     }
     // Make sure the robot is aligned for proper movement
     double align_err = m_impl->alignment_err(rob_loc, obj_loc);
     double tgt_err = m_impl->target_err(obj_loc);
-    log() << "Align Err:  " << align_err;
-    log() << "Target Err: " << tgt_err;
-    m_align_label->setText(align_text(align_err));
-    m_target_label->setText(target_text(tgt_err));
-    if (fabs(align_err) > g_pm->objmove_algn_err) {
+    m_align_label->publish(align_err);
+    m_target_label->publish(tgt_err);
+    state.record_error(tgt_err);
+    if (fabs(align_err) > m_compstate.params().objmove_algn_err) {
         // Correct for alignment
         m_impl->correct(align_err);
     } else {
         // Move in desired direction
-        m_impl->do_move(tgt_err);
+        m_impl->do_move();
     }
 }
 
-void ObjectMove::Impl::do_move(double delta) {
-    if (delta < 1) { delta = 1; }
+void ObjectMove::Impl::do_move() {
+    // The object is pushed at full power
+    const double power = Controller::MAX_POWER;
     switch (dir) {
         case nrg::dir::RIGHT:
-            delegate.move_right(delta);
+            delegate.move_right(power);
             break;
         case nrg::dir::LEFT:
-            delegate.move_left(delta);
+            delegate.move_left(power);
             break;
         case nrg::dir::DOWN:
-            delegate.move_down(delta);
+            delegate.move_down(power);
             break;
         case nrg::dir::UP:
-            delegate.move_up(delta);
+            delegate.move_up(power);
             break;
         default:
             break;
@@ -209,16 +201,17 @@ void ObjectMove::Impl::do_move(double delta) {
 }
 
 void ObjectMove::Impl::correct(double delta) {
+    const double power = Controller::MAX_POWER;
     switch (dir) {
         case nrg::dir::DOWN:
         case nrg::dir::UP:
-            if (delta > 0) { delegate.move_right(delta); }
-            else if (delta < 0) { delegate.move_left(-delta); }
+            if (delta > 0) { delegate.move_right(power); }
+            else if (delta < 0) { delegate.move_left(power); }
             break;
         case nrg::dir::RIGHT:
         case nrg::dir::LEFT:
-            if (delta > 0) { delegate.move_down(delta); }
-            else if (delta < 0) { delegate.move_up(-delta); }
+            if (delta > 0) { delegate.move_down(power); }
+            else if (delta < 0) { delegate.move_up(power); }
             break;
         default:
             break;
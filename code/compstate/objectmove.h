@@ -1,6 +1,8 @@
 #ifndef MINOTAUR_CPP_OBJECTMOVE_H
 #define MINOTAUR_CPP_OBJECTMOVE_H
 
+#include "statemachine.h"
+
 #include <QObject>
 #include <memory>
 
@@ -8,8 +10,9 @@
 namespace nrg {
     template<typename val_t> class vector;
 }
+class CompetitionState;
 class Controller;
-class StatusLabel;
+class UiLabel;
 typedef nrg::vector<double> vector2d;
 
 /**
@@ -34,7 +37,7 @@ typedef nrg::vector<double> vector2d;
  * the object. If the object is moving in the x-direction, normal base value
  * is the initial y-value, and normal deviation is the maximum difference to this.
  */
-class ObjectMove : public QObject {
+class ObjectMove : public QObject, public nrg::state_machine {
 Q_OBJECT
 
 public:
@@ -51,13 +54,15 @@ public:
     /**
      * Create a new ObjectMove procedure.
      *
+     * @param state     competition state providing the boxes
      * @param sol       reference to controller passed to delegate procedure
      * @param dir       desired movement direction of the object
      * @param target    the target x or y value for the object
      * @param norm_base the base normal value for object alignment
      * @param norm_dev  the maximum deviation from the normal base value
      */
-    explicit ObjectMove(
+    ObjectMove(
+        CompetitionState &state,
         std::weak_ptr<Controller> sol,
         int dir,
         double target,
@@ -69,19 +74,21 @@ public:
     void start();
     void stop();
 
-    bool is_done() const;
     Stop get_stop() const;
 
+protected:
+    void step(int state) override;
+
+    bool ready() const override;
+
 private:
-    void timerEvent(QTimerEvent *ev) override;
 
-    void movement_loop();
+    CompetitionState &m_compstate;
 
     class Impl;
     std::unique_ptr<Impl> m_impl;
     std::weak_ptr<Controller> m_sol;
 
-    bool m_done;
     /**
      * The stop condition, which is OKAY unless the ObjectMove
      * is completed. When is_done() == true, this value is set
@@ -89,8 +96,8 @@ private:
      */
     Stop m_stop;
 
-    StatusLabel *m_align_label;
-    StatusLabel *m_target_label;
+    std::unique_ptr<UiLabel> m_align_label;
+    std::unique_ptr<UiLabel> m_target_label;
 };
 
 #endif //MINOTAUR_CPP_OBJECTMOVE_H
@@ -2,15 +2,16 @@
 #include "objectline.h"
 #include "objectprocedure.h"
 #include "parammanager.h"
+#include "uilabel.h"
 
-#include "../camera/statusbox.h"
-#include "../camera/statuslabel.h"
-#include "../gui/mainwindow.h"
-#include "../gui/global.h"
 #include "../utility/algorithm.h"
+#include "../utility/logger.h"
 
-#include <QBasicTimer>
-#include <QTimerEvent>
+enum State {
+    INITIALIZE,
+    REQUIRE_LINE,
+    DOING_LINE
+};
 
 struct move_node {
     double base;
@@ -49,82 +50,105 @@ public:
     std::size_t index;
     vector2d initial;
     std::vector<move_node> move_nodes;
-    QBasicTimer timer;
+    // Handle of the movement loop while it is scheduled
+    nrg::control_scheduler::handle loop = nrg::control_scheduler::NO_HANDLE;
 };
 
 ObjectProcedure::Impl::Impl(const path2d &t_path) :
     path(t_path),
     index(0) {}
 
-ObjectProcedure::ObjectProcedure(std::weak_ptr<Controller> sol, const path2d &path) :
+ObjectProcedure::ObjectProcedure(CompetitionState &state, std::weak_ptr<Controller> sol, const path2d &path) :
+    // Names in the order of State
+    nrg::state_machine({"INITIALIZE", "REQUIRE_LINE", "DOING_LINE"}),
+    m_compstate(state),
     m_impl(std::make_unique<Impl>(path)),
-    m_sol(std::move(sol)),
-    m_done(false),
-    m_start(false) {
-    if (auto lp = Main::get()->status_box().lock()) {
-        m_index_label = lp->add_label("Obj Index: 0");
-    }
+    m_sol(std::move(sol)) {
+    m_index_label = std::make_unique<UiLabel>(m_compstate, [](const nrg::telemetry_slot::values &v) {
+        return "Obj Index: " + QString::number(v[0]);
+    });
 }
 
 ObjectProcedure::~ObjectProcedure() {
-    if (auto lp = Main::get()->status_box().lock()) {
-        lp->remove_label(m_index_label);
-    }
+    m_compstate.remove_control_loop(m_impl->loop);
 }
 
 void ObjectProcedure::start() {
-    m_impl->timer.start(g_pm->timer_fast, this);
+    m_impl->loop = m_compstate.add_control_loop([this] { tick(m_compstate.control_time()); });
 }
 
 void ObjectProcedure::stop() {
-    m_impl->timer.stop();
+    m_compstate.remove_control_loop(m_impl->loop);
     if (m_object_line != nullptr) {
         m_object_line->stop();
     }
 }
 
-void ObjectProcedure::timerEvent(QTimerEvent *ev) {
-    if (ev->timerId() == m_impl->timer.timerId()) {
-        movement_loop();
+bool ObjectProcedure::ready() const {
+    CompetitionState &state = m_compstate;
+    return state.is_robot_box_fresh() && state.is_robot_box_valid();
+}
+
+void ObjectProcedure::step(int state) {
+    m_compstate.record_state("ObjectProcedure", state_name(state));
+    m_index_label->publish(m_impl->index);
+    switch (state) {
+        case State::INITIALIZE:
+            do_initialize();
+            break;
+        case State::REQUIRE_LINE:
+            do_require_line();
+            break;
+        case State::DOING_LINE:
+            do_doing_line();
+            break;
+        default:
+            break;
     }
 }
 
-bool ObjectProcedure::is_done() {
-    return m_done;
+void ObjectProcedure::do_initialize() {
+    // The path starts from the object
+    path2d path;
+    vector2d object_loc = rect2d(m_compstate.get_object_box(true)).center();
+    path.push_back(object_loc);
+    path.insert(path.end(), m_impl->path.begin(), m_impl->path.end());
+    m_impl->path = std::move(path);
+    m_impl->move_nodes = path_to_move_nodes(m_impl->path);
+    transition(State::REQUIRE_LINE);
 }
 
-void ObjectProcedure::movement_loop() {
-    m_index_label->setText("Obj Index: " + QString::number(m_impl->index));
-    CompetitionState &state = Main::get()->state();
-    if (!state.is_robot_box_fresh() || !state.is_robot_box_valid()) {
+void ObjectProcedure::do_require_line() {
+    // If we have exhausted the move list, we are done
+    if (m_impl->index == m_impl->move_nodes.size()) {
+        m_compstate.remove_control_loop(m_impl->loop);
+        finish();
+        for (const std::string &row : state_rows()) {
+            log() << "Object Procedure " << row;
+        }
         return;
     }
-    // Initialization
-    if (!m_start) {
-        m_start = true;
-        path2d path;
-        vector2d object_loc = rect2d(state.get_object_box(true)).center();
-        path.push_back(object_loc);
-        path.insert(path.end(), m_impl->path.begin(), m_impl->path.end());
-        m_impl->path = std::move(path);
-        m_impl->move_nodes = path_to_move_nodes(m_impl->path);
-    }
-    // If there is no active object movement
-    if (!m_object_line) {
-        // If we have exhausted the move list, we are done
-        if (m_impl->index == m_impl->move_nodes.size()) {
-            m_impl->timer.stop();
-            m_done = true;
-            return;
+    // Grab the next move node and start moving along this line,
+    // ticked from this procedure
+    const move_node &next = m_impl->move_nodes[m_impl->index];
+    m_object_line = std::make_unique<ObjectLine>(m_compstate, m_sol, next.dir, next.target, next.base);
+    transition(State::DOING_LINE);
+}
+
+void ObjectProcedure::do_doing_line() {
+    m_object_line->tick(now());
+    if (m_object_line->is_failed()) {
+        m_compstate.remove_control_loop(m_impl->loop);
+        fail();
+        for (const std::string &row : state_rows()) {
+            log() << "Object Procedure failed " << row;
         }
-        // Grab the next move node
-        const move_node &next = m_impl->move_nodes[m_impl->index];
-        m_object_line = std::make_unique<ObjectLine>(m_sol, next.dir, next.target, next.base);
-        // Start moving along this line
-        m_object_line->start();
-    } else if (m_object_line->is_done()) {
+        return;
+    }
+    if (m_object_line->is_done()) {
         // Completed traversing line so increment the index and invalidate
         m_object_line.reset();
         ++m_impl->index;
+        transition(State::REQUIRE_LINE);
     }
 }
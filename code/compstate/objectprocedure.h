@@ -1,46 +1,51 @@
 #ifndef MINOTAUR_CPP_OBJECTPROCEDURE_H
 #define MINOTAUR_CPP_OBJECTPROCEDURE_H
 
+#include "statemachine.h"
+
 #include <QObject>
 #include <memory>
 
 namespace nrg {
     template<typename val_t> class vector;
 }
+class CompetitionState;
 class Controller;
 class ObjectLine;
-class StatusLabel;
+class UiLabel;
 typedef std::vector<nrg::vector<double>> path2d;
 
 /**
  * This procedure combines ObjectLine procedures to move the object
  * in a series of rectangular paths.
  */
-class ObjectProcedure : public QObject {
+class ObjectProcedure : public QObject, public nrg::state_machine {
 Q_OBJECT
 
 public:
-    explicit ObjectProcedure(std::weak_ptr<Controller> sol, const path2d &path);
+    ObjectProcedure(CompetitionState &state, std::weak_ptr<Controller> sol, const path2d &path);
     ~ObjectProcedure() override;
 
     void start();
     void stop();
 
-    bool is_done();
+protected:
+    void step(int state) override;
+
+    bool ready() const override;
 
 private:
-    void timerEvent(QTimerEvent *ev) override;
+    void do_initialize();
+    void do_require_line();
+    void do_doing_line();
 
-    void movement_loop();
+    CompetitionState &m_compstate;
 
     class Impl;
     std::unique_ptr<Impl> m_impl;
     std::weak_ptr<Controller> m_sol;
 
-    bool m_done;
-    bool m_start;
-
-    StatusLabel *m_index_label;
+    std::unique_ptr<UiLabel> m_index_label;
     std::unique_ptr<ObjectLine> m_object_line;
 };
 
@@ -15,6 +15,7 @@ volatile paramType paramName = defValue;                        \
 private:                                                        \
 weak_ref<ParameterSlot> paramName##_slot{nullptr};              \
 inline void obtain_##paramName##_slot(parent_t p) {             \
+    if (!p) { return; }                                         \
     if (auto lp = p->param_box().lock()) {                      \
         paramName##_slot = lp->add_slot(                        \
             #paramName,                                         \
@@ -23,6 +24,7 @@ inline void obtain_##paramName##_slot(parent_t p) {             \
     }                                                           \
 }                                                               \
 inline void release_##paramName##_slot(parent_t p) {            \
+    if (!p) { return; }                                         \
     if (auto lp = p->param_box().lock()) {                      \
         lp->remove_slot(paramName##_slot);                      \
     }                                                           \
@@ -33,7 +35,7 @@ inline Q_SLOT void set_##paramName(const QVariant &val) {       \
 
 #define PARAM_INIT(paramName)           \
 obtain_##paramName##_slot(m_p);         \
-connect(                                \
+if (paramName##_slot) connect(          \
     paramName##_slot.get(),             \
     &ParameterSlot::value_set,          \
     this,                               \
@@ -55,9 +57,34 @@ public:
     MANAGE_PARAM(double, object_calib_area, 400.0)
     MANAGE_PARAM(double,  area_acq_r_sigma,  1.34)
 
-    // Procedure
-    MANAGE_PARAM(int, timer_fast,  50)
-    MANAGE_PARAM(int, timer_reg,  200)
+    // Procedure, which declares tracking lost after watchdog_ms without
+    // a box, checked every watchdog_poll_ms
+    MANAGE_PARAM(int, watchdog_ms,      500)
+    MANAGE_PARAM(int, watchdog_poll_ms,  50)
+
+    // ControlThread
+    MANAGE_PARAM(int, control_priority,  0)
+    MANAGE_PARAM(int, control_cpu,      -1)
+
+    // Procedure control law, 0 for bang-bang and 1 for PID, with the
+    // output in solenoid power up to 255 for full power
+    MANAGE_PARAM(int,    control_law,     0)
+    MANAGE_PARAM(double, pid_kp,       20.0)
+    MANAGE_PARAM(double, pid_ki,        0.0)
+    MANAGE_PARAM(double, pid_kd,        0.0)
+    MANAGE_PARAM(double, pid_out_max, 255.0)
+    MANAGE_PARAM(double, pid_i_max,   100.0)
+
+    // Latency compensation, 0 to act on the boxes as seen and 1 to
+    // predict them forward to when a command acts; off until the
+    // actuation delay has been tuned on the robot
+    MANAGE_PARAM(int,    predict_latency,     0)
+    MANAGE_PARAM(double, actuation_ms,      0.0)
+    MANAGE_PARAM(double, predict_max_ms,  250.0)
+
+    // Flight recorder, 1 to record each control tick of a procedure
+    // to a log file in the working directory
+    MANAGE_PARAM(int, flight_record, 0)
 
     // ObjectProcedure
     MANAGE_PARAM(double, objline_move_dev,  10.0)
@@ -71,6 +98,10 @@ public:
     MANAGE_PARAM(int, wall_penalty_2,   4)
 
 public:
+    /**
+     * @param p main window whose parameter box shows the parameters,
+     *          or null to keep the defaults, such as when headless
+     */
     inline explicit param_manager(parent_t p) :
         m_p(p) {
         // CompetitionState
@@ -79,8 +110,28 @@ public:
         PARAM_INIT( area_acq_r_sigma)
 
         // Procedure
-        PARAM_INIT(timer_fast)
-        PARAM_INIT(timer_reg )
+        PARAM_INIT(watchdog_ms)
+        PARAM_INIT(watchdog_poll_ms)
+
+        // ControlThread
+        PARAM_INIT(control_priority)
+        PARAM_INIT(control_cpu)
+
+        // Procedure control law
+        PARAM_INIT(control_law)
+        PARAM_INIT(pid_kp)
+        PARAM_INIT(pid_ki)
+        PARAM_INIT(pid_kd)
+        PARAM_INIT(pid_out_max)
+        PARAM_INIT(pid_i_max)
+
+        // Latency compensation
+        PARAM_INIT(predict_latency)
+        PARAM_INIT(actuation_ms)
+        PARAM_INIT(predict_max_ms)
+
+        // Flight recorder
+        PARAM_INIT(flight_record)
 
         // ObjectProcedure
         PARAM_INIT(objline_move_dev)
@@ -101,8 +152,28 @@ public:
         PARAM_DEINIT( area_acq_r_sigma)
 
         // Procedure
-        PARAM_DEINIT(timer_fast)
-        PARAM_DEINIT(timer_reg )
+        PARAM_DEINIT(watchdog_ms)
+        PARAM_DEINIT(watchdog_poll_ms)
+
+        // ControlThread
+        PARAM_DEINIT(control_priority)
+        PARAM_DEINIT(control_cpu)
+
+        // Procedure control law
+        PARAM_DEINIT(control_law)
+        PARAM_DEINIT(pid_kp)
+        PARAM_DEINIT(pid_ki)
+        PARAM_DEINIT(pid_kd)
+        PARAM_DEINIT(pid_out_max)
+        PARAM_DEINIT(pid_i_max)
+
+        // Latency compensation
+        PARAM_DEINIT(predict_latency)
+        PARAM_DEINIT(actuation_ms)
+        PARAM_DEINIT(predict_max_ms)
+
+        // Flight recorder
+        PARAM_DEINIT(flight_record)
 
         // ObjectProcedure
         PARAM_DEINIT(objline_move_dev)
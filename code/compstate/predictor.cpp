@@ -0,0 +1,158 @@
+#include "predictor.h"
+
+#include <algorithm>
+
+typedef std::chrono::duration<double> seconds;
+typedef std::chrono::duration<double, std::milli> millis;
+
+// Weight of a new sample in the running means
+static constexpr double SMOOTHING = 0.1;
+
+// Shortest interval between frames, in seconds, that updates the
+// velocity; closer frames would scale tracker noise without bound
+static constexpr double MIN_VELOCITY_DT = 0.005;
+
+static double smooth(double mean, double sample) {
+    return mean + SMOOTHING * (sample - mean);
+}
+
+nrg::pose_predictor::pose_predictor(double alpha, double beta) :
+    m_alpha(alpha),
+    m_beta(beta),
+    m_estimate(false),
+    m_gain_seen(false),
+    m_gain(0),
+    m_latency_seen(false),
+    m_latency_ms(0),
+    m_max_latency_ms(0),
+    m_prediction_err(0),
+    m_unpredicted_err(0),
+    m_scored(0) {}
+
+void nrg::pose_predictor::observe(const vector2d &pos, clock::time_point captured, clock::time_point received) {
+    double latency = millis(received - captured).count();
+    m_latency_ms = m_latency_seen ? smooth(m_latency_ms, latency) : latency;
+    m_max_latency_ms = std::max(m_max_latency_ms, latency);
+    m_latency_seen = true;
+
+    double dt = seconds(captured - m_captured).count();
+    if (!m_estimate) {
+        m_pos = pos;
+        m_vel = {0.0, 0.0};
+        m_estimate = true;
+    } else if (dt <= 0) {
+        // A frame seen twice, or out of order, carries no motion
+        m_pos = pos;
+        m_last_seen = pos;
+        return;
+    } else {
+        vector2d commanded = commands_between(m_captured, captured);
+        learn_gain(pos - m_last_seen, commanded);
+        vector2d predicted = m_pos + m_vel * dt + commanded * m_gain;
+        vector2d residual = pos - predicted;
+        m_pos = predicted + residual * m_alpha;
+        if (dt >= MIN_VELOCITY_DT) {
+            m_vel += residual * (m_beta / dt);
+        }
+    }
+    m_captured = captured;
+    m_last_seen = pos;
+    score(pos, captured);
+    // Commands that acted before the frame are part of the position
+    while (!m_commands.empty() && m_commands.front().at <= captured) {
+        m_commands.pop_front();
+    }
+}
+
+void nrg::pose_predictor::command(const vector2d &dir, clock::time_point at) {
+    if (m_commands.size() == MAX_COMMANDS) { m_commands.pop_front(); }
+    m_commands.push_back({at, dir});
+}
+
+vector2d nrg::pose_predictor::commands_between(clock::time_point after, clock::time_point until) const {
+    vector2d sum{0.0, 0.0};
+    for (const sent_command &c : m_commands) {
+        if (c.at > after && c.at <= until) { sum += c.dir; }
+    }
+    return sum;
+}
+
+void nrg::pose_predictor::learn_gain(const vector2d &moved, const vector2d &commanded) {
+    double commanded_sq = commanded.norm_sq();
+    if (commanded_sq <= 0) { return; }
+    // Least squares displacement per command along the commands
+    double sample = moved.dot(commanded) / commanded_sq;
+    m_gain = m_gain_seen ? smooth(m_gain, sample) : sample;
+    m_gain_seen = true;
+}
+
+vector2d nrg::pose_predictor::predict(clock::time_point at, clock::duration max_horizon) const {
+    if (!m_estimate) { return m_last_seen; }
+    clock::duration horizon = std::max(clock::duration::zero(), std::min(max_horizon, at - m_captured));
+    // From the position as seen, so that nothing changes without latency
+    return m_last_seen + m_vel * seconds(horizon).count()
+           + commands_between(m_captured, m_captured + horizon) * m_gain;
+}
+
+vector2d nrg::pose_predictor::predict_scored(clock::time_point at, clock::duration max_horizon) {
+    vector2d predicted = predict(at, max_horizon);
+    // Only the latest prediction for a time is kept
+    if (m_estimate && at > m_captured && (m_pending.empty() || at > m_pending.back().at)) {
+        if (m_pending.size() == MAX_PENDING) { m_pending.pop_front(); }
+        m_pending.push_back({at, predicted, m_last_seen});
+    }
+    return predicted;
+}
+
+void nrg::pose_predictor::score(const vector2d &pos, clock::time_point captured) {
+    while (!m_pending.empty() && m_pending.front().at <= captured) {
+        const pending &p = m_pending.front();
+        // Where the body was at the time of the prediction
+        vector2d actual = pos - m_vel * seconds(captured - p.at).count()
+                          - commands_between(p.at, captured) * m_gain;
+        double err = (p.predicted - actual).norm();
+        double raw = (p.unpredicted - actual).norm();
+        m_prediction_err = m_scored ? smooth(m_prediction_err, err) : err;
+        m_unpredicted_err = m_scored ? smooth(m_unpredicted_err, raw) : raw;
+        ++m_scored;
+        m_pending.pop_front();
+    }
+}
+
+void nrg::pose_predictor::reset() {
+    m_estimate = false;
+    m_commands.clear();
+    m_pending.clear();
+}
+
+bool nrg::pose_predictor::has_estimate() const {
+    return m_estimate;
+}
+
+const vector2d &nrg::pose_predictor::velocity() const {
+    return m_vel;
+}
+
+double nrg::pose_predictor::command_gain() const {
+    return m_gain;
+}
+
+double nrg::pose_predictor::latency_ms() const {
+    return m_latency_ms;
+}
+
+double nrg::pose_predictor::max_latency_ms() const {
+    return m_max_latency_ms;
+}
+
+double nrg::pose_predictor::prediction_err() const {
+    return m_prediction_err;
+}
+
+double nrg::pose_predictor::unpredicted_err() const {
+    return m_unpredicted_err;
+}
+
+std::size_t nrg::pose_predictor::scored() const {
+    return m_scored;
+}
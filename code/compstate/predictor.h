@@ -0,0 +1,164 @@
+#ifndef MINOTAUR_CPP_PREDICTOR_H
+#define MINOTAUR_CPP_PREDICTOR_H
+
+#include "../utility/vector.h"
+
+#include <chrono>
+#include <deque>
+
+namespace nrg {
+
+    /**
+     * Predicts where a tracked body is now from where the camera saw it.
+     *
+     * Each tracked position is stamped with the time its frame was
+     * captured, and commands sent to move the body are stamped with the
+     * time they act. A prediction starts from the last position seen,
+     * adds the expected displacement of each command that acts after
+     * that frame was captured, and extrapolates any motion the commands
+     * do not explain. So procedures react to where the body will be when
+     * their command acts, instead of where it was a frame pipeline ago.
+     *
+     * The position and the unexplained velocity are estimated with an
+     * alpha-beta filter, and the displacement per command is learned
+     * from the motion seen between frames.
+     *
+     * The latency from capture to the control layer, and the error of
+     * the predictions, are measured online. A prediction is scored
+     * against the first observation captured after the time it was
+     * made for, along with the error of using the last observation
+     * unpredicted, so the gain of predicting can be seen.
+     */
+    class pose_predictor {
+    public:
+        typedef std::chrono::steady_clock clock;
+
+        enum {
+            // Predictions awaiting an observation to score them
+            MAX_PENDING = 16,
+            // Commands kept that have not acted in a seen frame
+            MAX_COMMANDS = 64
+        };
+
+        /**
+         * @param alpha weight of a new position against the prediction
+         * @param beta  weight of the position residual in the velocity
+         */
+        explicit pose_predictor(double alpha = 0.85, double beta = 0.3);
+
+        /**
+         * Update the estimate with a tracked position. A frame captured
+         * less than 5 ms after the last one updates the position only.
+         *
+         * @param pos      tracked position
+         * @param captured time the frame was captured
+         * @param received time the position reached the control layer
+         */
+        void observe(const vector2d &pos, clock::time_point captured, clock::time_point received);
+
+        /**
+         * Account a command sent to move the body.
+         *
+         * @param dir direction of the command, whose displacement is
+         *            learned
+         * @param at  time the command is expected to act
+         */
+        void command(const vector2d &dir, clock::time_point at);
+
+        /**
+         * Predict the position at a time, from the last observation.
+         *
+         * @param at          time to predict for
+         * @param max_horizon furthest to extrapolate past the capture
+         *                    of the last observation
+         * @return the predicted position, or the last observation if
+         *         there is no estimate
+         */
+        vector2d predict(clock::time_point at, clock::duration max_horizon) const;
+
+        /**
+         * Predict the position at a time, and score the prediction once
+         * the body is seen at that time.
+         */
+        vector2d predict_scored(clock::time_point at, clock::duration max_horizon);
+
+        /**
+         * Forget the estimate, keeping the statistics and the learned
+         * displacement per command.
+         */
+        void reset();
+
+        bool has_estimate() const;
+
+        const vector2d &velocity() const;
+
+        /**
+         * @return the learned displacement of a command, in pixels
+         */
+        double command_gain() const;
+
+        /**
+         * @return the mean latency from capture to the control layer,
+         *         over recent observations
+         */
+        double latency_ms() const;
+        double max_latency_ms() const;
+
+        /**
+         * @return the mean error of scored predictions over recent
+         *         ones, and the error of the last observations they
+         *         were made from
+         */
+        double prediction_err() const;
+        double unpredicted_err() const;
+
+        std::size_t scored() const;
+
+    private:
+        struct pending {
+            clock::time_point at;
+            vector2d predicted;
+            vector2d unpredicted;
+        };
+
+        struct sent_command {
+            clock::time_point at;
+            vector2d dir;
+        };
+
+        /**
+         * @return the sum of the directions of the commands acting
+         *         after a time and no later than another
+         */
+        vector2d commands_between(clock::time_point after, clock::time_point until) const;
+
+        void learn_gain(const vector2d &moved, const vector2d &commanded);
+
+        void score(const vector2d &pos, clock::time_point captured);
+
+        double m_alpha;
+        double m_beta;
+
+        bool m_estimate;
+        vector2d m_pos;
+        vector2d m_vel;
+        vector2d m_last_seen;
+        clock::time_point m_captured;
+
+        std::deque<sent_command> m_commands;
+        bool m_gain_seen;
+        double m_gain;
+
+        std::deque<pending> m_pending;
+
+        bool m_latency_seen;
+        double m_latency_ms;
+        double m_max_latency_ms;
+        double m_prediction_err;
+        double m_unpredicted_err;
+        std::size_t m_scored;
+    };
+
+}
+
+#endif //MINOTAUR_CPP_PREDICTOR_H
@@ -2,20 +2,27 @@
 #include "compstate.h"
 #include "common.h"
 #include "parammanager.h"
+#include "uilabel.h"
 
-#include "../camera/statusbox.h"
-#include "../camera/statuslabel.h"
 #include "../controller/controller.h"
-#include "../gui/global.h"
+#include "../controller/controllaw.h"
 #include "../utility/logger.h"
 
-#include <QBasicTimer>
-#include <QTimerEvent>
+#include <algorithm>
 
-#define DIR_RIGHT "RIGHT"
-#define DIR_LEFT  "LEFT"
-#define DIR_DOWN  "DOWN"
-#define DIR_UP    "UP"
+// Values published to the direction label
+enum {
+    DIR_IDLE,
+    DIR_RIGHT,
+    DIR_LEFT,
+    DIR_DOWN,
+    DIR_UP
+};
+
+static QString dir_text(double dir) {
+    static const char *const names[] = {"IDLE", "RIGHT", "LEFT", "DOWN", "UP"};
+    return names[static_cast<int>(dir)];
+}
 
 static QString err_text(double x, double y) {
     QString text;
@@ -33,9 +40,17 @@ static QString perp_text(double err_x, double err_y, double norm_sq) {
     return text;
 }
 
+/**
+ * @return the power of a move, which is at most full power
+ */
+static int to_power(double power) {
+    return static_cast<int>(std::min(power, static_cast<double>(Controller::MAX_POWER)));
+}
+
 class Procedure::Impl {
 public:
     Impl(
+        const param_manager &params,
         double t_loc_accept,
         double t_norm_dev,
         const path2d &t_path);
@@ -45,92 +60,124 @@ public:
     path2d path;
     vector2d initial;
     std::size_t index;
-    QBasicTimer timer;
+    // Handle of the movement loop while it is scheduled
+    nrg::control_scheduler::handle loop = nrg::control_scheduler::NO_HANDLE;
+
+    std::unique_ptr<nrg::control_law> law;
+    nrg::convergence_stats stats;
+    // Time of the previous update of the control law
+    nrg::convergence_stats::clock::time_point last_update;
+    bool updated;
+    // Whether the approach to the current node is being timed
+    bool timing;
 };
 
 Procedure::Impl::Impl(
+    const param_manager &params,
     double t_loc_accept,
     double t_norm_dev,
     const path2d &t_path) :
     loc_accept(t_loc_accept),
     norm_dev(t_norm_dev),
     path(t_path),
-    index(0) {}
+    index(0),
+    law(nrg::make_control_law(params.control_law, {
+        params.pid_kp, params.pid_ki, params.pid_kd, params.pid_out_max, params.pid_i_max
+    })),
+    updated(false),
+    timing(false) {}
 
 Procedure::Procedure(
+    CompetitionState &state,
     std::weak_ptr<Controller> sol,
     const path2d &path,
     double loc_accept,
     double norm_dev
 ) :
-    m_impl(std::make_unique<Impl>(loc_accept, norm_dev, path)),
-    m_sol(std::move(sol)),
-    m_done(false) {
+    // The path is followed in a single state
+    nrg::state_machine({"TRAVERSE"}),
+    m_compstate(state),
+    m_impl(std::make_unique<Impl>(state.params(), loc_accept, norm_dev, path)),
+    m_sol(std::move(sol)) {
+    // Grab the initial robot location
+    m_impl->initial = algo::rect_center(m_compstate.get_robot_box());
     // Create the status labels and set their initial values
-    if (auto lp = Main::get()->status_box().lock()) {
-        m_dir_label = lp->add_label("IDLE");
-        m_err_label = lp->add_label(err_text(0, 0));
-        m_index_label = lp->add_label(index_text(m_impl->index));
-        m_perp_label = lp->add_label(perp_text(0, 0, 0));
-    }
+    // The labels are formatted on the GUI thread
+    typedef const nrg::telemetry_slot::values &values;
+    m_dir_label = std::make_unique<UiLabel>(m_compstate, [](values v) { return dir_text(v[0]); });
+    m_err_label = std::make_unique<UiLabel>(m_compstate, [](values v) { return err_text(v[0], v[1]); });
+    m_index_label = std::make_unique<UiLabel>(m_compstate, [](values v) {
+        return index_text(static_cast<std::size_t>(v[0]));
+    });
+    m_perp_label = std::make_unique<UiLabel>(m_compstate, [](values v) { return perp_text(v[0], v[1], v[2]); });
 }
 
 Procedure::~Procedure() {
-    // Remove status labels
-    if (auto lp = Main::get()->status_box().lock()) {
-        lp->remove_label(m_dir_label);
-        lp->remove_label(m_err_label);
-        lp->remove_label(m_index_label);
-        lp->remove_label(m_perp_label);
-    }
+    // The status labels are removed as they are destroyed
+    m_compstate.remove_control_loop(m_impl->loop);
 }
 
-bool Procedure::is_done() const {
-    return m_done;
+bool Procedure::is_stopped() const {
+    return m_impl->loop == nrg::control_scheduler::NO_HANDLE;
 }
 
-bool Procedure::is_stopped() const {
-    return !m_impl->timer.isActive();
+void Procedure::set_control_law(std::unique_ptr<nrg::control_law> law) {
+    m_impl->law = std::move(law);
+    m_impl->updated = false;
+}
+
+const nrg::convergence_stats &Procedure::convergence() const {
+    return m_impl->stats;
+}
+
+void Procedure::log_convergence() const {
+    const nrg::convergence_stats &stats = m_impl->stats;
+    log() << "Reached " << stats.waypoints() << " nodes in " << stats.ticks()
+          << " ticks, time mean " << stats.mean_time_ms()
+          << " ms max " << stats.max_time_ms()
+          << " ms, overshoot mean " << stats.mean_overshoot()
+          << " max " << stats.max_overshoot();
 }
 
 void Procedure::start() {
-    // Start the time and grab the initial robot location
-    CompetitionState &state = Main::get()->state();
-    m_impl->timer.start(g_pm->timer_reg, this);
-    m_impl->initial = algo::rect_center(state.get_robot_box());
+    m_impl->loop = m_compstate.add_control_loop([this] { tick(m_compstate.control_time()); });
     Q_EMIT started();
 }
 
 void Procedure::stop() {
-    // Stop the timer
-    m_impl->timer.stop();
+    // Stop the movement loop
+    m_compstate.remove_control_loop(m_impl->loop);
     Q_EMIT stopped();
 }
 
-void Procedure::timerEvent(QTimerEvent *ev) {
-    if (ev->timerId() == m_impl->timer.timerId()) {
-        movement_loop();
+bool Procedure::ready() const {
+    // Finishing does not wait for a box
+    if (m_impl->index == m_impl->path.size() || m_sol.expired()) {
+        return true;
     }
+    // If the box has not been updated, tracker has lost acquisition, skip this tick
+    CompetitionState &state = m_compstate;
+    return state.is_robot_box_fresh() && state.is_robot_box_valid();
 }
 
-void Procedure::movement_loop() {
-    // If the path has been traversed or solenoid expired, stop timer
+void Procedure::step(int state) {
+    m_compstate.record_state("Procedure", state_name(state));
+    // If the path has been traversed or solenoid expired, stop the loop
     if (m_impl->index == m_impl->path.size() || m_sol.expired()) {
-        m_impl->timer.stop();
-        m_done = true;
+        m_compstate.remove_control_loop(m_impl->loop);
+        finish();
+        log_convergence();
         Q_EMIT finished();
         return;
     }
-
-    // If the box has not been updated, tracker has lost acquisition, skip this loop
-    CompetitionState &state = Main::get()->state();
-    if (
-        !state.is_robot_box_fresh() ||
-        !state.is_robot_box_valid()
-    ) { return; }
+    // Time the approach to the first node from the first tick
+    if (!m_impl->timing) {
+        m_impl->stats.begin(now());
+        m_impl->timing = true;
+    }
 
     // Acquire the current robot position
-    vector2d center = algo::rect_center(Main::get()->state().get_robot_box(true));
+    vector2d center = algo::rect_center(m_compstate.get_robot_box(true));
     vector2d target = m_impl->path[m_impl->index];
     // Source node is either the initial position or the last node
     vector2d source = m_impl->index > 0 ? m_impl->path[m_impl->index - 1] : m_impl->initial;
@@ -138,20 +185,29 @@ void Procedure::movement_loop() {
     // Find differences in each axis
     double err_x = target.x() - center.x();
     double err_y = target.y() - center.y();
-    m_err_label->setText(err_text(err_x, err_y));
+    m_err_label->publish(err_x, err_y);
 
     // If within acceptance range, move to next point
     if (hypot(err_x, err_y) < m_impl->loc_accept) {
+        m_impl->stats.converge(now());
+        m_impl->stats.begin(now());
+        m_impl->law->reset();
+        m_impl->updated = false;
         ++m_impl->index;
         return;
     }
-    m_index_label->setText(index_text(m_impl->index));
+    m_index_label->publish(m_impl->index);
+
+    // Overshoot is the distance past the target along the path
+    vector2d along = target - source;
+    double length = along.norm();
+    m_impl->stats.sample(length > 0 ? std::max(0.0, (center - target).dot(along) / length) : 0);
 
     // Calculate perpendicular distance to ensure the robot is straddling the line
     vector2d intersect = algo::perp_intersect(center, source, target);
     vector2d norm_diff = intersect - center;
     double norm_diff_sq = norm_diff.norm_sq();
-    m_perp_label->setText(perp_text(norm_diff.x(), norm_diff.y(), norm_diff_sq));
+    m_perp_label->publish(norm_diff.x(), norm_diff.y(), norm_diff_sq);
     if (norm_diff_sq > m_impl->norm_dev * m_impl->norm_dev) {
         target = intersect;
         err_x = norm_diff.x();
@@ -159,47 +215,69 @@ void Procedure::movement_loop() {
     }
 
     // Attempt to reduce the error
-    if (fabs(err_x) > fabs(err_y)) {
-        double estimated_power = fabs(err_x);
-        // Move in horizontal
-        if (target.x() > center.x()) { move_right(estimated_power); }
-        else { move_left(estimated_power); }
+    double dt = 0;
+    if (m_impl->updated) {
+        dt = std::chrono::duration<double>(now() - m_impl->last_update).count();
+    }
+    m_impl->last_update = now();
+    m_impl->updated = true;
+    m_compstate.record_error(hypot(err_x, err_y), target);
+    drive(m_impl->law->update({err_x, err_y}, dt));
+}
+
+void Procedure::drive(const vector2d &out) {
+    // The output of the law is the power of the move, and powers below
+    // one are not sent
+    auto move_x = [this, &out] {
+        if (out.x() >= 1) { move_right(out.x()); }
+        else if (out.x() <= -1) { move_left(-out.x()); }
+    };
+    auto move_y = [this, &out] {
+        if (out.y() >= 1) { move_down(out.y()); }
+        else if (out.y() <= -1) { move_up(-out.y()); }
+    };
+    // The direction label ends up showing the larger axis
+    if (fabs(out.x()) > fabs(out.y())) {
+        move_y();
+        move_x();
     } else {
-        double estimated_power = fabs(err_y);
-        // Move in vertical
-        if (target.y() > center.y()) { move_down(estimated_power); }
-        else { move_up(estimated_power); }
+        move_x();
+        move_y();
     }
 }
 
-void Procedure::move_right(double estimated_power) {
+void Procedure::move_right(double power) {
     // Right => +X
-    if (m_dir_label) { m_dir_label->setText(DIR_RIGHT); }
+    if (m_dir_label) { m_dir_label->publish(DIR_RIGHT); }
     if (auto sol = m_sol.lock()) {
-        sol->move({static_cast<int>(estimated_power), 0});
+        sol->move({1, 0}, Controller::STEP_TIME, to_power(power));
+        m_compstate.robot_commanded({1.0, 0.0});
     }
 }
 
-void Procedure::move_left(double estimated_power) {
+void Procedure::move_left(double power) {
     // Left => -X
-    if (m_dir_label) { m_dir_label->setText(DIR_LEFT); }
+    if (m_dir_label) { m_dir_label->publish(DIR_LEFT); }
     if (auto sol = m_sol.lock()) {
-        sol->move({-static_cast<int>(estimated_power), 0});
+        sol->move({-1, 0}, Controller::STEP_TIME, to_power(power));
+        m_compstate.robot_commanded({-1.0, 0.0});
     }
 }
 
-void Procedure::move_up(double estimated_power) {
+void Procedure::move_up(double power) {
     // Up => -Y
-    if (m_dir_label) { m_dir_label->setText(DIR_UP); }
+    if (m_dir_label) { m_dir_label->publish(DIR_UP); }
     if (auto sol = m_sol.lock()) {
-        sol->move({0, -static_cast<int>(estimated_power)});
+        sol->move({0, -1}, Controller::STEP_TIME, to_power(power));
+        m_compstate.robot_commanded({0.0, -1.0});
     }
 }
 
-void Procedure::move_down(double estimated_power) {
+void Procedure::move_down(double power) {
     // Down => +Y
-    if (m_dir_label) { m_dir_label->setText(DIR_DOWN); }
+    if (m_dir_label) { m_dir_label->publish(DIR_DOWN); }
     if (auto sol = m_sol.lock()) {
-        sol->move({0, static_cast<int>(estimated_power)});
+        sol->move({0, 1}, Controller::STEP_TIME, to_power(power));
+        m_compstate.robot_commanded({0.0, 1.0});
     }
 }
@@ -1,6 +1,8 @@
 #ifndef MINOTAUR_CPP_PROCEDURE_H
 #define MINOTAUR_CPP_PROCEDURE_H
 
+#include "statemachine.h"
+
 #include <QObject>
 #include <memory>
 
@@ -10,9 +12,12 @@
 // Forward declarations
 namespace nrg {
     template<typename val_t> class vector;
+    class control_law;
+    class convergence_stats;
 }
+class CompetitionState;
 class Controller;
-class StatusLabel;
+class UiLabel;
 typedef std::vector<nrg::vector<double>> path2d;
 
 /**
@@ -25,10 +30,19 @@ typedef std::vector<nrg::vector<double>> path2d;
  * along a specified path. This class is responsible solely for moving
  * a robot along a predefined path.
  *
- * These objects are powered by an internal timer that fires a movement
- * loop, which considers the current state.
+ * These objects are state machines. The outermost procedure is ticked
+ * by the control scheduler of the competition state each time the tracker
+ * delivers a new box, and ticks the procedures it has started within the
+ * same tick. They live on the control thread, and show their status
+ * through UiLabel.
+ *
+ * The movement sent on each tick is decided by a control law, chosen
+ * and tuned through the parameter manager. It is bang-bang by default,
+ * and the control_law parameter selects PID on both axes. The time
+ * taken to reach each node and the overshoot past it are logged when
+ * the path is done.
  */
-class Procedure : public QObject {
+class Procedure : public QObject, public nrg::state_machine {
 Q_OBJECT
 
 public:
@@ -36,12 +50,14 @@ public:
      * Create a new procedure instance. This constructor will
      * create a copy of the path to be traversed.
      *
+     * @param state      competition state providing the robot box
      * @param sol        pointer to the controller to use
      * @param path       path to traverse
      * @param loc_accept desired maximum distance to each node
      * @param norm_dev   desired max normal deviation from line paths
      */
     Procedure(
+        CompetitionState &state,
         std::weak_ptr<Controller> sol,
         const path2d &path,
         double loc_accept = DEFAULT_TARGET_LOC_ACCEPTANCE,
@@ -50,40 +66,63 @@ public:
 
     ~Procedure() override;
 
+    /**
+     * Schedule the procedure as the outermost one. Procedures started
+     * by another are ticked by it instead.
+     */
     void start();
     void stop();
 
-    bool is_done() const;
     bool is_stopped() const;
 
+    /**
+     * Replace the control law, which otherwise comes from the
+     * parameter manager.
+     *
+     * @param law the new control law
+     */
+    void set_control_law(std::unique_ptr<nrg::control_law> law);
+
+    const nrg::convergence_stats &convergence() const;
+
     Q_SIGNAL void started();
 
     Q_SIGNAL void stopped();
 
     Q_SIGNAL void finished();
 
-    // estimated_power is the positive error in the direction of movement,
-    // and it is up to the controller to translate this into a solenoid voltage
-    void move_right(double estimated_power);
-    void move_left(double estimated_power);
-    void move_up(double estimated_power);
-    void move_down(double estimated_power);
+    // power is the power of the move, up to Controller::MAX_POWER, which
+    // the controller scales the power of its solenoids by
+    void move_right(double power);
+    void move_left(double power);
+    void move_up(double power);
+    void move_down(double power);
+
+protected:
+    void step(int state) override;
+
+    bool ready() const override;
 
 private:
-    void timerEvent(QTimerEvent *ev) override;
 
-    void movement_loop();
+    /**
+     * Send the output of the control law, one axis at a time, the
+     * larger last.
+     */
+    void drive(const nrg::vector<double> &out);
+
+    void log_convergence() const;
+
+    CompetitionState &m_compstate;
 
     class Impl;
     std::unique_ptr<Impl> m_impl;
     std::weak_ptr<Controller> m_sol;
 
-    StatusLabel *m_dir_label;
-    StatusLabel *m_err_label;
-    StatusLabel *m_index_label;
-    StatusLabel *m_perp_label;
-
-    bool m_done;
+    std::unique_ptr<UiLabel> m_dir_label;
+    std::unique_ptr<UiLabel> m_err_label;
+    std::unique_ptr<UiLabel> m_index_label;
+    std::unique_ptr<UiLabel> m_perp_label;
 };
 
 #endif //MINOTAUR_CPP_PROCEDURE_H
@@ -3,18 +3,12 @@
 #include "readymove.h"
 #include "parammanager.h"
 #include "procedure.h"
+#include "uilabel.h"
 
-#include "../camera/statusbox.h"
-#include "../camera/statuslabel.h"
-#include "../gui/mainwindow.h"
-#include "../gui/global.h"
 #include "../utility/algorithm.h"
 #include "../utility/logger.h"
 #include "../utility/utility.h"
 
-#include <QBasicTimer>
-#include <QTimerEvent>
-
 #ifndef NDEBUG
 #include <cassert>
 #endif
@@ -37,70 +31,68 @@ enum State {
 
 class ReadyMove::Impl {
 public:
-    Impl(int t_dir, State t_state);
+    explicit Impl(int t_dir);
 
     /**
      * The desired side of the object to be on.
      */
     nrg::dir dir;
-    /**
-     * Internal state of the object.
-     */
-    State state;
     /**
      * The collision resolution vector.
      */
     vector2d resolve;
-    QBasicTimer timer;
+    // Handle of the movement loop while it is scheduled
+    nrg::control_scheduler::handle loop = nrg::control_scheduler::NO_HANDLE;
+    // State last written to the log, which is only written on a change
+    int logged_state = -1;
 };
 
-ReadyMove::Impl::Impl(int t_dir, State t_state) :
-    dir(static_cast<nrg::dir>(t_dir)),
-    state(t_state) {}
-
-ReadyMove::ReadyMove(std::weak_ptr<Controller> sol, int dir) :
-    m_impl(std::make_unique<Impl>(dir, State::UNINITIALIZED)),
-    m_sol(std::move(sol)),
-    m_done(false) {
-    if (auto lp = Main::get()->status_box().lock()) {
-        m_state_label = lp->add_label("Ready State: 0");
-    }
+ReadyMove::Impl::Impl(int t_dir) :
+    dir(static_cast<nrg::dir>(t_dir)) {}
+
+ReadyMove::ReadyMove(CompetitionState &state, std::weak_ptr<Controller> sol, int dir) :
+    // Names in the order of State
+    nrg::state_machine({"UNINITIALIZED", "COLLIDING", "READY_MOVE", "COLLIDING_PROC", "READY_MOVE_PROC"}),
+    m_compstate(state),
+    m_impl(std::make_unique<Impl>(dir)),
+    m_sol(std::move(sol)) {
+    m_state_label = std::make_unique<UiLabel>(m_compstate, [](const nrg::telemetry_slot::values &v) {
+        return "Ready State: " + QString::number(v[0]);
+    });
 }
 
 ReadyMove::~ReadyMove() {
-    if (auto lp = Main::get()->status_box().lock()) {
-        lp->remove_label(m_state_label);
-    }
+    m_compstate.remove_control_loop(m_impl->loop);
 }
 
 void ReadyMove::start() {
-    m_impl->timer.start(g_pm->timer_fast, this);
+    m_impl->loop = m_compstate.add_control_loop([this] { tick(m_compstate.control_time()); });
 }
 
 void ReadyMove::stop() {
-    m_impl->timer.stop();
+    m_compstate.remove_control_loop(m_impl->loop);
     if (m_proc != nullptr) {
         m_proc->stop();
     }
 }
 
-void ReadyMove::timerEvent(QTimerEvent *ev) {
-    if (ev->timerId() == m_impl->timer.timerId()) {
-        movement_loop();
-    }
+bool ReadyMove::ready() const {
+    CompetitionState &state = m_compstate;
+    return
+        state.is_object_box_fresh() &&
+        state.is_object_box_valid() &&
+        state.is_robot_box_fresh() &&
+        state.is_robot_box_valid();
 }
 
-void ReadyMove::movement_loop() {
-    CompetitionState &state = Main::get()->state();
-    if (!state.is_object_box_fresh() ||
-        !state.is_object_box_valid() ||
-        !state.is_robot_box_fresh() ||
-        !state.is_robot_box_valid()) {
-        return;
+void ReadyMove::step(int state) {
+    m_compstate.record_state("ReadyMove", state_name(state));
+    if (state != m_impl->logged_state) {
+        log() << "Ready Move State: " << state;
+        m_impl->logged_state = state;
     }
-    log() << "Ready Move State: " << m_impl->state;
-    m_state_label->setText("Ready State: " + QString::number(m_impl->state));
-    switch (m_impl->state) {
+    m_state_label->publish(state);
+    switch (state) {
         case UNINITIALIZED:
             do_uninitialized();
             break;
@@ -123,7 +115,7 @@ void ReadyMove::movement_loop() {
 
 void ReadyMove::do_uninitialized() {
     // Check for collision first
-    CompetitionState &state = Main::get()->state();
+    CompetitionState &state = m_compstate;
     rect2d obj_rect = state.get_object_box(true);
     rect2d rob_rect = state.get_robot_box(true);
     if (algo::aabb_collide(rob_rect, obj_rect)) {
@@ -133,10 +125,10 @@ void ReadyMove::do_uninitialized() {
         // If the bounding boxes collide resolve the collision
         // before moving
         m_impl->resolve = rob_rect.center() + resolve_delta;
-        m_impl->state = State::COLLIDING;
+        transition(State::COLLIDING);
     } else {
         // Ready to move to the correct side
-        m_impl->state = State::READY_MOVE;
+        transition(State::READY_MOVE);
     }
 }
 
@@ -147,13 +139,12 @@ void ReadyMove::do_colliding() {
 #endif
     path2d path = {m_impl->resolve};
     // Create a procedure whose goal is to move to the location
-    // that resolves the collision
+    // that resolves the collision, ticked from this one
     m_proc = std::make_unique<Procedure>(
-        m_sol, path,
-        g_pm->objproc_loc_acpt, g_pm->objproc_norm_dev
+        m_compstate, m_sol, path,
+        m_compstate.params().objproc_loc_acpt, m_compstate.params().objproc_norm_dev
     );
-    m_proc->start();
-    m_impl->state = State::COLLIDING_PROC;
+    transition(State::COLLIDING_PROC);
 }
 
 void ReadyMove::do_colliding_proc() {
@@ -161,17 +152,18 @@ void ReadyMove::do_colliding_proc() {
     assert(!!m_proc);
 #endif
     // Check to see if the procedure has completed
+    m_proc->tick(now());
     if (m_proc->is_done()) {
         m_proc.reset();
     } else {
         return;
     }
     // Ready to move
-    m_impl->state = State::READY_MOVE;
+    transition(State::READY_MOVE);
 }
 
 void ReadyMove::do_ready_move() {
-    CompetitionState &state = Main::get()->state();
+    CompetitionState &state = m_compstate;
     // Grab and consume object and robot boxes
     rect2d obj_rect = state.get_object_box(true);
     rect2d rob_rect = state.get_robot_box(true);
@@ -180,29 +172,35 @@ void ReadyMove::do_ready_move() {
 #endif
     // Generate the traverse path
     path2d path = algo::robot_object_path(rob_rect, obj_rect, m_impl->dir);
+    if (path.empty()) {
+        // The robot is against the object where it cannot get around it
+        log() << "Ready Move failed: no path to the side of the object";
+        m_compstate.remove_control_loop(m_impl->loop);
+        fail();
+        return;
+    }
     // Create the procedure and hand over control
     m_proc = std::make_unique<Procedure>(
-        m_sol, path,
-        g_pm->objproc_loc_acpt, g_pm->objproc_norm_dev
+        m_compstate, m_sol, path,
+        m_compstate.params().objproc_loc_acpt, m_compstate.params().objproc_norm_dev
     );
-    m_proc->start();
-    m_impl->state = State::READY_MOVE_PROC;
+    transition(State::READY_MOVE_PROC);
 }
 
 void ReadyMove::do_ready_move_proc() {
 #ifndef NDEBUG
     assert(!!m_proc);
 #endif
+    m_proc->tick(now());
     if (m_proc->is_done()) {
         m_proc.reset();
     } else {
         return;
     }
     // When this procedure is finished, this ReadyMove is finished
-    m_impl->timer.stop();
-    m_done = true;
-}
-
-bool ReadyMove::is_done() const {
-    return m_done;
+    m_compstate.remove_control_loop(m_impl->loop);
+    finish();
+    for (const std::string &row : state_rows()) {
+        log() << "Ready Move " << row;
+    }
 }
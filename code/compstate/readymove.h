@@ -1,12 +1,15 @@
 #ifndef MINOTAUR_CPP_OBJECTSTRATEGY_H
 #define MINOTAUR_CPP_OBJECTSTRATEGY_H
 
+#include "statemachine.h"
+
 #include <QObject>
 #include <memory>
 
+class CompetitionState;
 class Controller;
 class Procedure;
-class StatusLabel;
+class UiLabel;
 
 /**
  * This procedure object leverages the robot Procedure with the goal
@@ -15,23 +18,22 @@ class StatusLabel;
  * For instance, if the object must be moved downwards, this object will
  * move the robot to the top side of the object, without colliding.
  */
-class ReadyMove : public QObject {
+class ReadyMove : public QObject, public nrg::state_machine {
 Q_OBJECT
 
 public:
-    explicit ReadyMove(std::weak_ptr<Controller> sol, int dir);
+    ReadyMove(CompetitionState &state, std::weak_ptr<Controller> sol, int dir);
     ~ReadyMove();
 
     void start();
     void stop();
 
-    bool is_done() const;
-
-private:
-    void timerEvent(QTimerEvent *ev) override;
+protected:
+    void step(int state) override;
 
-    void movement_loop();
+    bool ready() const override;
 
+private:
     void do_uninitialized();
     void do_colliding();
     void do_colliding_proc();
@@ -39,6 +41,8 @@ private:
     void do_ready_move_proc();
 
 private:
+    CompetitionState &m_compstate;
+
     class Impl;
     std::unique_ptr<Impl> m_impl;
     std::weak_ptr<Controller> m_sol;
@@ -49,8 +53,7 @@ private:
      */
     std::unique_ptr<Procedure> m_proc;
 
-    StatusLabel *m_state_label;
-    bool m_done;
+    std::unique_ptr<UiLabel> m_state_label;
 };
 
 #endif //MINOTAUR_CPP_OBJECTSTRATEGY_H
@@ -0,0 +1,115 @@
+#include "statemachine.h"
+
+#include <sstream>
+
+#ifndef NDEBUG
+#include <cassert>
+#endif
+
+typedef std::chrono::duration<double, std::milli> millis;
+
+double nrg::state_time::time_ms() const {
+    return millis(time).count();
+}
+
+nrg::state_machine::state_machine(std::initializer_list<const char *> names) :
+    m_names(names),
+    m_times(names.size(), state_time{0, 0, clock::duration::zero()}),
+    m_state(0),
+    m_started(false),
+    m_done(false),
+    m_failed(false) {
+#ifndef NDEBUG
+    assert(!m_names.empty());
+#endif
+}
+
+void nrg::state_machine::tick(clock::time_point now) {
+    if (m_done) { return; }
+    m_now = now;
+    if (!m_started) {
+        m_started = true;
+        enter(m_state);
+    }
+    if (!ready()) { return; }
+    for (int i = 0; i < MAX_TRANSITIONS && !m_done; ++i) {
+        int current = m_state;
+        ++m_times[current].ticks;
+        step(current);
+        // Stop once a handler settles in its state
+        if (m_state == current) { break; }
+    }
+}
+
+bool nrg::state_machine::is_done() const {
+    return m_done;
+}
+
+bool nrg::state_machine::is_failed() const {
+    return m_failed;
+}
+
+int nrg::state_machine::state() const {
+    return m_state;
+}
+
+const char *nrg::state_machine::state_name(int state) const {
+    return m_names[state];
+}
+
+const std::vector<nrg::state_time> &nrg::state_machine::state_times() const {
+    return m_times;
+}
+
+std::vector<std::string> nrg::state_machine::state_rows() const {
+    std::vector<std::string> out;
+    for (std::size_t i = 0; i < m_times.size(); ++i) {
+        const state_time &t = m_times[i];
+        if (!t.entries) { continue; }
+        std::stringstream ss;
+        ss.setf(std::ios::fixed);
+        ss.precision(1);
+        ss << m_names[i] << ": " << t.entries << " entries "
+           << t.ticks << " ticks " << t.time_ms() << " ms";
+        out.push_back(ss.str());
+    }
+    return out;
+}
+
+bool nrg::state_machine::ready() const {
+    return true;
+}
+
+void nrg::state_machine::transition(int next) {
+#ifndef NDEBUG
+    assert(next >= 0 && static_cast<std::size_t>(next) < m_names.size());
+#endif
+    leave();
+    m_state = next;
+    enter(next);
+}
+
+void nrg::state_machine::finish() {
+    if (m_done) { return; }
+    if (m_started) { leave(); }
+    m_done = true;
+}
+
+void nrg::state_machine::fail() {
+    if (m_done) { return; }
+    finish();
+    m_failed = true;
+}
+
+nrg::state_machine::clock::time_point nrg::state_machine::now() const {
+    return m_now;
+}
+
+void nrg::state_machine::enter(int state) {
+    ++m_times[state].entries;
+    m_entered = m_now;
+}
+
+void nrg::state_machine::leave() {
+    m_times[m_state].time += m_now - m_entered;
+}
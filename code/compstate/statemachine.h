@@ -0,0 +1,137 @@
+#ifndef MINOTAUR_CPP_STATEMACHINE_H
+#define MINOTAUR_CPP_STATEMACHINE_H
+
+#include <chrono>
+#include <initializer_list>
+#include <string>
+#include <vector>
+
+namespace nrg {
+
+    /**
+     * Time accounting of one state of a state machine.
+     */
+    struct state_time {
+        typedef std::chrono::steady_clock::duration duration;
+
+        double time_ms() const;
+
+        // Times the state was entered
+        std::size_t entries;
+        // Ticks on which the handler of the state ran
+        std::size_t ticks;
+        // Total time spent in the state
+        duration time;
+    };
+
+    /**
+     * Hierarchical state machine of the procedures. Only the outermost
+     * machine is ticked by the control scheduler, once per control
+     * cycle, and the handler of each state ticks the child machine it
+     * owns, so the whole tree runs in a fixed order: parent, then child.
+     *
+     * A tick runs the handler of the current state, and again for each
+     * state it transitions to, so a parent can start a child, the child
+     * can act, and the parent can react to it finishing all within the
+     * same tick. The number of transitions in one tick is bounded, in
+     * case the states form a loop.
+     *
+     * The entries, ticks and time spent in each state are accounted.
+     */
+    class state_machine {
+    public:
+        typedef std::chrono::steady_clock clock;
+
+        enum {
+            // Transitions followed within one tick
+            MAX_TRANSITIONS = 16
+        };
+
+        /**
+         * @param names name of each state, the first being initial
+         */
+        explicit state_machine(std::initializer_list<const char *> names);
+
+        virtual ~state_machine() = default;
+
+        /**
+         * Run the machine for one control cycle, if it is ready.
+         *
+         * @param now time of the cycle, passed on to children
+         */
+        void tick(clock::time_point now = clock::now());
+
+        bool is_done() const;
+
+        /**
+         * @return whether the machine ended by failing, in which case
+         *         it is also done
+         */
+        bool is_failed() const;
+
+        int state() const;
+
+        const char *state_name(int state) const;
+
+        /**
+         * @return the accounting of each state, up to the last
+         *         transition or the end of the machine
+         */
+        const std::vector<state_time> &state_times() const;
+
+        /**
+         * Render the accounting of the states that were entered, such
+         * as "DOING_MOVE: 2 entries 40 ticks 1250.0 ms".
+         */
+        std::vector<std::string> state_rows() const;
+
+    protected:
+        /**
+         * Run the handler of a state.
+         */
+        virtual void step(int state) = 0;
+
+        /**
+         * @return false to skip the tick, such as when the boxes
+         *         the machine needs are stale
+         */
+        virtual bool ready() const;
+
+        /**
+         * Change state, whose handler then runs in the same tick.
+         */
+        void transition(int next);
+
+        /**
+         * End the machine, which is not ticked again.
+         */
+        void finish();
+
+        /**
+         * End the machine as having failed, such as when it cannot act
+         * on the boxes it sees or a child has failed.
+         */
+        void fail();
+
+        /**
+         * @return the time of the current tick
+         */
+        clock::time_point now() const;
+
+    private:
+        void enter(int state);
+        void leave();
+
+        std::vector<const char *> m_names;
+        std::vector<state_time> m_times;
+        int m_state;
+        bool m_started;
+        bool m_done;
+        bool m_failed;
+        clock::time_point m_now;
+        clock::time_point m_entered;
+    };
+
+}
+
+#endif //MINOTAUR_CPP_STATEMACHINE_H
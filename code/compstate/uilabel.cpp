@@ -0,0 +1,33 @@
+#include "compstate.h"
+#include "uilabel.h"
+
+#include "../camera/statusbox.h"
+#include "../camera/statuslabel.h"
+#include "../gui/global.h"
+
+UiLabel::UiLabel(CompetitionState &state, format_fn format) :
+    m_compstate(state),
+    m_slot(std::make_shared<nrg::telemetry_slot>()),
+    m_label(std::make_shared<StatusLabel *>(nullptr)) {
+    std::shared_ptr<nrg::telemetry_slot> slot = m_slot;
+    std::shared_ptr<StatusLabel *> label = m_label;
+    m_compstate.post_ui([slot, label, format] {
+        if (auto lp = Main::get()->status_box().lock()) {
+            *label = lp->add_telemetry(slot, format);
+        }
+    });
+}
+
+UiLabel::~UiLabel() {
+    std::shared_ptr<StatusLabel *> label = m_label;
+    m_compstate.post_ui([label] {
+        if (!*label) { return; }
+        if (auto lp = Main::get()->status_box().lock()) {
+            lp->remove_label(*label);
+        }
+    });
+}
+
+void UiLabel::publish(double v0, double v1, double v2, double v3) {
+    m_slot->publish(v0, v1, v2, v3);
+}
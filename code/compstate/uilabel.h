@@ -0,0 +1,56 @@
+#ifndef MINOTAUR_CPP_UILABEL_H
+#define MINOTAUR_CPP_UILABEL_H
+
+#include "../utility/telemetry.h"
+
+#include <QString>
+#include <functional>
+#include <memory>
+
+// Forward declarations
+class CompetitionState;
+class StatusLabel;
+
+/**
+ * Status label that may be owned and updated from the control thread.
+ * The owner publishes numeric values to a telemetry slot, which the
+ * status box formats and redraws at its own rate on the GUI thread.
+ * Creating and removing the label are posted to the UI mailbox of the
+ * competition state.
+ */
+class UiLabel {
+public:
+    typedef std::function<QString(const nrg::telemetry_slot::values &)> format_fn;
+
+    /**
+     * Add a label to the status box.
+     *
+     * @param state  competition state through which the label is posted
+     * @param format function turning the published values into the
+     *               label text, called on the GUI thread
+     */
+    UiLabel(CompetitionState &state, format_fn format);
+
+    /**
+     * Remove the label from the status box.
+     */
+    ~UiLabel();
+
+    UiLabel(const UiLabel &) = delete;
+
+    UiLabel &operator=(const UiLabel &) = delete;
+
+    /**
+     * Publish the values shown by the label. Cheap enough to call on
+     * every control tick.
+     */
+    void publish(double v0, double v1 = 0, double v2 = 0, double v3 = 0);
+
+private:
+    CompetitionState &m_compstate;
+    std::shared_ptr<nrg::telemetry_slot> m_slot;
+    // Set on the GUI thread once the label has been created
+    std::shared_ptr<StatusLabel *> m_label;
+};
+
+#endif //MINOTAUR_CPP_UILABEL_H
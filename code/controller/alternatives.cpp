@@ -0,0 +1,154 @@
+#include "alternatives.h"
+#include "lattice.h"
+#include "penaltyfield.h"
+
+#include "../utility/thread_pool.h"
+
+#include <algorithm>
+#include <future>
+#include <limits>
+#include <memory>
+
+static std::vector<int> flatten(array2d<int> &terrain) {
+    std::size_t ny = terrain.y();
+    std::vector<int> flat(terrain.x() * ny);
+    for (std::size_t x = 0; x < terrain.x(); ++x) {
+        std::copy(terrain[x].get(), terrain[x].get() + ny, flat.begin() + x * ny);
+    }
+    return flat;
+}
+
+static void unflatten(const std::vector<int> &flat, array2d<int> &terrain) {
+    std::size_t ny = terrain.y();
+    for (std::size_t x = 0; x < terrain.x(); ++x) {
+        std::copy(flat.begin() + x * ny, flat.begin() + (x + 1) * ny, terrain[x].get());
+    }
+}
+
+/**
+ * Add a penalty to the open cells within a chessboard radius of a
+ * run of path cells.
+ */
+static void penalise_band(
+    std::vector<int> &flat,
+    int nx, int ny,
+    const std::vector<vector2i> &cells,
+    int radius,
+    int penalty
+) {
+    std::vector<bool> done(flat.size(), false);
+    for (const vector2i &c : cells) {
+        for (int x = std::max(0, c.x() - radius); x <= std::min(nx - 1, c.x() + radius); ++x) {
+            for (int y = std::max(0, c.y() - radius); y <= std::min(ny - 1, c.y() + radius); ++y) {
+                auto i = static_cast<std::size_t>(x * ny + y);
+                if (done[i] || flat[i] == TERRAIN_WALL) { continue; }
+                done[i] = true;
+                flat[i] += penalty;
+            }
+        }
+    }
+}
+
+static nrg::path_candidate measure(
+    array2d<int> &terrain,
+    nrg::penalty_field &walls,
+    const std::vector<vector2i> &path
+) {
+    nrg::path_candidate c;
+    c.path = path;
+    c.cost = 0;
+    c.clearance = path.empty() ? 0 : std::numeric_limits<int>::max();
+    for (std::size_t i = 0; i < path.size(); ++i) {
+        if (i > 0) { c.cost += 1 + terrain[path[i].x()][path[i].y()]; }
+        c.clearance = std::min(c.clearance, walls.distance(path[i].x(), path[i].y()));
+    }
+    c.turns = nrg::count_switches(path);
+    return c;
+}
+
+static nrg::penalty_field wall_distance(array2d<int> &terrain) {
+    nrg::penalty_field walls(TERRAIN_WALL, [](int) { return 0; }, 0);
+    walls.compute(terrain);
+    return walls;
+}
+
+nrg::path_candidate nrg::measure_path(array2d<int> &terrain, const std::vector<vector2i> &path) {
+    penalty_field walls = wall_distance(terrain);
+    return measure(terrain, walls, path);
+}
+
+std::vector<nrg::path_candidate> nrg::alternative_paths(
+    array2d<int> &terrain,
+    const vector2i &start,
+    const vector2i &dest,
+    std::size_t k,
+    thread_pool &pool,
+    const alternative_options &options
+) {
+    std::vector<path_candidate> candidates;
+    if (k == 0) { return candidates; }
+    int nx = static_cast<int>(terrain.x());
+    int ny = static_cast<int>(terrain.y());
+
+    // Contested regions are part of the terrain every candidate sees
+    std::vector<int> base = flatten(terrain);
+    for (const rect2i &r : options.avoid) {
+        for (int x = std::max(0, r.x()); x < std::min(nx, r.x() + r.width()); ++x) {
+            for (int y = std::max(0, r.y()); y < std::min(ny, r.y() + r.height()); ++y) {
+                int &t = base[x * ny + y];
+                if (t != TERRAIN_WALL) { t += options.avoid_penalty; }
+            }
+        }
+    }
+    auto shared = std::make_shared<const std::vector<int>>(std::move(base));
+    auto plan = [shared, nx, ny, start, dest](const std::vector<int> *flat, int turn_penalty) {
+        array2d<int> grid(nx, ny);
+        unflatten(flat ? *flat : *shared, grid);
+        std::vector<vector2i> path;
+        lattice_planner planner(turn_penalty);
+        planner.search(grid, start, dest, path);
+        return path; // move constructor
+    };
+
+    std::vector<vector2i> shortest = plan(nullptr, options.turn_penalty);
+    if (shortest.empty()) { return candidates; }
+
+    std::vector<std::future<std::vector<vector2i>>> futures;
+    if (k > 1) {
+        futures.push_back(pool.submit([plan, &options] {
+            return plan(nullptr, options.straight_turn_penalty);
+        }));
+    }
+    // Split the inner cells of the shortest path into one section per
+    // remaining candidate and detour around each one concurrently
+    std::size_t sections = k > 2 ? k - 2 : 0;
+    std::size_t inner = shortest.size() > 2 ? shortest.size() - 2 : 0;
+    sections = std::min(sections, inner);
+    for (std::size_t s = 0; s < sections; ++s) {
+        std::size_t first = 1 + s * inner / sections;
+        std::size_t last = 1 + (s + 1) * inner / sections;
+        std::vector<vector2i> section(shortest.begin() + first, shortest.begin() + last);
+        futures.push_back(pool.submit([plan, shared, section, nx, ny, &options] {
+            std::vector<int> flat(*shared);
+            penalise_band(flat, nx, ny, section, options.detour_radius, options.detour_penalty);
+            return plan(&flat, options.turn_penalty);
+        }));
+    }
+
+    penalty_field walls = wall_distance(terrain);
+    candidates.push_back(measure(terrain, walls, shortest));
+    for (std::future<std::vector<vector2i>> &f : futures) {
+        std::vector<vector2i> path = f.get();
+        bool duplicate = path.empty();
+        for (const path_candidate &c : candidates) {
+            duplicate = duplicate || c.path == path;
+        }
+        if (!duplicate) {
+            candidates.push_back(measure(terrain, walls, path));
+        }
+    }
+    std::stable_sort(candidates.begin(), candidates.end(), [](const path_candidate &a, const path_candidate &b) {
+        return a.cost < b.cost;
+    });
+    return candidates;
+}
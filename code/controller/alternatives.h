@@ -0,0 +1,92 @@
+#ifndef MINOTAUR_CPP_ALTERNATIVES_H
+#define MINOTAUR_CPP_ALTERNATIVES_H
+
+#include "../utility/array2d.h"
+#include "../utility/rect.h"
+#include "../utility/vector.h"
+
+#include <vector>
+
+namespace nrg {
+    class thread_pool;
+
+    /**
+     * A candidate path with the metrics used to choose between
+     * alternatives.
+     */
+    struct path_candidate {
+        // Cells of the path, including the start and destination
+        std::vector<vector2i> path;
+        // Sum of one plus the terrain value of every cell entered
+        int cost;
+        // Number of heading switches
+        int turns;
+        // Least chessboard distance from a path cell to a wall or
+        // to the edge of the grid
+        int clearance;
+    };
+
+    /**
+     * Options controlling how alternatives are generated.
+     */
+    struct alternative_options {
+        alternative_options() :
+            turn_penalty(5),
+            straight_turn_penalty(1000),
+            detour_penalty(50),
+            detour_radius(2),
+            avoid_penalty(100) {}
+
+        // Turn penalty of the shortest and detour candidates
+        int turn_penalty;
+        // Turn penalty of the candidate that minimises turns
+        int straight_turn_penalty;
+        // Penalty added near a section of the shortest path to force
+        // a detour around it
+        int detour_penalty;
+        // Chessboard radius of the penalised band around a section
+        int detour_radius;
+        // Contested regions, in cells, that every candidate avoids
+        std::vector<rect2i> avoid;
+        // Penalty added to each cell of a contested region
+        int avoid_penalty;
+    };
+
+    /**
+     * Compute up to k diverse paths between two cells.
+     *
+     * The shortest path is found first. The other candidates are then
+     * planned concurrently on the pool: one minimising turns, and one
+     * for each section of the shortest path, planned with that section
+     * penalised so that the search detours around it. Duplicates are
+     * dropped and the candidates are sorted by cost.
+     *
+     * @param terrain kernelized terrain
+     * @param start   starting cell
+     * @param dest    destination cell
+     * @param k       maximum number of candidates
+     * @param pool    pool on which the candidates are planned
+     * @param options generation options
+     * @return the candidates, empty if the destination is unreachable
+     */
+    std::vector<path_candidate> alternative_paths(
+        array2d<int> &terrain,
+        const vector2i &start,
+        const vector2i &dest,
+        std::size_t k,
+        thread_pool &pool,
+        const alternative_options &options = alternative_options()
+    );
+
+    /**
+     * Compute the metrics of a path.
+     *
+     * @param terrain kernelized terrain
+     * @param path    4-connected path including the start
+     * @return a candidate holding the path and its metrics
+     */
+    path_candidate measure_path(array2d<int> &terrain, const std::vector<vector2i> &path);
+
+}
+
+#endif //MINOTAUR_CPP_ALTERNATIVES_H
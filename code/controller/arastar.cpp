@@ -0,0 +1,227 @@
+#include "arastar.h"
+#include "astar.h"
+#include "penaltyfield.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <functional>
+#include <limits>
+
+enum {
+    COST_INF = std::numeric_limits<int>::max() / 2,
+    // Expansions between deadline checks
+    CLOCK_INTERVAL = 256
+};
+
+nrg::ara_planner::ara_planner(double epsilon, double step) :
+    m_epsilon0(std::max(1.0, epsilon)),
+    m_step(step > 0 ? step : 0.5),
+    m_x(0),
+    m_y(0),
+    m_start(0),
+    m_dest(0),
+    m_epsilon(1),
+    m_bound(0),
+    m_iterations(0),
+    m_searching(false),
+    m_done(true) {}
+
+void nrg::ara_planner::reset(
+    array2d<int> &terrain,
+    const vector2i &start,
+    const vector2i &dest
+) {
+    m_x = static_cast<int>(terrain.x());
+    m_y = static_cast<int>(terrain.y());
+    auto num = static_cast<std::size_t>(m_x * m_y);
+    m_terrain.resize(num);
+    for (int x = 0; x < m_x; ++x) {
+        std::copy(terrain[x].get(), terrain[x].get() + m_y, m_terrain.begin() + x * m_y);
+    }
+    m_g.assign(num, COST_INF);
+    m_parent.assign(num, -1);
+    m_open.assign(num, false);
+    m_closed.assign(num, false);
+    m_incons.assign(num, false);
+    m_incons_list.clear();
+    m_heap.clear();
+    m_epsilon = m_epsilon0;
+    m_bound = 0;
+    m_iterations = 0;
+    m_searching = false;
+    m_done = true;
+    last_search_stats() = {0, 0};
+
+    auto outside = [this](const vector2i &v) {
+        return v.x() < 0 || v.y() < 0 || v.x() >= m_x || v.y() >= m_y;
+    };
+    if (outside(start) || outside(dest)) { return; }
+    m_start = start.x() * m_y + start.y();
+    m_dest = dest.x() * m_y + dest.y();
+    if (m_terrain[m_start] == TERRAIN_WALL || m_terrain[m_dest] == TERRAIN_WALL) { return; }
+    m_g[m_start] = 0;
+    push(m_start);
+    m_searching = true;
+    m_done = false;
+}
+
+int nrg::ara_planner::heuristic(int id) const {
+    return abs(id / m_y - m_dest / m_y) + abs(id % m_y - m_dest % m_y);
+}
+
+double nrg::ara_planner::key(int id) const {
+    return m_g[id] + m_epsilon * heuristic(id);
+}
+
+void nrg::ara_planner::push(int id) {
+    m_open[id] = true;
+    m_heap.emplace_back(key(id), id);
+    std::push_heap(m_heap.begin(), m_heap.end(), std::greater<queue_entry>());
+    ++last_search_stats().pushes;
+}
+
+bool nrg::ara_planner::improve_path(clock::time_point deadline) {
+    search_stats &stats = last_search_stats();
+    int count = 0;
+    while (!m_heap.empty()) {
+        queue_entry top = m_heap.front();
+        int u = top.second;
+        // Entries are never updated in place, so skip stale ones
+        if (!m_open[u] || top.first != key(u)) {
+            std::pop_heap(m_heap.begin(), m_heap.end(), std::greater<queue_entry>());
+            m_heap.pop_back();
+            continue;
+        }
+        if (m_g[m_dest] <= top.first) { break; }
+        if (++count % CLOCK_INTERVAL == 0 && clock::now() >= deadline) { return false; }
+        std::pop_heap(m_heap.begin(), m_heap.end(), std::greater<queue_entry>());
+        m_heap.pop_back();
+        m_open[u] = false;
+        m_closed[u] = true;
+        ++stats.expansions;
+        int ux = u / m_y;
+        int uy = u % m_y;
+        int xs[] = {ux - 1, ux + 1, ux, ux};
+        int ys[] = {uy, uy, uy - 1, uy + 1};
+        for (int i = 0; i < 4; ++i) {
+            if (xs[i] < 0 || ys[i] < 0 || xs[i] >= m_x || ys[i] >= m_y) { continue; }
+            int v = xs[i] * m_y + ys[i];
+            if (m_terrain[v] == TERRAIN_WALL) { continue; }
+            int c = m_g[u] + 1 + m_terrain[v];
+            if (c >= m_g[v]) { continue; }
+            m_g[v] = c;
+            m_parent[v] = u;
+            if (!m_closed[v]) {
+                push(v);
+            } else if (!m_incons[v]) {
+                // Improved after expansion in this iteration, so it
+                // waits for the next one instead of being re-expanded
+                m_incons[v] = true;
+                m_incons_list.push_back(v);
+            }
+        }
+    }
+    return true;
+}
+
+double nrg::ara_planner::achieved_bound() const {
+    if (m_g[m_dest] >= COST_INF) { return 0; }
+    // The least unweighted f-value among nodes still to be
+    // expanded is a lower bound on the optimal cost
+    int lower = COST_INF;
+    for (const queue_entry &e : m_heap) {
+        if (m_open[e.second]) {
+            lower = std::min(lower, m_g[e.second] + heuristic(e.second));
+        }
+    }
+    for (int v : m_incons_list) {
+        lower = std::min(lower, m_g[v] + heuristic(v));
+    }
+    if (lower >= m_g[m_dest]) { return 1; }
+    return std::min(m_epsilon, static_cast<double>(m_g[m_dest]) / lower);
+}
+
+void nrg::ara_planner::next_iteration() {
+    m_epsilon = std::max(1.0, m_epsilon - m_step);
+    // Re-key the open list under the new weight, adding the
+    // inconsistent nodes, and start a fresh closed set
+    std::vector<int> open;
+    for (const queue_entry &e : m_heap) {
+        if (m_open[e.second]) { open.push_back(e.second); }
+    }
+    for (int v : m_incons_list) {
+        m_incons[v] = false;
+        open.push_back(v);
+    }
+    m_incons_list.clear();
+    std::sort(open.begin(), open.end());
+    open.erase(std::unique(open.begin(), open.end()), open.end());
+    m_heap.clear();
+    for (int v : open) {
+        m_open[v] = true;
+        m_heap.emplace_back(key(v), v);
+    }
+    std::make_heap(m_heap.begin(), m_heap.end(), std::greater<queue_entry>());
+    std::fill(m_closed.begin(), m_closed.end(), false);
+}
+
+bool nrg::ara_planner::improve(clock::time_point deadline) {
+    while (!m_done) {
+        if (!improve_path(deadline)) { break; }
+        ++m_iterations;
+        m_bound = achieved_bound();
+        if (m_g[m_dest] >= COST_INF || m_bound <= 1 || m_epsilon <= 1) {
+            m_done = true;
+            break;
+        }
+        next_iteration();
+        if (clock::now() >= deadline) { break; }
+    }
+    return m_searching && m_g[m_dest] < COST_INF;
+}
+
+bool nrg::ara_planner::path(std::vector<vector2i> &path) const {
+    if (!m_searching || m_g[m_dest] >= COST_INF) { return false; }
+    // Parents always have a lower cost than their children, so the
+    // chain is a valid path even in the middle of an iteration
+    std::size_t first = path.size();
+    for (int v = m_dest; v != m_start; v = m_parent[v]) {
+        path.emplace_back(v / m_y, v % m_y);
+    }
+    path.emplace_back(m_start / m_y, m_start % m_y);
+    std::reverse(path.begin() + first, path.end());
+    return true;
+}
+
+double nrg::ara_planner::bound() const {
+    return m_bound;
+}
+
+int nrg::ara_planner::cost() const {
+    if (!m_searching || m_g[m_dest] >= COST_INF) { return -1; }
+    int cost = 0;
+    for (int v = m_dest; v != m_start; v = m_parent[v]) {
+        cost += 1 + m_terrain[v];
+    }
+    return cost;
+}
+
+int nrg::ara_planner::iterations() const {
+    return m_iterations;
+}
+
+bool nrg::search_path_anytime(
+    array2d<int> &terrain,
+    const vector2i &start,
+    const vector2i &dest,
+    std::chrono::microseconds budget,
+    std::vector<vector2i> &path,
+    double *bound
+) {
+    ara_planner::clock::time_point deadline = ara_planner::clock::now() + budget;
+    ara_planner planner;
+    planner.reset(terrain, start, dest);
+    planner.improve(deadline);
+    if (bound) { *bound = planner.bound(); }
+    return planner.path(path);
+}
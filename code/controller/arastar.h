@@ -0,0 +1,127 @@
+#ifndef MINOTAUR_CPP_ARASTAR_H
+#define MINOTAUR_CPP_ARASTAR_H
+
+#include "../utility/array2d.h"
+#include "../utility/vector.h"
+
+#include <chrono>
+#include <vector>
+
+namespace nrg {
+
+    /**
+     * Anytime repairing A* (ARA*). A first path is found quickly with a
+     * heavily weighted heuristic, then the weight is lowered step by step
+     * while time remains. Each iteration reuses the previous search and
+     * only re-expands the nodes whose costs became inconsistent.
+     *
+     * Moving into a cell costs one plus its terrain value, and walls
+     * have the value TERRAIN_WALL.
+     */
+    class ara_planner {
+    public:
+        typedef std::chrono::steady_clock clock;
+
+        explicit ara_planner(double epsilon = 3.0, double step = 0.5);
+
+        /**
+         * Copy a terrain and begin a new query. No search is done
+         * until improve() is called.
+         *
+         * @param terrain kernelized terrain
+         * @param start   starting cell
+         * @param dest    destination cell
+         */
+        void reset(array2d<int> &terrain, const vector2i &start, const vector2i &dest);
+
+        /**
+         * Search until the deadline passes or the path is optimal.
+         * May be called again to continue improving.
+         *
+         * @param deadline time by which to return
+         * @return true if a path has been found
+         */
+        bool improve(clock::time_point deadline);
+
+        /**
+         * Write the best path found so far, including the start and
+         * destination cells.
+         *
+         * @param path vector to which the path is written
+         * @return true if a path has been found
+         */
+        bool path(std::vector<vector2i> &path) const;
+
+        /**
+         * @return factor by which the path may exceed the optimal
+         *         cost, or zero if no iteration has finished
+         */
+        double bound() const;
+
+        /**
+         * @return cost of the best path, or -1 if none was found
+         */
+        int cost() const;
+
+        /**
+         * @return number of finished search iterations
+         */
+        int iterations() const;
+
+    private:
+        typedef std::pair<double, int> queue_entry;
+
+        int heuristic(int id) const;
+        double key(int id) const;
+        void push(int id);
+        bool improve_path(clock::time_point deadline);
+        void next_iteration();
+        double achieved_bound() const;
+
+        double m_epsilon0;
+        double m_step;
+
+        int m_x;
+        int m_y;
+        int m_start;
+        int m_dest;
+        std::vector<int> m_terrain;
+
+        double m_epsilon;
+        double m_bound;
+        int m_iterations;
+        bool m_searching;
+        bool m_done;
+
+        std::vector<int> m_g;
+        std::vector<int> m_parent;
+        std::vector<bool> m_open;
+        std::vector<bool> m_closed;
+        std::vector<bool> m_incons;
+        std::vector<int> m_incons_list;
+        std::vector<queue_entry> m_heap;
+    };
+
+    /**
+     * Find the best path available within a time budget.
+     *
+     * @param terrain kernelized terrain
+     * @param start   starting cell
+     * @param dest    destination cell
+     * @param budget  time allowed for the search
+     * @param path    vector to which the path is written
+     * @param bound   if not null, written with the suboptimality bound
+     * @return true if a path was found in time
+     */
+    bool search_path_anytime(
+        array2d<int> &terrain,
+        const vector2i &start,
+        const vector2i &dest,
+        std::chrono::microseconds budget,
+        std::vector<vector2i> &path,
+        double *bound = nullptr
+    );
+
+}
+
+#endif //MINOTAUR_CPP_ARASTAR_H
@@ -1,428 +1,250 @@
 #include "astar.h"
+#include "lattice.h"
+#include "penaltyfield.h"
+#include "plancache.h"
+#include "plancontext.h"
+#include "thetastar.h"
 
 #include "../camera/imageviewer.h"
 #include "../compstate/parammanager.h"
 #include "../gui/griddisplay.h"
 #include "../utility/algorithm.h"
+#include "../utility/indexed_heap.h"
+#include "../utility/logger.h"
+#include "../utility/spatial_grid.h"
+#include "../utility/thread_pool.h"
 
-#include <unordered_set>
-
-#include <set>
-#include <map>
+#include <algorithm>
+#include <cstdlib>
+#include <limits>
 
 #ifndef NDEBUG
 #include <cassert>
 #endif
 
-#define TERRAIN_WALL -1
-
-struct node {
-
-    node() :
-        x(0),
-        y(0),
-        g(0),
-        h(0),
-        f(0),
-        terrain(0),
-        parent(nullptr) {}
-
-    bool operator==(const node &o) {
-        return x == o.x && y == o.y;
-    }
-
-    bool operator!=(const node &o) {
-        return x != o.x || y != o.y;
-    }
-
-    int x;
-    int y;
-
-    int g;
-    int h;
-    int f;
-
-    int terrain;
-
-    node *parent;
-};
-
-static int get_h(node *a, node *b) {
-    int dx = a->x - b->x;
-    int dy = a->y - b->y;
-    return abs(dx) + abs(dy);
+nrg::search_stats &nrg::last_search_stats() {
+    static thread_local search_stats stats;
+    return stats;
 }
 
-static void backtrack(
-    node *start,
-    node *dest,
-    std::list<node *> &path
-) {
-    node *cur = dest;
-    while (cur != start) {
-        path.push_front(cur);
-        cur = cur->parent;
-    }
+static int manhattan_dist(int x, int y, const vector2i &dest) {
+    return abs(dest.x() - x) + abs(dest.y() - y);
 }
 
-static void get_neighbors(
-    node *cur,
-    array2d<node *, int> &world,
-    std::list<node *> &neighbors
-) {
-    int cx = cur->x;
-    int cy = cur->y;
-    int xs[] = {cx - 1, cx, cx, cx + 1};
-    int ys[] = {cy, cy - 1, cy + 1, cy};
-    for (int i = 0; i < 4; ++i) {
-        cx = xs[i];
-        cy = ys[i];
-        if (cx < 0 ||
-            cy < 0 ||
-            cx >= world.x() ||
-            cy >= world.y()) {
-            continue;
-        }
-        if (world[cx][cy]->terrain != TERRAIN_WALL) {
-            neighbors.push_back(world[cx][cy]);
-        }
-    }
-}
-
-static void astar_search_path(
-    node *start,
-    node *dest,
-    array2d<node *, int> &world,
-    std::list<node *> &path
-) {
-    std::unordered_set<node *> open_set;
-    std::unordered_set<node *> closed_set;
-    node *cur;
-
-    start->g = 0;
-    start->h = get_h(start, dest);
-    start->f = start->h;
-
-    open_set.insert(start);
-    while (!open_set.empty()) {
-        cur = nullptr;
-        for (node *node : open_set) {
-            if (cur == nullptr ||
-                node->f < cur->f ||
-                (node->f == cur->f && node->h < cur->h)) {
-                cur = node;
-            }
-        }
-        if (cur == nullptr) {
-            break;
-        }
-        open_set.erase(cur);
-        closed_set.insert(cur);
-
-        std::list<node *> neighbors;
-        get_neighbors(cur, world, neighbors);
-
-        for (node *neigh : neighbors) {
-            if (closed_set.find(neigh) != closed_set.end()) {
-                continue;
-            }
-            int cur_g = cur->g + get_h(cur, neigh) + world[neigh->x][neigh->y]->terrain;
-
-            if (cur->parent) {
-                int dx = cur->x - cur->parent->x;
-                int dy = cur->y - cur->parent->y;
-                bool turned =
-                    dx != neigh->x - cur->x ||
-                    dy != neigh->y - cur->y;
-                cur_g += turned * 5;
-            }
-
-            if (cur_g <= neigh->g || neigh->g == 0) {
-                neigh->g = cur_g;
-                neigh->h = get_h(neigh, dest);
-                neigh->f = neigh->h + neigh->g;
-                neigh->parent = cur;
-            }
-            open_set.insert(neigh);
-        }
-        if (cur->x == dest->x && cur->y == dest->y) {
-            backtrack(start, dest, path);
-            return;
-        }
-    }
-}
-
-typedef std::pair<double, vector2i> associated_cost;
-
-static double manhattan_dist(
-    const vector2i &cur,
-    const vector2i &dest
-) {
-    return abs(dest.x() - cur.x()) + abs(dest.y() - cur.y());
-}
-
-static bool is_valid(
-    int x, int y,
-    int max_row, int max_col
-) {
-    return (x >= 0) && (x < max_row) && (y >= 0) && (y < max_col);
-}
-
-static void get_neighbors(
-    const vector2i &c,
-    int max_row, int max_col,
-    std::vector<vector2i> &neighbors
+void nrg::search_path(
+    array2d<int> &terrain,
+    const vector2i &start,
+    const vector2i &dest,
+    std::vector<vector2i> &path
 ) {
-    int cur_x = c.x();
-    int cur_y = c.y();
-    if (is_valid(cur_x - 1, cur_y, max_row, max_col)) {
-        neighbors.emplace_back(cur_x - 1, cur_y);
-    }
-    if (is_valid(cur_x + 1, cur_y, max_row, max_col)) {
-        neighbors.emplace_back(cur_x + 1, cur_y);
-    }
-    if (is_valid(cur_x, cur_y - 1, max_row, max_col)) {
-        neighbors.emplace_back(cur_x, cur_y - 1);
-    }
-    if (is_valid(cur_x, cur_y + 1, max_row, max_col)) {
-        neighbors.emplace_back(cur_x, cur_y + 1);
-    }
+    search_path(default_planner_context(), terrain, start, dest, path);
 }
 
-static void backtrack(
+void nrg::search_path(
+    planner_context &context,
+    array2d<int> &terrain,
     const vector2i &start,
     const vector2i &dest,
-    const std::map<vector2i, vector2i> &parent,
     std::vector<vector2i> &path
 ) {
-    vector2i cur = dest;
-    while (cur != start) {
-        path.push_back(cur);
-        cur = parent.at(cur);
+    // The turn penalty now lives in the lattice state, so costs stay
+    // consistent; the start is not part of the returned path
+    lattice_planner planner(lattice_planner::DEFAULT_TURN_PENALTY, context);
+    std::size_t first = path.size();
+    if (planner.search(terrain, start, dest, path)) {
+        path.erase(path.begin() + first);
     }
-    path.push_back(start);
-    std::reverse(std::begin(path), std::end(path));
 }
 
-void nrg::search_path(
+void nrg::search_path_del(
     array2d<int> &terrain,
     const vector2i &start,
     const vector2i &dest,
     std::vector<vector2i> &path
 ) {
-    int mx = static_cast<int>(terrain.x());
-    int my = static_cast<int>(terrain.y());
-    std::list<node *> node_path;
-    array2d<node, int> nodes(mx, my);
-    array2d<node *, int> world(mx, my);
-    for (unsigned int x = 0; x < terrain.x(); ++x) {
-        for (unsigned int y = 0; y < terrain.y(); ++y) {
-            nodes[x][y].x = x;
-            nodes[x][y].y = y;
-            nodes[x][y].terrain = terrain[x][y];
-            world[x][y] = &nodes[x][y];
-        }
-    }
-    node *node_start = world[start.x()][start.y()];
-    node *node_dest = world[dest.x()][dest.y()];
-    astar_search_path(node_start, node_dest, world, node_path);
-    for (node *node : node_path) {
-        path.emplace_back(node->x, node->y);
-    }
+    search_path_del(default_planner_context(), terrain, start, dest, path);
 }
 
 void nrg::search_path_del(
+    planner_context &context,
     array2d<int> &terrain,
     const vector2i &start,
     const vector2i &dest,
     std::vector<vector2i> &path
 ) {
-    std::map<vector2i, vector2i> parent;
-    std::map<vector2i, double> cost;
-    std::set<associated_cost> open_set;
-
-    open_set.emplace(0, start);
-    parent[start] = start;
-    cost[start] = 0;
-
-    int max_row = static_cast<int>(terrain.x());
-    int max_col = static_cast<int>(terrain.y());
-
+    // Open set entries are ordered by (f, cell id), which matches the
+    // (f, cell) order of the ordered set this search used to keep
+    typedef std::pair<double, int> open_key;
+    typedef arena_allocator<open_key> open_alloc;
+    static const int dx[] = {-1, 1, 0, 0};
+    static const int dy[] = {0, 0, -1, 1};
+
+    search_stats &stats = last_search_stats();
+    stats = {0, 0};
+    int mx = static_cast<int>(terrain.x());
+    int my = static_cast<int>(terrain.y());
+    auto outside = [mx, my](const vector2i &v) {
+        return v.x() < 0 || v.y() < 0 || v.x() >= mx || v.y() >= my;
+    };
+    if (outside(start) || outside(dest)) { return; }
+
+    arena &memory = context.begin_query();
+    auto cells = static_cast<std::size_t>(mx * my);
+    double *cost = memory.array<double>(cells);
+    std::fill(cost, cost + cells, std::numeric_limits<double>::infinity());
+    int *parent = memory.array<int>(cells);
+    std::fill(parent, parent + cells, -1);
+    indexed_heap<open_key, open_alloc> open_set(cells, open_alloc(memory));
+
+    int start_id = start.x() * my + start.y();
+    int dest_id = dest.x() * my + dest.y();
+    cost[start_id] = 0;
+    parent[start_id] = start_id;
+    open_set.push(static_cast<std::size_t>(start_id), open_key(0, start_id));
+    ++stats.pushes;
+
+    bool found = false;
     while (!open_set.empty()) {
-        vector2i cur = open_set.begin()->second;
-        open_set.erase(open_set.begin());
-        if (cur == dest) { break; }
-
-        std::vector<vector2i> neighbors;
-        get_neighbors(cur, max_row, max_col, neighbors);
-        for (const vector2i &next : neighbors) {
-            if (terrain[next.x()][next.y()] != TERRAIN_WALL) {
-                double new_cost = cost[cur] + terrain[next.x()][next.y()];
-                if (!cost.count(next) || new_cost < cost[next]) {
-                    cost[next] = new_cost;
-                    open_set.emplace(new_cost + manhattan_dist(next, dest), next);
-                    parent[next] = cur;
-                }
+        auto cur = static_cast<int>(open_set.pop());
+        ++stats.expansions;
+        if (cur == dest_id) {
+            found = true;
+            break;
+        }
+        int cx = cur / my;
+        int cy = cur % my;
+        for (int i = 0; i < 4; ++i) {
+            int nx = cx + dx[i];
+            int ny = cy + dy[i];
+            if (nx < 0 || ny < 0 || nx >= mx || ny >= my) { continue; }
+            int t = terrain[nx][ny];
+            if (t == TERRAIN_WALL) { continue; }
+            int next = nx * my + ny;
+            double new_cost = cost[cur] + t;
+            if (new_cost < cost[next]) {
+                // Improved cells are reopened even if already expanded
+                cost[next] = new_cost;
+                parent[next] = cur;
+                open_set.push(static_cast<std::size_t>(next), open_key(new_cost + manhattan_dist(nx, ny, dest), next));
+                ++stats.pushes;
             }
         }
     }
-    backtrack(start, dest, parent, path);
+    if (!found) { return; }
+
+    std::size_t first = path.size();
+    for (int cur = dest_id; cur != start_id; cur = parent[cur]) {
+        path.emplace_back(cur / my, cur % my);
+    }
+    path.push_back(start);
+    std::reverse(path.begin() + first, path.end());
 }
 
-static bool is_wall_or_outside(
-    array2d<int> &terrain,
-    int x, int y, int wall
+enum {
+    // Distance of the outermost wall penalty ring
+    RING_RADIUS = 3
+};
+
+array2d<int> nrg::grid_kernelize(
+    array2d<int> &selected,
+    int wall_penalty_0,
+    int wall_penalty_1,
+    int wall_penalty_2
 ) {
-    return
-        x < 0 ||
-        y < 0 ||
-        x >= static_cast<int>(terrain.x()) ||
-        y >= static_cast<int>(terrain.y()) ||
-        terrain[x][y] == wall;
+    int wall = GridDisplay::default_weight();
+    // One distance transform replaces the three ring passes
+    penalty_field field(wall, ring_falloff(wall_penalty_0, wall_penalty_1, wall_penalty_2), RING_RADIUS);
+    field.compute(selected);
+    return std::move(field.terrain()); // move constructor
 }
 
-static int count_walls_around(
-    array2d<int> &terrain,
-    int x, int y, int wall
+array2d<int> nrg::grid_kernelize(
+    weak_ref<GridDisplay> grid,
+    weak_ref<param_manager> pm
 ) {
+    array2d<int> &selected = grid->selected();
 #ifndef NDEBUG
-    assert(x >= 0);
-    assert(y >= 0);
-    assert(x < static_cast<int>(terrain.x()));
-    assert(y < static_cast<int>(terrain.y()));
-    assert(terrain[x][y] != wall);
+    assert(static_cast<int>(selected.x()) == grid->get_num_cols());
+    assert(static_cast<int>(selected.y()) == grid->get_num_rows());
 #endif
-    int count = 0;
-    int left = x - 1;
-    int right = x + 1;
-    int bot = y - 1;
-    int top = y + 1;
-    int xs[] = {left, left, left, x, x, right, right, right};
-    int ys[] = {top, y, bot, top, bot, top, y, bot};
-    for (int i = 0; i < 8; ++i) {
-        if (is_wall_or_outside(terrain, xs[i], ys[i], wall)) {
-            ++count;
-        }
-    }
-    return count;
+    return grid_kernelize(selected, pm->wall_penalty_0, pm->wall_penalty_1, pm->wall_penalty_2);
 }
 
-/*static void apply_kernel(
-    array2d<int> &source,
-    array2d<int> &target,
-    unsigned int x, unsigned int y,
-    int wall, int wp0, int wp1, int wp2
-) {
-    using std::max;
-    using std::min;
-    using std::abs;
-#ifndef NDEBUG
-    assert(x < source.x());
-    assert(y < source.y());
-    assert(source[x][y] == wall);
-#endif
-    constexpr unsigned int offset = 2;
-    int wp[] = {0, wp0, wp1, wp2};
-    int x_min = -min(offset, x);
-    int y_min = -min(offset, y);
-    int x_max = min(offset, static_cast<int>(source.x()) - x - 1);
-    int y_max = min(offset, static_cast<int>(source.y()) - y - 1);
-    for (int dx = x_min; dx <= x_max; ++dx) {
-        for (int dy = y_min; dy <= y_max; ++dy) {
-            int tx = x + dx;
-            int ty = y + dy;
-            if (source[tx][ty] != wall) {
-                target[tx][ty] += wp[max(abs(dx), abs(dy))];
-            }
-        }
-    }
-}*/
+nrg::plan_cache &nrg::grid_plan_cache() {
+    static plan_cache cache;
+    return cache;
+}
 
-static void kernelize(
-    array2d<int> &source,
-    array2d<int> &target,
-    int wall, int wp0, int wp1, int wp2
-) {
-#ifndef NDEBUG
-    assert(source.x() == target.x());
-    assert(source.y() == target.y());
-#endif
-    // TODO cut out the repeated code
-    for (unsigned int x = 0; x < source.x(); ++x) {
-        for (unsigned int y = 0; y < source.y(); ++y) {
-            if (source[x][y] == wall) {
-                target[x][y] = TERRAIN_WALL;
-                /*apply_kernel(
-                    source, target,
-                    x, y, wall,
-                    wp0, wp1, wp2
-                );*/
-            }
-        }
-    }
-    for (unsigned int x = 0; x < source.x(); ++x) {
-        for (unsigned int y = 0; y < source.y(); ++y) {
-            if (target[x][y] != TERRAIN_WALL &&
-                count_walls_around(target, x, y, TERRAIN_WALL) > 0) {
-                target[x][y] = wp0;
-            }
-        }
-    }
-    for (unsigned int x = 0; x < source.x(); ++x) {
-        for (unsigned int y = 0; y < source.y(); ++y) {
-            if (target[x][y] != TERRAIN_WALL &&
-                target[x][y] != wp0 &&
-                count_walls_around(target, x, y, wp0) > 0) {
-                target[x][y] = wp1;
-            }
-        }
-    }
-    for (unsigned int x = 0; x < source.x(); ++x) {
-        for (unsigned int y = 0; y < source.y(); ++y) {
-            if (target[x][y] != TERRAIN_WALL &&
-                target[x][y] != wp0 &&
-                target[x][y] != wp1 &&
-                count_walls_around(target, x, y, wp1) > 0) {
-                target[x][y] = wp2;
-            }
-        }
-    }
+nrg::thread_pool &nrg::grid_thread_pool() {
+    static thread_pool pool;
+    return pool;
 }
 
-array2d<int> nrg::grid_kernelize(
+static nrg::terrain_key grid_terrain_key(
     weak_ref<GridDisplay> grid,
     weak_ref<param_manager> pm
 ) {
-    int wall = GridDisplay::default_weight();
-    int wp0 = pm->wall_penalty_0;
-    int wp1 = pm->wall_penalty_1;
-    int wp2 = pm->wall_penalty_2;
-    auto mx = static_cast<std::size_t>(grid->get_num_cols());
-    auto my = static_cast<std::size_t>(grid->get_num_rows());
-    array2d<int> source(mx, my);
-    array2d<int> terrain(mx, my);
-    array2d<int> &selected = grid->selected();
-    for (unsigned int x = 0; x < mx; ++x) {
-        memcpy(source[x].get(), selected[x].get(), my * sizeof(int));
+    // Penalties are part of the key so that parameter changes
+    // invalidate cached terrain just like grid edits do
+    return {
+        grid->version(),
+        pm->wall_penalty_0,
+        pm->wall_penalty_1,
+        pm->wall_penalty_2
+    };
+}
+
+static array2d<int> &cached_terrain(
+    weak_ref<GridDisplay> grid,
+    weak_ref<param_manager> pm,
+    const nrg::terrain_key &tkey
+) {
+    nrg::plan_cache &cache = nrg::grid_plan_cache();
+    array2d<int> *terrain = cache.terrains().find(tkey);
+    if (!terrain) {
+        terrain = &cache.terrains().insert(tkey, nrg::grid_kernelize(grid, pm));
     }
-    kernelize(source, terrain, wall, wp0, wp1, wp2);
-    return terrain; // move constructor
+    return *terrain;
 }
 
 std::vector<vector2i> nrg::grid_path(
     weak_ref<GridDisplay> grid,
     weak_ref<param_manager> pm
 ) {
+    terrain_key tkey = grid_terrain_key(grid, pm);
+    path_key pkey = {tkey, grid->get_pos_start(), grid->get_pos_end()};
+    plan_cache &cache = grid_plan_cache();
+    if (std::vector<vector2i> *cached = cache.paths().find(pkey)) {
+        return *cached;
+    }
+    array2d<int> &terrain = cached_terrain(grid, pm, tkey);
     std::vector<vector2i> path;
-    array2d<int> terrain = nrg::grid_kernelize(grid, pm);
-    const vector2i &start = grid->get_pos_start();
-    const vector2i &dest = grid->get_pos_end();
-    search_path(terrain, start, dest, path);
-    smooth_path(path);
-    //optimize_path(path, grid->selected());
+    // Any-angle waypoints replace the smoothing passes; the
+    // start is dropped since the robot is already there
+    if (search_path_theta(terrain, pkey.start, pkey.dest, path)) {
+        path.erase(path.begin());
+    }
+    cache.paths().insert(pkey, std::vector<vector2i>(path));
     return path; // move constructor
 }
 
+std::vector<nrg::path_candidate> nrg::grid_alternatives(
+    weak_ref<GridDisplay> grid,
+    weak_ref<param_manager> pm,
+    std::size_t k,
+    const alternative_options &options
+) {
+    array2d<int> &terrain = cached_terrain(grid, pm, grid_terrain_key(grid, pm));
+    return alternative_paths(
+        terrain,
+        grid->get_pos_start(),
+        grid->get_pos_end(),
+        k,
+        grid_thread_pool(),
+        options
+    );
+}
+
 void nrg::scale_path_pixels(
     weak_ref<GridDisplay> grid,
     std::vector<vector2i> &path
@@ -445,6 +267,11 @@ void nrg::connect_path(
     assert(dynamic_cast<ImageViewer *>(grid->parent()) != nullptr);
 #endif
     std::vector<vector2i> path = nrg::grid_path(grid, pm);
+    plan_cache &cache = grid_plan_cache();
+    log() << "Plan cache terrain hits " << cache.terrains().hits()
+          << " misses " << cache.terrains().misses()
+          << ", path hits " << cache.paths().hits()
+          << " misses " << cache.paths().misses();
     nrg::scale_path_pixels(grid, path);
     weak_ref<ImageViewer> viewer = dynamic_cast<ImageViewer *>(grid->parent());
     viewer->set_path(path);
@@ -465,24 +292,15 @@ void nrg::smooth_path(std::vector<vector2i> &path) {
     path.swap(smooth);
 }
 
-static void wallify(
-    array2d<int> &walls,
-    std::vector<rect2i> &rects
-) {
-    int wall = GridDisplay::default_weight();
-    int b = GridDisplay::grid_size();
-    int b2 = b / 2;
-    for (std::size_t x = 0; x < walls.x(); ++x) {
-        for (std::size_t y = 0; y < walls.y(); ++y) {
-            if (walls[x][y] == wall) {
-                rects.emplace_back(
-                    static_cast<int>(x) - b2,
-                    static_cast<int>(y) - b2,
-                    b, b
-                );
-            }
-        }
-    }
+enum {
+    // Bucket size of the wall index, in cells
+    WALL_BUCKET = 4
+};
+
+typedef nrg::spatial_grid<double> wall_index;
+
+static wall_index wallify(array2d<int> &walls) {
+    return wall_index::from_walls(walls, GridDisplay::default_weight(), WALL_BUCKET);
 }
 
 static std::pair<ray2i, ray2i> l_upper(
@@ -505,14 +323,9 @@ static std::pair<ray2i, ray2i> l_lower(
 
 static bool collides_with_any(
     const ray2i &ray,
-    const std::vector<rect2i> &rects
+    wall_index &walls
 ) {
-    for (const rect2i &rect : rects) {
-        if (algo::ray_aabb_intersect(ray, rect)) {
-            return true;
-        }
-    }
-    return false;
+    return walls.intersects(ray2d(ray.a().x(), ray.a().y(), ray.b().x(), ray.b().y()));
 }
 
 void nrg::optimize_path(
@@ -522,8 +335,7 @@ void nrg::optimize_path(
     typedef std::pair<ray2i, ray2i> l_path;
 
     std::vector<vector2i> opt;
-    std::vector<rect2i> rects;
-    wallify(walls, rects);
+    wall_index rects = wallify(walls);
 
     vector2i c = path.front();
     std::size_t j = 0;
@@ -571,4 +383,5 @@ void nrg::optimize_path(
             c = p;
         }
     }
+    path.swap(opt);
 }
@@ -1,6 +1,8 @@
 #ifndef ASTAR_H
 #define ASTAR_H
 
+#include "alternatives.h"
+
 #include "../utility/array2d.h"
 #include "../utility/vector.h"
 #include "../utility/weak_ref.h"
@@ -9,6 +11,25 @@ class GridDisplay;
 class param_manager;
 
 namespace nrg {
+    class plan_cache;
+    class planner_context;
+    class thread_pool;
+
+    /**
+     * Counters filled in by the grid planners.
+     */
+    struct search_stats {
+        // Nodes removed from the open set and expanded
+        std::size_t expansions;
+        // Insertions into the open set
+        std::size_t pushes;
+    };
+
+    /**
+     * @return counters of the last search run on this thread
+     */
+    search_stats &last_search_stats();
+
     void search_path(
         array2d<int> &terrain,
         const vector2i &start,
@@ -16,23 +37,84 @@ namespace nrg {
         std::vector<vector2i> &path
     );
 
+    /**
+     * Find a path with scratch memory drawn from a planner context, so
+     * that repeated queries do not allocate once the context has grown
+     * to fit them.
+     */
+    void search_path(
+        planner_context &context,
+        array2d<int> &terrain,
+        const vector2i &start,
+        const vector2i &dest,
+        std::vector<vector2i> &path
+    );
+
+    void search_path_del(
+        array2d<int> &terrain,
+        const vector2i &start,
+        const vector2i &dest,
+        std::vector<vector2i> &path
+    );
+
+    /**
+     * @see search_path(planner_context &, array2d<int> &, const vector2i &, const vector2i &, std::vector<vector2i> &)
+     */
     void search_path_del(
+        planner_context &context,
         array2d<int> &terrain,
         const vector2i &start,
         const vector2i &dest,
         std::vector<vector2i> &path
     );
 
+    /**
+     * Apply wall penalties to a grid of selected squares, where
+     * squares with GridDisplay::default_weight() are walls.
+     *
+     * @return the kernelized terrain
+     */
+    array2d<int> grid_kernelize(
+        array2d<int> &selected,
+        int wall_penalty_0,
+        int wall_penalty_1,
+        int wall_penalty_2
+    );
+
     array2d<int> grid_kernelize(
         weak_ref<GridDisplay> grid,
         weak_ref<param_manager> pm
     );
 
+    /**
+     * @return the cache of kernelized terrains and paths used by
+     *         grid_path
+     */
+    plan_cache &grid_plan_cache();
+
     std::vector<vector2i> grid_path(
         weak_ref<GridDisplay> grid,
         weak_ref<param_manager> pm
     );
 
+    /**
+     * @return the pool on which grid_alternatives plans candidates
+     */
+    thread_pool &grid_thread_pool();
+
+    /**
+     * Plan up to k alternative paths between the selected endpoints
+     * of the grid, sharing the cached terrain of grid_path.
+     *
+     * @see alternative_paths
+     */
+    std::vector<path_candidate> grid_alternatives(
+        weak_ref<GridDisplay> grid,
+        weak_ref<param_manager> pm,
+        std::size_t k,
+        const alternative_options &options = alternative_options()
+    );
+
     void scale_path_pixels(
         weak_ref<GridDisplay> grid,
         std::vector<vector2i> &path
@@ -0,0 +1,142 @@
+#include "controllaw.h"
+
+#include <algorithm>
+#include <cmath>
+
+typedef std::chrono::duration<double, std::milli> millis;
+
+static double clamp(double v, double bound) {
+    return std::max(-bound, std::min(bound, v));
+}
+
+static double sign(double v) {
+    return (v > 0) - (v < 0);
+}
+
+nrg::bang_bang_law::bang_bang_law(double power) :
+    m_power(power) {}
+
+vector2d nrg::bang_bang_law::update(const vector2d &err, double) {
+    if (std::fabs(err.x()) > std::fabs(err.y())) {
+        return {m_power * sign(err.x()), 0.0};
+    }
+    return {0.0, m_power * sign(err.y())};
+}
+
+void nrg::bang_bang_law::reset() {}
+
+nrg::pid_axis::pid_axis(const pid_gains &gains) :
+    m_gains(gains),
+    m_integral(0),
+    m_prev_err(0),
+    m_has_prev(false) {}
+
+double nrg::pid_axis::update(double err, double dt) {
+    double p = m_gains.kp * err;
+    double d = 0;
+    if (m_has_prev && dt > 0) {
+        d = m_gains.kd * (err - m_prev_err) / dt;
+    }
+    m_prev_err = err;
+    m_has_prev = true;
+
+    double integral = clamp(m_integral + err * dt, m_gains.i_max);
+    double out = p + m_gains.ki * integral + d;
+    // Keep the integral from growing while the output is saturated
+    // in the direction the error pushes it
+    bool winding = (out > m_gains.out_max && err > 0) || (out < -m_gains.out_max && err < 0);
+    if (winding) {
+        out = p + m_gains.ki * m_integral + d;
+    } else {
+        m_integral = integral;
+    }
+    return clamp(out, m_gains.out_max);
+}
+
+void nrg::pid_axis::reset() {
+    m_integral = 0;
+    m_prev_err = 0;
+    m_has_prev = false;
+}
+
+double nrg::pid_axis::integral() const {
+    return m_integral;
+}
+
+nrg::pid_law::pid_law(const pid_gains &gains) :
+    m_x(gains),
+    m_y(gains) {}
+
+vector2d nrg::pid_law::update(const vector2d &err, double dt) {
+    return {m_x.update(err.x(), dt), m_y.update(err.y(), dt)};
+}
+
+void nrg::pid_law::reset() {
+    m_x.reset();
+    m_y.reset();
+}
+
+std::unique_ptr<nrg::control_law> nrg::make_control_law(int law, const pid_gains &gains) {
+    switch (law) {
+        case control_law::PID:
+            return std::unique_ptr<control_law>(new pid_law(gains));
+        default:
+            return std::unique_ptr<control_law>(new bang_bang_law(gains.out_max));
+    }
+}
+
+nrg::convergence_stats::convergence_stats() :
+    m_timing(false),
+    m_current_overshoot(0),
+    m_waypoints(0),
+    m_ticks(0),
+    m_total_time(0),
+    m_max_time(0),
+    m_total_overshoot(0),
+    m_max_overshoot(0) {}
+
+void nrg::convergence_stats::begin(clock::time_point t) {
+    m_start = t;
+    m_timing = true;
+    m_current_overshoot = 0;
+}
+
+void nrg::convergence_stats::sample(double overshoot) {
+    ++m_ticks;
+    m_current_overshoot = std::max(m_current_overshoot, overshoot);
+}
+
+void nrg::convergence_stats::converge(clock::time_point t) {
+    if (!m_timing) { return; }
+    m_timing = false;
+    clock::duration time = t - m_start;
+    ++m_waypoints;
+    m_total_time += time;
+    m_max_time = std::max(m_max_time, time);
+    m_total_overshoot += m_current_overshoot;
+    m_max_overshoot = std::max(m_max_overshoot, m_current_overshoot);
+}
+
+std::size_t nrg::convergence_stats::waypoints() const {
+    return m_waypoints;
+}
+
+std::size_t nrg::convergence_stats::ticks() const {
+    return m_ticks;
+}
+
+double nrg::convergence_stats::mean_time_ms() const {
+    return m_waypoints ? millis(m_total_time).count() / m_waypoints : 0;
+}
+
+double nrg::convergence_stats::max_time_ms() const {
+    return millis(m_max_time).count();
+}
+
+double nrg::convergence_stats::mean_overshoot() const {
+    return m_waypoints ? m_total_overshoot / m_waypoints : 0;
+}
+
+double nrg::convergence_stats::max_overshoot() const {
+    return m_max_overshoot;
+}
@@ -0,0 +1,174 @@
+#ifndef MINOTAUR_CPP_CONTROLLAW_H
+#define MINOTAUR_CPP_CONTROLLAW_H
+
+#include "../utility/vector.h"
+
+#include <chrono>
+#include <cstddef>
+#include <memory>
+
+namespace nrg {
+
+    /**
+     * Turns the position error of the robot into the movement sent to
+     * the controller on each control tick. Procedures hold one and may
+     * be given another.
+     */
+    class control_law {
+    public:
+        enum type {
+            // Move along the axis of larger error only
+            BANG_BANG,
+            // PID on both axes
+            PID
+        };
+
+        virtual ~control_law() = default;
+
+        /**
+         * @param err error from the robot to its target, in pixels
+         * @param dt  seconds since the previous update, or zero on the
+         *            first update after a reset
+         * @return the movement along each axis, in solenoid power, where
+         *         Controller::MAX_POWER is full power
+         */
+        virtual vector2d update(const vector2d &err, double dt) = 0;
+
+        /**
+         * Forget the history of the errors, when the target changes.
+         */
+        virtual void reset() = 0;
+    };
+
+    /**
+     * The original law of Procedure: move along the axis of larger
+     * error, always with the same power.
+     */
+    class bang_bang_law : public control_law {
+    public:
+        /**
+         * @param power the power of each move
+         */
+        explicit bang_bang_law(double power);
+
+        vector2d update(const vector2d &err, double dt) override;
+
+        void reset() override;
+
+    private:
+        double m_power;
+    };
+
+    struct pid_gains {
+        double kp;
+        double ki;
+        double kd;
+        // Saturation of the output, in solenoid power, and the power
+        // of each move of the bang-bang law
+        double out_max;
+        // Bound on the magnitude of the error integral
+        double i_max;
+    };
+
+    /**
+     * PID controller of one axis. The output is saturated, and the
+     * integral is bounded and stops accumulating while the output is
+     * saturated in the direction of the error (anti-windup).
+     */
+    class pid_axis {
+    public:
+        explicit pid_axis(const pid_gains &gains);
+
+        /**
+         * @param err error along the axis
+         * @param dt  seconds since the previous update
+         * @return the saturated output
+         */
+        double update(double err, double dt);
+
+        void reset();
+
+        double integral() const;
+
+    private:
+        pid_gains m_gains;
+        double m_integral;
+        double m_prev_err;
+        bool m_has_prev;
+    };
+
+    /**
+     * PID on both axes at once, with the same gains.
+     */
+    class pid_law : public control_law {
+    public:
+        explicit pid_law(const pid_gains &gains);
+
+        vector2d update(const vector2d &err, double dt) override;
+
+        void reset() override;
+
+    private:
+        pid_axis m_x;
+        pid_axis m_y;
+    };
+
+    /**
+     * @param law   one of control_law::type
+     * @param gains gains used by the PID law, whose saturation is also
+     *              the power of the bang-bang law
+     * @return the control law, or the bang-bang law if unknown
+     */
+    std::unique_ptr<control_law> make_control_law(int law, const pid_gains &gains);
+
+    /**
+     * Time to reach each waypoint of a traversal, and how far the
+     * robot overshot it on the way.
+     */
+    class convergence_stats {
+    public:
+        typedef std::chrono::steady_clock clock;
+
+        convergence_stats();
+
+        /**
+         * Start timing the approach to a waypoint.
+         */
+        void begin(clock::time_point t = clock::now());
+
+        /**
+         * Record the distance past the waypoint, along the direction
+         * of approach, on a tick.
+         */
+        void sample(double overshoot);
+
+        /**
+         * Stop timing the waypoint, which has been reached.
+         */
+        void converge(clock::time_point t = clock::now());
+
+        std::size_t waypoints() const;
+        std::size_t ticks() const;
+
+        double mean_time_ms() const;
+        double max_time_ms() const;
+
+        double mean_overshoot() const;
+        double max_overshoot() const;
+
+    private:
+        clock::time_point m_start;
+        bool m_timing;
+        double m_current_overshoot;
+
+        std::size_t m_waypoints;
+        std::size_t m_ticks;
+        clock::duration m_total_time;
+        clock::duration m_max_time;
+        double m_total_overshoot;
+        double m_max_overshoot;
+    };
+
+}
+
+#endif //MINOTAUR_CPP_CONTROLLAW_H
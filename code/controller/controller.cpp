@@ -75,12 +75,12 @@ bool Controller::isKeyDown(int key) {
     return it->second;
 }
 
-void Controller::move(Dir dir, int timer) {
-    move(Controller::to_vector2i(dir), timer);
+void Controller::move(Dir dir, int timer, int power) {
+    move(Controller::to_vector2i(dir), timer, power);
 }
 
-void Controller::move(vector2i dir, int step_time) {
-    __move_delegate({dir.x() * (m_invert_x ? -1 : 1), dir.y() * (m_invert_y ? -1 : 1)}, step_time);
+void Controller::move(vector2i dir, int step_time, int power) {
+    __move_delegate({dir.x() * (m_invert_x ? -1 : 1), dir.y() * (m_invert_y ? -1 : 1)}, step_time, power);
 }
 
 void Controller::invert_x_axis() {
@@ -28,17 +28,20 @@ public:
 
     enum {
         STEP_TIME = 10,
-        NUM_KEYS = 50
+        NUM_KEYS = 50,
+        // Power of a move at the full power of the robot
+        MAX_POWER = 255
     };
 
     // Common robot functions
     virtual vector2i to_vector2i(Dir dir);
 
-    // Movement
-    void move(Dir dir, int timer = STEP_TIME);
-    void move(vector2i dir, int timer = STEP_TIME);
+    // Movement, where the vector is the direction of the move and power
+    // is its power up to MAX_POWER; moves from scripts are at full power
+    void move(Dir dir, int timer = STEP_TIME, int power = MAX_POWER);
+    void move(vector2i dir, int timer = STEP_TIME, int power = MAX_POWER);
 
-    virtual void __move_delegate(vector2i dir, int timer) = 0;
+    virtual void __move_delegate(vector2i dir, int timer, int power) = 0;
 
     // Key press functions
     void keyPressed(int key);
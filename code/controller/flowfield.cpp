@@ -0,0 +1,178 @@
+#include "flowfield.h"
+#include "astar.h"
+#include "penaltyfield.h"
+
+#include <functional>
+#include <queue>
+
+nrg::flow_field::flow_field() :
+    m_generation(0),
+    m_pending_x(0),
+    m_pending_y(0),
+    m_pending(false),
+    m_building(false),
+    m_stop(false) {}
+
+nrg::flow_field::~flow_field() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_cv.notify_all();
+    if (m_worker.joinable()) {
+        m_worker.join();
+    }
+}
+
+std::vector<int> nrg::flow_field::flatten(array2d<int> &terrain) {
+    std::size_t ny = terrain.y();
+    std::vector<int> flat(terrain.x() * ny);
+    for (std::size_t x = 0; x < terrain.x(); ++x) {
+        std::copy(terrain[x].get(), terrain[x].get() + ny, flat.begin() + x * ny);
+    }
+    return flat;
+}
+
+std::shared_ptr<nrg::flow_field::field> nrg::flow_field::build(
+    std::vector<int> &terrain,
+    int x, int y,
+    const vector2i &dest
+) {
+    auto f = std::make_shared<field>();
+    f->x = x;
+    f->y = y;
+    f->dest = dest;
+    f->cost.assign(terrain.size(), -1);
+    f->next.assign(terrain.size(), -1);
+    if (dest.x() < 0 || dest.y() < 0 || dest.x() >= x || dest.y() >= y) { return f; }
+    int d = dest.x() * y + dest.y();
+    if (terrain[d] == TERRAIN_WALL) { return f; }
+
+    // Reverse search: moving from u into v costs 1 + terrain[v],
+    // so relaxing u from an expanded v adds the cost of entering v
+    search_stats &stats = last_search_stats();
+    stats = {0, 1};
+    typedef std::pair<int, int> queue_entry;
+    std::priority_queue<
+        queue_entry,
+        std::vector<queue_entry>,
+        std::greater<queue_entry>
+    > open;
+    std::vector<int> best(terrain.size(), -1);
+    best[d] = 0;
+    open.emplace(0, d);
+    while (!open.empty()) {
+        queue_entry e = open.top();
+        open.pop();
+        int v = e.second;
+        if (f->cost[v] >= 0) { continue; }
+        f->cost[v] = e.first;
+        ++stats.expansions;
+        int enter = 1 + terrain[v];
+        int vx = v / y;
+        int vy = v % y;
+        int xs[] = {vx - 1, vx + 1, vx, vx};
+        int ys[] = {vy, vy, vy - 1, vy + 1};
+        for (int i = 0; i < 4; ++i) {
+            if (xs[i] < 0 || ys[i] < 0 || xs[i] >= x || ys[i] >= y) { continue; }
+            int u = xs[i] * y + ys[i];
+            if (terrain[u] == TERRAIN_WALL || f->cost[u] >= 0) { continue; }
+            int c = e.first + enter;
+            if (best[u] >= 0 && best[u] <= c) { continue; }
+            best[u] = c;
+            f->next[u] = v;
+            open.emplace(c, u);
+            ++stats.pushes;
+        }
+    }
+    return f;
+}
+
+std::shared_ptr<const nrg::flow_field::field> nrg::flow_field::current() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_field;
+}
+
+void nrg::flow_field::publish(std::shared_ptr<field> built) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_field = std::move(built);
+    ++m_generation;
+}
+
+void nrg::flow_field::compute(array2d<int> &terrain, const vector2i &dest) {
+    std::vector<int> flat = flatten(terrain);
+    publish(build(flat, static_cast<int>(terrain.x()), static_cast<int>(terrain.y()), dest));
+}
+
+void nrg::flow_field::rebuild(array2d<int> &terrain, const vector2i &dest) {
+    // Copy on the caller's thread so the terrain may change after
+    std::vector<int> flat = flatten(terrain);
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_pending_terrain.swap(flat);
+        m_pending_x = static_cast<int>(terrain.x());
+        m_pending_y = static_cast<int>(terrain.y());
+        m_pending_dest = dest;
+        m_pending = true;
+        if (!m_worker.joinable()) {
+            m_worker = std::thread(&flow_field::run, this);
+        }
+    }
+    m_cv.notify_all();
+}
+
+void nrg::flow_field::run() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    for (;;) {
+        m_cv.wait(lock, [this] { return m_stop || m_pending; });
+        if (m_stop) { return; }
+        std::vector<int> terrain;
+        terrain.swap(m_pending_terrain);
+        int x = m_pending_x;
+        int y = m_pending_y;
+        vector2i dest = m_pending_dest;
+        m_pending = false;
+        m_building = true;
+        lock.unlock();
+        std::shared_ptr<field> built = build(terrain, x, y, dest);
+        lock.lock();
+        m_field = std::move(built);
+        ++m_generation;
+        m_building = false;
+        m_cv.notify_all();
+    }
+}
+
+void nrg::flow_field::wait() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_cv.wait(lock, [this] { return m_stop || (!m_pending && !m_building); });
+}
+
+bool nrg::flow_field::next_step(const vector2i &from, vector2i &next) const {
+    std::shared_ptr<const field> f = current();
+    if (!f || from.x() < 0 || from.y() < 0 || from.x() >= f->x || from.y() >= f->y) {
+        return false;
+    }
+    int n = f->next[from.x() * f->y + from.y()];
+    if (n < 0) { return false; }
+    next = vector2i(n / f->y, n % f->y);
+    return true;
+}
+
+int nrg::flow_field::cost_to_go(const vector2i &from) const {
+    std::shared_ptr<const field> f = current();
+    if (!f || from.x() < 0 || from.y() < 0 || from.x() >= f->x || from.y() >= f->y) {
+        return -1;
+    }
+    return f->cost[from.x() * f->y + from.y()];
+}
+
+vector2i nrg::flow_field::dest() const {
+    std::shared_ptr<const field> f = current();
+    return f ? f->dest : vector2i(-1, -1);
+}
+
+unsigned long nrg::flow_field::generation() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_generation;
+}
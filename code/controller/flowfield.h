@@ -0,0 +1,128 @@
+#ifndef MINOTAUR_CPP_FLOWFIELD_H
+#define MINOTAUR_CPP_FLOWFIELD_H
+
+#include "../utility/array2d.h"
+#include "../utility/vector.h"
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace nrg {
+
+    /**
+     * Goal-centred flow field over a terrain grid. A single reverse
+     * Dijkstra from the destination stores the cost-to-go and the best
+     * next cell for every cell, so the next move from any position is a
+     * constant time lookup and a robot pushed off course never needs a
+     * new plan.
+     *
+     * Entering a cell costs one plus its terrain value, matching the
+     * other grid planners, and walls have the value TERRAIN_WALL.
+     *
+     * Fields can be rebuilt on a background thread. Queries keep
+     * answering from the previous field until the new one is swapped in.
+     * Procedures still follow waypoint lists, so nothing builds or
+     * queries a field yet. A caller that follows one owns it, and
+     * rebuilds it when its terrain or destination changes.
+     */
+    class flow_field {
+    public:
+        flow_field();
+        ~flow_field();
+
+        /**
+         * Build the field on the calling thread.
+         *
+         * @param terrain kernelized terrain
+         * @param dest    destination cell
+         */
+        void compute(array2d<int> &terrain, const vector2i &dest);
+
+        /**
+         * Copy the terrain and build the field on the background
+         * thread. If a rebuild is already pending it is replaced.
+         *
+         * @param terrain kernelized terrain
+         * @param dest    destination cell
+         */
+        void rebuild(array2d<int> &terrain, const vector2i &dest);
+
+        /**
+         * Block until no rebuild is pending or running.
+         */
+        void wait();
+
+        /**
+         * Find the best next cell from a position.
+         *
+         * @param from current cell
+         * @param next written with the next cell to move to
+         * @return true if the destination is reachable and not
+         *         already reached
+         */
+        bool next_step(const vector2i &from, vector2i &next) const;
+
+        /**
+         * @return the cost to reach the destination from a cell,
+         *         or -1 if it is unreachable
+         */
+        int cost_to_go(const vector2i &from) const;
+
+        /**
+         * @return the destination of the current field, or (-1, -1)
+         *         if none has been built
+         */
+        vector2i dest() const;
+
+        /**
+         * @return number of fields built so far
+         */
+        unsigned long generation() const;
+
+    private:
+        struct field {
+            int x;
+            int y;
+            vector2i dest;
+            std::vector<int> cost;
+            /**
+             * Id of the next cell for each cell, or -1.
+             */
+            std::vector<int> next;
+        };
+
+        static std::shared_ptr<field> build(
+            std::vector<int> &terrain,
+            int x, int y,
+            const vector2i &dest
+        );
+
+        static std::vector<int> flatten(array2d<int> &terrain);
+
+        std::shared_ptr<const field> current() const;
+        void publish(std::shared_ptr<field> built);
+        void run();
+
+        mutable std::mutex m_mutex;
+        std::condition_variable m_cv;
+        std::shared_ptr<const field> m_field;
+        unsigned long m_generation;
+
+        // Latest rebuild request waiting for the worker
+        std::vector<int> m_pending_terrain;
+        int m_pending_x;
+        int m_pending_y;
+        vector2i m_pending_dest;
+        bool m_pending;
+        bool m_building;
+        bool m_stop;
+
+        std::thread m_worker;
+    };
+
+}
+
+#endif //MINOTAUR_CPP_FLOWFIELD_H
@@ -0,0 +1,395 @@
+#include "hpastar.h"
+#include "astar.h"
+#include "penaltyfield.h"
+
+#include <algorithm>
+#include <limits>
+
+#ifndef NDEBUG
+#include <cassert>
+#endif
+
+enum {
+    COST_INF = std::numeric_limits<int>::max() / 2,
+    // Entrances are split into segments of at least this width
+    ENTRANCE_SPLIT = 6,
+    // Virtual abstract node ids for the query endpoints
+    NODE_START = -1,
+    NODE_DEST = -2
+};
+
+typedef std::pair<int, int> queue_entry;
+
+static void heap_push(std::vector<queue_entry> &heap, int key, int value) {
+    ++nrg::last_search_stats().pushes;
+    heap.emplace_back(key, value);
+    std::push_heap(heap.begin(), heap.end(), std::greater<queue_entry>());
+}
+
+static queue_entry heap_pop(std::vector<queue_entry> &heap) {
+    ++nrg::last_search_stats().expansions;
+    std::pop_heap(heap.begin(), heap.end(), std::greater<queue_entry>());
+    queue_entry e = heap.back();
+    heap.pop_back();
+    return e;
+}
+
+nrg::hpa_planner::hpa_planner(int cluster_size) :
+    m_size(std::max(cluster_size, 2)),
+    m_x(0),
+    m_y(0),
+    m_cx(0),
+    m_cy(0),
+    m_query(0) {}
+
+int nrg::hpa_planner::cell_id(int x, int y) const {
+    return x * m_y + y;
+}
+
+int nrg::hpa_planner::cluster_of(int id) const {
+    int x = id / m_y;
+    int y = id % m_y;
+    return x / m_size + (y / m_size) * m_cx;
+}
+
+int nrg::hpa_planner::terrain_of(int id) const {
+    return m_terrain[id];
+}
+
+int nrg::hpa_planner::local_index(const cluster &k, int id) const {
+    int x = id / m_y;
+    int y = id % m_y;
+    return (x - k.x0) * (k.y1 - k.y0) + (y - k.y0);
+}
+
+void nrg::hpa_planner::set_terrain(array2d<int> &terrain) {
+    m_x = static_cast<int>(terrain.x());
+    m_y = static_cast<int>(terrain.y());
+    m_cx = (m_x + m_size - 1) / m_size;
+    m_cy = (m_y + m_size - 1) / m_size;
+    m_terrain.resize(static_cast<std::size_t>(m_x * m_y));
+    for (int x = 0; x < m_x; ++x) {
+        std::copy(terrain[x].get(), terrain[x].get() + m_y, m_terrain.begin() + x * m_y);
+    }
+    auto num = static_cast<std::size_t>(m_cx * m_cy);
+    m_clusters.assign(num, cluster());
+    for (int cy = 0; cy < m_cy; ++cy) {
+        for (int cx = 0; cx < m_cx; ++cx) {
+            cluster &k = m_clusters[cx + cy * m_cx];
+            k.x0 = cx * m_size;
+            k.y0 = cy * m_size;
+            k.x1 = std::min(k.x0 + m_size, m_x);
+            k.y1 = std::min(k.y0 + m_size, m_y);
+            k.dirty = true;
+        }
+    }
+    m_node_index.assign(m_terrain.size(), -1);
+    m_g.assign(m_terrain.size(), 0);
+    m_parent.assign(m_terrain.size(), 0);
+    m_stamp.assign(m_terrain.size(), 0);
+    m_query = 0;
+    m_east.assign(num, {});
+    m_south.assign(num, {});
+    m_east_dirty.assign(num, true);
+    m_south_dirty.assign(num, true);
+    refresh();
+}
+
+void nrg::hpa_planner::set_cell(int x, int y, int value) {
+#ifndef NDEBUG
+    assert(x >= 0 && x < m_x);
+    assert(y >= 0 && y < m_y);
+#endif
+    int id = cell_id(x, y);
+    if (m_terrain[id] == value) { return; }
+    m_terrain[id] = value;
+    m_clusters[cluster_of(id)].dirty = true;
+}
+
+void nrg::hpa_planner::build_borders(int c, bool east) {
+    const cluster &k = m_clusters[c];
+    std::vector<transition> &border = east ? m_east[c] : m_south[c];
+    border.clear();
+    int cx = c % m_cx;
+    int cy = c / m_cx;
+    if ((east && cx + 1 >= m_cx) || (!east && cy + 1 >= m_cy)) { return; }
+    // Walk along the border and place transitions on
+    // each maximal run of cells open on both sides
+    int lo = east ? k.y0 : k.x0;
+    int hi = east ? k.y1 : k.x1;
+    int run = lo;
+    for (int i = lo; i <= hi; ++i) {
+        bool open = false;
+        if (i < hi) {
+            int a = east ? cell_id(k.x1 - 1, i) : cell_id(i, k.y1 - 1);
+            int b = east ? cell_id(k.x1, i) : cell_id(i, k.y1);
+            open = m_terrain[a] != TERRAIN_WALL && m_terrain[b] != TERRAIN_WALL;
+        }
+        if (open) { continue; }
+        // Long runs are split into segments, and each segment gets
+        // a transition on its cheapest cell since the ends of a run
+        // lie next to walls and carry the highest penalties
+        int len = i - run;
+        int segments = std::max(1, len / ENTRANCE_SPLIT);
+        for (int seg = 0; len > 0 && seg < segments; ++seg) {
+            int lo_j = run + len * seg / segments;
+            int hi_j = run + len * (seg + 1) / segments;
+            int mid = (lo_j + hi_j - 1) / 2;
+            int best = -1;
+            int best_cost = COST_INF;
+            for (int j = lo_j; j < hi_j; ++j) {
+                int a = east ? cell_id(k.x1 - 1, j) : cell_id(j, k.y1 - 1);
+                int b = east ? cell_id(k.x1, j) : cell_id(j, k.y1);
+                int cost = m_terrain[a] + m_terrain[b];
+                if (cost < best_cost || (cost == best_cost && abs(j - mid) < abs(best - mid))) {
+                    best = j;
+                    best_cost = cost;
+                }
+            }
+            border.emplace_back(
+                east ? cell_id(k.x1 - 1, best) : cell_id(best, k.y1 - 1),
+                east ? cell_id(k.x1, best) : cell_id(best, k.y1)
+            );
+        }
+        run = i + 1;
+    }
+}
+
+void nrg::hpa_planner::refresh() {
+    // Dirty clusters invalidate their four borders, and every
+    // cluster on an invalidated border must be rebuilt
+    std::vector<bool> rebuild(m_clusters.size(), false);
+    for (int c = 0; c < static_cast<int>(m_clusters.size()); ++c) {
+        if (!m_clusters[c].dirty) { continue; }
+        rebuild[c] = true;
+        m_east_dirty[c] = true;
+        m_south_dirty[c] = true;
+        if (c % m_cx > 0) { m_east_dirty[c - 1] = true; }
+        if (c / m_cx > 0) { m_south_dirty[c - m_cx] = true; }
+    }
+    for (int c = 0; c < static_cast<int>(m_clusters.size()); ++c) {
+        if (m_east_dirty[c]) {
+            build_borders(c, true);
+            rebuild[c] = true;
+            if (c % m_cx + 1 < m_cx) { rebuild[c + 1] = true; }
+            m_east_dirty[c] = false;
+        }
+        if (m_south_dirty[c]) {
+            build_borders(c, false);
+            rebuild[c] = true;
+            if (c / m_cx + 1 < m_cy) { rebuild[c + m_cx] = true; }
+            m_south_dirty[c] = false;
+        }
+    }
+    for (int c = 0; c < static_cast<int>(m_clusters.size()); ++c) {
+        if (rebuild[c]) { rebuild_cluster(c); }
+    }
+}
+
+void nrg::hpa_planner::rebuild_cluster(int c) {
+    cluster &k = m_clusters[c];
+    for (int node : k.nodes) { m_node_index[node] = -1; }
+    k.nodes.clear();
+    k.inter.clear();
+    auto add_transition = [this, &k](int node, int partner) {
+        int i = m_node_index[node];
+        if (i < 0) {
+            i = static_cast<int>(k.nodes.size());
+            m_node_index[node] = i;
+            k.nodes.push_back(node);
+            k.inter.emplace_back();
+        }
+        k.inter[i].push_back(partner);
+    };
+    for (const transition &t : m_east[c]) { add_transition(t.first, t.second); }
+    for (const transition &t : m_south[c]) { add_transition(t.first, t.second); }
+    if (c % m_cx > 0) {
+        for (const transition &t : m_east[c - 1]) { add_transition(t.second, t.first); }
+    }
+    if (c / m_cx > 0) {
+        for (const transition &t : m_south[c - m_cx]) { add_transition(t.second, t.first); }
+    }
+    // Intra-cluster costs from one bounded search per entrance
+    std::size_t n = k.nodes.size();
+    k.costs.assign(n * n, COST_INF);
+    for (std::size_t i = 0; i < n; ++i) {
+        local_search(k, k.nodes[i], -1, false);
+        for (std::size_t j = 0; j < n; ++j) {
+            k.costs[i * n + j] = m_local_dist[local_index(k, k.nodes[j])];
+        }
+    }
+    k.dirty = false;
+}
+
+void nrg::hpa_planner::local_search(const cluster &k, int source, int target, bool reverse) {
+    int w = k.x1 - k.x0;
+    int h = k.y1 - k.y0;
+    m_local_dist.assign(static_cast<std::size_t>(w * h), COST_INF);
+    m_local_parent.assign(static_cast<std::size_t>(w * h), -1);
+    if (m_terrain[source] == TERRAIN_WALL) { return; }
+    int local_target = target < 0 ? -1 : local_index(k, target);
+    int s = local_index(k, source);
+    m_local_dist[s] = 0;
+    m_heap.clear();
+    heap_push(m_heap, 0, s);
+    while (!m_heap.empty()) {
+        queue_entry e = heap_pop(m_heap);
+        int u = e.second;
+        if (e.first != m_local_dist[u]) { continue; }
+        if (u == local_target) { return; }
+        int ux = u / h;
+        int uy = u % h;
+        // In reverse the cost is of entering the popped cell, so
+        // the distances are to the source rather than from it
+        int enter_u = reverse ? 1 + m_terrain[cell_id(k.x0 + ux, k.y0 + uy)] : 0;
+        int xs[] = {ux - 1, ux + 1, ux, ux};
+        int ys[] = {uy, uy, uy - 1, uy + 1};
+        for (int i = 0; i < 4; ++i) {
+            if (xs[i] < 0 || ys[i] < 0 || xs[i] >= w || ys[i] >= h) { continue; }
+            int t = m_terrain[cell_id(k.x0 + xs[i], k.y0 + ys[i])];
+            if (t == TERRAIN_WALL) { continue; }
+            int v = xs[i] * h + ys[i];
+            int d = e.first + (reverse ? enter_u : 1 + t);
+            if (d < m_local_dist[v]) {
+                m_local_dist[v] = d;
+                m_local_parent[v] = u;
+                heap_push(m_heap, d, v);
+            }
+        }
+    }
+}
+
+void nrg::hpa_planner::local_path(
+    const cluster &k,
+    int from,
+    int to,
+    std::vector<vector2i> &path
+) {
+    local_search(k, from, to, false);
+    int h = k.y1 - k.y0;
+    std::vector<vector2i> segment;
+    int u = local_index(k, to);
+    int s = local_index(k, from);
+#ifndef NDEBUG
+    assert(m_local_dist[u] < COST_INF);
+#endif
+    while (u != s && u >= 0) {
+        segment.emplace_back(k.x0 + u / h, k.y0 + u % h);
+        u = m_local_parent[u];
+    }
+    path.insert(path.end(), segment.rbegin(), segment.rend());
+}
+
+bool nrg::hpa_planner::abstract_search(int start, int dest, std::vector<int> &nodes) {
+    int sc = cluster_of(start);
+    int dc = cluster_of(dest);
+    local_search(m_clusters[sc], start, -1, false);
+    m_start_dist.swap(m_local_dist);
+    local_search(m_clusters[dc], dest, -1, true);
+    m_dest_dist.swap(m_local_dist);
+
+    int dx = dest / m_y;
+    int dy = dest % m_y;
+    auto heuristic = [this, dx, dy](int id) -> int {
+        return abs(id / m_y - dx) + abs(id % m_y - dy);
+    };
+    if (++m_query == 0) {
+        std::fill(m_stamp.begin(), m_stamp.end(), 0);
+        m_query = 1;
+    }
+    m_heap.clear();
+    auto relax = [&](int from, int to, int cost, int base) {
+        if (cost >= COST_INF) { return; }
+        int d = base + cost;
+        if (m_stamp[to] == m_query && m_g[to] <= d) { return; }
+        m_stamp[to] = m_query;
+        m_g[to] = d;
+        m_parent[to] = from;
+        heap_push(m_heap, d + heuristic(to), to);
+    };
+
+    // Edges out of the start only exist to the entrances of
+    // its cluster, and edges into the destination only from
+    // the entrances of the destination cluster
+    const cluster &ks = m_clusters[sc];
+    for (int node : ks.nodes) {
+        relax(NODE_START, node, m_start_dist[local_index(ks, node)], 0);
+    }
+    int dest_direct = sc == dc ? m_start_dist[local_index(ks, dest)] : COST_INF;
+    int best = dest_direct;
+    int best_from = dest_direct < COST_INF ? NODE_START : NODE_DEST;
+    while (!m_heap.empty()) {
+        queue_entry e = heap_pop(m_heap);
+        int u = e.second;
+        if (e.first >= best) { break; }
+        if (e.first != m_g[u] + heuristic(u)) { continue; }
+        int g = m_g[u];
+        int c = cluster_of(u);
+        const cluster &k = m_clusters[c];
+        std::size_t n = k.nodes.size();
+        auto i = static_cast<std::size_t>(m_node_index[u]);
+        for (std::size_t j = 0; j < n; ++j) {
+            if (j != i) { relax(u, k.nodes[j], k.costs[i * n + j], g); }
+        }
+        for (int partner : k.inter[i]) {
+            relax(u, partner, 1 + terrain_of(partner), g);
+        }
+        if (c == dc) {
+            int d = m_dest_dist[local_index(k, u)];
+            if (d < COST_INF && g + d < best) {
+                best = g + d;
+                best_from = u;
+            }
+        }
+    }
+    if (best >= COST_INF) { return false; }
+    nodes.clear();
+    nodes.push_back(NODE_DEST);
+    for (int v = best_from; v != NODE_START; v = m_parent[v]) { nodes.push_back(v); }
+    nodes.push_back(NODE_START);
+    std::reverse(nodes.begin(), nodes.end());
+    return true;
+}
+
+bool nrg::hpa_planner::search(
+    const vector2i &start,
+    const vector2i &dest,
+    std::vector<vector2i> &path
+) {
+    auto outside = [this](const vector2i &v) {
+        return v.x() < 0 || v.y() < 0 || v.x() >= m_x || v.y() >= m_y;
+    };
+    if (outside(start) || outside(dest)) { return false; }
+    int s = cell_id(start.x(), start.y());
+    int d = cell_id(dest.x(), dest.y());
+    if (m_terrain[s] == TERRAIN_WALL || m_terrain[d] == TERRAIN_WALL) { return false; }
+    // Counters include clusters rebuilt lazily by this query
+    last_search_stats() = {0, 0};
+    refresh();
+    std::vector<int> nodes;
+    if (s == d) {
+        path.push_back(start);
+        return true;
+    }
+    if (!abstract_search(s, d, nodes)) { return false; }
+    // Refine each abstract edge into cells
+    path.push_back(start);
+    for (std::size_t i = 1; i < nodes.size(); ++i) {
+        int a = nodes[i - 1] == NODE_START ? s : nodes[i - 1];
+        int b = nodes[i] == NODE_DEST ? d : nodes[i];
+        int c = cluster_of(a);
+        if (c == cluster_of(b)) {
+            local_path(m_clusters[c], a, b, path);
+        } else {
+            path.emplace_back(b / m_y, b % m_y);
+        }
+    }
+    return true;
+}
+
+std::size_t nrg::hpa_planner::abstract_nodes() {
+    refresh();
+    std::size_t n = 0;
+    for (const cluster &k : m_clusters) { n += k.nodes.size(); }
+    return n;
+}
@@ -0,0 +1,148 @@
+#ifndef MINOTAUR_CPP_HPASTAR_H
+#define MINOTAUR_CPP_HPASTAR_H
+
+#include "../utility/array2d.h"
+#include "../utility/vector.h"
+
+#include <vector>
+
+namespace nrg {
+
+    /**
+     * Hierarchical path planner (HPA*) for large terrain grids, such as
+     * pixel-level occupancy from vision.
+     *
+     * The terrain is split into square clusters. Entrances between
+     * adjacent clusters and the costs between the entrances of each
+     * cluster are precomputed, so that a query only searches the small
+     * abstract graph and then refines each abstract edge with a search
+     * bounded to a single cluster.
+     *
+     * Changing terrain cells only marks their clusters as dirty, and
+     * the clusters are rebuilt lazily on the next query.
+     *
+     * Moving into a cell costs one plus its terrain value, and walls
+     * have the value TERRAIN_WALL. Paths are near-optimal.
+     */
+    class hpa_planner {
+    public:
+        enum {
+            DEFAULT_CLUSTER_SIZE = 16
+        };
+
+        explicit hpa_planner(int cluster_size = DEFAULT_CLUSTER_SIZE);
+
+        /**
+         * Copy a new terrain grid and rebuild every cluster.
+         *
+         * @param terrain kernelized terrain
+         */
+        void set_terrain(array2d<int> &terrain);
+
+        /**
+         * Change the value of a single terrain cell. The affected
+         * clusters are rebuilt on the next search.
+         *
+         * @param x     column of the cell
+         * @param y     row of the cell
+         * @param value the new terrain value
+         */
+        void set_cell(int x, int y, int value);
+
+        /**
+         * Find a path between two cells. The path includes the
+         * start and destination cells.
+         *
+         * @param start starting cell
+         * @param dest  destination cell
+         * @param path  vector to which the path is written
+         * @return true if a path was found
+         */
+        bool search(const vector2i &start, const vector2i &dest, std::vector<vector2i> &path);
+
+        /**
+         * @return number of entrance nodes in the abstract graph
+         */
+        std::size_t abstract_nodes();
+
+    private:
+        struct cluster {
+            int x0;
+            int y0;
+            int x1;
+            int y1;
+            bool dirty;
+            /**
+             * Cell ids of the entrance nodes in this cluster.
+             */
+            std::vector<int> nodes;
+            /**
+             * Row-major matrix of costs between entrance nodes.
+             */
+            std::vector<int> costs;
+            /**
+             * For each entrance node, the cell ids across the
+             * cluster border that it connects to.
+             */
+            std::vector<std::vector<int>> inter;
+        };
+
+        typedef std::pair<int, int> transition;
+
+        int cell_id(int x, int y) const;
+        int cluster_of(int id) const;
+        int terrain_of(int id) const;
+
+        void build_borders(int c, bool east);
+        void refresh();
+        void rebuild_cluster(int c);
+
+        void local_search(const cluster &k, int source, int target, bool reverse);
+        void local_path(const cluster &k, int from, int to, std::vector<vector2i> &path);
+        int local_index(const cluster &k, int id) const;
+
+        bool abstract_search(int start, int dest, std::vector<int> &nodes);
+
+        int m_size;
+        int m_x;
+        int m_y;
+        int m_cx;
+        int m_cy;
+
+        std::vector<int> m_terrain;
+        std::vector<cluster> m_clusters;
+        /**
+         * Transitions across the east and south border of each cluster.
+         */
+        std::vector<std::vector<transition>> m_east;
+        std::vector<std::vector<transition>> m_south;
+        std::vector<bool> m_east_dirty;
+        std::vector<bool> m_south_dirty;
+
+        /**
+         * Index of each cell in its cluster's entrance node
+         * list, or -1 if the cell is not an entrance.
+         */
+        std::vector<int> m_node_index;
+
+        typedef std::pair<int, int> queue_entry;
+        std::vector<queue_entry> m_heap;
+
+        // Scratch state of the cluster-bounded searches
+        std::vector<int> m_local_dist;
+        std::vector<int> m_local_parent;
+        // Costs from the query start and to the query destination
+        std::vector<int> m_start_dist;
+        std::vector<int> m_dest_dist;
+
+        // Scratch state of the abstract search, indexed by cell
+        // and only valid where the stamp matches the query
+        std::vector<int> m_g;
+        std::vector<int> m_parent;
+        std::vector<unsigned int> m_stamp;
+        unsigned int m_query;
+    };
+
+}
+
+#endif //MINOTAUR_CPP_HPASTAR_H
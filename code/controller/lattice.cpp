@@ -0,0 +1,193 @@
+#include "lattice.h"
+#include "astar.h"
+#include "penaltyfield.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <functional>
+
+enum {
+    // Parent marker of the start states
+    PARENT_NONE = nrg::NUM_HEADINGS,
+    WORD_BITS = 64
+};
+
+static const int s_dx[nrg::NUM_HEADINGS] = {0, 0, 1, -1};
+static const int s_dy[nrg::NUM_HEADINGS] = {-1, 1, 0, 0};
+
+static int heading_of(int dx, int dy) {
+    if (dx > 0) { return nrg::HEADING_RIGHT; }
+    if (dx < 0) { return nrg::HEADING_LEFT; }
+    return dy > 0 ? nrg::HEADING_DOWN : nrg::HEADING_UP;
+}
+
+nrg::lattice_planner::lattice_planner(int turn_penalty, planner_context &context) :
+    m_turn_penalty(turn_penalty),
+    m_cost(-1),
+    m_switches(0),
+    m_context(&context),
+    m_g(nullptr),
+    m_parent(nullptr),
+    m_closed(nullptr),
+    m_plane_words(0) {
+    for (int from = 0; from < NUM_HEADINGS; ++from) {
+        for (int to = 0; to < NUM_HEADINGS; ++to) {
+            m_primitives[from][to] = {
+                s_dx[to],
+                s_dy[to],
+                static_cast<heading>(to),
+                from == to ? 0 : turn_penalty
+            };
+        }
+    }
+}
+
+const nrg::motion_primitive *nrg::lattice_planner::primitives(heading from) const {
+    return m_primitives[from];
+}
+
+int nrg::lattice_planner::heuristic(int x, int y, int h, const vector2i &dest) const {
+    int dx = dest.x() - x;
+    int dy = dest.y() - y;
+    // At least one switch is needed unless the destination lies
+    // straight ahead along the current heading
+    bool turn;
+    if (dx != 0 && dy != 0) {
+        turn = true;
+    } else if (dx == 0 && dy == 0) {
+        turn = false;
+    } else {
+        turn = heading_of(dx, dy) != h;
+    }
+    return abs(dx) + abs(dy) + (turn ? m_turn_penalty : 0);
+}
+
+bool nrg::lattice_planner::closed(int state) const {
+    auto cell = static_cast<std::size_t>(state / NUM_HEADINGS);
+    std::uint64_t word = m_closed[(state % NUM_HEADINGS) * m_plane_words + cell / WORD_BITS];
+    return (word >> (cell % WORD_BITS)) & 1u;
+}
+
+void nrg::lattice_planner::close(int state) {
+    auto cell = static_cast<std::size_t>(state / NUM_HEADINGS);
+    m_closed[(state % NUM_HEADINGS) * m_plane_words + cell / WORD_BITS] |=
+        static_cast<std::uint64_t>(1) << (cell % WORD_BITS);
+}
+
+bool nrg::lattice_planner::search(
+    array2d<int> &terrain,
+    const vector2i &start,
+    const vector2i &dest,
+    std::vector<vector2i> &path,
+    int start_heading
+) {
+    m_cost = -1;
+    m_switches = 0;
+    search_stats &stats = last_search_stats();
+    stats = {0, 0};
+    int mx = static_cast<int>(terrain.x());
+    int my = static_cast<int>(terrain.y());
+    auto outside = [mx, my](const vector2i &v) {
+        return v.x() < 0 || v.y() < 0 || v.x() >= mx || v.y() >= my;
+    };
+    if (outside(start) || outside(dest)) { return false; }
+    if (terrain[start.x()][start.y()] == TERRAIN_WALL ||
+        terrain[dest.x()][dest.y()] == TERRAIN_WALL) {
+        return false;
+    }
+
+    arena &memory = m_context->begin_query();
+    auto cells = static_cast<std::size_t>(mx * my);
+    m_plane_words = (cells + WORD_BITS - 1) / WORD_BITS;
+    m_closed = memory.array<std::uint64_t>(m_plane_words * NUM_HEADINGS);
+    std::fill(m_closed, m_closed + m_plane_words * NUM_HEADINGS, 0);
+    m_g = memory.array<int>(cells * NUM_HEADINGS);
+    std::fill(m_g, m_g + cells * NUM_HEADINGS, -1);
+    m_parent = memory.array<std::uint8_t>(cells * NUM_HEADINGS);
+    arena_vector<queue_entry> heap{arena_allocator<queue_entry>(memory)};
+    heap.reserve(cells);
+    auto push = [&heap, &stats](int key, int state) {
+        heap.emplace_back(key, state);
+        std::push_heap(heap.begin(), heap.end(), std::greater<queue_entry>());
+        ++stats.pushes;
+    };
+
+    int start_cell = start.x() * my + start.y();
+    for (int h = 0; h < NUM_HEADINGS; ++h) {
+        if (start_heading != HEADING_ANY && start_heading != h) { continue; }
+        int s = start_cell * NUM_HEADINGS + h;
+        m_g[s] = 0;
+        m_parent[s] = PARENT_NONE;
+        push(heuristic(start.x(), start.y(), h, dest), s);
+    }
+
+    int goal = -1;
+    while (!heap.empty()) {
+        int u = heap.front().second;
+        std::pop_heap(heap.begin(), heap.end(), std::greater<queue_entry>());
+        heap.pop_back();
+        if (closed(u)) { continue; }
+        close(u);
+        ++stats.expansions;
+        int cell = u / NUM_HEADINGS;
+        int ux = cell / my;
+        int uy = cell % my;
+        if (ux == dest.x() && uy == dest.y()) {
+            goal = u;
+            break;
+        }
+        const motion_primitive *prims = m_primitives[u % NUM_HEADINGS];
+        for (int i = 0; i < NUM_HEADINGS; ++i) {
+            const motion_primitive &p = prims[i];
+            int vx = ux + p.dx;
+            int vy = uy + p.dy;
+            if (vx < 0 || vy < 0 || vx >= mx || vy >= my) { continue; }
+            int t = terrain[vx][vy];
+            if (t == TERRAIN_WALL) { continue; }
+            int v = (vx * my + vy) * NUM_HEADINGS + p.to;
+            if (closed(v)) { continue; }
+            int g = m_g[u] + 1 + t + p.extra;
+            if (m_g[v] >= 0 && m_g[v] <= g) { continue; }
+            m_g[v] = g;
+            m_parent[v] = static_cast<std::uint8_t>(u % NUM_HEADINGS);
+            push(g + heuristic(vx, vy, p.to, dest), v);
+        }
+    }
+    if (goal < 0) { return false; }
+
+    // Walk back along the headings each state was entered with
+    m_cost = m_g[goal];
+    std::size_t first = path.size();
+    int state = goal;
+    for (;;) {
+        int cell = state / NUM_HEADINGS;
+        int h = state % NUM_HEADINGS;
+        path.emplace_back(cell / my, cell % my);
+        int parent = m_parent[state];
+        if (parent == PARENT_NONE) { break; }
+        m_switches += parent != h;
+        int px = cell / my - s_dx[h];
+        int py = cell % my - s_dy[h];
+        state = (px * my + py) * NUM_HEADINGS + parent;
+    }
+    std::reverse(path.begin() + first, path.end());
+    return true;
+}
+
+int nrg::lattice_planner::cost() const {
+    return m_cost;
+}
+
+int nrg::lattice_planner::switches() const {
+    return m_switches;
+}
+
+int nrg::count_switches(const std::vector<vector2i> &path) {
+    int switches = 0;
+    for (std::size_t i = 2; i < path.size(); ++i) {
+        vector2i a = path[i - 1] - path[i - 2];
+        vector2i b = path[i] - path[i - 1];
+        switches += a != b;
+    }
+    return switches;
+}
@@ -0,0 +1,132 @@
+#ifndef MINOTAUR_CPP_LATTICE_H
+#define MINOTAUR_CPP_LATTICE_H
+
+#include "plancontext.h"
+
+#include "../utility/array2d.h"
+#include "../utility/vector.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace nrg {
+
+    /**
+     * Directions the robot can be driven in by the solenoids, in the
+     * same order as Controller::Dir.
+     */
+    enum heading {
+        HEADING_ANY = -1,
+        HEADING_UP,    // -Y
+        HEADING_DOWN,  // +Y
+        HEADING_RIGHT, // +X
+        HEADING_LEFT,  // -X
+        NUM_HEADINGS
+    };
+
+    /**
+     * A single move on the lattice: one cell in a new heading.
+     */
+    struct motion_primitive {
+        int dx;
+        int dy;
+        heading to;
+        // Cost added on top of entering the cell
+        int extra;
+    };
+
+    /**
+     * Path search over (x, y, heading) states. A move costs one plus
+     * the terrain value of the cell entered, and changing heading, which
+     * switches the driving solenoid, adds the turn penalty. Because the
+     * heading is part of the state the costs are consistent and the
+     * returned path is optimal, so with a large enough penalty it has
+     * the fewest direction switches possible.
+     *
+     * The closed set is kept as one bit-plane per heading, and each
+     * state only stores the heading of its parent, since the parent
+     * cell follows from the heading the state was entered with.
+     * Scratch memory is drawn from the arena of a planner context and
+     * released when the next query on that context begins.
+     */
+    class lattice_planner {
+    public:
+        enum {
+            // Penalty applied by the original grid search
+            DEFAULT_TURN_PENALTY = 5
+        };
+
+        /**
+         * @param turn_penalty cost added for each change of heading
+         * @param context      context providing the scratch memory
+         */
+        explicit lattice_planner(
+            int turn_penalty = DEFAULT_TURN_PENALTY,
+            planner_context &context = default_planner_context()
+        );
+
+        /**
+         * Find a path between two cells.
+         *
+         * @param terrain       kernelized terrain
+         * @param start         starting cell
+         * @param dest          destination cell
+         * @param path          vector to which the path, including the
+         *                      start and destination, is written
+         * @param start_heading heading the robot is already moving in,
+         *                      or HEADING_ANY if the first move is free
+         * @return true if a path was found
+         */
+        bool search(
+            array2d<int> &terrain,
+            const vector2i &start,
+            const vector2i &dest,
+            std::vector<vector2i> &path,
+            int start_heading = HEADING_ANY
+        );
+
+        /**
+         * @return cost of the last path found, or -1 if none
+         */
+        int cost() const;
+
+        /**
+         * @return heading switches along the last path found
+         */
+        int switches() const;
+
+        /**
+         * @return the primitives that may follow a move in a heading
+         */
+        const motion_primitive *primitives(heading from) const;
+
+    private:
+        typedef std::pair<int, int> queue_entry;
+
+        int heuristic(int x, int y, int h, const vector2i &dest) const;
+        bool closed(int state) const;
+        void close(int state);
+
+        int m_turn_penalty;
+        motion_primitive m_primitives[NUM_HEADINGS][NUM_HEADINGS];
+
+        int m_cost;
+        int m_switches;
+
+        planner_context *m_context;
+
+        // Scratch of the current search, owned by the context arena
+        int *m_g;
+        std::uint8_t *m_parent;
+        std::uint64_t *m_closed;
+        std::size_t m_plane_words;
+    };
+
+    /**
+     * @return the number of heading changes along a 4-connected path
+     */
+    int count_switches(const std::vector<vector2i> &path);
+
+}
+
+#endif //MINOTAUR_CPP_LATTICE_H
@@ -0,0 +1,270 @@
+#include "penaltyfield.h"
+
+#include <algorithm>
+#include <limits>
+#include <queue>
+
+#ifndef NDEBUG
+#include <cassert>
+#endif
+
+enum {
+    DIST_INVALID = std::numeric_limits<int>::max() / 2
+};
+
+nrg::penalty_falloff nrg::ring_falloff(int wp0, int wp1, int wp2) {
+    return [wp0, wp1, wp2](int d) -> int {
+        switch (d) {
+            case 1:
+                return wp0;
+            case 2:
+                return wp1;
+            case 3:
+                return wp2;
+            default:
+                return 0;
+        }
+    };
+}
+
+void nrg::inflate_walls(array2d<int> &terrain, int radius, bit_grid::footprint shape) {
+    bit_grid walls = bit_grid::from_grid(terrain, TERRAIN_WALL);
+    walls.dilated(radius, shape).to_grid(terrain, TERRAIN_WALL);
+}
+
+nrg::penalty_field::penalty_field(int wall, penalty_falloff falloff, int radius) :
+    m_wall(wall),
+    m_radius(std::max(radius, 0)),
+    m_table(static_cast<std::size_t>(m_radius) + 2, 0),
+    m_dist(0, 0),
+    m_terrain(0, 0),
+    m_walls(0, 0) {
+    // Tabulate the falloff so that the passes only do lookups, the
+    // last entry is the zero penalty of every distance beyond radius
+    for (int d = 1; d <= m_radius; ++d) {
+        m_table[d] = falloff(d);
+    }
+    m_table[0] = TERRAIN_WALL;
+}
+
+int nrg::penalty_field::radius() const {
+    return m_radius;
+}
+
+array2d<int> &nrg::penalty_field::terrain() {
+    return m_terrain;
+}
+
+int nrg::penalty_field::distance(int x, int y) {
+    return m_dist[x][y];
+}
+
+int nrg::penalty_field::base_distance(int x, int y) {
+    // Cells outside the grid count as walls, so the
+    // distance is bounded by the distance to the edge
+    if (m_walls[x][y]) { return 0; }
+    int nx = static_cast<int>(m_dist.x());
+    int ny = static_cast<int>(m_dist.y());
+    return std::min(std::min(x + 1, nx - x), std::min(y + 1, ny - y));
+}
+
+int nrg::penalty_field::penalty_of(int d) const {
+    return m_table[std::min(d, m_radius + 1)];
+}
+
+void nrg::penalty_field::compute(array2d<int> &source) {
+    std::size_t mx = source.x();
+    std::size_t my = source.y();
+    if (m_dist.x() != mx || m_dist.y() != my) {
+        m_dist = array2d<int>(mx, my);
+        m_terrain = array2d<int>(mx, my);
+        m_walls = array2d<bool>(mx, my);
+    }
+    int nx = static_cast<int>(mx);
+    int ny = static_cast<int>(my);
+    for (int x = 0; x < nx; ++x) {
+        int *src = source[x].get();
+        bool *walls = m_walls[x].get();
+        for (int y = 0; y < ny; ++y) {
+            walls[y] = src[y] == m_wall;
+        }
+        int *dist = m_dist[x].get();
+        for (int y = 0; y < ny; ++y) {
+            dist[y] = base_distance(x, y);
+        }
+    }
+    forward_pass();
+    backward_pass();
+    for (int x = 0; x < nx; ++x) {
+        int *dist = m_dist[x].get();
+        int *terrain = m_terrain[x].get();
+        for (int y = 0; y < ny; ++y) {
+            terrain[y] = penalty_of(dist[y]);
+        }
+    }
+}
+
+void nrg::penalty_field::forward_pass() {
+    // Chamfer forward mask (x - 1, y - 1), (x - 1, y), (x - 1, y + 1), (x, y - 1).
+    // The terms from the previous column are applied to the whole column
+    // at once and only the (x, y - 1) term needs a sequential sweep
+    int nx = static_cast<int>(m_dist.x());
+    int ny = static_cast<int>(m_dist.y());
+    if (ny == 0) { return; }
+    int **dist = m_dist.get();
+    for (int x = 0; x < nx; ++x) {
+        int *cur = dist[x];
+        if (x > 0) {
+            const int *prev = dist[x - 1];
+            cur[0] = std::min(cur[0], prev[0] + 1);
+            if (ny > 1) {
+                cur[0] = std::min(cur[0], prev[1] + 1);
+                cur[ny - 1] = std::min(cur[ny - 1], prev[ny - 2] + 1);
+                cur[ny - 1] = std::min(cur[ny - 1], prev[ny - 1] + 1);
+            }
+            for (int y = 1; y < ny - 1; ++y) {
+                int m = std::min(std::min(prev[y - 1], prev[y]), prev[y + 1]);
+                cur[y] = std::min(cur[y], m + 1);
+            }
+        }
+        for (int y = 1; y < ny; ++y) {
+            cur[y] = std::min(cur[y], cur[y - 1] + 1);
+        }
+    }
+}
+
+void nrg::penalty_field::backward_pass() {
+    // Chamfer backward mask (x + 1, y - 1), (x + 1, y), (x + 1, y + 1), (x, y + 1)
+    int nx = static_cast<int>(m_dist.x());
+    int ny = static_cast<int>(m_dist.y());
+    if (ny == 0) { return; }
+    int **dist = m_dist.get();
+    for (int x = nx - 1; x >= 0; --x) {
+        int *cur = dist[x];
+        if (x + 1 < nx) {
+            const int *next = dist[x + 1];
+            cur[0] = std::min(cur[0], next[0] + 1);
+            if (ny > 1) {
+                cur[0] = std::min(cur[0], next[1] + 1);
+                cur[ny - 1] = std::min(cur[ny - 1], next[ny - 2] + 1);
+                cur[ny - 1] = std::min(cur[ny - 1], next[ny - 1] + 1);
+            }
+            for (int y = 1; y < ny - 1; ++y) {
+                int m = std::min(std::min(next[y - 1], next[y]), next[y + 1]);
+                cur[y] = std::min(cur[y], m + 1);
+            }
+        }
+        for (int y = ny - 2; y >= 0; --y) {
+            cur[y] = std::min(cur[y], cur[y + 1] + 1);
+        }
+    }
+}
+
+void nrg::penalty_field::set_wall(int x, int y, bool wall) {
+#ifndef NDEBUG
+    assert(x >= 0 && x < static_cast<int>(m_dist.x()));
+    assert(y >= 0 && y < static_cast<int>(m_dist.y()));
+#endif
+    if (m_walls[x][y] == wall) { return; }
+    m_walls[x][y] = wall;
+    std::vector<cell> queue;
+    if (wall) {
+        // A new wall can only lower distances
+        m_dist[x][y] = 0;
+        queue.emplace_back(x, y);
+        lower(queue);
+        return;
+    }
+    // Raise phase: invalidate, level by level, every cell whose
+    // distance was derived only through the removed wall
+    int nx = static_cast<int>(m_dist.x());
+    int ny = static_cast<int>(m_dist.y());
+    std::vector<std::pair<cell, int>> raised;
+    raised.emplace_back(cell(x, y), 0);
+    m_dist[x][y] = DIST_INVALID;
+    for (std::size_t i = 0; i < raised.size(); ++i) {
+        cell c = raised[i].first;
+        int level = raised[i].second;
+        for (int dx = -1; dx <= 1; ++dx) {
+            for (int dy = -1; dy <= 1; ++dy) {
+                int tx = c.first + dx;
+                int ty = c.second + dy;
+                if (tx < 0 || ty < 0 || tx >= nx || ty >= ny) { continue; }
+                if (m_dist[tx][ty] != level + 1 || is_supported(tx, ty)) { continue; }
+                m_dist[tx][ty] = DIST_INVALID;
+                raised.emplace_back(cell(tx, ty), level + 1);
+            }
+        }
+    }
+    // Lower phase: reseed the invalidated cells from their
+    // valid neighbours and propagate the new distances
+    for (const std::pair<cell, int> &r : raised) {
+        int tx = r.first.first;
+        int ty = r.first.second;
+        int d = base_distance(tx, ty);
+        for (int dx = -1; dx <= 1; ++dx) {
+            for (int dy = -1; dy <= 1; ++dy) {
+                int ux = tx + dx;
+                int uy = ty + dy;
+                if (ux < 0 || uy < 0 || ux >= nx || uy >= ny) { continue; }
+                d = std::min(d, m_dist[ux][uy] + 1);
+            }
+        }
+        m_dist[tx][ty] = d;
+    }
+    for (const std::pair<cell, int> &r : raised) {
+        queue.push_back(r.first);
+    }
+    lower(queue);
+}
+
+bool nrg::penalty_field::is_supported(int x, int y) {
+    int d = m_dist[x][y];
+    if (d == base_distance(x, y)) { return true; }
+    int nx = static_cast<int>(m_dist.x());
+    int ny = static_cast<int>(m_dist.y());
+    for (int dx = -1; dx <= 1; ++dx) {
+        for (int dy = -1; dy <= 1; ++dy) {
+            int tx = x + dx;
+            int ty = y + dy;
+            if (tx < 0 || ty < 0 || tx >= nx || ty >= ny) { continue; }
+            if (m_dist[tx][ty] + 1 == d) { return true; }
+        }
+    }
+    return false;
+}
+
+void nrg::penalty_field::lower(std::vector<cell> &queue) {
+    // Unit weight Dijkstra from the seeded cells, every cell
+    // whose distance is final is written back to the terrain
+    typedef std::pair<int, cell> entry;
+    std::priority_queue<entry, std::vector<entry>, std::greater<entry>> open;
+    for (const cell &c : queue) {
+        open.emplace(m_dist[c.first][c.second], c);
+    }
+    int nx = static_cast<int>(m_dist.x());
+    int ny = static_cast<int>(m_dist.y());
+    while (!open.empty()) {
+        entry e = open.top();
+        open.pop();
+        int x = e.second.first;
+        int y = e.second.second;
+        if (e.first != m_dist[x][y]) { continue; }
+        refresh(x, y);
+        for (int dx = -1; dx <= 1; ++dx) {
+            for (int dy = -1; dy <= 1; ++dy) {
+                int tx = x + dx;
+                int ty = y + dy;
+                if (tx < 0 || ty < 0 || tx >= nx || ty >= ny) { continue; }
+                if (m_dist[tx][ty] > e.first + 1) {
+                    m_dist[tx][ty] = e.first + 1;
+                    open.emplace(e.first + 1, cell(tx, ty));
+                }
+            }
+        }
+    }
+}
+
+void nrg::penalty_field::refresh(int x, int y) {
+    m_terrain[x][y] = penalty_of(m_dist[x][y]);
+}
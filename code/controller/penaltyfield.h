@@ -0,0 +1,127 @@
+#ifndef MINOTAUR_CPP_PENALTYFIELD_H
+#define MINOTAUR_CPP_PENALTYFIELD_H
+
+#include "../utility/array2d.h"
+#include "../utility/bit_grid.h"
+
+#include <functional>
+#include <vector>
+
+#define TERRAIN_WALL -1
+
+namespace nrg {
+
+    /**
+     * Function mapping the Chebyshev distance of a cell to the
+     * nearest wall, or to the edge of the grid, to the penalty
+     * added to the cell's terrain cost. Distance zero is a wall.
+     */
+    typedef std::function<int(int)> penalty_falloff;
+
+    /**
+     * Falloff that reproduces the three penalty rings of the
+     * original kernel: cells one, two and three cells from a
+     * wall are given wp0, wp1 and wp2 respectively.
+     *
+     * @param wp0 penalty of cells adjacent to a wall
+     * @param wp1 penalty of cells two cells from a wall
+     * @param wp2 penalty of cells three cells from a wall
+     * @return the ring falloff function
+     */
+    penalty_falloff ring_falloff(int wp0, int wp1, int wp2);
+
+    /**
+     * Grow the walls of a terrain by a robot footprint, so that the
+     * robot can be planned for as a single cell. The walls are packed
+     * into a bit_grid and dilated with word operations.
+     *
+     * @param terrain kernelized terrain, updated in place
+     * @param radius  radius of the robot footprint in cells
+     * @param shape   shape of the robot footprint
+     */
+    void inflate_walls(
+        array2d<int> &terrain,
+        int radius,
+        bit_grid::footprint shape = bit_grid::SQUARE
+    );
+
+    /**
+     * Wall penalty field computed with a two-pass chessboard distance
+     * transform. The cost per cell is independent of the falloff
+     * radius, and single wall cells can be added or removed without
+     * recomputing the whole field.
+     *
+     * The field stores the kernelized terrain, where walls have the
+     * value TERRAIN_WALL and every other cell the falloff penalty of
+     * its distance to the nearest wall or to the edge of the grid.
+     */
+    class penalty_field {
+    public:
+        /**
+         * Create an empty penalty field.
+         *
+         * @param wall    source value that indicates a wall
+         * @param falloff penalty as a function of wall distance
+         * @param radius  largest distance at which falloff is evaluated,
+         *                cells further away have zero penalty
+         */
+        penalty_field(int wall, penalty_falloff falloff, int radius);
+
+        /**
+         * Recompute the distance transform and the terrain
+         * for a new source grid.
+         *
+         * @param source grid of walls and free cells
+         */
+        void compute(array2d<int> &source);
+
+        /**
+         * Add or remove a single wall and update the affected
+         * cells of the distance transform and terrain.
+         *
+         * @param x    column of the changed cell
+         * @param y    row of the changed cell
+         * @param wall whether the cell is now a wall
+         */
+        void set_wall(int x, int y, bool wall);
+
+        /**
+         * @return distance of a cell to the nearest wall or grid edge
+         */
+        int distance(int x, int y);
+
+        /**
+         * @return the kernelized terrain
+         */
+        array2d<int> &terrain();
+
+        int radius() const;
+
+    private:
+        typedef std::pair<int, int> cell;
+
+        int base_distance(int x, int y);
+        int penalty_of(int d) const;
+
+        void forward_pass();
+        void backward_pass();
+
+        void lower(std::vector<cell> &queue);
+        bool is_supported(int x, int y);
+        void refresh(int x, int y);
+
+        int m_wall;
+        int m_radius;
+        /**
+         * Falloff evaluated at distances [0, radius + 1].
+         */
+        std::vector<int> m_table;
+
+        array2d<int> m_dist;
+        array2d<int> m_terrain;
+        array2d<bool> m_walls;
+    };
+
+}
+
+#endif //MINOTAUR_CPP_PENALTYFIELD_H
@@ -0,0 +1,48 @@
+#include "plancache.h"
+
+static std::size_t hash_combine(std::size_t seed, int v) {
+    return seed ^ (std::hash<int>()(v) + 0x9e3779b9 + (seed << 6) + (seed >> 2));
+}
+
+bool nrg::terrain_key::operator==(const terrain_key &o) const {
+    return version == o.version &&
+           wall_penalty_0 == o.wall_penalty_0 &&
+           wall_penalty_1 == o.wall_penalty_1 &&
+           wall_penalty_2 == o.wall_penalty_2;
+}
+
+std::size_t nrg::terrain_key::hash::operator()(const terrain_key &k) const {
+    std::size_t h = std::hash<unsigned long>()(k.version);
+    h = hash_combine(h, k.wall_penalty_0);
+    h = hash_combine(h, k.wall_penalty_1);
+    return hash_combine(h, k.wall_penalty_2);
+}
+
+bool nrg::path_key::operator==(const path_key &o) const {
+    return terrain == o.terrain && start == o.start && dest == o.dest;
+}
+
+std::size_t nrg::path_key::hash::operator()(const path_key &k) const {
+    std::size_t h = terrain_key::hash()(k.terrain);
+    h = hash_combine(h, k.start.x());
+    h = hash_combine(h, k.start.y());
+    h = hash_combine(h, k.dest.x());
+    return hash_combine(h, k.dest.y());
+}
+
+nrg::plan_cache::plan_cache(std::size_t terrain_capacity, std::size_t path_capacity) :
+    m_terrains(terrain_capacity),
+    m_paths(path_capacity) {}
+
+nrg::plan_cache::terrain_cache &nrg::plan_cache::terrains() {
+    return m_terrains;
+}
+
+nrg::plan_cache::path_cache &nrg::plan_cache::paths() {
+    return m_paths;
+}
+
+void nrg::plan_cache::clear() {
+    m_terrains.clear();
+    m_paths.clear();
+}
@@ -0,0 +1,75 @@
+#ifndef MINOTAUR_CPP_PLANCACHE_H
+#define MINOTAUR_CPP_PLANCACHE_H
+
+#include "../utility/array2d.h"
+#include "../utility/lru_cache.h"
+#include "../utility/vector.h"
+
+#include <vector>
+
+namespace nrg {
+
+    /**
+     * Identifies a kernelized terrain by the version of the grid it
+     * was built from and the wall penalties that were applied.
+     */
+    struct terrain_key {
+        unsigned long version;
+        int wall_penalty_0;
+        int wall_penalty_1;
+        int wall_penalty_2;
+
+        bool operator==(const terrain_key &o) const;
+
+        struct hash {
+            std::size_t operator()(const terrain_key &k) const;
+        };
+    };
+
+    /**
+     * Identifies a planned path by its terrain and endpoints.
+     */
+    struct path_key {
+        terrain_key terrain;
+        vector2i start;
+        vector2i dest;
+
+        bool operator==(const path_key &o) const;
+
+        struct hash {
+            std::size_t operator()(const path_key &k) const;
+        };
+    };
+
+    /**
+     * Caches kernelized terrains and planned paths, so that repeated
+     * plans over an unchanged grid cost a hash lookup.
+     */
+    class plan_cache {
+    public:
+        enum {
+            DEFAULT_TERRAIN_CAPACITY = 4,
+            DEFAULT_PATH_CAPACITY = 64
+        };
+
+        typedef lru_cache<terrain_key, array2d<int>, terrain_key::hash> terrain_cache;
+        typedef lru_cache<path_key, std::vector<vector2i>, path_key::hash> path_cache;
+
+        explicit plan_cache(
+            std::size_t terrain_capacity = DEFAULT_TERRAIN_CAPACITY,
+            std::size_t path_capacity = DEFAULT_PATH_CAPACITY
+        );
+
+        terrain_cache &terrains();
+        path_cache &paths();
+
+        void clear();
+
+    private:
+        terrain_cache m_terrains;
+        path_cache m_paths;
+    };
+
+}
+
+#endif //MINOTAUR_CPP_PLANCACHE_H
@@ -0,0 +1,24 @@
+#include "plancontext.h"
+
+nrg::planner_context::planner_context(std::size_t initial) :
+    m_arena(initial),
+    m_queries(0) {}
+
+nrg::arena &nrg::planner_context::begin_query() {
+    m_arena.reset();
+    ++m_queries;
+    return m_arena;
+}
+
+nrg::arena &nrg::planner_context::memory() {
+    return m_arena;
+}
+
+unsigned long nrg::planner_context::queries() const {
+    return m_queries;
+}
+
+nrg::planner_context &nrg::default_planner_context() {
+    static thread_local planner_context context;
+    return context;
+}
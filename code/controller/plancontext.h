@@ -0,0 +1,48 @@
+#ifndef MINOTAUR_CPP_PLANCONTEXT_H
+#define MINOTAUR_CPP_PLANCONTEXT_H
+
+#include "../utility/arena.h"
+
+namespace nrg {
+
+    /**
+     * Owns the scratch memory of the grid planners. Each query draws
+     * its per-cell tables and open set from the context's arena and
+     * releases them all when the next query begins, so once the arena
+     * has grown to fit the largest query no further heap allocations
+     * are made.
+     *
+     * A context must only be used by one thread at a time.
+     */
+    class planner_context {
+    public:
+        explicit planner_context(std::size_t initial = arena::DEFAULT_BLOCK);
+
+        /**
+         * Release the scratch memory of the previous query.
+         *
+         * @return the arena from which the new query allocates
+         */
+        arena &begin_query();
+
+        arena &memory();
+
+        /**
+         * @return number of queries begun on this context
+         */
+        unsigned long queries() const;
+
+    private:
+        arena m_arena;
+        unsigned long m_queries;
+    };
+
+    /**
+     * @return the context of the calling thread, used by the planners
+     *         when none is given
+     */
+    planner_context &default_planner_context();
+
+}
+
+#endif //MINOTAUR_CPP_PLANCONTEXT_H
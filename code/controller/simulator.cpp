@@ -2,29 +2,26 @@
 #include "../simulator/globalsim.h"
 #include "simulator.h"
 
+#include <algorithm>
+
+static int sign(int v) {
+    return (v > 0) - (v < 0);
+}
+
 Simulator::Simulator(GlobalSim *sim) :
     Controller(false, false) {
-    connect(this, &Simulator::move_right, sim, &GlobalSim::robot_right);
-    connect(this, &Simulator::move_left, sim, &GlobalSim::robot_left);
-    connect(this, &Simulator::move_down, sim, &GlobalSim::robot_down);
-    connect(this, &Simulator::move_up, sim, &GlobalSim::robot_up);
+    connect(this, &Simulator::push, sim, &GlobalSim::robot_push);
 }
 
-void Simulator::__move_delegate(vector2i dir, int timer) {
+void Simulator::__move_delegate(vector2i dir, int timer, int power) {
     // Update the robot position
 #ifndef NDEBUG
     debug() << "Moved " << dir << " in " << timer << " sec";
 #endif
-    robot_pos += dir;
-    if (dir.x() > 0) {
-        Q_EMIT move_right();
-    } else if (dir.x() < 0) {
-        Q_EMIT move_left();
-    } else if (dir.y() > 0) {
-        Q_EMIT move_down();
-    } else if (dir.y() < 0) {
-        Q_EMIT move_up();
-    }
+    // The robot takes one step in the direction of the move
+    robot_pos += vector2i(sign(dir.x()), sign(dir.y()));
+    power = std::max(0, std::min(power, static_cast<int>(MAX_POWER)));
+    Q_EMIT push(sign(dir.x()), sign(dir.y()), static_cast<double>(power) / MAX_POWER);
 }
 
 vector2i *Simulator::getRobotPos() {
@@ -15,15 +15,16 @@ Q_OBJECT
 public:
     Simulator(GlobalSim *sim);
 
-    void __move_delegate(vector2i dir, int timer) override;
+    void __move_delegate(vector2i dir, int timer, int power) override;
 
     // Get (x,y) position of the robot
     vector2i *getRobotPos();
 
-    Q_SIGNAL void move_right();
-    Q_SIGNAL void move_left();
-    Q_SIGNAL void move_down();
-    Q_SIGNAL void move_up();
+    /**
+     * Push the robot along an axis, with a power that is a fraction of
+     * full power, as GlobalSim::robot_push().
+     */
+    Q_SIGNAL void push(int dx, int dy, double power);
 
 private:
     vector2i robot_pos;
@@ -1,9 +1,11 @@
 #include "../utility/logger.h"
 #include "solenoid.h"
 #include <QSerialPortInfo>
+#include <algorithm>
 
 Solenoid::Solenoid()
-    : Controller(false, false) {
+    : Controller(false, false),
+      m_serial(this) {
     // For convenience, attempt auto-detect connection at launch
     attempt_connection();
 }
@@ -12,7 +14,8 @@ Solenoid::Solenoid(
     const QString &serial_port,
     QSerialPort::BaudRate baud_rate
 )
-    : Controller(true, true) {
+    : Controller(true, true),
+      m_serial(this) {
     attempt_connection(serial_port, baud_rate);
 }
 
@@ -83,7 +86,7 @@ void Solenoid::readSerial() {
 }
 
 vector2i Solenoid::to_vector2i(Dir dir) {
-    constexpr int power = 255;
+    constexpr int power = MAX_POWER;
     switch (dir) {
         case Dir::UP:
             return {0, power};
@@ -98,7 +101,7 @@ vector2i Solenoid::to_vector2i(Dir dir) {
     }
 }
 
-void Solenoid::__move_delegate(vector2i dir, int time) {
+void Solenoid::__move_delegate(vector2i dir, int time, int power) {
 #ifndef NDEBUG
     debug() << "Moving Solenoid controller";
     debug() << "Attempting to move " << dir;
@@ -112,7 +115,7 @@ void Solenoid::__move_delegate(vector2i dir, int time) {
     debug() << dir << " : " << time;
 #endif
     //m_serial.write(encode_message(dir, time));
-    char dir_msg;
+    char dir_msg = 0;
     if (dir.x() > 0) {
         dir_msg = RIGHT;
     } else if (dir.x() < 0) {
@@ -123,6 +126,14 @@ void Solenoid::__move_delegate(vector2i dir, int time) {
     } else if (dir.y() < 0) {
         dir_msg = UP;
     }
+    if (!dir_msg) { return; }
+    // The power of the move is a fraction of the power set for the
+    // solenoid, which the Arduino keeps until it is changed, so moves
+    // at full power leave it untouched
+    auto direction = static_cast<Direction>(dir_msg);
+    solenoid_power &current = power_of(direction);
+    int value = current.full * std::max(0, std::min(power, static_cast<int>(MAX_POWER))) / MAX_POWER;
+    if (value != current.sent) { send_power(value, direction); }
     m_serial.write(&dir_msg, 1);
     if (!m_serial.waitForBytesWritten(200)) {
         fatal() << "Failed to execute movement: write timed out";
@@ -149,6 +160,12 @@ void Solenoid::change_delay(int value) {
 
 void Solenoid::change_power(int value, Direction direction) {
     log() << "Changing " << (direction == UP ? "up" : direction == DOWN ? "down" : direction == RIGHT ? "right" : "left") << " solenoid power to " << value;
+    power_of(direction).full = value;
+    send_power(value, direction);
+}
+
+void Solenoid::send_power(int value, Direction direction) {
+    power_of(direction).sent = value;
     char signal = 'p';
     char dir = direction;
     char power = static_cast<char>(value);
@@ -157,6 +174,14 @@ void Solenoid::change_power(int value, Direction direction) {
     m_serial.write(&power, 1);
 }
 
+Solenoid::solenoid_power &Solenoid::power_of(Direction direction) {
+    auto it = m_powers.find(direction);
+    if (it == m_powers.end()) {
+        it = m_powers.emplace(direction, solenoid_power{MAX_POWER, MAX_POWER}).first;
+    }
+    return it->second;
+}
+
 QByteArray Solenoid::encode_message(vector2i dir, int time) {
     shrink_into<int16_t> s;
     nrg::vector<int16_t> short_vec(s(dir.x()), s(dir.y()));
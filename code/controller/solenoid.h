@@ -33,7 +33,7 @@ public:
 
     vector2i to_vector2i(Dir dir) override;
 
-    void __move_delegate(vector2i dir, int timer) override;
+    void __move_delegate(vector2i dir, int timer, int power) override;
 
     /**
      * @return if the QSerialPort is currently managing an active connection
@@ -101,8 +101,31 @@ public:
         UP = 119
     };
 
+    /**
+     * Set the power of a solenoid, at which moves of full power are sent.
+     */
     void change_power(int value, enum Direction direction);
 
+    /**
+     * Write the power of a solenoid to the Arduino.
+     */
+    void send_power(int value, enum Direction direction);
+
+    struct solenoid_power {
+        // Power set for moves of full power
+        int full;
+        // Power last written to the Arduino
+        int sent;
+    };
+
+    /**
+     * @return the power of a solenoid, which the Arduino starts at full
+     */
+    solenoid_power &power_of(enum Direction direction);
+
+    std::unordered_map<int, solenoid_power> m_powers;
+
+    // Child of the solenoid, so that it follows it between threads
     QSerialPort m_serial;
 };
 
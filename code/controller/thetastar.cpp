@@ -0,0 +1,172 @@
+#include "thetastar.h"
+#include "astar.h"
+#include "penaltyfield.h"
+#include "plancontext.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+
+double nrg::line_cost(
+    array2d<int> &terrain,
+    const vector2i &a,
+    const vector2i &b
+) {
+    int x = a.x();
+    int y = a.y();
+    if (terrain[x][y] == TERRAIN_WALL) { return -1; }
+    int nx = abs(b.x() - a.x());
+    int ny = abs(b.y() - a.y());
+    int sx = b.x() > a.x() ? 1 : -1;
+    int sy = b.y() > a.y() ? 1 : -1;
+    double len = std::sqrt(static_cast<double>(nx * nx + ny * ny));
+    // The segment crosses the i-th vertical cell border at
+    // t = (2i + 1) / 2nx and the j-th horizontal border at
+    // t = (2j + 1) / 2ny, which are compared exactly as integers
+    int i = 0;
+    int j = 0;
+    double t = 0;
+    double cost = 0;
+    while (i < nx || j < ny) {
+        bool step_x = j >= ny || (i < nx && (2 * i + 1) * ny <= (2 * j + 1) * nx);
+        bool step_y = i >= nx || (j < ny && (2 * j + 1) * nx <= (2 * i + 1) * ny);
+        double next = step_x
+            ? (2 * i + 1) / (2.0 * nx)
+            : (2 * j + 1) / (2.0 * ny);
+        cost += (next - t) * len * (1 + terrain[x][y]);
+        t = next;
+        if (step_x && step_y) {
+            // Passing through a corner touches both side cells
+            if (terrain[x + sx][y] == TERRAIN_WALL ||
+                terrain[x][y + sy] == TERRAIN_WALL) {
+                return -1;
+            }
+        }
+        if (step_x) {
+            x += sx;
+            ++i;
+        }
+        if (step_y) {
+            y += sy;
+            ++j;
+        }
+        if (terrain[x][y] == TERRAIN_WALL) { return -1; }
+    }
+    return cost + (1 - t) * len * (1 + terrain[x][y]);
+}
+
+bool nrg::line_of_sight(
+    array2d<int> &terrain,
+    const vector2i &a,
+    const vector2i &b
+) {
+    return line_cost(terrain, a, b) >= 0;
+}
+
+bool nrg::search_path_theta(
+    array2d<int> &terrain,
+    const vector2i &start,
+    const vector2i &dest,
+    std::vector<vector2i> &path
+) {
+    return search_path_theta(default_planner_context(), terrain, start, dest, path);
+}
+
+bool nrg::search_path_theta(
+    planner_context &context,
+    array2d<int> &terrain,
+    const vector2i &start,
+    const vector2i &dest,
+    std::vector<vector2i> &path
+) {
+    int mx = static_cast<int>(terrain.x());
+    int my = static_cast<int>(terrain.y());
+    auto outside = [mx, my](const vector2i &v) {
+        return v.x() < 0 || v.y() < 0 || v.x() >= mx || v.y() >= my;
+    };
+    // Unselected grid endpoints are reported as (-1, -1)
+    if (outside(start) || outside(dest)) { return false; }
+    if (terrain[start.x()][start.y()] == TERRAIN_WALL ||
+        terrain[dest.x()][dest.y()] == TERRAIN_WALL) {
+        return false;
+    }
+    arena &memory = context.begin_query();
+    auto num = static_cast<std::size_t>(mx * my);
+    double *g = memory.array<double>(num);
+    std::fill(g, g + num, std::numeric_limits<double>::infinity());
+    int *parent = memory.array<int>(num);
+    std::fill(parent, parent + num, -1);
+    bool *closed = memory.array<bool>(num);
+    std::fill(closed, closed + num, false);
+    auto cell = [my](int id) { return vector2i(id / my, id % my); };
+    auto heuristic = [&dest](const vector2i &v) {
+        double dx = v.x() - dest.x();
+        double dy = v.y() - dest.y();
+        return std::sqrt(dx * dx + dy * dy);
+    };
+
+    typedef std::pair<double, int> queue_entry;
+    arena_vector<queue_entry> open{arena_allocator<queue_entry>(memory)};
+    open.reserve(num);
+    auto push = [&open](double key, int id) {
+        open.emplace_back(key, id);
+        std::push_heap(open.begin(), open.end(), std::greater<queue_entry>());
+    };
+    search_stats &stats = last_search_stats();
+    stats = {0, 1};
+    int s = start.x() * my + start.y();
+    int d = dest.x() * my + dest.y();
+    g[s] = 0;
+    parent[s] = s;
+    push(heuristic(start), s);
+    while (!open.empty()) {
+        int u = open.front().second;
+        std::pop_heap(open.begin(), open.end(), std::greater<queue_entry>());
+        open.pop_back();
+        if (closed[u]) { continue; }
+        closed[u] = true;
+        ++stats.expansions;
+        if (u == d) { break; }
+        vector2i cu = cell(u);
+        vector2i cp = cell(parent[u]);
+        for (int ox = -1; ox <= 1; ++ox) {
+            for (int oy = -1; oy <= 1; ++oy) {
+                vector2i cn(cu.x() + ox, cu.y() + oy);
+                if ((ox == 0 && oy == 0) ||
+                    cn.x() < 0 || cn.y() < 0 ||
+                    cn.x() >= mx || cn.y() >= my) {
+                    continue;
+                }
+                int n = cn.x() * my + cn.y();
+                if (closed[n]) { continue; }
+                // Try to skip the expanded node and connect straight
+                // to its parent, keeping whichever is cheaper given
+                // that the terrain penalties are not uniform
+                double step = line_cost(terrain, cu, cn);
+                if (step < 0) { continue; }
+                double best = g[u] + step;
+                int from = u;
+                if (parent[u] != u) {
+                    double direct = line_cost(terrain, cp, cn);
+                    if (direct >= 0 && g[parent[u]] + direct <= best) {
+                        best = g[parent[u]] + direct;
+                        from = parent[u];
+                    }
+                }
+                if (best < g[n]) {
+                    g[n] = best;
+                    parent[n] = from;
+                    push(best + heuristic(cn), n);
+                    ++stats.pushes;
+                }
+            }
+        }
+    }
+    if (!closed[d]) { return false; }
+    std::size_t first = path.size();
+    for (int v = d; v != s; v = parent[v]) { path.push_back(cell(v)); }
+    path.push_back(start);
+    std::reverse(path.begin() + first, path.end());
+    return true;
+}
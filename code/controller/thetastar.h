@@ -0,0 +1,79 @@
+#ifndef MINOTAUR_CPP_THETASTAR_H
+#define MINOTAUR_CPP_THETASTAR_H
+
+#include "../utility/array2d.h"
+#include "../utility/vector.h"
+
+#include <vector>
+
+namespace nrg {
+
+    class planner_context;
+
+    /**
+     * Walk the straight segment between the centres of two cells and
+     * accumulate its cost. Each visited cell costs the length of the
+     * segment inside it times one plus its terrain value. Where the
+     * segment passes exactly through a cell corner, the two cells
+     * touching the corner must also be open, so that paths never
+     * squeeze diagonally between walls.
+     *
+     * @param terrain kernelized terrain
+     * @param a       first cell
+     * @param b       second cell
+     * @return the cost of the segment, or a negative value if the
+     *         segment is blocked by a wall
+     */
+    double line_cost(
+        array2d<int> &terrain,
+        const vector2i &a,
+        const vector2i &b
+    );
+
+    /**
+     * @return true if no wall blocks the segment between two cells
+     */
+    bool line_of_sight(
+        array2d<int> &terrain,
+        const vector2i &a,
+        const vector2i &b
+    );
+
+    /**
+     * Any-angle path search (Theta*). Nodes may take any visible
+     * ancestor as their parent, so the path is a short list of
+     * waypoints joined by straight segments that line of sight
+     * guarantees to be free of walls.
+     *
+     * @param terrain kernelized terrain
+     * @param start   starting cell
+     * @param dest    destination cell
+     * @param path    vector to which the waypoints, including the
+     *                start and destination, are written
+     * @return true if a path was found
+     */
+    bool search_path_theta(
+        array2d<int> &terrain,
+        const vector2i &start,
+        const vector2i &dest,
+        std::vector<vector2i> &path
+    );
+
+    /**
+     * Any-angle path search with scratch memory drawn from a planner
+     * context, so that repeated queries do not allocate once the
+     * context has grown to fit them.
+     *
+     * @see search_path_theta(array2d<int> &, const vector2i &, const vector2i &, std::vector<vector2i> &)
+     */
+    bool search_path_theta(
+        planner_context &context,
+        array2d<int> &terrain,
+        const vector2i &start,
+        const vector2i &dest,
+        std::vector<vector2i> &path
+    );
+
+}
+
+#endif //MINOTAUR_CPP_THETASTAR_H
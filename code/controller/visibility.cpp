@@ -0,0 +1,320 @@
+#include "visibility.h"
+#include "astar.h"
+
+#include "../utility/algorithm.h"
+#include "../utility/indexed_heap.h"
+
+#include <algorithm>
+#include <limits>
+
+#ifndef NDEBUG
+#include <cassert>
+#endif
+
+enum {
+    NO_PARENT = -1
+};
+
+// Margin by which rectangles shrink for interior tests, so
+// that segments along an edge or through a corner stay clear
+static constexpr double INTERIOR_MARGIN = 1e-6;
+
+typedef nrg::visibility_planner::point point;
+typedef nrg::visibility_planner::box box;
+
+// Outward directions of the corners, clockwise from the top-left
+static const point s_outward[] = {{-1, -1}, {1, -1}, {1, 1}, {-1, 1}};
+
+nrg::visibility_planner::visibility_planner(const point &robot, double bucket) :
+    m_half(robot * 0.5),
+    m_bucket(bucket) {}
+
+std::vector<box> nrg::visibility_planner::wall_rects(array2d<int> &walls, int wall) {
+    std::size_t nx = walls.x();
+    std::size_t ny = walls.y();
+    array2d<bool> used(nx, ny);
+    std::vector<box> rects;
+    for (std::size_t x = 0; x < nx; ++x) {
+        for (std::size_t y = 0; y < ny; ++y) {
+            if (walls[x][y] != wall || used[x][y]) { continue; }
+            // Take the vertical run, then widen it while the next
+            // column holds the same run of unused walls
+            std::size_t y1 = y;
+            while (y1 + 1 < ny && walls[x][y1 + 1] == wall && !used[x][y1 + 1]) { ++y1; }
+            std::size_t x1 = x;
+            for (; x1 + 1 < nx; ++x1) {
+                bool full = true;
+                for (std::size_t k = y; k <= y1 && full; ++k) {
+                    full = walls[x1 + 1][k] == wall && !used[x1 + 1][k];
+                }
+                if (!full) { break; }
+            }
+            for (std::size_t i = x; i <= x1; ++i) {
+                for (std::size_t k = y; k <= y1; ++k) { used[i][k] = true; }
+            }
+            rects.emplace_back(
+                static_cast<double>(x) - 0.5,
+                static_cast<double>(y) - 0.5,
+                static_cast<double>(x1 - x + 1),
+                static_cast<double>(y1 - y + 1)
+            );
+        }
+    }
+    return rects;
+}
+
+box nrg::visibility_planner::inflate(const box &r) const {
+    return {
+        r.x() - m_half.x(),
+        r.y() - m_half.y(),
+        r.width() + 2 * m_half.x(),
+        r.height() + 2 * m_half.y()
+    };
+}
+
+box nrg::visibility_planner::interior(const box &r) {
+    return {
+        r.x() + INTERIOR_MARGIN,
+        r.y() + INTERIOR_MARGIN,
+        std::max(0.0, r.width() - 2 * INTERIOR_MARGIN),
+        std::max(0.0, r.height() - 2 * INTERIOR_MARGIN)
+    };
+}
+
+bool nrg::visibility_planner::wall_blocked(const point &a, const point &b) {
+    return m_wall_index && m_wall_index->intersects(ray<double>(a, b));
+}
+
+bool nrg::visibility_planner::obstacle_blocked(
+    const point &a,
+    const point &b,
+    const std::vector<bool> *skip
+) const {
+    ray<double> seg(a, b);
+    for (std::size_t i = 0; i < m_obstacles.size(); ++i) {
+        if (skip && (*skip)[i]) { continue; }
+        if (algo::segment_aabb_intersect(seg, m_obstacles[i].interior)) { return true; }
+    }
+    return false;
+}
+
+bool nrg::visibility_planner::inside_wall(const point &p) {
+    return wall_blocked(p, p);
+}
+
+bool nrg::visibility_planner::tangent(std::size_t id, const point &to) const {
+    // A line through a corner stays outside the obstacle on both
+    // sides unless it points into or straight out of its quadrant
+    point d = to - m_pos[id];
+    return d.x() * m_outward[id].x() * d.y() * m_outward[id].y() <= 0;
+}
+
+void nrg::visibility_planner::add_corners(const box &r) {
+    point corners[] = {r.tl(), r.tr(), r.br(), r.bl()};
+    for (std::size_t k = 0; k < 4; ++k) {
+        m_pos.push_back(corners[k]);
+        m_outward.push_back(s_outward[k]);
+        m_alive.push_back(!inside_wall(corners[k]));
+        m_adj.emplace_back();
+    }
+}
+
+void nrg::visibility_planner::connect_node(std::size_t id) {
+    if (!m_alive[id]) { return; }
+    for (std::size_t j = 0; j < m_pos.size(); ++j) {
+        if (j == id || !m_alive[j]) { continue; }
+        // The corners of one obstacle are connected in turn, so an
+        // edge to an earlier corner may already be there
+        const std::vector<std::size_t> &adj = m_adj[id];
+        if (std::find(adj.begin(), adj.end(), j) != adj.end()) { continue; }
+        if (tangent(id, m_pos[j]) && tangent(j, m_pos[id]) && !wall_blocked(m_pos[id], m_pos[j])) {
+            m_adj[id].push_back(j);
+            m_adj[j].push_back(id);
+        }
+    }
+}
+
+void nrg::visibility_planner::disconnect_node(std::size_t id) {
+    for (std::size_t j : m_adj[id]) {
+        std::vector<std::size_t> &adj = m_adj[j];
+        adj.erase(std::find(adj.begin(), adj.end(), id));
+    }
+    m_adj[id].clear();
+}
+
+void nrg::visibility_planner::place_obstacle(std::size_t handle, const box &r) {
+    obstacle &ob = m_obstacles[handle];
+    ob.bounds = inflate(r);
+    ob.interior = interior(ob.bounds);
+    point corners[] = {ob.bounds.tl(), ob.bounds.tr(), ob.bounds.br(), ob.bounds.bl()};
+    for (std::size_t k = 0; k < 4; ++k) {
+        m_pos[ob.first_node + k] = corners[k];
+        m_alive[ob.first_node + k] = !inside_wall(corners[k]);
+    }
+    for (std::size_t k = 0; k < 4; ++k) {
+        connect_node(ob.first_node + k);
+    }
+}
+
+void nrg::visibility_planner::set_walls(const std::vector<box> &walls) {
+    m_pos.clear();
+    m_outward.clear();
+    m_alive.clear();
+    m_adj.clear();
+    m_wall_index.reset();
+    std::vector<box> inflated;
+    inflated.reserve(walls.size());
+    for (const box &w : walls) {
+        inflated.push_back(inflate(w));
+    }
+    if (!inflated.empty()) {
+        double x0 = std::numeric_limits<double>::max();
+        double y0 = x0;
+        double x1 = std::numeric_limits<double>::lowest();
+        double y1 = x1;
+        for (const box &w : inflated) {
+            x0 = std::min(x0, w.x());
+            y0 = std::min(y0, w.y());
+            x1 = std::max(x1, w.x() + w.width());
+            y1 = std::max(y1, w.y() + w.height());
+        }
+        m_wall_index.reset(new spatial_grid<double>({x0, y0, x1 - x0, y1 - y0}, m_bucket));
+        for (const box &w : inflated) {
+            m_wall_index->insert(interior(w));
+        }
+    }
+    for (const box &w : inflated) {
+        add_corners(w);
+    }
+    std::size_t wall_nodes = m_pos.size();
+    for (std::size_t i = 0; i < wall_nodes; ++i) {
+        if (!m_alive[i]) { continue; }
+        for (std::size_t j = i + 1; j < wall_nodes; ++j) {
+            if (m_alive[j] && tangent(i, m_pos[j]) && tangent(j, m_pos[i]) &&
+                !wall_blocked(m_pos[i], m_pos[j])) {
+                m_adj[i].push_back(j);
+                m_adj[j].push_back(i);
+            }
+        }
+    }
+    // Obstacle corners follow the wall corners
+    for (std::size_t h = 0; h < m_obstacles.size(); ++h) {
+        m_obstacles[h].first_node = m_pos.size();
+        add_corners(m_obstacles[h].bounds);
+        for (std::size_t k = 0; k < 4; ++k) {
+            connect_node(m_obstacles[h].first_node + k);
+        }
+    }
+}
+
+std::size_t nrg::visibility_planner::add_obstacle(const box &r) {
+    std::size_t handle = m_obstacles.size();
+    box bounds = inflate(r);
+    m_obstacles.push_back({bounds, interior(bounds), m_pos.size()});
+    add_corners(bounds);
+    for (std::size_t k = 0; k < 4; ++k) {
+        connect_node(m_obstacles[handle].first_node + k);
+    }
+    return handle;
+}
+
+void nrg::visibility_planner::move_obstacle(std::size_t handle, const box &r) {
+#ifndef NDEBUG
+    assert(handle < m_obstacles.size());
+#endif
+    std::size_t first = m_obstacles[handle].first_node;
+    for (std::size_t k = 0; k < 4; ++k) {
+        disconnect_node(first + k);
+    }
+    place_obstacle(handle, r);
+}
+
+bool nrg::visibility_planner::search(
+    const point &start,
+    const point &dest,
+    std::vector<point> &path
+) {
+    search_stats &stats = last_search_stats();
+    stats = {0, 0};
+    if (inside_wall(start) || inside_wall(dest) || obstacle_blocked(dest, dest, nullptr)) {
+        return false;
+    }
+    std::vector<bool> skip(m_obstacles.size());
+    for (std::size_t i = 0; i < m_obstacles.size(); ++i) {
+        skip[i] = algo::segment_aabb_intersect(ray<double>(start, start), m_obstacles[i].interior);
+    }
+    if (!wall_blocked(start, dest) && !obstacle_blocked(start, dest, &skip)) {
+        path.push_back(start);
+        path.push_back(dest);
+        return true;
+    }
+
+    // The start and destination become two extra nodes
+    std::size_t n = m_pos.size();
+    std::size_t s = n;
+    std::size_t d = n + 1;
+    std::vector<std::size_t> from_start;
+    std::vector<bool> to_dest(n, false);
+    for (std::size_t i = 0; i < n; ++i) {
+        if (!m_alive[i]) { continue; }
+        if (tangent(i, start) && !wall_blocked(start, m_pos[i]) && !obstacle_blocked(start, m_pos[i], &skip)) {
+            from_start.push_back(i);
+        }
+        to_dest[i] = tangent(i, dest) && !wall_blocked(m_pos[i], dest) && !obstacle_blocked(m_pos[i], dest, nullptr);
+    }
+
+    auto pos = [&](std::size_t id) -> const point & {
+        return id == s ? start : id == d ? dest : m_pos[id];
+    };
+    std::vector<double> g(n + 2, std::numeric_limits<double>::max());
+    std::vector<long> parent(n + 2, NO_PARENT);
+    std::vector<bool> closed(n + 2, false);
+    indexed_heap<double> open(n + 2);
+    g[s] = 0;
+    open.push(s, (dest - start).norm());
+    ++stats.pushes;
+    auto relax = [&](std::size_t u, std::size_t v) {
+        if (closed[v]) { return; }
+        double c = g[u] + (pos(v) - pos(u)).norm();
+        if (c >= g[v]) { return; }
+        g[v] = c;
+        parent[v] = static_cast<long>(u);
+        open.push(v, c + (dest - pos(v)).norm());
+        ++stats.pushes;
+    };
+    while (!open.empty()) {
+        std::size_t u = open.pop();
+        closed[u] = true;
+        ++stats.expansions;
+        if (u == d) { break; }
+        if (u == s) {
+            for (std::size_t v : from_start) { relax(u, v); }
+            continue;
+        }
+        for (std::size_t v : m_adj[u]) {
+            // Wall edges are checked against moving obstacles lazily
+            if (!closed[v] && !obstacle_blocked(m_pos[u], m_pos[v], nullptr)) { relax(u, v); }
+        }
+        if (to_dest[u]) { relax(u, d); }
+    }
+    if (parent[d] == NO_PARENT) { return false; }
+
+    std::size_t first = path.size();
+    for (long v = static_cast<long>(d); v != NO_PARENT; v = parent[v]) {
+        path.push_back(pos(static_cast<std::size_t>(v)));
+    }
+    std::reverse(path.begin() + first, path.end());
+    return true;
+}
+
+std::size_t nrg::visibility_planner::nodes() const {
+    return static_cast<std::size_t>(std::count(m_alive.begin(), m_alive.end(), true));
+}
+
+std::size_t nrg::visibility_planner::edges() const {
+    std::size_t sum = 0;
+    for (const std::vector<std::size_t> &adj : m_adj) {
+        sum += adj.size();
+    }
+    return sum / 2;
+}
@@ -0,0 +1,142 @@
+#ifndef MINOTAUR_CPP_VISIBILITY_H
+#define MINOTAUR_CPP_VISIBILITY_H
+
+#include "../utility/array2d.h"
+#include "../utility/rect.h"
+#include "../utility/spatial_grid.h"
+#include "../utility/vector.h"
+
+#include <memory>
+#include <vector>
+
+namespace nrg {
+
+    /**
+     * Shortest paths for the robot among axis-aligned walls and moving
+     * obstacles such as the tracked object.
+     *
+     * Obstacles are inflated by half the robot size, so the robot can be
+     * treated as a point, and the graph nodes are the corners of the
+     * inflated obstacles. Paths may graze obstacle edges but never pass
+     * through their interior.
+     *
+     * Only edges tangent to the obstacles at both corners are kept,
+     * since shortest paths never bend around a corner in any other
+     * way. The wall graph is built once. Moving an obstacle only rebuilds the
+     * edges of its own corners, while the other edges are checked
+     * against the moving obstacles during the search. Searches use A*
+     * with the straight-line distance.
+     */
+    class visibility_planner {
+    public:
+        typedef vector<double> point;
+        typedef rect<double> box;
+
+        enum {
+            // Bucket size, in path units, of the wall index
+            DEFAULT_BUCKET = 32
+        };
+
+        /**
+         * @param robot  size of the robot bounding box
+         * @param bucket bucket size of the wall index
+         */
+        explicit visibility_planner(const point &robot, double bucket = DEFAULT_BUCKET);
+
+        /**
+         * Merge the wall cells of a grid into as few rectangles as
+         * possible. Cell (x, y) covers [x - 1/2, x + 1/2] on each axis,
+         * as with spatial_grid::from_walls.
+         *
+         * @param walls grid of cells
+         * @param wall  value of the wall cells
+         * @return the merged rectangles
+         */
+        static std::vector<box> wall_rects(array2d<int> &walls, int wall);
+
+        /**
+         * Replace the static walls and rebuild the wall graph. The
+         * edges of moving obstacles are rebuilt as well.
+         *
+         * @param walls wall rectangles, not yet inflated
+         */
+        void set_walls(const std::vector<box> &walls);
+
+        /**
+         * Add a moving obstacle.
+         *
+         * @param obstacle obstacle rectangle, not yet inflated
+         * @return handle used to move the obstacle
+         */
+        std::size_t add_obstacle(const box &obstacle);
+
+        /**
+         * Move an obstacle, rebuilding only the edges of its corners.
+         *
+         * @param handle   handle returned by add_obstacle
+         * @param obstacle new obstacle rectangle, not yet inflated
+         */
+        void move_obstacle(std::size_t handle, const box &obstacle);
+
+        /**
+         * Find the shortest path between two points. Moving obstacles
+         * that already contain the start are ignored for the first
+         * segment, so that a robot touching the object can back away.
+         *
+         * @param start starting point
+         * @param dest  destination point
+         * @param path  vector to which the path, including the start
+         *              and destination, is written
+         * @return true if a path was found
+         */
+        bool search(const point &start, const point &dest, std::vector<point> &path);
+
+        /**
+         * @return number of usable corner nodes
+         */
+        std::size_t nodes() const;
+
+        /**
+         * @return number of undirected edges between corner nodes
+         */
+        std::size_t edges() const;
+
+    private:
+        struct obstacle {
+            // Inflated rectangle
+            box bounds;
+            // Inflated rectangle shrunk for interior tests
+            box interior;
+            std::size_t first_node;
+        };
+
+        box inflate(const box &r) const;
+        static box interior(const box &r);
+
+        bool wall_blocked(const point &a, const point &b);
+        bool obstacle_blocked(const point &a, const point &b, const std::vector<bool> *skip) const;
+        bool inside_wall(const point &p);
+        bool tangent(std::size_t id, const point &to) const;
+
+        void add_corners(const box &r);
+        void connect_node(std::size_t id);
+        void disconnect_node(std::size_t id);
+        void place_obstacle(std::size_t handle, const box &obstacle);
+
+        point m_half;
+        double m_bucket;
+
+        std::unique_ptr<spatial_grid<double>> m_wall_index;
+        std::vector<obstacle> m_obstacles;
+
+        // Wall corners come first, then four per obstacle
+        std::vector<point> m_pos;
+        // Signs of the direction pointing away from each corner's obstacle
+        std::vector<point> m_outward;
+        std::vector<bool> m_alive;
+        std::vector<std::vector<std::size_t>> m_adj;
+    };
+
+}
+
+#endif //MINOTAUR_CPP_VISIBILITY_H
@@ -135,6 +135,7 @@ void GridDisplay::button_clicked(int x, int y) {
         // Sets button to different shades of green based on weighting assigned
         m_button[x][y]->setBrush(m_camera_display->get_weighting() == -1 ? m_default_brush : m_selected_brushes[m_camera_display->get_weighting()]);
     }
+    ++m_version;
 #ifndef NDEBUG
     qDebug() << "Button (" << x << "," << y << ") = " << m_square_selected[x][y];
 #endif
@@ -150,6 +151,7 @@ void GridDisplay::draw_buttons() {
             m_square_selected[x][y] = NOT_SELECTED_WEIGHT;
         }
     }
+    ++m_version;
     m_view->adjustSize();
 }
 
@@ -167,6 +169,7 @@ void GridDisplay::clear_selection() {
             m_square_selected[x][y] = NOT_SELECTED_WEIGHT;
         }
     }
+    ++m_version;
 }
 
 void GridDisplay::show_grid() {
@@ -294,6 +297,7 @@ void GridDisplay::rect_select_all_buttons(
             m_button[x][y]->setBrush(m_camera_display->get_weighting() == -1 ? m_default_brush : m_selected_brushes[m_camera_display->get_weighting()]);
         }
     }
+    ++m_version;
 }
 
 void GridDisplay::rect_deselect_all_buttons(
@@ -310,6 +314,7 @@ void GridDisplay::rect_deselect_all_buttons(
             m_button[x][y]->setBrush(m_default_brush);
         }
     }
+    ++m_version;
 }
 
 int GridDisplay::get_num_rows() const {
@@ -332,6 +337,10 @@ array2d<int> &GridDisplay::selected() {
     return m_square_selected;
 }
 
+unsigned long GridDisplay::version() const {
+    return m_version;
+}
+
 void GridDisplay::set_mouse_start(const QPoint &pos) {
     m_mouse_click_start = pos;
 }
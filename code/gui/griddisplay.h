@@ -46,6 +46,9 @@ public:
 
     array2d<int> &selected();
 
+    // Incremented on every change to the selected squares
+    unsigned long version() const;
+
     QRect view_geometry();
 
     bool is_displayed();
@@ -101,6 +104,7 @@ private:
 
     array2d<QGraphicsRectItem *> m_button;
     array2d<int> m_square_selected;
+    unsigned long m_version = 0;
 
     std::unique_ptr<QGraphicsScene> m_scene;
     std::unique_ptr<QGraphicsView> m_view;
@@ -12,6 +12,7 @@
 #include "../camera/statusbox.h"
 #include "../camera/statuslabel.h"
 #include "../compstate/compstate.h"
+#include "../compstate/controlthread.h"
 #include "../compstate/objectprocedure.h"
 #include "../compstate/parammanager.h"
 #include "../compstate/procedure.h"
@@ -43,6 +44,7 @@ MainWindow::MainWindow() :
     m_serial_box(std::make_unique<SerialBox>(m_solenoid, this)),
     m_simulator_window(std::make_unique<SimulatorWindow>(m_simulator, this)),
 
+    m_control_thread(std::make_unique<ControlThread>()),
     m_compstate(std::make_unique<CompetitionState>(this)),
 
     m_controller_type(Controller::SOLENOID) {
@@ -60,6 +62,11 @@ MainWindow::MainWindow() :
     // Connect solenoid serial port to the monitor
     connect(m_solenoid.get(), &Solenoid::serialRead, m_serial_box.get(), &SerialBox::append_text);
 
+    // Controller commands are sent from the control thread, so the
+    // serial port is serviced there as well
+    m_solenoid->moveToThread(m_control_thread.get());
+    m_control_thread->start();
+
     // Simulator and controls
     connect(m_camera_display.get(), &CameraDisplay::camera_changed, this, &MainWindow::switchToSimulator);
 
@@ -86,6 +93,8 @@ MainWindow::MainWindow() :
 }
 
 MainWindow::~MainWindow() {
+    // Stop the procedures and controllers before they are destroyed
+    m_control_thread->stop();
     // Delete global parameter manager
     delete g_pm;
 }
@@ -108,26 +117,30 @@ void MainWindow::keyPressEvent(QKeyEvent *e) {
         return;
     }
     m_controller->keyPressed(e->key());
+    Controller::Dir dir;
     switch (e->key()) {
         case Qt::Key_Up:
-            m_controller->move(Controller::Dir::UP);
+            dir = Controller::Dir::UP;
             break;
 
         case Qt::Key_Down:
-            m_controller->move(Controller::Dir::DOWN);
+            dir = Controller::Dir::DOWN;
             break;
 
         case Qt::Key_Right:
-            m_controller->move(Controller::Dir::RIGHT);
+            dir = Controller::Dir::RIGHT;
             break;
 
         case Qt::Key_Left:
-            m_controller->move(Controller::Dir::LEFT);
+            dir = Controller::Dir::LEFT;
             break;
 
         default:
-            break;
+            return;
     }
+    // Movements are sent from the control thread
+    std::shared_ptr<Controller> controller = m_controller;
+    m_control_thread->post([controller, dir] { controller->move(dir); });
 }
 
 void MainWindow::keyReleaseEvent(QKeyEvent *e) {
@@ -180,12 +193,14 @@ void MainWindow::clearLogOutput() {
 
 void MainWindow::invertControllerX() {
     log() << "Inverting X-axis";
-    m_controller->invert_x_axis();
+    std::shared_ptr<Controller> controller = m_controller;
+    m_control_thread->post([controller] { controller->invert_x_axis(); });
 }
 
 void MainWindow::invertControllerY() {
     log() << "Inverting Y-axis";
-    m_controller->invert_y_axis();
+    std::shared_ptr<Controller> controller = m_controller;
+    m_control_thread->post([controller] { controller->invert_y_axis(); });
 }
 
 std::weak_ptr<Controller> MainWindow::controller() const {
@@ -211,3 +226,7 @@ std::weak_ptr<GlobalSim> MainWindow::global_sim() const {
 CompetitionState &MainWindow::state() {
     return *m_compstate;
 }
+
+ControlThread &MainWindow::control_thread() {
+    return *m_control_thread;
+}
@@ -16,6 +16,7 @@ class ActionAbout;
 class CameraDisplay;
 class CompetitionState;
 class Controller;
+class ControlThread;
 class GlobalSim;
 class ParameterBox;
 class ScriptWindow;
@@ -48,6 +49,11 @@ public:
 
     CompetitionState &state();
 
+    /**
+     * @return the thread running the procedures and controller commands
+     */
+    ControlThread &control_thread();
+
 public Q_SLOTS:
 
     /**
@@ -98,6 +104,7 @@ private:
     std::unique_ptr<SerialBox> m_serial_box;
     std::unique_ptr<SimulatorWindow> m_simulator_window;
 
+    std::unique_ptr<ControlThread> m_control_thread;
     std::unique_ptr<CompetitionState> m_compstate;
 
     int m_controller_type;
@@ -4,12 +4,21 @@
 #include "parameterslot.h"
 #include "mainwindow.h"
 
+#include "../utility/logger.h"
+
+#include <QFileDialog>
+#include <QRegExp>
+#include <QTextStream>
+
+#include <algorithm>
+
 ParameterBox::ParameterBox(MainWindow *parent) :
     QDialog(parent),
     ui(new Ui::ParameterBox) {
     ui->setupUi(this);
 
     connect(ui->set_btn, &QPushButton::clicked, this, &ParameterBox::set_values);
+    connect(ui->load_btn, &QPushButton::clicked, this, &ParameterBox::choose_profile);
 }
 
 ParameterBox::~ParameterBox() {
@@ -33,3 +42,36 @@ void ParameterBox::remove_slot(weak_ref<ParameterSlot> &slot) {
     ui->layout->removeWidget(slot.get());
     if (it != m_slots.end()) { m_slots.erase(it); }
 }
+
+bool ParameterBox::load_profile(const QString &file_path) {
+    QFile profile(file_path);
+    if (!profile.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        fatal() << "Could not open parameter profile";
+        return false;
+    }
+    QTextStream in(&profile);
+    while (!in.atEnd()) {
+        QString line = in.readLine().trimmed();
+        if (line.isEmpty() || line.startsWith('#')) { continue; }
+        QStringList fields = line.split(QRegExp("\\s+"), QString::SkipEmptyParts);
+        if (fields.size() != 2) {
+            log() << "Malformed profile line: " << line;
+            continue;
+        }
+        auto it = std::find_if(m_slots.begin(), m_slots.end(), [&fields](const std::unique_ptr<ParameterSlot> &slot) {
+            return slot->name() == fields[0];
+        });
+        if (it == m_slots.end()) {
+            log() << "Unknown parameter in profile: " << fields[0];
+            continue;
+        }
+        (*it)->set_text(fields[1]);
+        (*it)->set_value();
+    }
+    return true;
+}
+
+void ParameterBox::choose_profile() {
+    QString file_path = QFileDialog::getOpenFileName(this, "Load Parameter Profile");
+    if (!file_path.isEmpty()) { load_profile(file_path); }
+}
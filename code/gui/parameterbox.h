@@ -27,6 +27,18 @@ public:
 
     void remove_slot(weak_ref<ParameterSlot> &slot);
 
+    /**
+     * Set parameters from a profile, such as one written by the
+     * autotuner. Each line holds a parameter name and its value, and
+     * lines starting with '#' are comments.
+     *
+     * @param file_path path of the profile
+     * @return false if the profile could not be read
+     */
+    bool load_profile(const QString &file_path);
+
+    Q_SLOT void choose_profile();
+
 protected:
     Q_SIGNAL void set_values();
 
@@ -19,6 +19,14 @@ ParameterSlot::ParameterSlot(
 
 #include <QDebug>
 
+QString ParameterSlot::name() const {
+    return ui->label->text();
+}
+
+void ParameterSlot::set_text(const QString &text) {
+    ui->edit->setText(text);
+}
+
 void ParameterSlot::set_value() {
     Q_EMIT value_set(QVariant::fromValue(ui->edit->text()));
 }
@@ -22,6 +22,13 @@ public:
 
     ~ParameterSlot() override;
 
+    QString name() const;
+
+    /**
+     * Replace the text of the value, which is set with set_value.
+     */
+    void set_text(const QString &text);
+
     Q_SLOT void set_value();
 
     Q_SIGNAL void value_set(const QVariant &value);
@@ -10,6 +10,7 @@
 #include <QSerialPortInfo>
 #include <QSlider>
 #include <QLineEdit>
+#include <QTimer>
 
 #include <iostream>
 #include <cassert>
@@ -115,20 +116,28 @@ SerialBox::~SerialBox() {
 
 void SerialBox::slider_changed(int value, int dir) {
     m_edit_boxes[dir]->setText(QString::number(value));
+    Solenoid::Direction direction;
     switch (dir) {
         case 0:
-            m_solenoid->change_power(value, Solenoid::UP);
+            direction = Solenoid::UP;
             break;
         case 1:
-            m_solenoid->change_power(value, Solenoid::DOWN);
+            direction = Solenoid::DOWN;
             break;
         case 2:
-            m_solenoid->change_power(value, Solenoid::LEFT);
+            direction = Solenoid::LEFT;
             break;
         case 3:
-            m_solenoid->change_power(value, Solenoid::RIGHT);
+            direction = Solenoid::RIGHT;
             break;
+        default:
+            return;
     }
+    // Run on the thread servicing the serial port
+    Solenoid *solenoid = m_solenoid.get();
+    QTimer::singleShot(0, solenoid, [solenoid, value, direction] {
+        solenoid->change_power(value, direction);
+    });
 }
 
 void SerialBox::up_slider_changed(int value) {
@@ -177,7 +186,10 @@ void SerialBox::attempt_connection() {
     auto baud_rate = static_cast<QSerialPort::BaudRate>(
         ui->baud_combo_box->currentData().toInt()
     );
-    m_solenoid->attempt_connection(serial_port, baud_rate);
+    Solenoid *solenoid = m_solenoid.get();
+    QTimer::singleShot(0, solenoid, [solenoid, serial_port, baud_rate] {
+        solenoid->attempt_connection(serial_port, baud_rate);
+    });
 }
 
 void SerialBox::update_status(int new_status) {
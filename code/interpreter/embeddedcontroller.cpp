@@ -1,4 +1,5 @@
 #include "../compstate/compstate.h"
+#include "../compstate/controlthread.h"
 #include "../controller/controller.h"
 #include "../gui/global.h"
 #include "../simulator/globalsim.h"
@@ -18,35 +19,34 @@ void EmbeddedController::bind_controller(std::shared_ptr<Controller> *controller
     this->m_controller_ptr = controller_ptr;
 }
 
+template<typename dir_t>
+static bool post_move(std::shared_ptr<Controller> *controller_ptr, dir_t dir) {
+    if (!controller_ptr || !*controller_ptr) { return false; }
+    // Movements are sent from the control thread
+    std::shared_ptr<Controller> controller = *controller_ptr;
+    Main::get()->control_thread().post([controller, dir] { controller->move(dir); });
+    return true;
+}
+
 bool EmbeddedController::send_movement(vector2i &move_vector) {
     // Forward movement to the currently selected controller
-    if (!m_controller_ptr || !*m_controller_ptr) { return false; }
-    (*m_controller_ptr)->move(move_vector);
-    return true;
+    return post_move(m_controller_ptr, move_vector);
 }
 
 bool EmbeddedController::move_up() {
-    if (!m_controller_ptr || !*m_controller_ptr) { return false; }
-    (*m_controller_ptr)->move(Controller::Dir::UP);
-    return true;
+    return post_move(m_controller_ptr, Controller::Dir::UP);
 }
 
 bool EmbeddedController::move_down() {
-    if (!m_controller_ptr || !*m_controller_ptr) { return false; }
-    (*m_controller_ptr)->move(Controller::Dir::DOWN);
-    return true;
+    return post_move(m_controller_ptr, Controller::Dir::DOWN);
 }
 
 bool EmbeddedController::move_right() {
-    if (!m_controller_ptr || !*m_controller_ptr) { return false; }
-    (*m_controller_ptr)->move(Controller::Dir::RIGHT);
-    return true;
+    return post_move(m_controller_ptr, Controller::Dir::RIGHT);
 }
 
 bool EmbeddedController::move_left() {
-    if (!m_controller_ptr || !*m_controller_ptr) { return false; }
-    (*m_controller_ptr)->move(Controller::Dir::LEFT);
-    return true;
+    return post_move(m_controller_ptr, Controller::Dir::LEFT);
 }
 
 PyObject *Embedded::emb_move(PyObject *, PyObject *args) {
@@ -80,41 +80,44 @@ PyObject *Embedded::emb_down(PyObject *, PyObject *) {
     return PyLong_FromLong(res);
 }
 
-PyObject *Embedded::emb_robot_rect(PyObject *, PyObject *) {
-    cv::Rect2d robot_rect = Main::get()->state().get_robot_box(false);
+/**
+ * @return a box of a state snapshot as a tuple of x, y, width and height
+ */
+static PyObject *rect_tuple(const double (&box)[4]) {
     PyObject *rect_tuple = PyTuple_New(4);
-    PyTuple_SetItem(rect_tuple, 0, PyFloat_FromDouble(robot_rect.x));
-    PyTuple_SetItem(rect_tuple, 1, PyFloat_FromDouble(robot_rect.y));
-    PyTuple_SetItem(rect_tuple, 2, PyFloat_FromDouble(robot_rect.width));
-    PyTuple_SetItem(rect_tuple, 3, PyFloat_FromDouble(robot_rect.height));
+    for (Py_ssize_t i = 0; i < 4; ++i) {
+        PyTuple_SetItem(rect_tuple, i, PyFloat_FromDouble(box[i]));
+    }
     return rect_tuple;
 }
 
+/**
+ * @return the center of a box of a state snapshot as a tuple
+ */
+static PyObject *center_tuple(const double (&box)[4]) {
+    PyObject *pos_tuple = PyTuple_New(2);
+    PyTuple_SetItem(pos_tuple, 0, PyFloat_FromDouble(box[0] + box[2] / 2));
+    PyTuple_SetItem(pos_tuple, 1, PyFloat_FromDouble(box[1] + box[3] / 2));
+    return pos_tuple;
+}
+
+// Scripts do not run on the control thread, so they read the boxes
+// through the snapshot it publishes
+
+PyObject *Embedded::emb_robot_rect(PyObject *, PyObject *) {
+    return rect_tuple(Main::get()->state().snapshot().robot);
+}
+
 PyObject *Embedded::emb_object_rect(PyObject *, PyObject *) {
-    cv::Rect object_rect = Main::get()->state().get_object_box(false);
-    PyObject *rect_tuple = PyTuple_New(4);
-    PyTuple_SetItem(rect_tuple, 0, PyFloat_FromDouble(object_rect.x));
-    PyTuple_SetItem(rect_tuple, 1, PyFloat_FromDouble(object_rect.y));
-    PyTuple_SetItem(rect_tuple, 2, PyFloat_FromDouble(object_rect.width));
-    PyTuple_SetItem(rect_tuple, 3, PyFloat_FromDouble(object_rect.height));
-    return rect_tuple;
+    return rect_tuple(Main::get()->state().snapshot().object);
 }
 
 PyObject *Embedded::emb_robot_pos(PyObject *, PyObject *) {
-    cv::Rect2d robot_rect = Main::get()->state().get_robot_box(false);
-    PyObject *pos_tuple = PyTuple_New(2);
-    PyTuple_SetItem(pos_tuple, 0, PyFloat_FromDouble(robot_rect.x + robot_rect.width / 2));
-    PyTuple_SetItem(pos_tuple, 1, PyFloat_FromDouble(robot_rect.y + robot_rect.height / 2));
-    return pos_tuple;
+    return center_tuple(Main::get()->state().snapshot().robot);
 }
 
-
 PyObject *Embedded::emb_object_pos(PyObject *, PyObject *) {
-    cv::Rect2d object_rect = Main::get()->state().get_robot_box(false);
-    PyObject *pos_tuple = PyTuple_New(2);
-    PyTuple_SetItem(pos_tuple, 0, PyFloat_FromDouble(object_rect.x + object_rect.width / 2));
-    PyTuple_SetItem(pos_tuple, 1, PyFloat_FromDouble(object_rect.y + object_rect.height / 2));
-    return pos_tuple;
+    return center_tuple(Main::get()->state().snapshot().object);
 }
 
 PyObject *Embedded::sim_reset(PyObject *, PyObject *) {
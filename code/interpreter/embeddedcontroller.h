@@ -35,7 +35,8 @@ public:
     // Set a controller as the active controller
     void bind_controller(std::shared_ptr<Controller> *controller_ptr);
 
-    // Send a movement to the active controller
+    // Send a movement to the active controller, in the direction of the
+    // vector and at full power, whatever the length of the vector
     bool send_movement(vector2i &move_vector);
 
     bool move_right();
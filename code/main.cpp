@@ -8,12 +8,18 @@
 Q_DECLARE_METATYPE(cv::Rect2d);
 Q_DECLARE_METATYPE(cv::UMat);
 Q_DECLARE_METATYPE(std::shared_ptr<CompetitionState::wall_arr>);
+Q_DECLARE_METATYPE(std::string);
+Q_DECLARE_METATYPE(std::chrono::steady_clock::time_point);
 
 int main(int argc, char *argv[]) {
     qRegisterMetaType<cv::UMat>();
     qRegisterMetaType<std::shared_ptr<CompetitionState::wall_arr>>();
     qRegisterMetaType<std::shared_ptr<VideoModifier>>();
     qRegisterMetaType<cv::Rect2d>();
+    // Serial messages are read on the control thread
+    qRegisterMetaType<std::string>();
+    // Frames are stamped with their capture time
+    qRegisterMetaType<std::chrono::steady_clock::time_point>("std::chrono::steady_clock::time_point");
 
     QApplication app(argc, argv);
 
@@ -0,0 +1,273 @@
+#include "autotuner.h"
+
+#include "../compstate/parammanager.h"
+#include "../utility/thread_pool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <future>
+#include <random>
+#include <type_traits>
+
+namespace {
+
+    /**
+     * A parameter of param_manager that the simulation exercises.
+     */
+    struct tunable {
+        const char *name;
+        bool integer;
+        void (*set)(param_manager &params, double value);
+        double (*get)(const param_manager &params);
+    };
+
+    void assign(volatile double &param, double value) {
+        param = value;
+    }
+
+    void assign(volatile int &param, double value) {
+        param = static_cast<int>(std::lround(value));
+    }
+
+}
+
+#define TUNABLE(paramName) {                                                                \
+    #paramName,                                                                             \
+    std::is_integral<std::remove_cv<decltype(param_manager::paramName)>::type>::value,     \
+    [](param_manager &p, double v) { assign(p.paramName, v); },                             \
+    [](const param_manager &p) -> double { return p.paramName; }                            \
+}
+
+// The timers and wall penalties are left out, as the simulation has
+// no watchdog and does not plan paths
+static const tunable s_tunables[] = {
+    TUNABLE(area_acq_r_sigma),
+    TUNABLE(control_law),
+    TUNABLE(pid_kp),
+    TUNABLE(pid_ki),
+    TUNABLE(pid_kd),
+    TUNABLE(pid_out_max),
+    TUNABLE(pid_i_max),
+    TUNABLE(objline_move_dev),
+    TUNABLE(objmove_algn_err),
+    TUNABLE(objproc_norm_dev),
+    TUNABLE(objproc_loc_acpt)
+};
+
+#undef TUNABLE
+
+enum {
+    // Smallest deviation of a dimension, in thousandths of its range
+    MIN_SIGMA_PERMILLE = 20
+};
+
+static const tunable *find_tunable(const std::string &name) {
+    for (const tunable &t : s_tunables) {
+        if (name == t.name) { return &t; }
+    }
+    return nullptr;
+}
+
+/**
+ * @return whether a candidate is better than another: feasible ones
+ *         first, then those failing fewer episodes, then the fastest
+ */
+static bool better(const AutoTuner::Candidate &a, const AutoTuner::Candidate &b) {
+    if (a.feasible != b.feasible) { return a.feasible; }
+    if (!a.feasible && a.failures != b.failures) { return a.failures < b.failures; }
+    return a.cost < b.cost;
+}
+
+static SimHarness::Result run_episode(
+    const std::vector<AutoTuner::Dimension> &dims,
+    const std::vector<double> &values,
+    const AutoTuner::Scenario &scenario,
+    SimHarness::Config config
+) {
+    config.robot = scenario.robot;
+    config.object = scenario.object;
+    SimHarness harness(config);
+    for (std::size_t i = 0; i < dims.size(); ++i) {
+        find_tunable(dims[i].name)->set(harness.params(), values[i]);
+    }
+    return scenario.object_move
+           ? harness.run_object_move(scenario.path)
+           : harness.run_traversal(scenario.path);
+}
+
+AutoTuner::AutoTuner() :
+    AutoTuner(Config()) {}
+
+AutoTuner::AutoTuner(const Config &config) :
+    m_config(config) {}
+
+AutoTuner::Config &AutoTuner::config() {
+    return m_config;
+}
+
+bool AutoTuner::add_dimension(const std::string &name, double lower, double upper) {
+    if (!is_tunable(name) || lower > upper) { return false; }
+    m_dims.push_back({name, lower, upper});
+    return true;
+}
+
+void AutoTuner::add_scenario(const Scenario &scenario) {
+    m_scenarios.push_back(scenario);
+}
+
+const std::vector<AutoTuner::Dimension> &AutoTuner::dimensions() const {
+    return m_dims;
+}
+
+const std::vector<AutoTuner::Scenario> &AutoTuner::scenarios() const {
+    return m_scenarios;
+}
+
+const std::vector<AutoTuner::Candidate> &AutoTuner::history() const {
+    return m_history;
+}
+
+bool AutoTuner::is_tunable(const std::string &name) {
+    return find_tunable(name) != nullptr;
+}
+
+void AutoTuner::use_defaults() {
+    // The PID gains are left out while the default law is bang-bang,
+    // and are tuned along with control_law fixed to PID
+    if (m_dims.empty()) {
+        add_dimension("objline_move_dev", 4.0, 20.0);
+        add_dimension("objmove_algn_err", 1.0, 6.0);
+        add_dimension("objproc_norm_dev", 2.0, 10.0);
+        add_dimension("objproc_loc_acpt", 1.5, 8.0);
+    }
+    if (m_scenarios.empty()) {
+        // Around a square, then an object pushed along both axes
+        add_scenario({false, {0.0, 0.0}, {200.0, 200.0}, {{60.0, 0.0}, {60.0, 60.0}, {0.0, 60.0}, {0.0, 0.0}}});
+        add_scenario({true, {-40.0, 0.0}, {40.0, 0.0}, {{100.0, 0.0}, {100.0, 40.0}}});
+    }
+}
+
+AutoTuner::Candidate AutoTuner::evaluate(const std::vector<double> &values) {
+    use_defaults();
+    return evaluate_all({values}).front();
+}
+
+std::vector<AutoTuner::Candidate> AutoTuner::evaluate_all(const std::vector<std::vector<double>> &values) {
+    nrg::thread_pool pool(m_config.threads);
+    std::vector<std::future<SimHarness::Result>> results;
+    for (const std::vector<double> &candidate : values) {
+        for (std::size_t s = 0; s < m_scenarios.size(); ++s) {
+            for (std::size_t k = 0; k < m_config.seeds; ++k) {
+                SimHarness::Config sim = m_config.sim;
+                sim.seed = static_cast<unsigned>(m_config.seed + s * m_config.seeds + k);
+                const Scenario &scenario = m_scenarios[s];
+                results.push_back(pool.submit([this, &candidate, &scenario, sim] {
+                    return run_episode(m_dims, candidate, scenario, sim);
+                }));
+            }
+        }
+    }
+
+    std::vector<Candidate> out;
+    auto it = results.begin();
+    for (const std::vector<double> &candidate : values) {
+        Candidate c{candidate, 0, 0, 0, false};
+        double total = 0;
+        for (std::size_t e = 0; e < m_scenarios.size() * m_config.seeds; ++e, ++it) {
+            SimHarness::Result r = it->get();
+            ++c.episodes;
+            if (!r.done || r.final_err > m_config.max_final_err) {
+                ++c.failures;
+                total += m_config.sim.timeout_ms;
+            } else {
+                total += r.time_ms;
+            }
+        }
+        c.cost = c.episodes ? total / c.episodes : 0;
+        c.feasible = c.failures <= m_config.max_failure * c.episodes;
+        out.push_back(std::move(c));
+    }
+    return out;
+}
+
+AutoTuner::Candidate AutoTuner::tune() {
+    use_defaults();
+    m_history.clear();
+    std::mt19937 gen(m_config.seed);
+    std::size_t n = m_dims.size();
+
+    // Start from the defaults and a uniform sample of the bounds
+    std::vector<std::vector<double>> samples;
+    {
+        SimHarness defaults;
+        std::vector<double> values;
+        for (const Dimension &dim : m_dims) {
+            double value = find_tunable(dim.name)->get(defaults.params());
+            values.push_back(std::max(dim.lower, std::min(dim.upper, value)));
+        }
+        samples.push_back(std::move(values));
+    }
+    while (samples.size() < std::max<std::size_t>(m_config.population, 1)) {
+        std::vector<double> values;
+        for (const Dimension &dim : m_dims) {
+            values.push_back(std::uniform_real_distribution<>(dim.lower, dim.upper)(gen));
+        }
+        samples.push_back(std::move(values));
+    }
+
+    Candidate best{};
+    for (std::size_t g = 0; g < m_config.generations; ++g) {
+        std::vector<Candidate> evaluated = evaluate_all(samples);
+        std::sort(evaluated.begin(), evaluated.end(), better);
+        m_history.push_back(evaluated.front());
+        if (g == 0 || better(evaluated.front(), best)) { best = evaluated.front(); }
+
+        // Log weights favour the better elites
+        std::size_t mu = std::max<std::size_t>(1, std::min(m_config.elites, evaluated.size()));
+        std::vector<double> weights;
+        double weight_sum = 0;
+        for (std::size_t i = 0; i < mu; ++i) {
+            weights.push_back(std::log(mu + 0.5) - std::log(i + 1.0));
+            weight_sum += weights.back();
+        }
+        std::vector<double> mean(n, 0);
+        std::vector<double> sigma(n, 0);
+        for (std::size_t j = 0; j < n; ++j) {
+            for (std::size_t i = 0; i < mu; ++i) {
+                mean[j] += weights[i] / weight_sum * evaluated[i].values[j];
+            }
+            for (std::size_t i = 0; i < mu; ++i) {
+                double d = evaluated[i].values[j] - mean[j];
+                sigma[j] += weights[i] / weight_sum * d * d;
+            }
+            double range = m_dims[j].upper - m_dims[j].lower;
+            sigma[j] = std::max(std::sqrt(sigma[j]), range * MIN_SIGMA_PERMILLE / 1000);
+        }
+
+        samples.assign(1, mean);
+        while (samples.size() < m_config.population) {
+            std::vector<double> values;
+            for (std::size_t j = 0; j < n; ++j) {
+                double value = std::normal_distribution<>(mean[j], sigma[j])(gen);
+                values.push_back(std::max(m_dims[j].lower, std::min(m_dims[j].upper, value)));
+            }
+            samples.push_back(std::move(values));
+        }
+    }
+    return best;
+}
+
+void AutoTuner::write_profile(std::ostream &out, const Candidate &candidate) const {
+    out << "# Parameter profile written by the autotuner\n";
+    out << "# Mean time " << candidate.cost << " ms, " << candidate.failures
+        << " of " << candidate.episodes << " episodes failed\n";
+    for (std::size_t i = 0; i < m_dims.size() && i < candidate.values.size(); ++i) {
+        out << m_dims[i].name << ' ';
+        if (find_tunable(m_dims[i].name)->integer) {
+            out << std::lround(candidate.values[i]);
+        } else {
+            out << candidate.values[i];
+        }
+        out << '\n';
+    }
+}
@@ -0,0 +1,142 @@
+#ifndef MINOTAUR_CPP_AUTOTUNER_H
+#define MINOTAUR_CPP_AUTOTUNER_H
+
+#include "simharness.h"
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/**
+ * Tunes the procedure parameters of param_manager against simulated
+ * episodes, minimising the time taken to finish them without failing.
+ *
+ * Each candidate is a value for every tuned parameter, and is run on
+ * every scenario with several tracker noise seeds, the episodes being
+ * spread across a thread pool with a SimHarness each. The first
+ * generation is drawn uniformly from the bounds, along with the
+ * current defaults. Each later generation is drawn from a normal
+ * distribution around the rank-weighted mean of the best candidates
+ * of the last, with a deviation per parameter estimated from them,
+ * like a separable CMA-ES without step size control. Every candidate
+ * is run with the same seeds, so candidates are compared on the same
+ * noise.
+ *
+ * The best candidate is written as a profile of "name value" lines,
+ * which ParameterBox loads.
+ */
+class AutoTuner {
+public:
+    struct Config {
+        std::size_t generations = 6;
+        std::size_t population = 16;
+        // Best candidates the next generation is drawn around
+        std::size_t elites = 4;
+        // Episodes of each scenario, with their own noise seeds
+        std::size_t seeds = 2;
+        // Fraction of episodes a candidate may fail
+        double max_failure = 0;
+        // Distance from the end of the path beyond which an episode
+        // that finished has failed
+        double max_final_err = 10;
+        // Worker threads, or zero for one per hardware thread
+        std::size_t threads = 0;
+        // Seed of the search, from which the episode seeds follow
+        unsigned seed = 0;
+        // Configuration of every episode, except the start positions
+        // and the seed
+        SimHarness::Config sim;
+    };
+
+    struct Dimension {
+        std::string name;
+        double lower;
+        double upper;
+    };
+
+    struct Scenario {
+        // Whether the object is pushed along the path, or else the
+        // robot traverses it
+        bool object_move;
+        vector2d robot;
+        vector2d object;
+        path2d path;
+    };
+
+    struct Candidate {
+        // Value of each dimension
+        std::vector<double> values;
+        // Mean virtual time of the episodes, failed ones counting as
+        // the timeout
+        double cost;
+        std::size_t failures;
+        std::size_t episodes;
+        // Whether no more episodes failed than allowed
+        bool feasible;
+    };
+
+    AutoTuner();
+    explicit AutoTuner(const Config &config);
+
+    Config &config();
+
+    /**
+     * Tune a parameter, instead of the default dimensions.
+     *
+     * @param name  name of the parameter in param_manager
+     * @param lower smallest value tried
+     * @param upper largest value tried
+     * @return false if the parameter cannot be tuned
+     */
+    bool add_dimension(const std::string &name, double lower, double upper);
+
+    /**
+     * Run a scenario in every evaluation, instead of the defaults.
+     */
+    void add_scenario(const Scenario &scenario);
+
+    const std::vector<Dimension> &dimensions() const;
+    const std::vector<Scenario> &scenarios() const;
+
+    /**
+     * Run the search.
+     *
+     * @return the best candidate found
+     */
+    Candidate tune();
+
+    /**
+     * Run every episode of a candidate.
+     *
+     * @param values value of each dimension
+     */
+    Candidate evaluate(const std::vector<double> &values);
+
+    /**
+     * @return the best candidate of each generation of the last search
+     */
+    const std::vector<Candidate> &history() const;
+
+    /**
+     * Write a candidate as a parameter profile.
+     */
+    void write_profile(std::ostream &out, const Candidate &candidate) const;
+
+    /**
+     * @return whether a parameter can be tuned
+     */
+    static bool is_tunable(const std::string &name);
+
+private:
+    void use_defaults();
+
+    std::vector<Candidate> evaluate_all(const std::vector<std::vector<double>> &values);
+
+    Config m_config;
+    std::vector<Dimension> m_dims;
+    std::vector<Scenario> m_scenarios;
+    std::vector<Candidate> m_history;
+};
+
+#endif //MINOTAUR_CPP_AUTOTUNER_H
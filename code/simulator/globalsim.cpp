@@ -20,31 +20,16 @@ void GlobalSim::robot_reset() {
     check_collide();
 }
 
-void GlobalSim::robot_right() {
-    // Right is +X
-    m_robot.x() += get_di();
-    m_robot.y() += get_dk();
-    check_collide();
-}
-
-void GlobalSim::robot_left() {
-    // Left is -X
-    m_robot.x() -= get_di();
-    m_robot.y() += get_dk();
-    check_collide();
-}
-
-void GlobalSim::robot_down() {
-    // Down is +Y
-    m_robot.y() += get_di();
-    m_robot.x() += get_dk();
-    check_collide();
-}
-
-void GlobalSim::robot_up() {
-    // Up is -Y
-    m_robot.y() -= get_di();
-    m_robot.x() += get_dk();
+void GlobalSim::robot_push(int dx, int dy, double power) {
+    double di = power * get_di();
+    double dk = power * get_dk();
+    if (dx != 0) {
+        m_robot.x() += dx > 0 ? di : -di;
+        m_robot.y() += dk;
+    } else if (dy != 0) {
+        m_robot.y() += dy > 0 ? di : -di;
+        m_robot.x() += dk;
+    }
     check_collide();
 }
 
@@ -20,10 +20,18 @@ public:
     GlobalSim();
 
     Q_SLOT void robot_reset();
-    Q_SLOT void robot_right();
-    Q_SLOT void robot_left();
-    Q_SLOT void robot_down();
-    Q_SLOT void robot_up();
+
+    /**
+     * Push the robot along an axis. A push of full power moves it
+     * between DELTA_PREF_MIN and DELTA_PREF_MAX along the axis, with up
+     * to DELTA_ERR of drift across it, and a weaker push moves it a
+     * shorter step.
+     *
+     * @param dx    sign of the push along X, or zero
+     * @param dy    sign of the push along Y, if there is none along X
+     * @param power power of the push, as a fraction of full power
+     */
+    Q_SLOT void robot_push(int dx, int dy, double power);
 
     vector2d &robot();
     vector2d &object();
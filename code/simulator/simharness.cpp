@@ -0,0 +1,194 @@
+#include "globalsim.h"
+#include "simharness.h"
+
+#include "../compstate/compstate.h"
+#include "../compstate/objectprocedure.h"
+#include "../compstate/parammanager.h"
+#include "../compstate/predictor.h"
+#include "../compstate/procedure.h"
+#include "../controller/controller.h"
+#include "../utility/random.h"
+
+#include <opencv2/core/types.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <deque>
+
+typedef std::chrono::steady_clock sim_clock;
+typedef std::chrono::duration<double, std::milli> millis;
+
+namespace {
+
+    /**
+     * Controller that moves the simulation directly, counting the
+     * commands it is sent.
+     */
+    class HarnessController : public Controller {
+    public:
+        explicit HarnessController(GlobalSim *sim) :
+            Controller(false, false),
+            m_sim(sim),
+            m_commands(0) {}
+
+        void __move_delegate(vector2i dir, int, int power) override {
+            ++m_commands;
+            power = std::max(0, std::min(power, static_cast<int>(MAX_POWER)));
+            m_sim->robot_push((dir.x() > 0) - (dir.x() < 0), (dir.y() > 0) - (dir.y() < 0),
+                              static_cast<double>(power) / MAX_POWER);
+        }
+
+        std::size_t commands() const {
+            return m_commands;
+        }
+
+    private:
+        GlobalSim *m_sim;
+        std::size_t m_commands;
+    };
+
+}
+
+static cv::Rect2d box_around(const vector2d &center, double width, double height, double noise) {
+    double x = center.x();
+    double y = center.y();
+    if (noise > 0) {
+        // Not kept between runs, as it caches values
+        std::normal_distribution<> dis(0, noise);
+        x += dis(rng::engine());
+        y += dis(rng::engine());
+    }
+    return {x - width / 2, y - height / 2, width, height};
+}
+
+static cv::Rect2d robot_box(const vector2d &center, double noise) {
+    double width = GlobalSim::Robot::WIDTH;
+    return box_around(center, width, width, noise);
+}
+
+static cv::Rect2d object_box(const vector2d &center, double noise) {
+    // Matches the collision box of the simulation
+    double width = GlobalSim::Robot::WIDTH;
+    return box_around(center, width * 3 / 2, width, noise);
+}
+
+/**
+ * @return the distance from a point to the nearest segment of a path
+ */
+static double path_distance(const vector2d &p, const path2d &path) {
+    double best = path.empty() ? 0 : (p - path.front()).norm();
+    for (std::size_t i = 1; i < path.size(); ++i) {
+        vector2d a = path[i - 1];
+        vector2d ab = path[i] - a;
+        double length_sq = ab.norm_sq();
+        double t = length_sq > 0 ? (p - a).dot(ab) / length_sq : 0;
+        t = std::max(0.0, std::min(1.0, t));
+        vector2d closest = a + ab * t;
+        best = std::min(best, (p - closest).norm());
+    }
+    return best;
+}
+
+SimHarness::SimHarness() :
+    SimHarness(Config()) {}
+
+SimHarness::SimHarness(const Config &config) :
+    m_config(config),
+    m_params(new param_manager(nullptr)) {
+    double width = GlobalSim::Robot::WIDTH;
+    m_params->robot_calib_area = width * width;
+    m_params->object_calib_area = width * width * 3 / 2;
+}
+
+SimHarness::~SimHarness() = default;
+
+SimHarness::Config &SimHarness::config() {
+    return m_config;
+}
+
+param_manager &SimHarness::params() {
+    return *m_params;
+}
+
+SimHarness::Result SimHarness::run_traversal(const path2d &path) {
+    path2d reference = {m_config.robot};
+    reference.insert(reference.end(), path.begin(), path.end());
+    return run<Procedure>(path, false, reference);
+}
+
+SimHarness::Result SimHarness::run_object_move(const path2d &path) {
+    // The object is pushed along x, then along y, to each node
+    path2d reference = {m_config.object};
+    for (const vector2d &node : path) {
+        reference.emplace_back(node.x(), reference.back().y());
+        reference.push_back(node);
+    }
+    return run<ObjectProcedure>(path, true, reference);
+}
+
+template<typename procedure_t>
+SimHarness::Result SimHarness::run(const path2d &path, bool track_object, const path2d &reference) {
+    auto wall_start = sim_clock::now();
+    rng::seed(m_config.seed);
+    GlobalSim sim;
+    sim.robot() = m_config.robot;
+    sim.object() = m_config.object;
+    auto controller = std::make_shared<HarnessController>(&sim);
+    CompetitionState state(nullptr, m_params.get());
+
+    // The virtual clock starts now, and only moves with the frames
+    sim_clock::time_point start = wall_start;
+    auto frame = std::chrono::duration_cast<sim_clock::duration>(millis(m_config.frame_ms));
+    auto latency = std::chrono::duration_cast<sim_clock::duration>(millis(m_config.latency_ms));
+    sim_clock::time_point now = start;
+    // Frames captured but not yet received
+    struct captured_frame {
+        sim_clock::time_point captured;
+        vector2d robot;
+        vector2d object;
+    };
+    // The bodies were at rest before the start
+    std::deque<captured_frame> pipeline{{now - latency, sim.robot(), sim.object()}};
+    auto feed = [&] {
+        pipeline.push_back({now, sim.robot(), sim.object()});
+        // Deliver the latest frame old enough to have come through
+        while (pipeline.size() > 1 && pipeline[1].captured + latency <= now) {
+            pipeline.pop_front();
+        }
+        const captured_frame &seen = pipeline.front();
+        if (seen.captured + latency > now) { return; }
+        state.receive_robot_box(robot_box(seen.robot, m_config.noise), seen.captured, now, now);
+        state.receive_object_box(object_box(seen.object, m_config.noise), seen.captured, now, now);
+    };
+
+    Result result{};
+    // The procedure sees the boxes of the first frame when created
+    feed();
+    procedure_t procedure(state, controller, path);
+    if (!m_config.flight_record.empty()) { state.start_recording(m_config.flight_record); }
+    procedure.start();
+    double total_err = 0;
+    while (!procedure.is_done() && millis(now - start).count() < m_config.timeout_ms) {
+        now += frame;
+        ++result.frames;
+        feed();
+        double err = path_distance(track_object ? sim.object() : sim.robot(), reference);
+        total_err += err;
+        result.max_path_err = std::max(result.max_path_err, err);
+    }
+    procedure.stop();
+    state.stop_recording();
+
+    const vector2d &end = track_object ? sim.object() : sim.robot();
+    result.done = procedure.is_done() && !procedure.is_failed();
+    result.time_ms = millis(now - start).count();
+    result.commands = controller->commands();
+    result.mean_path_err = result.frames ? total_err / result.frames : 0;
+    result.final_err = (end - reference.back()).norm();
+    result.wall_ms = millis(sim_clock::now() - wall_start).count();
+    const nrg::pose_predictor &predictor = track_object ? state.object_predictor() : state.robot_predictor();
+    result.prediction_err = predictor.prediction_err();
+    result.unpredicted_err = predictor.unpredicted_err();
+    return result;
+}
@@ -0,0 +1,112 @@
+#ifndef MINOTAUR_CPP_SIMHARNESS_H
+#define MINOTAUR_CPP_SIMHARNESS_H
+
+#include "../utility/vector.h"
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+class param_manager;
+typedef std::vector<nrg::vector<double>> path2d;
+
+/**
+ * Runs procedures against GlobalSim without a display or event loop,
+ * on a virtual clock. Each tracker frame places boxes around the robot
+ * and object of the simulation and hands them to a headless competition
+ * state, which ticks the procedure, and the commands it sends move the
+ * simulation at once. The boxes may show the simulation as it was some
+ * time ago, like a camera pipeline with latency. No time is spent
+ * waiting, so a run takes as long as its control ticks.
+ *
+ * Each harness has its own parameters, starting from the defaults
+ * calibrated to the boxes of the simulation, so harnesses on separate
+ * threads can run different parameters at once.
+ */
+class SimHarness {
+public:
+    struct Config {
+        // Virtual time between tracker frames
+        double frame_ms = 1000.0 / 30;
+        // Virtual time after which a run is given up
+        double timeout_ms = 120000;
+        // Standard deviation of the tracked box positions, in pixels
+        double noise = 0;
+        // Time from the capture of a frame to its box being received
+        double latency_ms = 0;
+        // Seed of the simulation and of the tracker noise
+        unsigned seed = 0;
+        // Starting centers of the robot and object
+        vector2d robot = {0.0, 0.0};
+        vector2d object = {40.0, 0.0};
+        // Flight log to record the control ticks to, or none if empty
+        std::string flight_record;
+    };
+
+    struct Result {
+        // Whether the procedure finished before the timeout, without
+        // failing
+        bool done;
+        // Virtual time from the start of the procedure to its end
+        double time_ms;
+        std::size_t frames;
+        // Movement commands sent to the controller
+        std::size_t commands;
+        // Distance of the moved body from the path on each frame
+        double mean_path_err;
+        double max_path_err;
+        // Distance of the moved body from the end of the path
+        double final_err;
+        // Real time taken by the run
+        double wall_ms;
+        // Mean error of the predicted position of the moved body, and
+        // of its last tracked position, at the time of a control tick
+        double prediction_err;
+        double unpredicted_err;
+    };
+
+    SimHarness();
+    explicit SimHarness(const Config &config);
+    ~SimHarness();
+
+    Config &config();
+
+    /**
+     * @return the parameters of the procedures run by the harness
+     */
+    param_manager &params();
+
+    /**
+     * Move the robot along a path with a Procedure.
+     *
+     * @param path nodes to traverse, after the starting position
+     * @return metrics of the run, with the path error of the robot
+     */
+    Result run_traversal(const path2d &path);
+
+    /**
+     * Push the object along a path with an ObjectProcedure, which moves
+     * it along each axis in turn.
+     *
+     * @param path nodes to push the object to
+     * @return metrics of the run, with the path error of the object
+     */
+    Result run_object_move(const path2d &path);
+
+private:
+    /**
+     * Run a procedure constructed from the path.
+     *
+     * @param path         path given to the procedure
+     * @param track_object whether the object, or else the robot, is moved
+     * @param reference    path from which the path error is measured
+     */
+    template<typename procedure_t>
+    Result run(const path2d &path, bool track_object, const path2d &reference);
+
+    Config m_config;
+    std::unique_ptr<param_manager> m_params;
+};
+
+#endif //MINOTAUR_CPP_SIMHARNESS_H
@@ -123,6 +123,42 @@ namespace algo {
         return tmax >= tmin;
     }
 
+    /**
+     * Determines whether a line segment, including its end points,
+     * touches an AABB. Unlike ray_aabb_intersect, the test is bounded
+     * to the segment and handles axis-aligned segments.
+     *
+     * @tparam val_t
+     * @param v
+     * @param aabb
+     * @return
+     */
+    template<typename val_t>
+    bool segment_aabb_intersect(const nrg::ray<val_t> &v, const nrg::rect<val_t> &aabb) {
+        double tmin = 0;
+        double tmax = 1;
+        double a[] = {static_cast<double>(v.a().x()), static_cast<double>(v.a().y())};
+        double d[] = {
+            static_cast<double>(v.b().x() - v.a().x()),
+            static_cast<double>(v.b().y() - v.a().y())
+        };
+        double lo[] = {static_cast<double>(aabb.tl().x()), static_cast<double>(aabb.tl().y())};
+        double hi[] = {static_cast<double>(aabb.br().x()), static_cast<double>(aabb.br().y())};
+        for (int i = 0; i < 2; ++i) {
+            if (d[i] == 0) {
+                // Parallel to this slab, so it must start inside it
+                if (a[i] < lo[i] || a[i] > hi[i]) { return false; }
+                continue;
+            }
+            double t1 = (lo[i] - a[i]) / d[i];
+            double t2 = (hi[i] - a[i]) / d[i];
+            tmin = std::max(tmin, std::min(t1, t2));
+            tmax = std::min(tmax, std::max(t1, t2));
+            if (tmax < tmin) { return false; }
+        }
+        return true;
+    }
+
     /**
      * Determines whether two AABBs are in collision.
      *
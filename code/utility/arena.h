@@ -0,0 +1,181 @@
+#ifndef MINOTAUR_CPP_ARENA_H
+#define MINOTAUR_CPP_ARENA_H
+
+#include <algorithm>
+#include <new>
+#include <vector>
+
+namespace nrg {
+
+    /**
+     * Bump allocator for scratch memory whose lifetime ends together.
+     * Allocations only advance a pointer and are never freed one at a
+     * time; reset() releases everything at once.
+     *
+     * When a query needs more than the current block, extra blocks are
+     * chained on. The next reset() replaces the chain with a single
+     * block large enough for the peak usage, so repeated queries of a
+     * similar size stop touching the heap.
+     */
+    class arena {
+    public:
+        enum {
+            DEFAULT_BLOCK = 64 * 1024
+        };
+
+        explicit arena(std::size_t initial = DEFAULT_BLOCK) :
+            m_used(0),
+            m_peak(0),
+            m_chained(0) {
+            add_block(initial);
+        }
+
+        ~arena() {
+            for (block &b : m_blocks) {
+                ::operator delete(b.data);
+            }
+        }
+
+        arena(const arena &) = delete;
+
+        arena &operator=(const arena &) = delete;
+
+        /**
+         * Allocate uninitialised memory.
+         *
+         * @param bytes size of the allocation
+         * @param align alignment, a power of two
+         * @return pointer to the memory
+         */
+        void *allocate(std::size_t bytes, std::size_t align) {
+            block &b = m_blocks.back();
+            std::size_t offset = (b.used + align - 1) & ~(align - 1);
+            if (offset + bytes > b.size) {
+                // Chain a block that fits the request on its own
+                add_block(std::max(bytes + align, 2 * b.size));
+                return allocate(bytes, align);
+            }
+            m_used += offset + bytes - b.used;
+            b.used = offset + bytes;
+            m_peak = std::max(m_peak, m_used);
+            return b.data + offset;
+        }
+
+        /**
+         * Allocate an uninitialised array.
+         *
+         * @tparam val_t trivially constructible element type
+         * @param n      number of elements
+         * @return pointer to the first element
+         */
+        template<typename val_t>
+        val_t *array(std::size_t n) {
+            return static_cast<val_t *>(allocate(n * sizeof(val_t), alignof(val_t)));
+        }
+
+        /**
+         * Release every allocation. Memory handed out before the
+         * reset must no longer be used.
+         */
+        void reset() {
+            if (m_blocks.size() > 1) {
+                std::size_t total = 0;
+                for (block &b : m_blocks) {
+                    total += b.size;
+                    ::operator delete(b.data);
+                }
+                m_blocks.clear();
+                add_block(std::max(total, m_peak));
+            }
+            m_blocks.back().used = 0;
+            m_used = 0;
+        }
+
+        /**
+         * @return bytes handed out since the last reset
+         */
+        std::size_t used() const {
+            return m_used;
+        }
+
+        /**
+         * @return largest number of bytes in use at once
+         */
+        std::size_t peak() const {
+            return m_peak;
+        }
+
+        /**
+         * @return number of times a block had to be chained on
+         */
+        std::size_t chained() const {
+            return m_chained;
+        }
+
+    private:
+        struct block {
+            char *data;
+            std::size_t size;
+            std::size_t used;
+        };
+
+        void add_block(std::size_t size) {
+            auto data = static_cast<char *>(::operator new(size));
+            if (!m_blocks.empty()) { ++m_chained; }
+            m_blocks.push_back({data, size, 0});
+        }
+
+        std::vector<block> m_blocks;
+        std::size_t m_used;
+        std::size_t m_peak;
+        std::size_t m_chained;
+    };
+
+    /**
+     * Standard allocator drawing from an arena, so that containers can
+     * hold scratch state. Deallocation does nothing; the memory comes
+     * back when the arena is reset.
+     *
+     * @tparam val_t
+     */
+    template<typename val_t>
+    class arena_allocator {
+    public:
+        typedef val_t value_type;
+
+        explicit arena_allocator(arena &a) :
+            m_arena(&a) {}
+
+        template<typename u_val_t>
+        arena_allocator(const arena_allocator<u_val_t> &o) :
+            m_arena(o.m_arena) {}
+
+        val_t *allocate(std::size_t n) {
+            return m_arena->template array<val_t>(n);
+        }
+
+        void deallocate(val_t *, std::size_t) {}
+
+        template<typename u_val_t>
+        bool operator==(const arena_allocator<u_val_t> &o) const {
+            return m_arena == o.m_arena;
+        }
+
+        template<typename u_val_t>
+        bool operator!=(const arena_allocator<u_val_t> &o) const {
+            return m_arena != o.m_arena;
+        }
+
+    private:
+        template<typename u_val_t>
+        friend class arena_allocator;
+
+        arena *m_arena;
+    };
+
+    template<typename val_t>
+    using arena_vector = std::vector<val_t, arena_allocator<val_t>>;
+
+}
+
+#endif //MINOTAUR_CPP_ARENA_H
@@ -86,6 +86,10 @@ public:
     }
 
     array2d<val_t, size_t> &operator=(array2d<val_t, size_t> &&arr) noexcept {
+        // Release the currently held array before taking the other
+        if (m_arr) {
+            delete_array();
+        }
         m_x = arr.m_x;
         m_y = arr.m_y;
         m_arr = arr.m_arr;
@@ -0,0 +1,201 @@
+#include "bit_grid.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+typedef nrg::bit_grid::word_t word_t;
+
+nrg::bit_grid::bit_grid(std::size_t x, std::size_t y) :
+    m_x(x),
+    m_y(y),
+    m_stride((y + WORD_BITS - 1) / WORD_BITS),
+    m_words(x * m_stride, 0) {}
+
+std::size_t nrg::bit_grid::x() const {
+    return m_x;
+}
+
+std::size_t nrg::bit_grid::y() const {
+    return m_y;
+}
+
+std::size_t nrg::bit_grid::stride() const {
+    return m_stride;
+}
+
+word_t *nrg::bit_grid::column(std::size_t x) {
+    return m_words.data() + x * m_stride;
+}
+
+const word_t *nrg::bit_grid::column(std::size_t x) const {
+    return m_words.data() + x * m_stride;
+}
+
+bool nrg::bit_grid::get(int x, int y) const {
+#ifndef NDEBUG
+    assert(x >= 0 && static_cast<std::size_t>(x) < m_x);
+    assert(y >= 0 && static_cast<std::size_t>(y) < m_y);
+#endif
+    return (column(static_cast<std::size_t>(x))[y / WORD_BITS] >> (y % WORD_BITS)) & 1u;
+}
+
+void nrg::bit_grid::set(int x, int y, bool occupied) {
+#ifndef NDEBUG
+    assert(x >= 0 && static_cast<std::size_t>(x) < m_x);
+    assert(y >= 0 && static_cast<std::size_t>(y) < m_y);
+#endif
+    word_t &word = column(static_cast<std::size_t>(x))[y / WORD_BITS];
+    word_t bit = static_cast<word_t>(1) << (y % WORD_BITS);
+    word = occupied ? word | bit : word & ~bit;
+}
+
+void nrg::bit_grid::clear() {
+    std::fill(m_words.begin(), m_words.end(), 0);
+}
+
+int nrg::bit_grid::lowest_bit(word_t bits) {
+#if defined(__GNUC__)
+    return __builtin_ctzll(bits);
+#else
+    int i = 0;
+    while (!(bits & 1u)) {
+        bits >>= 1;
+        ++i;
+    }
+    return i;
+#endif
+}
+
+int nrg::bit_grid::popcount(word_t bits) {
+#if defined(__GNUC__)
+    return __builtin_popcountll(bits);
+#else
+    bits = bits - ((bits >> 1) & 0x5555555555555555ull);
+    bits = (bits & 0x3333333333333333ull) + ((bits >> 2) & 0x3333333333333333ull);
+    bits = (bits + (bits >> 4)) & 0x0f0f0f0f0f0f0f0full;
+    return static_cast<int>((bits * 0x0101010101010101ull) >> 56);
+#endif
+}
+
+std::size_t nrg::bit_grid::count() const {
+    std::size_t n = 0;
+    for (word_t w : m_words) {
+        n += static_cast<std::size_t>(popcount(w));
+    }
+    return n;
+}
+
+int nrg::bit_grid::count_window(int x, int y, int radius) const {
+    int x0 = std::max(0, x - radius);
+    int x1 = std::min(static_cast<int>(m_x) - 1, x + radius);
+    int y0 = std::max(0, y - radius);
+    int y1 = std::min(static_cast<int>(m_y) - 1, y + radius);
+    if (x0 > x1 || y0 > y1) { return 0; }
+    int w0 = y0 / WORD_BITS;
+    int w1 = y1 / WORD_BITS;
+    // Masks of the bits from y0 in the first word and up to y1 in the last
+    word_t first = ~static_cast<word_t>(0) << (y0 % WORD_BITS);
+    word_t last = ~static_cast<word_t>(0) >> (WORD_BITS - 1 - y1 % WORD_BITS);
+    int n = 0;
+    for (int cx = x0; cx <= x1; ++cx) {
+        const word_t *col = column(static_cast<std::size_t>(cx));
+        for (int w = w0; w <= w1; ++w) {
+            word_t mask = ~static_cast<word_t>(0);
+            if (w == w0) { mask &= first; }
+            if (w == w1) { mask &= last; }
+            n += popcount(col[w] & mask);
+        }
+    }
+    return n;
+}
+
+int nrg::bit_grid::count_neighbors(int x, int y) const {
+    return count_window(x, y, 1) - get(x, y);
+}
+
+void nrg::bit_grid::shift_or(const word_t *src, word_t *dst, int shift) const {
+    auto n = static_cast<int>(m_stride);
+    int s = std::abs(shift);
+    int q = s / WORD_BITS;
+    int r = s % WORD_BITS;
+    for (int w = 0; w < n; ++w) {
+        // Cell y of src lands on cell y + shift of dst
+        int a = shift > 0 ? w - q : w + q;
+        int b = shift > 0 ? a - 1 : a + 1;
+        word_t hi = a >= 0 && a < n ? src[a] : 0;
+        word_t lo = r && b >= 0 && b < n ? src[b] : 0;
+        if (shift > 0) {
+            dst[w] |= (hi << r) | (r ? lo >> (WORD_BITS - r) : 0);
+        } else {
+            dst[w] |= (hi >> r) | (r ? lo << (WORD_BITS - r) : 0);
+        }
+    }
+}
+
+void nrg::bit_grid::mask_tails() {
+    int tail = static_cast<int>(m_y % WORD_BITS);
+    if (tail == 0) { return; }
+    word_t mask = (static_cast<word_t>(1) << tail) - 1;
+    for (std::size_t x = 0; x < m_x; ++x) {
+        column(x)[m_stride - 1] &= mask;
+    }
+}
+
+void nrg::bit_grid::complement() {
+    for (word_t &w : m_words) {
+        w = ~w;
+    }
+    mask_tails();
+}
+
+nrg::bit_grid nrg::bit_grid::dilated(int radius, footprint shape) const {
+    if (radius <= 0) { return *this; }
+    // Half widths along y of the footprint at each x offset
+    std::vector<int> width(static_cast<std::size_t>(radius) + 1, radius);
+    if (shape == DISC) {
+        for (int d = 0; d <= radius; ++d) {
+            width[d] = static_cast<int>(std::floor(std::sqrt(static_cast<double>(radius * radius - d * d))));
+        }
+    }
+    // Dilate every column along y once for each half width in use,
+    // growing the previous width by one shift in each direction
+    int widest = width[0];
+    std::vector<bit_grid> along_y(static_cast<std::size_t>(widest) + 1, *this);
+    for (int k = 1; k <= widest; ++k) {
+        bit_grid &cur = along_y[k];
+        cur = along_y[k - 1];
+        for (std::size_t x = 0; x < m_x; ++x) {
+            shift_or(column(x), cur.column(x), k);
+            shift_or(column(x), cur.column(x), -k);
+        }
+        cur.mask_tails();
+    }
+    // Then OR the neighbouring columns, each at its own width
+    bit_grid out(m_x, m_y);
+    auto nx = static_cast<int>(m_x);
+    for (int x = 0; x < nx; ++x) {
+        word_t *dst = out.column(static_cast<std::size_t>(x));
+        for (int dx = -radius; dx <= radius; ++dx) {
+            int sx = x + dx;
+            if (sx < 0 || sx >= nx) { continue; }
+            const word_t *src = along_y[width[std::abs(dx)]].column(static_cast<std::size_t>(sx));
+            for (std::size_t w = 0; w < m_stride; ++w) {
+                dst[w] |= src[w];
+            }
+        }
+    }
+    return out;
+}
+
+nrg::bit_grid nrg::bit_grid::eroded(int radius, footprint shape) const {
+    bit_grid open = *this;
+    open.complement();
+    bit_grid out = open.dilated(radius, shape);
+    out.complement();
+    return out;
+}
+
+bool nrg::bit_grid::operator==(const bit_grid &o) const {
+    return m_x == o.m_x && m_y == o.m_y && m_words == o.m_words;
+}
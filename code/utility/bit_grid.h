@@ -0,0 +1,170 @@
+#ifndef MINOTAUR_CPP_BIT_GRID_H
+#define MINOTAUR_CPP_BIT_GRID_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#ifndef NDEBUG
+#include <cassert>
+#endif
+
+namespace nrg {
+
+    /**
+     * Occupancy grid packed 64 cells to a word. Each column of the
+     * grid is a run of words along y, matching the column-major layout
+     * of array2d, so conversions walk memory in order.
+     *
+     * Morphology works on whole words: a column is dilated along y by
+     * shifting and OR-ing its words, and along x by OR-ing columns.
+     * Cells beyond the edge of the grid count as free when dilating and
+     * as occupied when eroding, so that erosion stays the dual of
+     * dilation.
+     */
+    class bit_grid {
+    public:
+        typedef std::uint64_t word_t;
+
+        enum {
+            WORD_BITS = 64
+        };
+
+        /**
+         * Shape of the structuring element of dilation and erosion.
+         */
+        enum footprint {
+            // All cells within the chessboard radius
+            SQUARE,
+            // All cells within the Euclidean radius
+            DISC
+        };
+
+        bit_grid(std::size_t x = 0, std::size_t y = 0);
+
+        /**
+         * Pack the cells of a grid that hold a value.
+         *
+         * @param grid  grid indexed as grid[x][y]
+         * @param value value of the occupied cells
+         * @return the occupancy of the grid
+         */
+        template<typename grid_t, typename val_t>
+        static bit_grid from_grid(grid_t &grid, const val_t &value) {
+            const int nx = static_cast<int>(grid.x());
+            const int ny = static_cast<int>(grid.y());
+            bit_grid bits(static_cast<std::size_t>(nx), static_cast<std::size_t>(ny));
+            for (int x = 0; x < nx; ++x) {
+                word_t *col = bits.column(static_cast<std::size_t>(x));
+                for (int y = 0; y < ny; ++y) {
+                    col[y / WORD_BITS] |= static_cast<word_t>(grid[x][y] == value) << (y % WORD_BITS);
+                }
+            }
+            return bits;
+        }
+
+        /**
+         * Write a value to every cell of a grid that is occupied here,
+         * leaving the other cells untouched.
+         *
+         * @param grid  grid of the same dimensions
+         * @param value value written to the occupied cells
+         */
+        template<typename grid_t, typename val_t>
+        void to_grid(grid_t &grid, const val_t &value) const {
+#ifndef NDEBUG
+            assert(static_cast<std::size_t>(grid.x()) == m_x);
+            assert(static_cast<std::size_t>(grid.y()) == m_y);
+#endif
+            const int nx = static_cast<int>(m_x);
+            for (int x = 0; x < nx; ++x) {
+                const word_t *col = column(static_cast<std::size_t>(x));
+                for (std::size_t w = 0; w < m_stride; ++w) {
+                    // Only visit the set bits of each word
+                    for (word_t bits = col[w]; bits; bits &= bits - 1) {
+                        int y = static_cast<int>(w * WORD_BITS + lowest_bit(bits));
+                        grid[x][y] = value;
+                    }
+                }
+            }
+        }
+
+        std::size_t x() const;
+
+        std::size_t y() const;
+
+        /**
+         * @return number of words in each column
+         */
+        std::size_t stride() const;
+
+        bool get(int x, int y) const;
+
+        void set(int x, int y, bool occupied);
+
+        void clear();
+
+        /**
+         * @return number of occupied cells
+         */
+        std::size_t count() const;
+
+        /**
+         * Count the occupied cells within a chessboard radius of a
+         * cell, including the cell itself.
+         *
+         * @param x      column of the cell
+         * @param y      row of the cell
+         * @param radius chessboard radius of the window
+         * @return number of occupied cells in the window
+         */
+        int count_window(int x, int y, int radius) const;
+
+        /**
+         * @return number of occupied cells among the 8 neighbours
+         */
+        int count_neighbors(int x, int y) const;
+
+        /**
+         * @param radius radius of the footprint in cells
+         * @param shape  shape of the footprint
+         * @return the cells whose footprint touches an occupied cell
+         */
+        bit_grid dilated(int radius, footprint shape = SQUARE) const;
+
+        /**
+         * @param radius radius of the footprint in cells
+         * @param shape  shape of the footprint
+         * @return the cells whose footprint is fully occupied
+         */
+        bit_grid eroded(int radius, footprint shape = SQUARE) const;
+
+        word_t *column(std::size_t x);
+
+        const word_t *column(std::size_t x) const;
+
+        bool operator==(const bit_grid &o) const;
+
+    private:
+        static int lowest_bit(word_t bits);
+
+        static int popcount(word_t bits);
+
+        /**
+         * OR a column into another, moved by a number of cells along y.
+         */
+        void shift_or(const word_t *src, word_t *dst, int shift) const;
+
+        void complement();
+
+        void mask_tails();
+
+        std::size_t m_x;
+        std::size_t m_y;
+        std::size_t m_stride;
+        std::vector<word_t> m_words;
+    };
+
+}
+
+#endif //MINOTAUR_CPP_BIT_GRID_H
@@ -0,0 +1,285 @@
+#include "flight_recorder.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+#include <istream>
+#include <ostream>
+#include <type_traits>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define FLIGHT_MAPPED
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+static_assert(std::is_trivially_copyable<nrg::flight_record>::value, "flight records are copied as bytes");
+static_assert((nrg::flight_recorder::CAPACITY & (nrg::flight_recorder::CAPACITY - 1)) == 0,
+              "ring capacity is a power of two");
+
+const char nrg::flight_recorder::MAGIC[8] = {'M', 'N', 'F', 'L', 'I', 'G', 'H', 'T'};
+
+static constexpr std::uint64_t MASK = nrg::flight_recorder::CAPACITY - 1;
+
+static std::uint64_t log_bytes(std::uint64_t records) {
+    return sizeof(nrg::flight_header) + records * sizeof(nrg::flight_record);
+}
+
+nrg::flight_recorder::flight_recorder() :
+    m_ring(new flight_record[CAPACITY]),
+    m_head(0),
+    m_tail(0),
+    m_seq(0),
+    m_dropped(0),
+    m_flushed(0),
+    m_open(false),
+    m_fd(-1),
+    m_map(nullptr),
+    m_mapped(0),
+    m_file(nullptr),
+    m_stop(false) {}
+
+nrg::flight_recorder::~flight_recorder() {
+    close();
+    wait();
+}
+
+bool nrg::flight_recorder::open(const std::string &path) {
+    close();
+    wait();
+    m_head.store(0, std::memory_order_relaxed);
+    m_tail.store(0, std::memory_order_relaxed);
+    m_seq.store(0, std::memory_order_relaxed);
+    m_dropped.store(0, std::memory_order_relaxed);
+    m_flushed.store(0, std::memory_order_relaxed);
+
+    flight_header header{};
+    std::memcpy(header.magic, MAGIC, sizeof(header.magic));
+    header.version = VERSION;
+    header.record_size = sizeof(flight_record);
+    header.count = 0;
+#ifdef FLIGHT_MAPPED
+    m_fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (m_fd < 0) { return false; }
+    if (!reserve(GROW_RECORDS)) {
+        ::close(m_fd);
+        m_fd = -1;
+        return false;
+    }
+    std::memcpy(m_map, &header, sizeof(header));
+#else
+    m_file = std::fopen(path.c_str(), "wb");
+    if (!m_file) { return false; }
+    if (std::fwrite(&header, sizeof(header), 1, m_file) != 1) {
+        std::fclose(m_file);
+        m_file = nullptr;
+        return false;
+    }
+#endif
+    m_path = path;
+    m_open = true;
+    m_stop = false;
+    m_thread = std::thread(&flight_recorder::run, this);
+    return true;
+}
+
+void nrg::flight_recorder::close() {
+    if (!m_open) { return; }
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_cv.notify_one();
+    m_open = false;
+}
+
+void nrg::flight_recorder::wait() {
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+}
+
+void nrg::flight_recorder::finish() {
+    write_count();
+#ifdef FLIGHT_MAPPED
+    if (m_map) {
+        msync(m_map, m_mapped, MS_SYNC);
+        munmap(m_map, m_mapped);
+        m_map = nullptr;
+        m_mapped = 0;
+    }
+    // The file was grown in steps, so the unused end is cut. If it
+    // cannot be, the count in the header still bounds the records
+    int cut = ftruncate(m_fd, static_cast<off_t>(log_bytes(m_flushed.load(std::memory_order_relaxed))));
+    (void) cut;
+    ::close(m_fd);
+    m_fd = -1;
+#else
+    std::fclose(m_file);
+    m_file = nullptr;
+#endif
+}
+
+bool nrg::flight_recorder::is_open() const {
+    return m_open;
+}
+
+bool nrg::flight_recorder::record(const flight_record &r) {
+    if (!m_open) { return false; }
+    std::uint64_t seq = m_seq.load(std::memory_order_relaxed);
+    m_seq.store(seq + 1, std::memory_order_relaxed);
+    std::uint64_t head = m_head.load(std::memory_order_relaxed);
+    if (head - m_tail.load(std::memory_order_acquire) > MASK) {
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    flight_record &slot = m_ring[head & MASK];
+    slot = r;
+    slot.seq = seq;
+    m_head.store(head + 1, std::memory_order_release);
+    return true;
+}
+
+std::uint64_t nrg::flight_recorder::recorded() const {
+    return m_seq.load(std::memory_order_relaxed);
+}
+
+std::uint64_t nrg::flight_recorder::dropped() const {
+    return m_dropped.load(std::memory_order_relaxed);
+}
+
+std::uint64_t nrg::flight_recorder::flushed() const {
+    return m_flushed.load(std::memory_order_relaxed);
+}
+
+const std::string &nrg::flight_recorder::path() const {
+    return m_path;
+}
+
+void nrg::flight_recorder::run() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (!m_stop) {
+        // The recording thread never signals, so it never makes a call
+        m_cv.wait_for(lock, std::chrono::milliseconds(FLUSH_MS));
+        lock.unlock();
+        drain();
+        lock.lock();
+    }
+    lock.unlock();
+    // The records queued before the close are the last ones
+    drain();
+    finish();
+}
+
+void nrg::flight_recorder::drain() {
+    std::uint64_t tail = m_tail.load(std::memory_order_relaxed);
+    std::uint64_t head = m_head.load(std::memory_order_acquire);
+    if (tail == head) { return; }
+    std::uint64_t count = m_flushed.load(std::memory_order_relaxed);
+    if (!reserve(count + (head - tail))) {
+        // Records that cannot be written are dropped to free the ring
+        m_dropped.fetch_add(head - tail, std::memory_order_relaxed);
+        m_tail.store(head, std::memory_order_release);
+        return;
+    }
+    for (; tail != head; ++tail, ++count) {
+        const flight_record &r = m_ring[tail & MASK];
+#ifdef FLIGHT_MAPPED
+        std::memcpy(m_map + log_bytes(count), &r, sizeof(r));
+#else
+        std::fwrite(&r, sizeof(r), 1, m_file);
+#endif
+    }
+    m_tail.store(head, std::memory_order_release);
+    m_flushed.store(count, std::memory_order_relaxed);
+    write_count();
+}
+
+bool nrg::flight_recorder::reserve(std::uint64_t records) {
+#ifdef FLIGHT_MAPPED
+    if (log_bytes(records) <= m_mapped) { return true; }
+    std::uint64_t steps = (records + GROW_RECORDS - 1) / GROW_RECORDS;
+    std::uint64_t size = log_bytes(steps * GROW_RECORDS);
+    if (m_map) {
+        munmap(m_map, m_mapped);
+        m_map = nullptr;
+        m_mapped = 0;
+    }
+    if (ftruncate(m_fd, static_cast<off_t>(size)) != 0) { return false; }
+    void *map = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0);
+    if (map == MAP_FAILED) { return false; }
+    m_map = static_cast<char *>(map);
+    m_mapped = size;
+    return true;
+#else
+    (void) records;
+    return m_file != nullptr;
+#endif
+}
+
+void nrg::flight_recorder::write_count() {
+    std::uint64_t count = m_flushed.load(std::memory_order_relaxed);
+#ifdef FLIGHT_MAPPED
+    if (!m_map) { return; }
+    std::memcpy(m_map + offsetof(flight_header, count), &count, sizeof(count));
+#else
+    std::fseek(m_file, offsetof(flight_header, count), SEEK_SET);
+    std::fwrite(&count, sizeof(count), 1, m_file);
+    std::fseek(m_file, 0, SEEK_END);
+    std::fflush(m_file);
+#endif
+}
+
+bool nrg::read_flight_log(std::istream &in, std::vector<flight_record> &records) {
+    flight_header header{};
+    if (!in.read(reinterpret_cast<char *>(&header), sizeof(header))) { return false; }
+    if (std::memcmp(header.magic, flight_recorder::MAGIC, sizeof(header.magic)) != 0
+        || header.version != flight_recorder::VERSION
+        || header.record_size != sizeof(flight_record)) {
+        return false;
+    }
+    records.clear();
+    flight_record r;
+    for (std::uint64_t i = 0; i < header.count && in.read(reinterpret_cast<char *>(&r), sizeof(r)); ++i) {
+        records.push_back(r);
+    }
+    return true;
+}
+
+/**
+ * @return the text of a fixed size field, which is not terminated if
+ *         it fills the field
+ */
+template<std::size_t N>
+static std::string field_text(const char (&field)[N]) {
+    return std::string(field, std::find(field, field + N, '\0'));
+}
+
+void nrg::write_flight_csv(std::ostream &out, const std::vector<flight_record> &records) {
+    out << "seq,captured_ms,received_ms,latency_ms,tick_ms,source,"
+           "robot_x,robot_y,robot_w,robot_h,object_x,object_y,object_w,object_h,"
+           "predicted_x,predicted_y,target_x,target_y,err,command_x,command_y,commands,"
+           "procedure,state\n";
+    if (records.empty()) { return; }
+    const double ms = 1e-6;
+    const std::int64_t t0 = records.front().received_ns;
+    char row[512];
+    for (const flight_record &r : records) {
+        std::snprintf(
+            row, sizeof(row),
+            "%llu,%.3f,%.3f,%.3f,%.3f,%s,"
+            "%.2f,%.2f,%.2f,%.2f,%.2f,%.2f,%.2f,%.2f,"
+            "%.2f,%.2f,%.2f,%.2f,%.2f,%.0f,%.0f,%u,",
+            static_cast<unsigned long long>(r.seq),
+            (r.captured_ns - t0) * ms, (r.received_ns - t0) * ms,
+            (r.received_ns - r.captured_ns) * ms, r.tick_ns * ms,
+            r.source == flight_record::ROBOT_BOX ? "robot" : "object",
+            r.robot[0], r.robot[1], r.robot[2], r.robot[3],
+            r.object[0], r.object[1], r.object[2], r.object[3],
+            r.predicted[0], r.predicted[1], r.target[0], r.target[1], r.err,
+            r.command[0], r.command[1], static_cast<unsigned>(r.commands));
+        out << row << field_text(r.procedure) << ',' << field_text(r.state) << '\n';
+    }
+}
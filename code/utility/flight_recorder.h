@@ -0,0 +1,204 @@
+#ifndef MINOTAUR_CPP_FLIGHT_RECORDER_H
+#define MINOTAUR_CPP_FLIGHT_RECORDER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <iosfwd>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace nrg {
+
+    /**
+     * What happened in one control tick. Records are copied as bytes
+     * into the log, so they hold no pointers, and the log is read back
+     * on a machine of the same byte order.
+     */
+    struct flight_record {
+        // Box whose arrival ran the tick
+        enum : std::uint8_t {
+            ROBOT_BOX,
+            OBJECT_BOX
+        };
+
+        // Count of ticks offered to the recorder, including dropped ones
+        std::uint64_t seq;
+        // Times on the control clock, in nanoseconds from its epoch
+        std::int64_t captured_ns;
+        std::int64_t received_ns;
+        // Time the procedures took to tick
+        std::int64_t tick_ns;
+        // Boxes as tracked, as x, y, width and height
+        float robot[4];
+        float object[4];
+        // Center the robot was predicted at for the commands of the tick
+        float predicted[2];
+        // Target of the innermost procedure and the error to it, which
+        // are not a number if it did not give them
+        float target[2];
+        float err;
+        // Sum of the unit directions of the commands sent
+        float command[2];
+        std::uint16_t commands;
+        std::uint8_t source;
+        std::uint8_t reserved;
+        // Innermost procedure to step last in the tick, and the state
+        // it stepped in
+        char procedure[16];
+        char state[32];
+    };
+
+    /**
+     * Start of a flight log, followed by count records.
+     */
+    struct flight_header {
+        char magic[8];
+        std::uint32_t version;
+        std::uint32_t record_size;
+        std::uint64_t count;
+    };
+
+    /**
+     * Records control ticks to a binary log with no locks or allocation
+     * on the recording thread. Records go into a ring buffer, and a
+     * flush thread copies them into the log file, which is mapped into
+     * memory where the platform allows. The header count is updated on
+     * each flush, so a log cut short by a crash is read up to the last
+     * flush.
+     *
+     * Only one thread may record. If the flush thread falls behind and
+     * the ring is full, records are dropped and counted, and show as
+     * gaps in their sequence numbers.
+     */
+    class flight_recorder {
+    public:
+        enum {
+            // Records held in the ring, a power of two
+            CAPACITY = 4096,
+            // Interval at which the flush thread wakes
+            FLUSH_MS = 100,
+            // Records by which the log file grows
+            GROW_RECORDS = 16384,
+            VERSION = 1
+        };
+
+        static const char MAGIC[8];
+
+        flight_recorder();
+
+        ~flight_recorder();
+
+        flight_recorder(const flight_recorder &) = delete;
+
+        flight_recorder &operator=(const flight_recorder &) = delete;
+
+        /**
+         * Start a new log, closing any open one and waiting for it to
+         * be written. Not to be called while another thread records.
+         *
+         * @param path file to write, replaced if it exists
+         * @return false if the file could not be created
+         */
+        bool open(const std::string &path);
+
+        /**
+         * Stop recording. The flush thread writes the remaining records
+         * and closes the log, so the caller does not wait on the file.
+         */
+        void close();
+
+        /**
+         * Block until the log closed last has been written and closed.
+         */
+        void wait();
+
+        bool is_open() const;
+
+        /**
+         * Queue a record, whose sequence number is assigned.
+         *
+         * @return false if the ring was full and the record dropped
+         */
+        bool record(const flight_record &r);
+
+        /**
+         * @return records offered, and those of them dropped, since the
+         *         log was opened
+         */
+        std::uint64_t recorded() const;
+        std::uint64_t dropped() const;
+
+        /**
+         * @return records in the log file as of the last flush
+         */
+        std::uint64_t flushed() const;
+
+        const std::string &path() const;
+
+    private:
+        void run();
+
+        /**
+         * Copy the queued records into the log.
+         */
+        void drain();
+
+        /**
+         * Make room in the log for a number of records.
+         */
+        bool reserve(std::uint64_t records);
+
+        void write_count();
+
+        /**
+         * Write the final count and close the log file.
+         */
+        void finish();
+
+        std::unique_ptr<flight_record[]> m_ring;
+        // Written by the recording thread
+        std::atomic<std::uint64_t> m_head;
+        // Written by the flush thread
+        std::atomic<std::uint64_t> m_tail;
+        std::atomic<std::uint64_t> m_seq;
+        std::atomic<std::uint64_t> m_dropped;
+        std::atomic<std::uint64_t> m_flushed;
+
+        std::string m_path;
+        bool m_open;
+        // Log file, mapped or written through a stream
+        int m_fd;
+        char *m_map;
+        std::uint64_t m_mapped;
+        std::FILE *m_file;
+
+        std::mutex m_mutex;
+        std::condition_variable m_cv;
+        bool m_stop;
+        std::thread m_thread;
+    };
+
+    /**
+     * Read a flight log. A log cut short is read up to its last whole
+     * record.
+     *
+     * @param in      stream of the log, opened in binary mode
+     * @param records receives the records
+     * @return false if the stream is not a flight log of this version
+     */
+    bool read_flight_log(std::istream &in, std::vector<flight_record> &records);
+
+    /**
+     * Write records as CSV with a header row, with times in
+     * milliseconds from the first record received.
+     */
+    void write_flight_csv(std::ostream &out, const std::vector<flight_record> &records);
+
+}
+
+#endif //MINOTAUR_CPP_FLIGHT_RECORDER_H
@@ -1,9 +1,11 @@
 #ifndef MINOTAUR_CPP_GRAPH2D_H
 #define MINOTAUR_CPP_GRAPH2D_H
 
-#include <unordered_map>
-#include <unordered_set>
+#include <algorithm>
+#include <limits>
+#include <vector>
 
+#include "indexed_heap.h"
 #include "vector.h"
 
 namespace nrg {
@@ -37,8 +39,15 @@ namespace nrg {
     };
 
     /**
-     * Basic graph implementation on a two dimensional coordinate
-     * system, where each node occupies a point in a plane.
+     * Graph on a two dimensional coordinate system, where each node
+     * occupies a point in a plane.
+     *
+     * Edges are collected as they are connected and packed into
+     * compressed sparse rows the first time they are needed, and the
+     * search keeps its scores and parents in vectors indexed by node
+     * id with an indexed heap for the open set, so graphs with
+     * thousands of nodes, such as visibility graphs and roadmaps, are
+     * cheap to search.
      *
      * @tparam val_t
      */
@@ -47,6 +56,32 @@ namespace nrg {
     public:
         typedef typename node2d<val_t>::id_t id_t;
 
+        /**
+         * Neighbours of a node, as a range over the packed rows.
+         */
+        class id_range {
+        public:
+            id_range(const id_t *first, const id_t *last) :
+                m_first(first),
+                m_last(last) {}
+
+            const id_t *begin() const {
+                return m_first;
+            }
+
+            const id_t *end() const {
+                return m_last;
+            }
+
+            std::size_t size() const {
+                return static_cast<std::size_t>(m_last - m_first);
+            }
+
+        private:
+            const id_t *m_first;
+            const id_t *m_last;
+        };
+
         static nrg::path<val_t> to_path(const std::vector<node2d<val_t>> &node_path) {
             nrg::path<val_t> path;
             for (const node2d<val_t> &node : node_path) {
@@ -56,33 +91,8 @@ namespace nrg {
         }
 
     private:
-        typedef std::unordered_set<id_t> id_set;
         typedef std::vector<node2d<val_t>> node_list;
-        typedef std::unordered_map<id_t, id_set> connection_map;
-        typedef std::unordered_map<id_t, id_t> id_map;
-        typedef std::unordered_map<id_t, val_t> score_map;
-
-        static id_t node_min_fscore(
-            const id_set &open_set,
-            const score_map &f_scores
-        ) {
-            // Linear to find the best node but graph2d is meant for small
-            // applications (less than 20 nodes), can make the open_set an
-            // ordered map on f_score if really needed
-            id_t min_id = *open_set.begin();
-            for (const id_t &id : open_set) {
-                if (score_of(id, f_scores) < score_of(min_id, f_scores)) { min_id = id; }
-            }
-            return min_id;
-        }
-
-        static val_t score_of(
-            const id_t &id,
-            const score_map &scores
-        ) {
-            auto it = scores.find(id);
-            return it == scores.end() ? std::numeric_limits<val_t>::max() : it->second;
-        }
+        typedef std::pair<id_t, id_t> edge;
 
         static val_t dist(
             const node2d<val_t> &n0,
@@ -92,58 +102,106 @@ namespace nrg {
         }
 
     public:
+        graph2d() :
+            m_packed(true) {}
+
         const node2d<val_t> &add_node(const vector<val_t> &coord) {
             id_t id = m_nodes.size();
             m_nodes.emplace_back(id, coord);
+            m_packed = false;
             return m_nodes[id];
         }
 
         void connect(const node2d<val_t> &n0, const node2d<val_t> &n1) {
-            m_connections[n0.id()].insert(n1.id());
-            m_connections[n1.id()].insert(n0.id());
+            m_edges.emplace_back(n0.id(), n1.id());
+            m_edges.emplace_back(n1.id(), n0.id());
+            m_packed = false;
+        }
+
+        /**
+         * Reserve space ahead of a bulk build.
+         *
+         * @param nodes expected number of nodes
+         * @param edges expected number of undirected edges
+         */
+        void reserve(std::size_t nodes, std::size_t edges) {
+            m_nodes.reserve(nodes);
+            m_edges.reserve(2 * edges);
+        }
+
+        std::size_t size() const {
+            return m_nodes.size();
         }
 
         std::vector<node2d<val_t>> astar(const node2d<val_t> &start, const node2d<val_t> &end) const {
-            id_set closed_set;
-            id_set open_set;
-            id_map came_from;
-            score_map g_scores;
-            score_map f_scores;
-            open_set.insert(start.id());
+            pack();
+            std::size_t n = m_nodes.size();
+            std::vector<val_t> g_scores(n, std::numeric_limits<val_t>::max());
+            std::vector<id_t> came_from(n, NO_PARENT);
+            std::vector<bool> closed(n, false);
+            indexed_heap<val_t> open_set(n);
             g_scores[start.id()] = 0;
-            f_scores[start.id()] = dist(start, end);
+            open_set.push(start.id(), dist(start, end));
             while (!open_set.empty()) {
-                id_t current = node_min_fscore(open_set, f_scores);
+                id_t current = open_set.pop();
                 if (current == end.id()) {
                     return reconstruct_path(came_from, current);
                 }
-                open_set.erase(current);
-                closed_set.insert(current);
-                for (const id_t &nb : m_connections.at(current)) {
-                    if (closed_set.find(nb) != closed_set.end()) { continue; }
-                    if (open_set.find(nb) == open_set.end()) { open_set.insert(nb); }
-                    val_t tentative = score_of(current, g_scores) + dist(m_nodes[current], m_nodes[nb]);
-                    if (tentative >= score_of(nb, g_scores)) { continue; }
+                closed[current] = true;
+                for (const id_t &nb : neighbors(current)) {
+                    if (closed[nb]) { continue; }
+                    val_t tentative = g_scores[current] + dist(m_nodes[current], m_nodes[nb]);
+                    if (tentative >= g_scores[nb]) { continue; }
                     came_from[nb] = current;
                     g_scores[nb] = tentative;
-                    f_scores[nb] = tentative + dist(m_nodes[nb], end);
+                    open_set.push(nb, tentative + dist(m_nodes[nb], end));
                 }
             }
             return {};
         }
 
-        const id_set &connections_of(const node2d<val_t> &node) {
-            return m_connections.at(node.id());
+        id_range connections_of(const node2d<val_t> &node) {
+            pack();
+            return neighbors(node.id());
         }
 
     private:
+        static constexpr id_t NO_PARENT = std::numeric_limits<id_t>::max();
+
+        /**
+         * Sort the collected edges into compressed sparse rows,
+         * dropping duplicates. Rows are rebuilt only after the graph
+         * has changed, and the graph must not change while another
+         * thread searches it.
+         */
+        void pack() const {
+            if (m_packed) { return; }
+            std::sort(m_edges.begin(), m_edges.end());
+            m_edges.erase(std::unique(m_edges.begin(), m_edges.end()), m_edges.end());
+            m_offsets.assign(m_nodes.size() + 1, 0);
+            m_targets.resize(m_edges.size());
+            for (std::size_t i = 0; i < m_edges.size(); ++i) {
+                ++m_offsets[m_edges[i].first + 1];
+                m_targets[i] = m_edges[i].second;
+            }
+            for (std::size_t i = 1; i < m_offsets.size(); ++i) {
+                m_offsets[i] += m_offsets[i - 1];
+            }
+            m_packed = true;
+        }
+
+        id_range neighbors(id_t id) const {
+            const id_t *base = m_targets.data();
+            return {base + m_offsets[id], base + m_offsets[id + 1]};
+        }
+
         std::vector<node2d<val_t>> reconstruct_path(
-            const id_map &came_from,
+            const std::vector<id_t> &came_from,
             id_t current
         ) const {
             std::vector<node2d<val_t>> path = {m_nodes[current]};
-            while (came_from.find(current) != came_from.end()) {
-                current = came_from.at(current);
+            while (came_from[current] != NO_PARENT) {
+                current = came_from[current];
                 path.push_back(m_nodes[current]);
             }
             std::reverse(path.begin(), path.end());
@@ -151,9 +209,17 @@ namespace nrg {
         }
 
         node_list m_nodes;
-        connection_map m_connections;
+
+        // Edges in both directions, kept sorted once packed
+        mutable std::vector<edge> m_edges;
+        mutable std::vector<std::size_t> m_offsets;
+        mutable std::vector<id_t> m_targets;
+        mutable bool m_packed;
     };
 
+    template<typename val_t>
+    constexpr typename graph2d<val_t>::id_t graph2d<val_t>::NO_PARENT;
+
 }
 
 #endif //MINOTAUR_CPP_GRAPH2D_H
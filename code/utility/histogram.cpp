@@ -0,0 +1,101 @@
+#include "histogram.h"
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+
+nrg::histogram::histogram(double width, std::size_t buckets) :
+    m_width(width),
+    m_buckets(buckets + 1, 0),
+    m_count(0),
+    m_min(0),
+    m_max(0),
+    m_total(0) {}
+
+void nrg::histogram::add(double sample) {
+    sample = std::max(0.0, sample);
+    std::size_t last = m_buckets.size() - 1;
+    double i = std::floor(sample / m_width);
+    ++m_buckets[i < static_cast<double>(last) ? static_cast<std::size_t>(i) : last];
+    m_min = m_count ? std::min(m_min, sample) : sample;
+    m_max = m_count ? std::max(m_max, sample) : sample;
+    m_total += sample;
+    ++m_count;
+}
+
+void nrg::histogram::clear() {
+    std::fill(m_buckets.begin(), m_buckets.end(), 0);
+    m_count = 0;
+    m_min = 0;
+    m_max = 0;
+    m_total = 0;
+}
+
+std::size_t nrg::histogram::count() const {
+    return m_count;
+}
+
+double nrg::histogram::min() const {
+    return m_min;
+}
+
+double nrg::histogram::max() const {
+    return m_max;
+}
+
+double nrg::histogram::mean() const {
+    return m_count ? m_total / m_count : 0;
+}
+
+double nrg::histogram::width() const {
+    return m_width;
+}
+
+std::size_t nrg::histogram::size() const {
+    return m_buckets.size();
+}
+
+std::size_t nrg::histogram::bucket(std::size_t i) const {
+    return m_buckets[i];
+}
+
+std::size_t nrg::histogram::overflow() const {
+    return m_buckets.back();
+}
+
+double nrg::histogram::percentile(double p) const {
+    if (!m_count) { return 0; }
+    // Rank of the sample at the percentile, counting from one
+    auto rank = static_cast<std::size_t>(std::ceil(p / 100 * m_count));
+    rank = std::max<std::size_t>(rank, 1);
+    std::size_t seen = 0;
+    std::size_t last = m_buckets.size() - 1;
+    for (std::size_t i = 0; i < last; ++i) {
+        seen += m_buckets[i];
+        if (seen >= rank) {
+            return std::min(m_max, (i + 1) * m_width);
+        }
+    }
+    return m_max;
+}
+
+std::vector<std::string> nrg::histogram::rows(std::size_t bar_width) const {
+    std::vector<std::string> out;
+    std::size_t fullest = *std::max_element(m_buckets.begin(), m_buckets.end());
+    std::size_t last = m_buckets.size() - 1;
+    for (std::size_t i = 0; i < m_buckets.size(); ++i) {
+        if (!m_buckets[i]) { continue; }
+        std::stringstream ss;
+        ss.width(4);
+        ss << i * m_width;
+        if (i < last) {
+            ss << '-' << (i + 1) * m_width;
+        } else {
+            ss << '+';
+        }
+        ss << ": " << m_buckets[i] << ' '
+           << std::string((m_buckets[i] * bar_width + fullest - 1) / fullest, '#');
+        out.push_back(ss.str());
+    }
+    return out;
+}
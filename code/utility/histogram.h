@@ -0,0 +1,83 @@
+#ifndef MINOTAUR_CPP_HISTOGRAM_H
+#define MINOTAUR_CPP_HISTOGRAM_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace nrg {
+
+    /**
+     * Histogram of non-negative samples in buckets of equal width from
+     * zero, with a final bucket for samples beyond the last one. The
+     * exact minimum, maximum and mean are kept alongside.
+     */
+    class histogram {
+    public:
+        /**
+         * @param width   width of each bucket
+         * @param buckets number of buckets before the overflow bucket
+         */
+        explicit histogram(double width = 1, std::size_t buckets = 100);
+
+        void add(double sample);
+
+        void clear();
+
+        /**
+         * @return number of samples added
+         */
+        std::size_t count() const;
+
+        double min() const;
+        double max() const;
+        double mean() const;
+
+        double width() const;
+
+        /**
+         * @return number of buckets, including the overflow bucket
+         */
+        std::size_t size() const;
+
+        /**
+         * @param i bucket index, where size() - 1 is the overflow bucket
+         * @return number of samples in the bucket
+         */
+        std::size_t bucket(std::size_t i) const;
+
+        /**
+         * @return number of samples beyond the last bucket
+         */
+        std::size_t overflow() const;
+
+        /**
+         * Estimate a percentile as the upper edge of the bucket in which
+         * it falls, or the maximum if it falls in the overflow bucket.
+         *
+         * @param p percentile in [0, 100]
+         * @return the estimate, or zero if there are no samples
+         */
+        double percentile(double p) const;
+
+        /**
+         * Render the non-empty buckets as rows of a bar chart, such as
+         * "  12-13: 40 ########".
+         *
+         * @param bar_width length of the bar of the fullest bucket
+         * @return one row for each non-empty bucket
+         */
+        std::vector<std::string> rows(std::size_t bar_width = 40) const;
+
+    private:
+        double m_width;
+        std::vector<std::size_t> m_buckets;
+        std::size_t m_count;
+        double m_min;
+        double m_max;
+        double m_total;
+    };
+
+}
+
+#endif //MINOTAUR_CPP_HISTOGRAM_H
@@ -0,0 +1,157 @@
+#ifndef MINOTAUR_CPP_INDEXED_HEAP_H
+#define MINOTAUR_CPP_INDEXED_HEAP_H
+
+#include <limits>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#ifndef NDEBUG
+#include <cassert>
+#endif
+
+namespace nrg {
+
+    /**
+     * Binary min-heap over dense ids in [0, capacity). The position of
+     * each id in the heap is tracked, so keys can be lowered in place
+     * instead of pushing duplicate entries, and the heap never holds
+     * more entries than its capacity.
+     *
+     * @tparam key_t
+     * @tparam alloc_t allocator for the heap storage
+     */
+    template<typename key_t, typename alloc_t = std::allocator<key_t>>
+    class indexed_heap {
+    public:
+        typedef std::size_t id_t;
+
+        explicit indexed_heap(std::size_t capacity = 0, const alloc_t &alloc = alloc_t()) :
+            m_heap(entry_alloc(alloc)),
+            m_pos(capacity, NONE, pos_alloc(alloc)) {
+            m_heap.reserve(capacity);
+        }
+
+        /**
+         * Empty the heap and allow ids up to a new capacity.
+         *
+         * @param capacity
+         */
+        void reset(std::size_t capacity) {
+            m_heap.clear();
+            m_heap.reserve(capacity);
+            m_pos.assign(capacity, NONE);
+        }
+
+        bool empty() const {
+            return m_heap.empty();
+        }
+
+        std::size_t size() const {
+            return m_heap.size();
+        }
+
+        bool contains(id_t id) const {
+            return m_pos[id] != NONE;
+        }
+
+        /**
+         * Insert an id, or lower its key if it is already in the
+         * heap. A higher key for a contained id is ignored.
+         *
+         * @param id
+         * @param key
+         * @return true if the heap changed
+         */
+        bool push(id_t id, const key_t &key) {
+#ifndef NDEBUG
+            assert(id < m_pos.size());
+#endif
+            std::size_t i = m_pos[id];
+            if (i == NONE) {
+                i = m_heap.size();
+                m_heap.emplace_back(key, id);
+                m_pos[id] = i;
+            } else if (key < m_heap[i].first) {
+                m_heap[i].first = key;
+            } else {
+                return false;
+            }
+            sift_up(i);
+            return true;
+        }
+
+        id_t top() const {
+            return m_heap.front().second;
+        }
+
+        const key_t &top_key() const {
+            return m_heap.front().first;
+        }
+
+        /**
+         * Remove the id with the least key.
+         *
+         * @return the removed id
+         */
+        id_t pop() {
+            id_t id = m_heap.front().second;
+            m_pos[id] = NONE;
+            if (m_heap.size() > 1) {
+                m_heap.front() = m_heap.back();
+                m_pos[m_heap.front().second] = 0;
+                m_heap.pop_back();
+                sift_down(0);
+            } else {
+                m_heap.pop_back();
+            }
+            return id;
+        }
+
+    private:
+        typedef std::pair<key_t, id_t> entry;
+        typedef typename std::allocator_traits<alloc_t>::template rebind_alloc<entry> entry_alloc;
+        typedef typename std::allocator_traits<alloc_t>::template rebind_alloc<std::size_t> pos_alloc;
+
+        static constexpr std::size_t NONE = std::numeric_limits<std::size_t>::max();
+
+        void place(std::size_t i, const entry &e) {
+            m_heap[i] = e;
+            m_pos[e.second] = i;
+        }
+
+        void sift_up(std::size_t i) {
+            entry e = m_heap[i];
+            while (i > 0) {
+                std::size_t parent = (i - 1) / 2;
+                if (!(e.first < m_heap[parent].first)) { break; }
+                place(i, m_heap[parent]);
+                i = parent;
+            }
+            place(i, e);
+        }
+
+        void sift_down(std::size_t i) {
+            entry e = m_heap[i];
+            std::size_t n = m_heap.size();
+            for (;;) {
+                std::size_t child = 2 * i + 1;
+                if (child >= n) { break; }
+                if (child + 1 < n && m_heap[child + 1].first < m_heap[child].first) { ++child; }
+                if (!(m_heap[child].first < e.first)) { break; }
+                place(i, m_heap[child]);
+                i = child;
+            }
+            place(i, e);
+        }
+
+        std::vector<entry, entry_alloc> m_heap;
+        std::vector<std::size_t, pos_alloc> m_pos;
+    };
+
+    template<typename key_t, typename alloc_t>
+    constexpr std::size_t indexed_heap<key_t, alloc_t>::NONE;
+
+}
+
+#endif //MINOTAUR_CPP_INDEXED_HEAP_H
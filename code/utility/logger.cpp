@@ -1,4 +1,5 @@
 #include "logger.h"
+#include <QMetaObject>
 #include <QString>
 #include <QTextEdit>
 #include <fstream>
@@ -27,6 +28,7 @@ bool Logger::log(const QString &message, LogType type) {
 Logger Logger::s_logger;
 
 bool Logger::log_message(const std::string &message, LogType type) {
+    if (m_silent) { return false; }
     std::stringstream ss;
     ss << "<font color=\"";
     switch (type) {
@@ -44,16 +46,27 @@ bool Logger::log_message(const std::string &message, LogType type) {
        << ClockTime::getCurrentTime()
        << message
        << "</font>";
+    std::lock_guard<std::mutex> lock(m_mutex);
     write_to_file(message);
     return *m_log_out << ss.str();
 }
 
 void Logger::setStream(QTextEdit *output_field) {
+    std::lock_guard<std::mutex> lock(s_logger.m_mutex);
     s_logger.m_log_out.reset(reinterpret_cast<log_out *>(new log_text_field(output_field)));
+    s_logger.m_silent = false;
 }
 
 void Logger::setStdout() {
+    std::lock_guard<std::mutex> lock(s_logger.m_mutex);
     s_logger.m_log_out.reset(reinterpret_cast<log_out *>(new log_stdout));
+    s_logger.m_silent = false;
+}
+
+void Logger::setSilent() {
+    std::lock_guard<std::mutex> lock(s_logger.m_mutex);
+    s_logger.m_log_out.reset(new log_out);
+    s_logger.m_silent = true;
 }
 
 bool Logger::clear_log() {
@@ -61,7 +74,8 @@ bool Logger::clear_log() {
 }
 
 Logger::Logger() :
-    m_log_out(reinterpret_cast<log_out *>(new log_stdout)) {}
+    m_log_out(reinterpret_cast<log_out *>(new log_stdout)),
+    m_silent(false) {}
 
 log_stream::log_stream(Logger::LogType log_type) :
     m_log_type(log_type) {}
@@ -100,7 +114,9 @@ bool log_stdout::operator<<(const std::string &str) {
 
 bool log_text_field::operator<<(const std::string &str) {
     if (m_output_field) {
-        m_output_field->append(QString::fromStdString(str));
+        // Queued when logging from a thread other than the GUI thread
+        QMetaObject::invokeMethod(m_output_field, "append", Qt::AutoConnection,
+                                  Q_ARG(QString, QString::fromStdString(str)));
         return true;
     }
     return false;
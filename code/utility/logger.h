@@ -1,10 +1,12 @@
 #ifndef LOGGER_H
 #define LOGGER_H
 
+#include <atomic>
 #include <iostream>
 #include <string>
 #include <sstream>
 #include <memory>
+#include <mutex>
 
 #include "clock_time.h"
 
@@ -32,7 +34,8 @@ struct log_stdout : public log_out {
 };
 
 /**
- * Forward log outputs to a QTextEdit.
+ * Forward log outputs to a QTextEdit. Messages logged from other
+ * threads are appended on the thread of the QTextEdit.
  */
 struct log_text_field : public log_out {
     explicit log_text_field(QTextEdit *output_field);
@@ -82,6 +85,12 @@ public:
      */
     static void setStdout();
 
+    /**
+     * Discard all log output, including the log file, such as when
+     * running procedures headless many times over.
+     */
+    static void setSilent();
+
     /**
      * Clear the log output.
      *
@@ -97,6 +106,11 @@ private:
     bool log_message(const std::string &message, LogType type);
 
     std::unique_ptr<log_out> m_log_out;
+    // Checked before formatting, outside the lock
+    std::atomic<bool> m_silent;
+
+    // Messages are logged from the GUI, camera and control threads
+    std::mutex m_mutex;
 
     friend class log_stream;
 };
@@ -0,0 +1,100 @@
+#ifndef MINOTAUR_CPP_LRU_CACHE_H
+#define MINOTAUR_CPP_LRU_CACHE_H
+
+#include <functional>
+#include <list>
+#include <unordered_map>
+
+namespace nrg {
+
+    /**
+     * Fixed capacity map that evicts the least recently used entry
+     * and counts lookup hits and misses.
+     *
+     * @tparam key_t
+     * @tparam val_t must be move constructible
+     * @tparam hash_t
+     */
+    template<typename key_t, typename val_t, typename hash_t = std::hash<key_t>>
+    class lru_cache {
+    public:
+        explicit lru_cache(std::size_t capacity) :
+            m_capacity(capacity > 0 ? capacity : 1),
+            m_hits(0),
+            m_misses(0) {}
+
+        /**
+         * Look up an entry and mark it as most recently used.
+         *
+         * @param key
+         * @return pointer to the cached value, valid until the next
+         *         insertion, or nullptr on a miss
+         */
+        val_t *find(const key_t &key) {
+            auto it = m_index.find(key);
+            if (it == m_index.end()) {
+                ++m_misses;
+                return nullptr;
+            }
+            ++m_hits;
+            m_entries.splice(m_entries.begin(), m_entries, it->second);
+            return &it->second->second;
+        }
+
+        /**
+         * Insert or replace an entry, evicting the least recently
+         * used entry if the cache is full.
+         *
+         * @param key
+         * @param val
+         * @return reference to the cached value
+         */
+        val_t &insert(const key_t &key, val_t &&val) {
+            auto it = m_index.find(key);
+            if (it != m_index.end()) {
+                m_entries.erase(it->second);
+                m_index.erase(it);
+            } else if (m_entries.size() >= m_capacity) {
+                m_index.erase(m_entries.back().first);
+                m_entries.pop_back();
+            }
+            m_entries.emplace_front(key, std::move(val));
+            m_index[key] = m_entries.begin();
+            return m_entries.front().second;
+        }
+
+        void clear() {
+            m_entries.clear();
+            m_index.clear();
+        }
+
+        std::size_t size() const {
+            return m_entries.size();
+        }
+
+        std::size_t capacity() const {
+            return m_capacity;
+        }
+
+        std::size_t hits() const {
+            return m_hits;
+        }
+
+        std::size_t misses() const {
+            return m_misses;
+        }
+
+    private:
+        typedef std::list<std::pair<key_t, val_t>> entry_list;
+
+        std::size_t m_capacity;
+        std::size_t m_hits;
+        std::size_t m_misses;
+
+        entry_list m_entries;
+        std::unordered_map<key_t, typename entry_list::iterator, hash_t> m_index;
+    };
+
+}
+
+#endif //MINOTAUR_CPP_LRU_CACHE_H
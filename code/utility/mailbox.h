@@ -0,0 +1,72 @@
+#ifndef MINOTAUR_CPP_MAILBOX_H
+#define MINOTAUR_CPP_MAILBOX_H
+
+#include <functional>
+#include <mutex>
+#include <vector>
+
+namespace nrg {
+
+    /**
+     * Queue of tasks posted from any thread and run, in order of
+     * posting, by the one thread that drains the mailbox. Tasks are
+     * run outside the lock, so a task may post further tasks; these
+     * wait for the next drain.
+     */
+    class mailbox {
+    public:
+        typedef std::function<void()> task_fn;
+
+        mailbox() = default;
+
+        mailbox(const mailbox &) = delete;
+
+        mailbox &operator=(const mailbox &) = delete;
+
+        /**
+         * Queue a task.
+         *
+         * @param task task to run on the draining thread
+         * @return true if the mailbox was empty, in which case the
+         *         draining thread should be woken
+         */
+        bool post(task_fn task) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_tasks.push_back(std::move(task));
+            return m_tasks.size() == 1;
+        }
+
+        /**
+         * Run the queued tasks.
+         *
+         * @return number of tasks run
+         */
+        std::size_t drain() {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                // The buffers are swapped so their storage is reused
+                m_running.swap(m_tasks);
+            }
+            for (task_fn &task : m_running) {
+                task();
+            }
+            std::size_t n = m_running.size();
+            m_running.clear();
+            return n;
+        }
+
+        std::size_t size() const {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            return m_tasks.size();
+        }
+
+    private:
+        mutable std::mutex m_mutex;
+        std::vector<task_fn> m_tasks;
+        // Only touched by the draining thread
+        std::vector<task_fn> m_running;
+    };
+
+}
+
+#endif //MINOTAUR_CPP_MAILBOX_H
@@ -6,3 +6,7 @@ std::mt19937 &rng::engine() {
     return engine;
 }
 
+void rng::seed(std::mt19937::result_type value) {
+    engine().seed(value);
+}
+
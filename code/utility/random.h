@@ -7,6 +7,12 @@ namespace rng {
 
     std::mt19937 &engine();
 
+    /**
+     * Seed the engine of the calling thread, which is otherwise seeded
+     * randomly, so that a simulation can be repeated.
+     */
+    void seed(std::mt19937::result_type value);
+
     template<int lower, int upper>
     double randf() {
         thread_local static std::uniform_real_distribution<> dis(lower, upper);
@@ -0,0 +1,44 @@
+#include "realtime.h"
+
+#ifdef __linux__
+#include <algorithm>
+#include <pthread.h>
+#include <sched.h>
+#include <thread>
+#endif
+
+bool nrg::set_realtime_priority(int priority) {
+#ifdef __linux__
+    sched_param param{};
+    int policy = SCHED_OTHER;
+    if (priority > 0) {
+        policy = SCHED_FIFO;
+        param.sched_priority = std::min(
+            std::max(priority, sched_get_priority_min(SCHED_FIFO)),
+            sched_get_priority_max(SCHED_FIFO));
+    }
+    return pthread_setschedparam(pthread_self(), policy, &param) == 0;
+#else
+    return priority <= 0;
+#endif
+}
+
+bool nrg::set_cpu_affinity(int cpu) {
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (cpu < 0) {
+        int cpus = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+        for (int i = 0; i < cpus && i < CPU_SETSIZE; ++i) {
+            CPU_SET(i, &set);
+        }
+    } else if (cpu < CPU_SETSIZE) {
+        CPU_SET(cpu, &set);
+    } else {
+        return false;
+    }
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    return cpu < 0;
+#endif
+}
@@ -0,0 +1,28 @@
+#ifndef MINOTAUR_CPP_REALTIME_H
+#define MINOTAUR_CPP_REALTIME_H
+
+namespace nrg {
+
+    /**
+     * Set the scheduling of the calling thread. A positive priority
+     * selects the SCHED_FIFO real-time policy at that priority, clamped
+     * to the range of the policy, and zero or less restores the default
+     * time-shared policy. Real-time scheduling usually requires root or
+     * CAP_SYS_NICE, and is only available on Linux.
+     *
+     * @param priority real-time priority, or zero for none
+     * @return true if the scheduling was applied
+     */
+    bool set_realtime_priority(int priority);
+
+    /**
+     * Pin the calling thread to a CPU. Only available on Linux.
+     *
+     * @param cpu index of the CPU, or a negative value to allow all CPUs
+     * @return true if the affinity was applied
+     */
+    bool set_cpu_affinity(int cpu);
+
+}
+
+#endif //MINOTAUR_CPP_REALTIME_H
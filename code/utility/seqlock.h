@@ -0,0 +1,119 @@
+#ifndef MINOTAUR_CPP_SEQLOCK_H
+#define MINOTAUR_CPP_SEQLOCK_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace nrg {
+
+    /**
+     * A value stored by one writer thread and loaded by any number of
+     * reader threads, without locks. The writer never waits, and a
+     * reader retries if it overlaps a store, so it always sees the whole
+     * of a single store (a seqlock).
+     *
+     * The value is held as atomic words, so that a read overlapping a
+     * store is not a data race, and must be trivially copyable.
+     *
+     * @tparam value_t type of the value
+     */
+    template<typename value_t>
+    class seqlock {
+        static_assert(std::is_trivially_copyable<value_t>::value, "seqlock values are copied as words");
+
+    public:
+        typedef std::uint64_t word_t;
+
+        enum {
+            WORDS = (sizeof(value_t) + sizeof(word_t) - 1) / sizeof(word_t),
+            // Version that values never have, as it marks a store in
+            // progress, so the first load succeeds
+            UNSEEN = 1
+        };
+
+        /**
+         * @param value initial value, of version zero
+         */
+        explicit seqlock(const value_t &value = value_t()) :
+            m_seq(0) {
+            word_t words[WORDS] = {};
+            std::memcpy(words, &value, sizeof(value_t));
+            for (int i = 0; i < WORDS; ++i) {
+                m_words[i].store(words[i], std::memory_order_relaxed);
+            }
+        }
+
+        seqlock(const seqlock &) = delete;
+
+        seqlock &operator=(const seqlock &) = delete;
+
+        /**
+         * Store a new value. Only one thread may store to a seqlock.
+         */
+        void store(const value_t &value) {
+            word_t words[WORDS] = {};
+            std::memcpy(words, &value, sizeof(value_t));
+            std::uint32_t seq = m_seq.load(std::memory_order_relaxed);
+            // An odd sequence number marks a store in progress
+            m_seq.store(seq + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            for (int i = 0; i < WORDS; ++i) {
+                m_words[i].store(words[i], std::memory_order_relaxed);
+            }
+            m_seq.store(seq + 2, std::memory_order_release);
+        }
+
+        /**
+         * @return the value of the last store
+         */
+        value_t load() const {
+            value_t out{};
+            std::uint32_t seen = UNSEEN;
+            load(out, seen);
+            return out;
+        }
+
+        /**
+         * Load the value if it has changed since the last load.
+         *
+         * @param out  receives the value
+         * @param seen version of the last load, updated on a load
+         * @return true if the value changed and was loaded
+         */
+        bool load(value_t &out, std::uint32_t &seen) const {
+            word_t words[WORDS];
+            for (;;) {
+                std::uint32_t before = m_seq.load(std::memory_order_acquire);
+                // Wait out a store before comparing, as an odd version
+                // may equal the one that was seen
+                if (before & 1u) { continue; }
+                if (before == seen) { return false; }
+                for (int i = 0; i < WORDS; ++i) {
+                    words[i] = m_words[i].load(std::memory_order_relaxed);
+                }
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (m_seq.load(std::memory_order_relaxed) == before) {
+                    std::memcpy(&out, words, sizeof(value_t));
+                    seen = before;
+                    return true;
+                }
+            }
+        }
+
+        /**
+         * @return the version of the value, which changes on each store
+         */
+        std::uint32_t version() const {
+            return m_seq.load(std::memory_order_acquire);
+        }
+
+    private:
+        std::atomic<std::uint32_t> m_seq;
+        std::atomic<word_t> m_words[WORDS];
+    };
+
+}
+
+#endif //MINOTAUR_CPP_SEQLOCK_H
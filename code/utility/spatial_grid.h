@@ -0,0 +1,175 @@
+#ifndef MINOTAUR_CPP_SPATIAL_GRID_H
+#define MINOTAUR_CPP_SPATIAL_GRID_H
+
+#include "algorithm.h"
+#include "array2d.h"
+#include "ray.h"
+#include "rect.h"
+
+#include <cmath>
+#include <limits>
+#include <vector>
+
+namespace nrg {
+
+    /**
+     * Uniform grid spatial index over static AABBs. Each rectangle is
+     * stored in every bucket it overlaps, and a segment query only
+     * tests the rectangles in the buckets the segment passes through,
+     * so the cost depends on the segment length rather than on the
+     * number of rectangles.
+     *
+     * Rectangles outside the bounds are kept in the edge buckets, so
+     * queries stay exact everywhere.
+     *
+     * @tparam val_t
+     */
+    template<typename val_t>
+    class spatial_grid {
+    public:
+        /**
+         * Build an index of the cells of a grid that hold a given
+         * value. Cell (x, y) covers [x - 1/2, x + 1/2] on each axis,
+         * so segments between cell indices run through cell centres.
+         *
+         * @param walls  grid of cells
+         * @param wall   value of the cells to index
+         * @param bucket bucket size in cells
+         */
+        static spatial_grid<val_t> from_walls(array2d<int> &walls, int wall, val_t bucket) {
+            auto nx = static_cast<val_t>(walls.x());
+            auto ny = static_cast<val_t>(walls.y());
+            val_t half = static_cast<val_t>(0.5);
+            spatial_grid<val_t> index({-half, -half, nx, ny}, bucket);
+            for (std::size_t x = 0; x < walls.x(); ++x) {
+                for (std::size_t y = 0; y < walls.y(); ++y) {
+                    if (walls[x][y] == wall) {
+                        index.insert({static_cast<val_t>(x) - half, static_cast<val_t>(y) - half, 1, 1});
+                    }
+                }
+            }
+            return index;
+        }
+
+        spatial_grid(const rect<val_t> &bounds, val_t bucket) :
+            m_bounds(bounds),
+            m_bucket(bucket),
+            m_nx(std::max(1, static_cast<int>(std::ceil(bounds.width() / static_cast<double>(bucket))))),
+            m_ny(std::max(1, static_cast<int>(std::ceil(bounds.height() / static_cast<double>(bucket))))),
+            m_buckets(static_cast<std::size_t>(m_nx * m_ny)),
+            m_query(0) {}
+
+        /**
+         * Add a rectangle to the index.
+         *
+         * @param r
+         */
+        void insert(const rect<val_t> &r) {
+            auto id = m_rects.size();
+            m_rects.push_back(r);
+            m_stamps.push_back(0);
+            int x0 = bucket_x(r.tl().x());
+            int x1 = bucket_x(r.br().x());
+            int y0 = bucket_y(r.tl().y());
+            int y1 = bucket_y(r.br().y());
+            for (int bx = x0; bx <= x1; ++bx) {
+                for (int by = y0; by <= y1; ++by) {
+                    m_buckets[bx + by * m_nx].push_back(id);
+                }
+            }
+        }
+
+        std::size_t size() const {
+            return m_rects.size();
+        }
+
+        /**
+         * Determine whether a segment touches any rectangle.
+         *
+         * @param seg
+         * @return
+         */
+        bool intersects(const ray<val_t> &seg) {
+            if (++m_query == 0) {
+                std::fill(m_stamps.begin(), m_stamps.end(), 0);
+                m_query = 1;
+            }
+            double ax = seg.a().x();
+            double ay = seg.a().y();
+            double bx = seg.b().x();
+            double by = seg.b().y();
+            // Walk the bucket columns the segment spans, and in each
+            // the rows covered by the part of the segment inside it
+            int c0 = bucket_x(std::min(ax, bx));
+            int c1 = bucket_x(std::max(ax, bx));
+            for (int c = c0; c <= c1; ++c) {
+                double lo = c == 0 ? -std::numeric_limits<double>::infinity() : edge_x(c);
+                double hi = c == m_nx - 1 ? std::numeric_limits<double>::infinity() : edge_x(c + 1);
+                double sx0 = std::max(std::min(ax, bx), lo);
+                double sx1 = std::min(std::max(ax, bx), hi);
+                double y0 = ax == bx ? ay : y_at(ax, ay, bx, by, sx0);
+                double y1 = ax == bx ? by : y_at(ax, ay, bx, by, sx1);
+                int r0 = bucket_y(std::min(y0, y1));
+                int r1 = bucket_y(std::max(y0, y1));
+                for (int r = r0; r <= r1; ++r) {
+                    for (std::size_t id : m_buckets[c + r * m_nx]) {
+                        if (m_stamps[id] == m_query) { continue; }
+                        m_stamps[id] = m_query;
+                        if (algo::segment_aabb_intersect(seg, m_rects[id])) {
+                            return true;
+                        }
+                    }
+                }
+            }
+            return false;
+        }
+
+        /**
+         * Test a batch of segments.
+         *
+         * @param segs segments to test
+         * @param hits written with whether each segment touches any rectangle
+         */
+        void intersects(const std::vector<ray<val_t>> &segs, std::vector<bool> &hits) {
+            hits.resize(segs.size());
+            for (std::size_t i = 0; i < segs.size(); ++i) {
+                hits[i] = intersects(segs[i]);
+            }
+        }
+
+    private:
+        int bucket_x(double x) const {
+            int b = static_cast<int>(std::floor((x - m_bounds.x()) / m_bucket));
+            return std::max(0, std::min(m_nx - 1, b));
+        }
+
+        int bucket_y(double y) const {
+            int b = static_cast<int>(std::floor((y - m_bounds.y()) / m_bucket));
+            return std::max(0, std::min(m_ny - 1, b));
+        }
+
+        double edge_x(int c) const {
+            return m_bounds.x() + static_cast<double>(c) * m_bucket;
+        }
+
+        static double y_at(double ax, double ay, double bx, double by, double x) {
+            double t = (x - ax) / (bx - ax);
+            return ay + t * (by - ay);
+        }
+
+        rect<val_t> m_bounds;
+        val_t m_bucket;
+        int m_nx;
+        int m_ny;
+
+        std::vector<std::vector<std::size_t>> m_buckets;
+        std::vector<rect<val_t>> m_rects;
+
+        // Rectangles already tested by the current query
+        std::vector<unsigned int> m_stamps;
+        unsigned int m_query;
+    };
+
+}
+
+#endif //MINOTAUR_CPP_SPATIAL_GRID_H
@@ -0,0 +1,71 @@
+#ifndef MINOTAUR_CPP_TELEMETRY_H
+#define MINOTAUR_CPP_TELEMETRY_H
+
+#include "seqlock.h"
+
+#include <array>
+#include <cstdint>
+
+namespace nrg {
+
+    /**
+     * A few numeric values published by one producer thread and read
+     * by a display thread, without locks, through a seqlock. Formatting
+     * the values is left to the reader.
+     */
+    class telemetry_slot {
+    public:
+        enum {
+            MAX_VALUES = 4
+        };
+
+        typedef std::array<double, MAX_VALUES> values;
+
+        enum {
+            // Version that values never have, so the first read succeeds
+            UNSEEN = seqlock<values>::UNSEEN
+        };
+
+        telemetry_slot() = default;
+
+        telemetry_slot(const telemetry_slot &) = delete;
+
+        telemetry_slot &operator=(const telemetry_slot &) = delete;
+
+        /**
+         * Publish new values. Only one thread may publish to a slot, and
+         * publishing the current values again does nothing.
+         */
+        void publish(double v0, double v1 = 0, double v2 = 0, double v3 = 0) {
+            const values next = {{v0, v1, v2, v3}};
+            // The publishing thread is the only writer, so its load
+            // never waits
+            if (m_values.load() == next) { return; }
+            m_values.store(next);
+        }
+
+        /**
+         * Read the values if they have changed since the last read.
+         *
+         * @param out  receives the values
+         * @param seen version of the last read, updated on a read
+         * @return true if the values changed and were read
+         */
+        bool read(values &out, std::uint32_t &seen) const {
+            return m_values.load(out, seen);
+        }
+
+        /**
+         * @return the version of the values, which changes on each publish
+         */
+        std::uint32_t version() const {
+            return m_values.version();
+        }
+
+    private:
+        seqlock<values> m_values;
+    };
+
+}
+
+#endif //MINOTAUR_CPP_TELEMETRY_H
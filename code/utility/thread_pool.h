@@ -0,0 +1,103 @@
+#ifndef MINOTAUR_CPP_THREAD_POOL_H
+#define MINOTAUR_CPP_THREAD_POOL_H
+
+#include <algorithm>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+namespace nrg {
+
+    /**
+     * Fixed set of worker threads running queued tasks in order of
+     * submission. Results are returned through futures, and tasks
+     * still queued when the pool is destroyed are run before the
+     * workers exit.
+     */
+    class thread_pool {
+    public:
+        /**
+         * @param threads number of workers, or zero to use one per
+         *                hardware thread
+         */
+        explicit thread_pool(std::size_t threads = 0) :
+            m_stop(false) {
+            if (threads == 0) {
+                threads = std::max(1u, std::thread::hardware_concurrency());
+            }
+            for (std::size_t i = 0; i < threads; ++i) {
+                m_workers.emplace_back(&thread_pool::run, this);
+            }
+        }
+
+        ~thread_pool() {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_stop = true;
+            }
+            m_cv.notify_all();
+            for (std::thread &worker : m_workers) {
+                worker.join();
+            }
+        }
+
+        thread_pool(const thread_pool &) = delete;
+
+        thread_pool &operator=(const thread_pool &) = delete;
+
+        /**
+         * Queue a task.
+         *
+         * @param task callable taking no arguments
+         * @return future holding the result of the task
+         */
+        template<typename fn_t>
+        std::future<typename std::result_of<fn_t()>::type> submit(fn_t task) {
+            typedef typename std::result_of<fn_t()>::type result_t;
+            // packaged_task is move-only, so it is shared to fit in
+            // a copyable std::function
+            auto packaged = std::make_shared<std::packaged_task<result_t()>>(std::move(task));
+            std::future<result_t> result = packaged->get_future();
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_tasks.emplace([packaged] { (*packaged)(); });
+            }
+            m_cv.notify_one();
+            return result;
+        }
+
+        std::size_t size() const {
+            return m_workers.size();
+        }
+
+    private:
+        void run() {
+            for (;;) {
+                std::function<void()> task;
+                {
+                    std::unique_lock<std::mutex> lock(m_mutex);
+                    m_cv.wait(lock, [this] { return m_stop || !m_tasks.empty(); });
+                    if (m_tasks.empty()) { return; }
+                    task = std::move(m_tasks.front());
+                    m_tasks.pop();
+                }
+                task();
+            }
+        }
+
+        std::mutex m_mutex;
+        std::condition_variable m_cv;
+        std::queue<std::function<void()>> m_tasks;
+        bool m_stop;
+
+        std::vector<std::thread> m_workers;
+    };
+
+}
+
+#endif //MINOTAUR_CPP_THREAD_POOL_H
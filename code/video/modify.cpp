@@ -32,3 +32,11 @@ void VideoModifier::add_modifier_list(QComboBox *list) {
 }
 
 void VideoModifier::register_actions(ActionBox *) {}
+
+void VideoModifier::set_frame_time(std::chrono::steady_clock::time_point captured) {
+    m_frame_time = captured;
+}
+
+std::chrono::steady_clock::time_point VideoModifier::frame_time() const {
+    return m_frame_time;
+}
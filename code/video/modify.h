@@ -1,6 +1,7 @@
 #ifndef MINOTAUR_CPP_MODIFY_H
 #define MINOTAUR_CPP_MODIFY_H
 
+#include <chrono>
 #include <memory>
 
 #include <opencv2/core/core.hpp>
@@ -26,6 +27,17 @@ public:
     virtual void modify(cv::UMat &img) = 0;
 
     virtual void register_actions(ActionBox *box);
+
+    /**
+     * Set the capture time of the frame about to be modified.
+     */
+    void set_frame_time(std::chrono::steady_clock::time_point captured);
+
+protected:
+    std::chrono::steady_clock::time_point frame_time() const;
+
+private:
+    std::chrono::steady_clock::time_point m_frame_time;
 };
 
 Q_DECLARE_METATYPE(std::shared_ptr<VideoModifier>);
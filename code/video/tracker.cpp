@@ -78,7 +78,7 @@ void __tracker::stop_tracking() {
     }
 }
 
-void __tracker::update_track(cv::UMat &img) {
+void __tracker::update_track(cv::UMat &img, std::chrono::steady_clock::time_point captured) {
     if (m_state == State::FAILED) {
         reset_tracker();
         if (m_tracker->init(img, m_bounding_box)) {
@@ -101,7 +101,7 @@ void __tracker::update_track(cv::UMat &img) {
             }
         }
         m_mutex.unlock();
-        Q_EMIT target_box(m_bounding_box);
+        Q_EMIT target_box(m_bounding_box, captured);
     }
 }
 
@@ -119,8 +119,10 @@ TrackerModifier::TrackerModifier() :
     m_robot_tracker(),
     m_object_tracker() {
     CompetitionState *state = &Main::get()->state();
-    connect(&m_robot_tracker, &__tracker::target_box, state, &CompetitionState::acquire_robot_box);
-    connect(&m_object_tracker, &__tracker::target_box, state, &CompetitionState::acquire_object_box);
+    // Direct, so that boxes go straight to the control thread
+    // instead of waiting on the GUI thread
+    connect(&m_robot_tracker, &__tracker::target_box, state, &CompetitionState::acquire_robot_box, Qt::DirectConnection);
+    connect(&m_object_tracker, &__tracker::target_box, state, &CompetitionState::acquire_object_box, Qt::DirectConnection);
 }
 
 void TrackerModifier::traverse() {
@@ -157,8 +159,8 @@ void TrackerModifier::register_actions(ActionBox *box) {
 }
 
 void TrackerModifier::modify(cv::UMat &img) {
-    m_robot_tracker.update_track(img);
-    m_object_tracker.update_track(img);
+    m_robot_tracker.update_track(img, frame_time());
+    m_object_tracker.update_track(img, frame_time());
     m_robot_tracker.draw_bounding_box(img);
     m_object_tracker.draw_bounding_box(img);
 }
@@ -32,13 +32,17 @@ public:
 
     __tracker();
 
-    void update_track(cv::UMat &img);
+    /**
+     * @param img      frame to track in
+     * @param captured time the frame was captured, sent with the box
+     */
+    void update_track(cv::UMat &img, std::chrono::steady_clock::time_point captured);
 
     void draw_bounding_box(cv::UMat &img);
 
     State state() const;
 
-    Q_SIGNAL void target_box(const cv::Rect2d &box);
+    Q_SIGNAL void target_box(const cv::Rect2d &box, std::chrono::steady_clock::time_point captured);
 
     Q_SLOT void begin_tracking();
 
@@ -0,0 +1,83 @@
+#include <gtest/gtest.h>
+
+#include <code/controller/alternatives.h>
+#include <code/controller/lattice.h>
+#include <code/controller/penaltyfield.h>
+#include <code/utility/thread_pool.h>
+
+#include <algorithm>
+#include <cstdlib>
+
+/**
+ * A 30x20 grid split by a wall at x = 15 with gaps at y = 3 and y = 16.
+ */
+static void two_gap_terrain(array2d<int> &terrain) {
+    for (int y = 0; y < 20; ++y) {
+        terrain[15][y] = y == 3 || y == 16 ? 0 : TERRAIN_WALL;
+    }
+}
+
+static bool uses_cell(const std::vector<vector2i> &path, const vector2i &cell) {
+    return std::find(path.begin(), path.end(), cell) != path.end();
+}
+
+TEST(alternative_paths, diverse_candidates) {
+    array2d<int> terrain(30, 20);
+    two_gap_terrain(terrain);
+    nrg::thread_pool pool(3);
+    vector2i start(2, 5);
+    vector2i dest(27, 5);
+    std::vector<nrg::path_candidate> candidates = nrg::alternative_paths(terrain, start, dest, 5, pool);
+    ASSERT_GE(candidates.size(), 2u);
+    ASSERT_LE(candidates.size(), 5u);
+    bool upper = false;
+    bool lower = false;
+    for (std::size_t i = 0; i < candidates.size(); ++i) {
+        const nrg::path_candidate &c = candidates[i];
+        ASSERT_EQ(start, c.path.front());
+        ASSERT_EQ(dest, c.path.back());
+        int cost = 0;
+        for (std::size_t j = 1; j < c.path.size(); ++j) {
+            ASSERT_EQ(1, abs(c.path[j].x() - c.path[j - 1].x()) + abs(c.path[j].y() - c.path[j - 1].y()));
+            ASSERT_NE(TERRAIN_WALL, terrain[c.path[j].x()][c.path[j].y()]);
+            cost += 1 + terrain[c.path[j].x()][c.path[j].y()];
+        }
+        ASSERT_EQ(cost, c.cost);
+        ASSERT_EQ(nrg::count_switches(c.path), c.turns);
+        // Both gaps are next to the dividing wall
+        ASSERT_EQ(1, c.clearance);
+        if (i > 0) { ASSERT_LE(candidates[i - 1].cost, c.cost); }
+        for (std::size_t j = 0; j < i; ++j) { ASSERT_NE(candidates[j].path, c.path); }
+        upper = upper || uses_cell(c.path, {15, 3});
+        lower = lower || uses_cell(c.path, {15, 16});
+    }
+    ASSERT_TRUE(uses_cell(candidates.front().path, {15, 3}));
+    ASSERT_TRUE(upper);
+    ASSERT_TRUE(lower);
+}
+
+TEST(alternative_paths, avoids_contested_region) {
+    array2d<int> terrain(30, 20);
+    two_gap_terrain(terrain);
+    nrg::thread_pool pool(2);
+    nrg::alternative_options options;
+    options.avoid.emplace_back(13, 0, 5, 8);
+    std::vector<nrg::path_candidate> candidates =
+        nrg::alternative_paths(terrain, {2, 5}, {27, 5}, 3, pool, options);
+    ASSERT_FALSE(candidates.empty());
+    for (const nrg::path_candidate &c : candidates) {
+        ASSERT_TRUE(uses_cell(c.path, {15, 16}));
+    }
+}
+
+TEST(alternative_paths, unreachable) {
+    array2d<int> terrain(10, 10);
+    for (int y = 0; y < 10; ++y) { terrain[4][y] = TERRAIN_WALL; }
+    nrg::thread_pool pool(2);
+    ASSERT_TRUE(nrg::alternative_paths(terrain, {0, 0}, {9, 9}, 4, pool).empty());
+    ASSERT_TRUE(nrg::alternative_paths(terrain, {0, 0}, {3, 9}, 0, pool).empty());
+    std::vector<nrg::path_candidate> one = nrg::alternative_paths(terrain, {0, 0}, {3, 9}, 1, pool);
+    ASSERT_EQ(1u, one.size());
+    ASSERT_EQ(12, one[0].cost);
+    ASSERT_EQ(1, one[0].turns);
+}
@@ -0,0 +1,99 @@
+#include <gtest/gtest.h>
+
+#include <code/controller/arastar.h>
+#include <code/controller/flowfield.h>
+#include <code/controller/penaltyfield.h>
+
+#include <cstdlib>
+
+static void random_terrain(array2d<int> &terrain) {
+    for (std::size_t x = 0; x < terrain.x(); ++x) {
+        for (std::size_t y = 0; y < terrain.y(); ++y) {
+            terrain[x][y] = rand() % 5 == 0 ? TERRAIN_WALL : rand() % 6;
+        }
+    }
+}
+
+static int walk_cost(array2d<int> &terrain, const std::vector<vector2i> &path) {
+    int cost = 0;
+    for (std::size_t i = 1; i < path.size(); ++i) {
+        EXPECT_EQ(1, abs(path[i].x() - path[i - 1].x()) + abs(path[i].y() - path[i - 1].y()));
+        EXPECT_NE(TERRAIN_WALL, terrain[path[i].x()][path[i].y()]);
+        cost += 1 + terrain[path[i].x()][path[i].y()];
+    }
+    return cost;
+}
+
+TEST(ara_star, converges_to_optimal) {
+    srand(11);
+    array2d<int> terrain(60, 30);
+    for (int trial = 0; trial < 10; ++trial) {
+        random_terrain(terrain);
+        vector2i start(rand() % 60, rand() % 30);
+        vector2i dest(rand() % 60, rand() % 30);
+        terrain[start.x()][start.y()] = 0;
+        terrain[dest.x()][dest.y()] = 0;
+        nrg::flow_field flow;
+        flow.compute(terrain, dest);
+        int optimal = flow.cost_to_go(start);
+
+        nrg::ara_planner planner;
+        planner.reset(terrain, start, dest);
+        bool found = planner.improve(nrg::ara_planner::clock::now() + std::chrono::seconds(10));
+        ASSERT_EQ(optimal >= 0, found);
+        if (!found) { continue; }
+        ASSERT_DOUBLE_EQ(1.0, planner.bound());
+        ASSERT_EQ(optimal, planner.cost());
+        std::vector<vector2i> path;
+        ASSERT_TRUE(planner.path(path));
+        ASSERT_EQ(start, path.front());
+        ASSERT_EQ(dest, path.back());
+        ASSERT_EQ(optimal, walk_cost(terrain, path));
+    }
+}
+
+TEST(ara_star, resumes_after_deadline) {
+    srand(12);
+    array2d<int> terrain(120, 80);
+    random_terrain(terrain);
+    vector2i start(0, 0);
+    vector2i dest(119, 79);
+    terrain[start.x()][start.y()] = 0;
+    terrain[dest.x()][dest.y()] = 0;
+    nrg::flow_field flow;
+    flow.compute(terrain, dest);
+    int optimal = flow.cost_to_go(start);
+    ASSERT_GT(optimal, 0);
+
+    nrg::ara_planner planner(5.0, 1.0);
+    planner.reset(terrain, start, dest);
+    // A deadline in the past stops the search early
+    planner.improve(nrg::ara_planner::clock::now());
+    ASSERT_LE(planner.iterations(), 1);
+    double bound = 0;
+    while (bound != 1.0) {
+        planner.improve(nrg::ara_planner::clock::now() + std::chrono::microseconds(50));
+        if (planner.iterations() == 0) { continue; }
+        // Every reported bound holds and never gets worse
+        ASSERT_TRUE(bound == 0 || planner.bound() <= bound);
+        bound = planner.bound();
+        ASSERT_GE(bound, 1.0);
+        ASSERT_LE(planner.cost(), bound * optimal + 1e-9);
+    }
+    ASSERT_EQ(optimal, planner.cost());
+}
+
+TEST(ara_star, unreachable) {
+    array2d<int> terrain(10, 10);
+    for (int y = 0; y < 10; ++y) { terrain[5][y] = TERRAIN_WALL; }
+    std::vector<vector2i> path;
+    double bound = -1;
+    ASSERT_FALSE(nrg::search_path_anytime(terrain, {0, 0}, {9, 9}, std::chrono::milliseconds(5), path, &bound));
+    ASSERT_TRUE(path.empty());
+    ASSERT_FALSE(nrg::search_path_anytime(terrain, {0, 0}, {5, 5}, std::chrono::milliseconds(5), path));
+    ASSERT_FALSE(nrg::search_path_anytime(terrain, {0, 0}, {10, 0}, std::chrono::milliseconds(5), path));
+    terrain[5][3] = 0;
+    ASSERT_TRUE(nrg::search_path_anytime(terrain, {0, 0}, {9, 9}, std::chrono::milliseconds(5), path, &bound));
+    ASSERT_DOUBLE_EQ(1.0, bound);
+    ASSERT_EQ(9 + 9 + 1, static_cast<int>(path.size()));
+}
@@ -1,6 +1,7 @@
 #include <gtest/gtest.h>
 
 #include <code/controller/astar.h>
+#include <code/controller/plancontext.h>
 
 TEST(direct_movement, find_path) {
     array2d<int> a = {{1,   1, -1, 1},
@@ -28,3 +29,23 @@ TEST(direct_movement, find_path) {
     ASSERT_EQ(path.at(6), p7);
 }
 
+TEST(direct_movement, reuses_context) {
+    array2d<int> a = {{1,   1, -1, 1},
+                     {1,   1, -1, 1},
+                     {-1,  1, 1,  1},
+                     {1,   1, -1, 1}};
+
+    nrg::planner_context context;
+    std::vector<vector2i> first;
+    std::vector<vector2i> second;
+    nrg::search_path_del(context, a, {3, 0}, {0, 3}, first);
+    nrg::search_path_del(context, a, {3, 0}, {0, 3}, second);
+    ASSERT_EQ(first, second);
+    ASSERT_EQ(2u, context.queries());
+    ASSERT_EQ(0u, context.memory().chained());
+
+    // A destination inside a wall is unreachable
+    std::vector<vector2i> none;
+    nrg::search_path_del(context, a, {3, 0}, {2, 0}, none);
+    ASSERT_TRUE(none.empty());
+}
@@ -0,0 +1,85 @@
+#include <gtest/gtest.h>
+
+#include <code/controller/controllaw.h>
+
+TEST(control_law, bang_bang_moves_along_larger_axis) {
+    nrg::bang_bang_law law(255);
+    vector2d out = law.update({10.0, -4.0}, 0.1);
+    ASSERT_DOUBLE_EQ(255, out.x());
+    ASSERT_DOUBLE_EQ(0, out.y());
+    out = law.update({3.0, -4.0}, 0.1);
+    ASSERT_DOUBLE_EQ(0, out.x());
+    ASSERT_DOUBLE_EQ(-255, out.y());
+}
+
+TEST(control_law, pid_saturates_output) {
+    nrg::pid_axis axis({2.0, 0.0, 0.0, 50.0, 100.0});
+    ASSERT_DOUBLE_EQ(20, axis.update(10, 0.1));
+    ASSERT_DOUBLE_EQ(50, axis.update(40, 0.1));
+    ASSERT_DOUBLE_EQ(-50, axis.update(-40, 0.1));
+}
+
+TEST(control_law, pid_derivative_needs_previous_error) {
+    nrg::pid_axis axis({0.0, 0.0, 1.0, 50.0, 100.0});
+    ASSERT_DOUBLE_EQ(0, axis.update(10, 0.5));
+    ASSERT_DOUBLE_EQ(-10, axis.update(5, 0.5));
+    axis.reset();
+    ASSERT_DOUBLE_EQ(0, axis.update(5, 0.5));
+}
+
+TEST(control_law, pid_integral_is_bounded) {
+    nrg::pid_axis axis({0.0, 1.0, 0.0, 50.0, 3.0});
+    axis.update(10, 0.1);
+    ASSERT_DOUBLE_EQ(1, axis.integral());
+    for (int i = 0; i < 10; ++i) {
+        axis.update(10, 0.1);
+    }
+    ASSERT_DOUBLE_EQ(3, axis.integral());
+    axis.update(-10, 0.1);
+    ASSERT_DOUBLE_EQ(2, axis.integral());
+}
+
+TEST(control_law, pid_does_not_wind_up_while_saturated) {
+    nrg::pid_axis axis({1.0, 1.0, 0.0, 10.0, 100.0});
+    for (int i = 0; i < 20; ++i) {
+        ASSERT_DOUBLE_EQ(10, axis.update(20, 1.0));
+    }
+    ASSERT_DOUBLE_EQ(0, axis.integral());
+    // Once the error reverses the output follows at once
+    ASSERT_DOUBLE_EQ(-1, axis.update(-1, 0.0));
+}
+
+TEST(control_law, pid_law_runs_each_axis) {
+    std::unique_ptr<nrg::control_law> law =
+        nrg::make_control_law(nrg::control_law::PID, {0.5, 0.0, 0.0, 50.0, 100.0});
+    vector2d out = law->update({10.0, -4.0}, 0.1);
+    ASSERT_DOUBLE_EQ(5, out.x());
+    ASSERT_DOUBLE_EQ(-2, out.y());
+    law = nrg::make_control_law(-1, {0.5, 0.0, 0.0, 50.0, 100.0});
+    out = law->update({10.0, -4.0}, 0.1);
+    ASSERT_DOUBLE_EQ(50, out.x());
+    ASSERT_DOUBLE_EQ(0, out.y());
+}
+
+TEST(convergence_stats, times_waypoints_and_overshoot) {
+    typedef nrg::convergence_stats::clock clock;
+    nrg::convergence_stats stats;
+    ASSERT_EQ(0, stats.mean_time_ms());
+    clock::time_point t0 = clock::now();
+    stats.begin(t0);
+    stats.sample(0);
+    stats.sample(4);
+    stats.sample(1);
+    stats.converge(t0 + std::chrono::milliseconds(100));
+    stats.begin(t0 + std::chrono::milliseconds(100));
+    stats.sample(0);
+    stats.converge(t0 + std::chrono::milliseconds(400));
+    // Converging twice does not count the waypoint again
+    stats.converge(t0 + std::chrono::milliseconds(900));
+    ASSERT_EQ(2u, stats.waypoints());
+    ASSERT_EQ(4u, stats.ticks());
+    ASSERT_DOUBLE_EQ(200, stats.mean_time_ms());
+    ASSERT_DOUBLE_EQ(300, stats.max_time_ms());
+    ASSERT_DOUBLE_EQ(2, stats.mean_overshoot());
+    ASSERT_DOUBLE_EQ(4, stats.max_overshoot());
+}
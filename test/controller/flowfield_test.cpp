@@ -0,0 +1,69 @@
+#include <gtest/gtest.h>
+
+#include <code/controller/flowfield.h>
+#include <code/controller/penaltyfield.h>
+
+#include <cstdlib>
+
+static void random_terrain(array2d<int> &terrain) {
+    for (std::size_t x = 0; x < terrain.x(); ++x) {
+        for (std::size_t y = 0; y < terrain.y(); ++y) {
+            terrain[x][y] = rand() % 5 == 0 ? TERRAIN_WALL : rand() % 4;
+        }
+    }
+}
+
+TEST(flow_field, follows_cost_to_go) {
+    srand(5);
+    const int nx = 40;
+    const int ny = 25;
+    array2d<int> terrain(nx, ny);
+    random_terrain(terrain);
+    vector2i dest(30, 12);
+    terrain[dest.x()][dest.y()] = 0;
+    nrg::flow_field flow;
+    flow.compute(terrain, dest);
+    ASSERT_EQ(dest, flow.dest());
+    ASSERT_EQ(0, flow.cost_to_go(dest));
+    vector2i next;
+    ASSERT_FALSE(flow.next_step(dest, next));
+    for (int x = 0; x < nx; ++x) {
+        for (int y = 0; y < ny; ++y) {
+            int cost = flow.cost_to_go({x, y});
+            if (terrain[x][y] == TERRAIN_WALL) {
+                ASSERT_EQ(-1, cost);
+                continue;
+            }
+            if (cost < 0) { continue; }
+            // Walking the field pays exactly the cost-to-go
+            vector2i cur(x, y);
+            int walked = 0;
+            while (flow.next_step(cur, next)) {
+                ASSERT_EQ(1, abs(next.x() - cur.x()) + abs(next.y() - cur.y()));
+                walked += 1 + terrain[next.x()][next.y()];
+                cur = next;
+            }
+            ASSERT_EQ(dest, cur);
+            ASSERT_EQ(cost, walked);
+        }
+    }
+}
+
+TEST(flow_field, background_rebuild) {
+    array2d<int> terrain(20, 10);
+    nrg::flow_field flow;
+    flow.compute(terrain, {0, 0});
+    ASSERT_EQ(1u, flow.generation());
+    ASSERT_EQ(19 + 9, flow.cost_to_go({19, 9}));
+    // Wall off the destination's column except for the far end
+    for (int y = 0; y < 9; ++y) { terrain[1][y] = TERRAIN_WALL; }
+    flow.rebuild(terrain, {0, 0});
+    flow.wait();
+    ASSERT_EQ(2u, flow.generation());
+    ASSERT_EQ(19 + 9 + 9, flow.cost_to_go({19, 0}));
+    ASSERT_EQ(-1, flow.cost_to_go({1, 0}));
+    flow.rebuild(terrain, {19, 9});
+    flow.wait();
+    ASSERT_EQ(vector2i(19, 9), flow.dest());
+    ASSERT_EQ(0, flow.cost_to_go({19, 9}));
+}
@@ -0,0 +1,99 @@
+#include <gtest/gtest.h>
+
+#include <code/controller/hpastar.h>
+#include <code/controller/penaltyfield.h>
+
+#include <cstdlib>
+#include <queue>
+
+static int path_cost(array2d<int> &terrain, const std::vector<vector2i> &path) {
+    int cost = 0;
+    for (std::size_t i = 1; i < path.size(); ++i) {
+        const vector2i &a = path[i - 1];
+        const vector2i &b = path[i];
+        EXPECT_EQ(1, abs(a.x() - b.x()) + abs(a.y() - b.y()));
+        EXPECT_NE(TERRAIN_WALL, terrain[b.x()][b.y()]);
+        cost += 1 + terrain[b.x()][b.y()];
+    }
+    return cost;
+}
+
+static int optimal_cost(array2d<int> &terrain, const vector2i &start, const vector2i &dest) {
+    int nx = static_cast<int>(terrain.x());
+    int ny = static_cast<int>(terrain.y());
+    std::vector<int> dist(static_cast<std::size_t>(nx * ny), -1);
+    typedef std::pair<int, int> entry;
+    std::priority_queue<entry, std::vector<entry>, std::greater<entry>> open;
+    open.emplace(0, start.x() * ny + start.y());
+    while (!open.empty()) {
+        entry e = open.top();
+        open.pop();
+        if (dist[e.second] >= 0) { continue; }
+        dist[e.second] = e.first;
+        int x = e.second / ny;
+        int y = e.second % ny;
+        int xs[] = {x - 1, x + 1, x, x};
+        int ys[] = {y, y, y - 1, y + 1};
+        for (int i = 0; i < 4; ++i) {
+            if (xs[i] < 0 || ys[i] < 0 || xs[i] >= nx || ys[i] >= ny) { continue; }
+            int t = terrain[xs[i]][ys[i]];
+            if (t == TERRAIN_WALL || dist[xs[i] * ny + ys[i]] >= 0) { continue; }
+            open.emplace(e.first + 1 + t, xs[i] * ny + ys[i]);
+        }
+    }
+    return dist[dest.x() * ny + dest.y()];
+}
+
+TEST(hpa_planner, near_optimal_paths) {
+    srand(11);
+    const int nx = 90;
+    const int ny = 70;
+    array2d<int> terrain(nx, ny);
+    for (int x = 0; x < nx; ++x) {
+        for (int y = 0; y < ny; ++y) {
+            terrain[x][y] = rand() % 5 == 0 ? TERRAIN_WALL : rand() % 3;
+        }
+    }
+    nrg::hpa_planner planner(10);
+    planner.set_terrain(terrain);
+    ASSERT_GT(planner.abstract_nodes(), 0u);
+    for (int i = 0; i < 40; ++i) {
+        vector2i start(rand() % nx, rand() % ny);
+        vector2i dest(rand() % nx, rand() % ny);
+        terrain[start.x()][start.y()] = 0;
+        terrain[dest.x()][dest.y()] = 0;
+        planner.set_cell(start.x(), start.y(), 0);
+        planner.set_cell(dest.x(), dest.y(), 0);
+        int optimal = optimal_cost(terrain, start, dest);
+        std::vector<vector2i> path;
+        bool found = planner.search(start, dest, path);
+        ASSERT_EQ(optimal >= 0, found);
+        if (!found) { continue; }
+        ASSERT_EQ(start, path.front());
+        ASSERT_EQ(dest, path.back());
+        int cost = path_cost(terrain, path);
+        ASSERT_GE(cost, optimal);
+        ASSERT_LE(cost, optimal * 3 / 2 + 10);
+    }
+}
+
+TEST(hpa_planner, lazy_wall_update) {
+    const int n = 40;
+    array2d<int> terrain(n, n);
+    nrg::hpa_planner planner(8);
+    planner.set_terrain(terrain);
+    std::vector<vector2i> path;
+    ASSERT_TRUE(planner.search({0, 20}, {39, 20}, path));
+    ASSERT_LE(path_cost(terrain, path), 39 * 3 / 2);
+    // Wall off the middle column except for a gap at the top
+    for (int y = 1; y < n; ++y) {
+        planner.set_cell(20, y, TERRAIN_WALL);
+        terrain[20][y] = TERRAIN_WALL;
+    }
+    path.clear();
+    ASSERT_TRUE(planner.search({0, 20}, {39, 20}, path));
+    ASSERT_GE(path_cost(terrain, path), optimal_cost(terrain, {0, 20}, {39, 20}));
+    planner.set_cell(20, 0, TERRAIN_WALL);
+    path.clear();
+    ASSERT_FALSE(planner.search({0, 20}, {39, 20}, path));
+}
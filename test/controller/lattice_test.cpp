@@ -0,0 +1,126 @@
+#include <gtest/gtest.h>
+
+#include <code/controller/astar.h>
+#include <code/controller/lattice.h>
+#include <code/controller/penaltyfield.h>
+
+#include <cstdlib>
+#include <functional>
+#include <queue>
+
+static void random_terrain(array2d<int> &terrain) {
+    for (std::size_t x = 0; x < terrain.x(); ++x) {
+        for (std::size_t y = 0; y < terrain.y(); ++y) {
+            terrain[x][y] = rand() % 4 == 0 ? TERRAIN_WALL : rand() % 5;
+        }
+    }
+}
+
+/**
+ * Plain Dijkstra over (x, y, heading) states.
+ */
+static int reference_cost(array2d<int> &terrain, const vector2i &start, const vector2i &dest, int penalty) {
+    const int dx[] = {0, 0, 1, -1};
+    const int dy[] = {-1, 1, 0, 0};
+    int mx = static_cast<int>(terrain.x());
+    int my = static_cast<int>(terrain.y());
+    std::vector<int> best(static_cast<std::size_t>(mx * my * 4), -1);
+    typedef std::pair<int, int> entry;
+    std::priority_queue<entry, std::vector<entry>, std::greater<entry>> open;
+    for (int h = 0; h < 4; ++h) {
+        open.emplace(0, (start.x() * my + start.y()) * 4 + h);
+    }
+    while (!open.empty()) {
+        entry e = open.top();
+        open.pop();
+        if (best[e.second] >= 0) { continue; }
+        best[e.second] = e.first;
+        int cell = e.second / 4;
+        int x = cell / my;
+        int y = cell % my;
+        if (x == dest.x() && y == dest.y()) { return e.first; }
+        for (int h = 0; h < 4; ++h) {
+            int nx = x + dx[h];
+            int ny = y + dy[h];
+            if (nx < 0 || ny < 0 || nx >= mx || ny >= my || terrain[nx][ny] == TERRAIN_WALL) { continue; }
+            int c = e.first + 1 + terrain[nx][ny] + (h != e.second % 4 ? penalty : 0);
+            open.emplace(c, (nx * my + ny) * 4 + h);
+        }
+    }
+    return -1;
+}
+
+TEST(lattice, optimal_with_turns) {
+    srand(21);
+    array2d<int> terrain(40, 25);
+    nrg::lattice_planner planner;
+    for (int trial = 0; trial < 20; ++trial) {
+        random_terrain(terrain);
+        vector2i start(rand() % 40, rand() % 25);
+        vector2i dest(rand() % 40, rand() % 25);
+        terrain[start.x()][start.y()] = 0;
+        terrain[dest.x()][dest.y()] = 0;
+        int expected = reference_cost(terrain, start, dest, nrg::lattice_planner::DEFAULT_TURN_PENALTY);
+        std::vector<vector2i> path;
+        ASSERT_EQ(expected >= 0, planner.search(terrain, start, dest, path));
+        if (expected < 0) { continue; }
+        ASSERT_EQ(expected, planner.cost());
+        ASSERT_EQ(start, path.front());
+        ASSERT_EQ(dest, path.back());
+        int walked = 0;
+        for (std::size_t i = 1; i < path.size(); ++i) {
+            ASSERT_EQ(1, abs(path[i].x() - path[i - 1].x()) + abs(path[i].y() - path[i - 1].y()));
+            walked += 1 + terrain[path[i].x()][path[i].y()];
+        }
+        int switches = nrg::count_switches(path);
+        ASSERT_EQ(switches, planner.switches());
+        ASSERT_EQ(expected, walked + switches * nrg::lattice_planner::DEFAULT_TURN_PENALTY);
+
+        // The legacy entry point shares the cost model
+        std::vector<vector2i> legacy;
+        nrg::search_path(terrain, start, dest, legacy);
+        legacy.insert(legacy.begin(), start);
+        ASSERT_EQ(path, legacy);
+    }
+}
+
+TEST(lattice, fewest_switches) {
+    array2d<int> terrain(10, 10);
+    // A staircase of walls that a greedy path would zig-zag through
+    for (int i = 2; i < 8; ++i) { terrain[i][9 - i] = TERRAIN_WALL; }
+    nrg::lattice_planner planner(1000);
+    std::vector<vector2i> path;
+    ASSERT_TRUE(planner.search(terrain, {0, 0}, {9, 9}, path));
+    ASSERT_EQ(1, planner.switches());
+    ASSERT_EQ(1, nrg::count_switches(path));
+
+    // Already moving left, so reaching a cell to the right needs a switch
+    path.clear();
+    ASSERT_TRUE(planner.search(terrain, {0, 0}, {5, 0}, path, nrg::HEADING_LEFT));
+    ASSERT_EQ(1, planner.switches());
+    ASSERT_EQ(5 + 1000, planner.cost());
+    path.clear();
+    ASSERT_TRUE(planner.search(terrain, {0, 0}, {5, 0}, path, nrg::HEADING_RIGHT));
+    ASSERT_EQ(0, planner.switches());
+    ASSERT_EQ(5, planner.cost());
+
+    const nrg::motion_primitive *prims = planner.primitives(nrg::HEADING_UP);
+    ASSERT_EQ(0, prims[nrg::HEADING_UP].extra);
+    ASSERT_EQ(-1, prims[nrg::HEADING_UP].dy);
+    ASSERT_EQ(1000, prims[nrg::HEADING_DOWN].extra);
+}
+
+TEST(lattice, unreachable) {
+    array2d<int> terrain(6, 6);
+    for (int y = 0; y < 6; ++y) { terrain[3][y] = TERRAIN_WALL; }
+    nrg::lattice_planner planner;
+    std::vector<vector2i> path;
+    ASSERT_FALSE(planner.search(terrain, {0, 0}, {5, 5}, path));
+    ASSERT_FALSE(planner.search(terrain, {0, 0}, {3, 3}, path));
+    ASSERT_FALSE(planner.search(terrain, {0, 0}, {6, 0}, path));
+    ASSERT_TRUE(path.empty());
+    ASSERT_EQ(-1, planner.cost());
+    ASSERT_TRUE(planner.search(terrain, {1, 1}, {1, 1}, path));
+    ASSERT_EQ(1u, path.size());
+    ASSERT_EQ(0, planner.cost());
+}
@@ -0,0 +1,86 @@
+#include <gtest/gtest.h>
+
+#include <code/controller/penaltyfield.h>
+
+#include <cstdlib>
+
+static int brute_distance(array2d<int> &source, int x, int y, int wall) {
+    int nx = static_cast<int>(source.x());
+    int ny = static_cast<int>(source.y());
+    int d = std::min(std::min(x + 1, nx - x), std::min(y + 1, ny - y));
+    for (int tx = 0; tx < nx; ++tx) {
+        for (int ty = 0; ty < ny; ++ty) {
+            if (source[tx][ty] == wall) {
+                d = std::min(d, std::max(abs(tx - x), abs(ty - y)));
+            }
+        }
+    }
+    return d;
+}
+
+TEST(penalty_field, ring_penalties) {
+    array2d<int> a = {{-1, -1, -1, -1, -1, -1, -1, -1},
+                      {-1, -1, -1, -1, -1, -1, -1, -1},
+                      {-1, -1, -1, -1, -1, -1, -1, -1},
+                      {-1, -1, -1, -1, -1, -1, -1, -1},
+                      {-1, -1, -1, -1, -1, -1, -1, -1},
+                      {-1, -1, -1, -1, -1, -1, -1, -1},
+                      {-1, -1, -1, -1, -1, -1, -1, 0},
+                      {-1, -1, -1, -1, -1, -1, -1, -1}};
+    nrg::penalty_field field(0, nrg::ring_falloff(233, 16, 4), 3);
+    field.compute(a);
+    array2d<int> &t = field.terrain();
+    ASSERT_EQ(TERRAIN_WALL, t[6][7]);
+    ASSERT_EQ(233, t[0][0]);
+    ASSERT_EQ(233, t[5][6]);
+    ASSERT_EQ(16, t[1][1]);
+    ASSERT_EQ(16, t[4][5]);
+    ASSERT_EQ(4, t[2][2]);
+    ASSERT_EQ(4, t[3][4]);
+    ASSERT_EQ(0, t[3][3]);
+}
+
+TEST(penalty_field, incremental_matches_recompute) {
+    srand(7);
+    const int nx = 23;
+    const int ny = 17;
+    array2d<int> a(nx, ny);
+    for (int x = 0; x < nx; ++x) {
+        for (int y = 0; y < ny; ++y) {
+            a[x][y] = rand() % 9 == 0 ? 0 : -1;
+        }
+    }
+    auto falloff = [](int d) -> int { return 100 / (d * d); };
+    nrg::penalty_field field(0, falloff, 8);
+    field.compute(a);
+    for (int i = 0; i < 300; ++i) {
+        int x = rand() % nx;
+        int y = rand() % ny;
+        a[x][y] = a[x][y] == 0 ? -1 : 0;
+        field.set_wall(x, y, a[x][y] == 0);
+        if (i % 25 != 0) { continue; }
+        nrg::penalty_field fresh(0, falloff, 8);
+        fresh.compute(a);
+        for (int tx = 0; tx < nx; ++tx) {
+            for (int ty = 0; ty < ny; ++ty) {
+                ASSERT_EQ(brute_distance(a, tx, ty, 0), field.distance(tx, ty));
+                ASSERT_EQ(fresh.terrain()[tx][ty], field.terrain()[tx][ty]);
+            }
+        }
+    }
+}
+
+TEST(penalty_field, inflate_walls) {
+    array2d<int> a(9, 7);
+    a[4][3] = TERRAIN_WALL;
+    a[0][0] = 12;
+    nrg::inflate_walls(a, 2);
+    for (int x = 0; x < 9; ++x) {
+        for (int y = 0; y < 7; ++y) {
+            bool near = abs(x - 4) <= 2 && abs(y - 3) <= 2;
+            ASSERT_EQ(near, a[x][y] == TERRAIN_WALL);
+        }
+    }
+    // Penalties away from the walls are kept
+    ASSERT_EQ(12, a[0][0]);
+}
@@ -0,0 +1,73 @@
+#include <gtest/gtest.h>
+
+#include <code/controller/astar.h>
+#include <code/controller/penaltyfield.h>
+#include <code/controller/plancontext.h>
+#include <code/controller/thetastar.h>
+
+#include <cstdlib>
+
+TEST(theta_star, line_of_sight) {
+    array2d<int> a = {{0, 0,  0, 0},
+                      {0, 0, -1, 0},
+                      {0, -1, 0, 0},
+                      {0, 0,  0, 0}};
+    ASSERT_FALSE(nrg::line_of_sight(a, {0, 0}, {3, 3}));
+    ASSERT_TRUE(nrg::line_of_sight(a, {0, 0}, {0, 3}));
+    ASSERT_TRUE(nrg::line_of_sight(a, {0, 0}, {3, 0}));
+    // Diagonal squeeze between two walls is blocked
+    ASSERT_FALSE(nrg::line_of_sight(a, {1, 1}, {2, 2}));
+    ASSERT_FALSE(nrg::line_of_sight(a, {0, 3}, {3, 0}));
+    ASSERT_DOUBLE_EQ(3.0, nrg::line_cost(a, {0, 0}, {0, 3}));
+    ASSERT_DOUBLE_EQ(3.0, nrg::line_cost(a, {0, 0}, {3, 0}));
+}
+
+TEST(theta_star, straight_in_open_terrain) {
+    array2d<int> a(30, 20);
+    std::vector<vector2i> path;
+    ASSERT_TRUE(nrg::search_path_theta(a, {1, 2}, {27, 15}, path));
+    ASSERT_EQ(2u, path.size());
+    ASSERT_EQ(vector2i(1, 2), path.front());
+    ASSERT_EQ(vector2i(27, 15), path.back());
+}
+
+TEST(theta_star, few_visible_waypoints) {
+    srand(3);
+    const int nx = 60;
+    const int ny = 30;
+    array2d<int> a(nx, ny);
+    // A wall with a single gap, plus scattered obstacles
+    for (int y = 0; y < ny - 4; ++y) { a[30][y] = TERRAIN_WALL; }
+    for (int i = 0; i < 120; ++i) { a[rand() % nx][rand() % ny] = TERRAIN_WALL; }
+    a[2][2] = 0;
+    a[57][2] = 0;
+    for (int y = ny - 4; y < ny; ++y) { a[30][y] = 0; }
+    std::vector<vector2i> path;
+    ASSERT_TRUE(nrg::search_path_theta(a, {2, 2}, {57, 2}, path));
+    std::vector<vector2i> grid;
+    nrg::search_path_del(a, {2, 2}, {57, 2}, grid);
+    nrg::smooth_path(grid);
+    ASSERT_LT(path.size(), grid.size());
+    for (std::size_t i = 1; i < path.size(); ++i) {
+        ASSERT_TRUE(nrg::line_of_sight(a, path[i - 1], path[i]));
+    }
+    for (int y = ny - 4; y < ny; ++y) { a[30][y] = TERRAIN_WALL; }
+    path.clear();
+    ASSERT_FALSE(nrg::search_path_theta(a, {2, 2}, {57, 2}, path));
+    ASSERT_TRUE(path.empty());
+}
+
+TEST(theta_star, reuses_context) {
+    array2d<int> a(30, 20);
+    for (int y = 0; y < 16; ++y) { a[15][y] = TERRAIN_WALL; }
+    nrg::planner_context context;
+    std::vector<vector2i> first;
+    std::vector<vector2i> second;
+    ASSERT_TRUE(nrg::search_path_theta(context, a, {2, 2}, {27, 2}, first));
+    ASSERT_TRUE(nrg::search_path_theta(context, a, {2, 2}, {27, 2}, second));
+    ASSERT_EQ(first, second);
+    ASSERT_EQ(2u, context.queries());
+    std::vector<vector2i> expected;
+    ASSERT_TRUE(nrg::search_path_theta(a, {2, 2}, {27, 2}, expected));
+    ASSERT_EQ(expected, first);
+}
@@ -0,0 +1,119 @@
+#include <gtest/gtest.h>
+
+#include <code/controller/visibility.h>
+#include <code/utility/algorithm.h>
+
+#include <cmath>
+#include <cstdlib>
+
+typedef nrg::visibility_planner::point point;
+typedef nrg::visibility_planner::box box;
+
+static double path_length(const std::vector<point> &path) {
+    double len = 0;
+    for (std::size_t i = 1; i < path.size(); ++i) {
+        len += (path[i] - path[i - 1]).norm();
+    }
+    return len;
+}
+
+static bool crosses_interior(const point &a, const point &b, const box &r) {
+    box in(r.x() + 1e-3, r.y() + 1e-3, r.width() - 2e-3, r.height() - 2e-3);
+    return algo::segment_aabb_intersect(nrg::ray<double>(a, b), in);
+}
+
+TEST(visibility_planner, around_wall) {
+    nrg::visibility_planner planner({2, 2});
+    planner.set_walls({box(4, -5, 2, 10)});
+    ASSERT_EQ(4u, planner.nodes());
+    // Only the diagonals of the wall are blocked
+    ASSERT_EQ(4u, planner.edges());
+    std::vector<point> path;
+    ASSERT_TRUE(planner.search({0, 0}, {10, 0}, path));
+    ASSERT_EQ(4u, path.size());
+    ASSERT_EQ(point(0, 0), path.front());
+    ASSERT_EQ(point(10, 0), path.back());
+    // Over the inflated wall, from (3, -6) to (7, -6)
+    ASSERT_NEAR(2 * std::sqrt(9.0 + 36.0) + 4, path_length(path), 1e-9);
+
+    path.clear();
+    ASSERT_TRUE(planner.search({0, -10}, {10, -10}, path));
+    ASSERT_EQ(2u, path.size());
+    ASSERT_FALSE(planner.search({0, 0}, {5, 0}, path));
+}
+
+TEST(visibility_planner, wall_rects) {
+    array2d<int> walls(8, 6);
+    for (int x = 1; x < 5; ++x) {
+        for (int y = 1; y < 3; ++y) { walls[x][y] = 1; }
+    }
+    walls[6][5] = 1;
+    std::vector<box> rects = nrg::visibility_planner::wall_rects(walls, 1);
+    ASSERT_EQ(2u, rects.size());
+    ASSERT_DOUBLE_EQ(0.5, rects[0].x());
+    ASSERT_DOUBLE_EQ(0.5, rects[0].y());
+    ASSERT_DOUBLE_EQ(4, rects[0].width());
+    ASSERT_DOUBLE_EQ(2, rects[0].height());
+    ASSERT_DOUBLE_EQ(5.5, rects[1].x());
+    ASSERT_DOUBLE_EQ(4.5, rects[1].y());
+}
+
+TEST(visibility_planner, obstacle_edges) {
+    nrg::visibility_planner planner({2, 2});
+    planner.set_walls({});
+    std::size_t first = planner.add_obstacle(box(10, 10, 4, 4));
+    ASSERT_EQ(4u, planner.nodes());
+    // Only the sides of the box
+    ASSERT_EQ(4u, planner.edges());
+    planner.add_obstacle(box(30, 10, 4, 4));
+    ASSERT_EQ(8u, planner.nodes());
+    // The sides, eight edges between the tops and between the bottoms,
+    // and the two crossing tangents
+    ASSERT_EQ(18u, planner.edges());
+    planner.move_obstacle(first, box(10, 20, 4, 4));
+    planner.move_obstacle(first, box(10, 10, 4, 4));
+    ASSERT_EQ(18u, planner.edges());
+    planner.set_walls({});
+    ASSERT_EQ(18u, planner.edges());
+}
+
+TEST(visibility_planner, moving_obstacle_matches_rebuild) {
+    srand(8);
+    array2d<int> walls(60, 30);
+    for (int i = 0; i < 40; ++i) {
+        int x = rand() % 56;
+        int y = rand() % 26;
+        for (int k = 0; k < 4; ++k) { walls[x + (i % 2 ? k : 0)][y + (i % 2 ? 0 : k)] = 1; }
+    }
+    std::vector<box> rects = nrg::visibility_planner::wall_rects(walls, 1);
+    point robot(1, 1);
+    nrg::visibility_planner planner(robot, 8);
+    planner.set_walls(rects);
+    std::size_t handle = planner.add_obstacle(box(10, 10, 3, 3));
+    for (int move = 0; move < 15; ++move) {
+        box object(rand() % 50, rand() % 25, 2 + rand() % 4, 2 + rand() % 4);
+        planner.move_obstacle(handle, object);
+        nrg::visibility_planner fresh(robot, 8);
+        fresh.set_walls(rects);
+        fresh.add_obstacle(object);
+        ASSERT_EQ(fresh.edges(), planner.edges());
+
+        point start(-2, -2);
+        point dest(62, 32);
+        std::vector<point> path;
+        std::vector<point> expected;
+        bool found = planner.search(start, dest, path);
+        ASSERT_EQ(fresh.search(start, dest, expected), found);
+        ASSERT_TRUE(found);
+        ASSERT_NEAR(path_length(expected), path_length(path), 1e-9);
+        // No segment cuts through an inflated wall or the object
+        rects.push_back(object);
+        for (std::size_t i = 1; i < path.size(); ++i) {
+            for (const box &r : rects) {
+                box inflated(r.x() - 0.5, r.y() - 0.5, r.width() + 1, r.height() + 1);
+                ASSERT_FALSE(crosses_interior(path[i - 1], path[i], inflated));
+            }
+        }
+        rects.pop_back();
+    }
+}
@@ -0,0 +1,77 @@
+#include <gtest/gtest.h>
+#include <code/simulator/autotuner.h>
+#include <code/utility/logger.h>
+
+#include <sstream>
+
+namespace {
+
+    class AutoTunerTest : public ::testing::Test {
+    protected:
+        void SetUp() override {
+            Logger::setSilent();
+            AutoTuner::Config &config = tuner.config();
+            config.generations = 3;
+            config.population = 6;
+            config.elites = 3;
+            config.seeds = 2;
+            config.threads = 2;
+            config.seed = 5;
+            config.sim.noise = 1.0;
+            config.sim.timeout_ms = 20000;
+            // The gains only act with the PID law
+            tuner.add_dimension("control_law", 1, 1);
+            tuner.add_dimension("pid_kp", 2.0, 40.0);
+            tuner.add_dimension("pid_kd", 0.0, 2.0);
+            tuner.add_scenario({false, {0.0, 0.0}, {200.0, 200.0}, {{60.0, 0.0}, {60.0, 60.0}}});
+        }
+
+        void TearDown() override {
+            Logger::setStdout();
+        }
+
+        AutoTuner tuner;
+    };
+
+}
+
+TEST_F(AutoTunerTest, rejects_unknown_parameters) {
+    ASSERT_FALSE(tuner.add_dimension("no_such_param", 0, 1));
+    ASSERT_FALSE(tuner.add_dimension("pid_ki", 1, 0));
+    ASSERT_TRUE(AutoTuner::is_tunable("objproc_loc_acpt"));
+    ASSERT_EQ(3u, tuner.dimensions().size());
+}
+
+TEST_F(AutoTunerTest, best_is_no_worse_than_defaults) {
+    AutoTuner::Candidate defaults = tuner.evaluate({1.0, 20.0, 0.0});
+    ASSERT_TRUE(defaults.feasible);
+    ASSERT_EQ(2u, defaults.episodes);
+
+    AutoTuner::Candidate best = tuner.tune();
+    ASSERT_TRUE(best.feasible);
+    ASSERT_LE(best.cost, defaults.cost);
+    ASSERT_EQ(3u, tuner.history().size());
+    for (std::size_t i = 0; i < tuner.dimensions().size(); ++i) {
+        ASSERT_GE(best.values[i], tuner.dimensions()[i].lower);
+        ASSERT_LE(best.values[i], tuner.dimensions()[i].upper);
+    }
+}
+
+TEST_F(AutoTunerTest, same_seed_same_search) {
+    AutoTuner::Candidate a = tuner.tune();
+    tuner.config().threads = 3;
+    AutoTuner::Candidate b = tuner.tune();
+    ASSERT_EQ(a.values, b.values);
+    ASSERT_DOUBLE_EQ(a.cost, b.cost);
+}
+
+TEST_F(AutoTunerTest, writes_profile) {
+    AutoTuner::Candidate candidate{{1.0, 1.5, 0.25}, 1000, 0, 2, true};
+    std::stringstream ss;
+    tuner.write_profile(ss, candidate);
+    std::string profile = ss.str();
+    ASSERT_EQ('#', profile[0]);
+    ASSERT_NE(std::string::npos, profile.find("\ncontrol_law 1\n"));
+    ASSERT_NE(std::string::npos, profile.find("\npid_kp 1.5\n"));
+    ASSERT_NE(std::string::npos, profile.find("\npid_kd 0.25\n"));
+}
@@ -30,3 +30,13 @@ TEST(common, robot_object_path) {
         ASSERT_EQ(exp_top[i].y(), res_top[i].y());
     }
 }
+
+TEST(common, robot_object_path_against_corner) {
+    // The robot touches the top-left corner of the object, so sweeping
+    // it to most of the points around the object hits the object
+    rect2d obj(28, -8, 24, 16);
+    rect2d rob(12, -24, 16, 16);
+    for (int side = nrg::dir::TOP; side <= nrg::dir::LEFT; ++side) {
+        ASSERT_TRUE(algo::robot_object_path(rob, obj, side).empty());
+    }
+}
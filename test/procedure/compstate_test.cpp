@@ -0,0 +1,86 @@
+#include <gtest/gtest.h>
+#include <code/compstate/compstate.h>
+#include <code/compstate/parammanager.h>
+#include <code/utility/logger.h>
+
+#include <opencv2/core/types.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+namespace {
+
+    typedef nrg::control_scheduler::clock control_clock;
+
+    class CompetitionStateTest : public ::testing::Test {
+    protected:
+        void SetUp() override {
+            Logger::setSilent();
+        }
+
+        void TearDown() override {
+            Logger::setStdout();
+        }
+
+        param_manager params{nullptr};
+        CompetitionState state{nullptr, &params};
+    };
+
+}
+
+TEST_F(CompetitionStateTest, snapshot_follows_boxes) {
+    CompetitionState::Snapshot first = state.snapshot();
+    ASSERT_EQ(0u, first.seq);
+    ASSERT_FALSE(first.robot_fresh);
+
+    control_clock::time_point t0;
+    state.receive_robot_box({10, 20, 20, 20}, t0 + std::chrono::milliseconds(5), t0 + std::chrono::milliseconds(50));
+    state.receive_object_box({40, 0, 24, 16}, t0 + std::chrono::milliseconds(6), t0 + std::chrono::milliseconds(60));
+    state.acquire_target_box({1, 2, 3, 4});
+    CompetitionState::Snapshot s = state.snapshot();
+    ASSERT_EQ(2u, s.seq);
+    ASSERT_EQ(10, s.robot[0]);
+    ASSERT_EQ(20, s.robot[3]);
+    ASSERT_EQ(24, s.object[2]);
+    ASSERT_EQ(4, s.target[3]);
+    ASSERT_EQ(5000000, s.robot_captured_ns);
+    ASSERT_EQ(60000000, s.object_received_ns);
+    ASSERT_TRUE(s.robot_fresh);
+    ASSERT_TRUE(s.object_fresh);
+    // Of the calibrated area of 400
+    ASSERT_TRUE(s.robot_valid);
+}
+
+TEST_F(CompetitionStateTest, snapshot_is_never_torn) {
+    std::atomic<bool> done(false);
+    std::atomic<int> torn(0);
+    std::thread reader([this, &done, &torn] {
+        std::uint64_t last = 0;
+        while (!done) {
+            CompetitionState::Snapshot s = state.snapshot();
+            // Each box is received with its fields and times equal to
+            // the number of boxes received before it
+            bool whole = s.robot[0] == s.robot[1] && s.robot[0] == s.robot[2]
+                         && s.object[0] == s.object[1] && s.object[0] == s.object[2]
+                         && s.robot_captured_ns == s.robot_received_ns
+                         && s.object_captured_ns == s.object_received_ns;
+            if (!whole || s.seq < last) { ++torn; }
+            last = s.seq;
+        }
+    });
+    control_clock::time_point t0;
+    for (int i = 1; i <= 20000; ++i) {
+        double v = i;
+        control_clock::time_point t = t0 + std::chrono::nanoseconds(i);
+        if (i % 2) {
+            state.receive_robot_box({v, v, v, 20}, t, t);
+        } else {
+            state.receive_object_box({v, v, v, 16}, t, t);
+        }
+    }
+    done = true;
+    reader.join();
+    ASSERT_EQ(0, torn);
+    ASSERT_EQ(20000u, state.snapshot().seq);
+}
@@ -0,0 +1,129 @@
+#include <gtest/gtest.h>
+#include <code/compstate/controlscheduler.h>
+
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+typedef nrg::control_scheduler::clock sched_clock;
+
+TEST(control_scheduler, runs_loops_in_order) {
+    nrg::control_scheduler scheduler;
+    std::vector<int> order;
+    scheduler.add([&order] { order.push_back(1); });
+    nrg::control_scheduler::handle h = scheduler.add([&order] { order.push_back(2); });
+    scheduler.add([&order] { order.push_back(3); });
+    scheduler.tick();
+    scheduler.remove(h);
+    scheduler.tick();
+    ASSERT_EQ((std::vector<int>{1, 2, 3, 1, 3}), order);
+    ASSERT_EQ(2u, scheduler.stats().ticks);
+    // Boxes with no active loop are not counted
+    scheduler.remove(1);
+    scheduler.remove(3);
+    scheduler.tick();
+    ASSERT_EQ(2u, scheduler.stats().ticks);
+}
+
+TEST(control_scheduler, changes_during_tick) {
+    nrg::control_scheduler scheduler;
+    std::vector<int> order;
+    nrg::control_scheduler::handle outer = nrg::control_scheduler::NO_HANDLE;
+    nrg::control_scheduler::handle inner = nrg::control_scheduler::NO_HANDLE;
+    outer = scheduler.add([&] {
+        order.push_back(1);
+        if (inner == nrg::control_scheduler::NO_HANDLE) {
+            // Started procedures run from the next box
+            inner = scheduler.add([&] { order.push_back(2); });
+        } else {
+            // Removed procedures do not run again, even in this tick
+            scheduler.remove(inner);
+            scheduler.remove(outer);
+        }
+    });
+    scheduler.tick();
+    ASSERT_EQ((std::vector<int>{1}), order);
+    scheduler.tick();
+    ASSERT_EQ((std::vector<int>{1, 1}), order);
+    ASSERT_EQ(0u, scheduler.size());
+}
+
+TEST(control_scheduler, adds_many_during_tick) {
+    struct context {
+        nrg::control_scheduler scheduler;
+        std::vector<int> order;
+    } ctx;
+    // A small loop is held inside its function, so it would move if
+    // the list were reallocated under it
+    ctx.scheduler.add([&ctx] {
+        if (ctx.order.empty()) {
+            for (int i = 0; i < 64; ++i) {
+                ctx.scheduler.add([&ctx] { ctx.order.push_back(2); });
+            }
+            // A loop added and removed in one tick never runs
+            ctx.scheduler.remove(ctx.scheduler.add([&ctx] { ctx.order.push_back(3); }));
+        }
+        ctx.order.push_back(1);
+    });
+    ctx.scheduler.tick();
+    ASSERT_EQ((std::vector<int>{1}), ctx.order);
+    ASSERT_EQ(65u, ctx.scheduler.size());
+    ctx.scheduler.tick();
+    ASSERT_EQ(66u, ctx.order.size());
+    ASSERT_EQ(1, ctx.order[1]);
+    ASSERT_EQ(64, std::count(ctx.order.begin(), ctx.order.end(), 2));
+}
+
+TEST(control_scheduler, watchdog) {
+    nrg::control_scheduler scheduler(std::chrono::milliseconds(100));
+    sched_clock::time_point t0 = sched_clock::now();
+    // Nothing is waiting on boxes yet
+    ASSERT_FALSE(scheduler.check_watchdog(t0 + std::chrono::seconds(1)));
+    scheduler.add([] {});
+    scheduler.tick(t0);
+    ASSERT_FALSE(scheduler.check_watchdog(t0 + std::chrono::milliseconds(50)));
+    ASSERT_TRUE(scheduler.check_watchdog(t0 + std::chrono::milliseconds(150)));
+    ASSERT_TRUE(scheduler.is_tracking_lost());
+    // Trips once per loss
+    ASSERT_FALSE(scheduler.check_watchdog(t0 + std::chrono::milliseconds(300)));
+    ASSERT_EQ(1u, scheduler.stats().watchdog_trips);
+    scheduler.tick(t0 + std::chrono::milliseconds(310));
+    ASSERT_FALSE(scheduler.is_tracking_lost());
+}
+
+TEST(control_scheduler, latency_stats) {
+    nrg::control_scheduler scheduler;
+    scheduler.add([] {});
+    sched_clock::time_point received = sched_clock::now() - std::chrono::milliseconds(20);
+    scheduler.tick(received);
+    scheduler.tick();
+    const nrg::tick_stats &stats = scheduler.stats();
+    ASSERT_EQ(2u, stats.ticks);
+    ASSERT_GE(stats.max_latency_ms(), 20.0);
+    ASSERT_LT(stats.last_latency_ms(), stats.max_latency_ms());
+    ASSERT_GE(stats.mean_latency_ms(), 10.0);
+    scheduler.reset_stats();
+    ASSERT_EQ(0u, scheduler.stats().ticks);
+}
+
+TEST(control_scheduler, records_tick_intervals) {
+    nrg::control_scheduler scheduler;
+    sched_clock::time_point t = sched_clock::now();
+    // Boxes with no loop do not count towards the intervals
+    scheduler.tick(t, t);
+    scheduler.add([] {});
+    scheduler.tick(t + std::chrono::milliseconds(5), t + std::chrono::milliseconds(5));
+    // Intervals are between the starts of the ticks, so a tick that
+    // starts late shows as jitter even if its box arrived on time
+    scheduler.tick(t + std::chrono::milliseconds(20), t + std::chrono::milliseconds(25));
+    scheduler.tick(t + std::chrono::milliseconds(40), t + std::chrono::milliseconds(45));
+    scheduler.tick(t + std::chrono::milliseconds(60), t + std::chrono::milliseconds(78));
+    const nrg::histogram &interval = scheduler.stats().interval;
+    ASSERT_EQ(3u, interval.count());
+    ASSERT_EQ(2u, interval.bucket(20));
+    ASSERT_EQ(1u, interval.bucket(33));
+    ASSERT_DOUBLE_EQ(33, interval.max());
+    scheduler.reset_stats();
+    scheduler.tick(t + std::chrono::milliseconds(90));
+    ASSERT_EQ(0u, scheduler.stats().interval.count());
+}
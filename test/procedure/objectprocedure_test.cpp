@@ -1,6 +1,33 @@
 #include <gtest/gtest.h>
+#include <code/compstate/compstate.h>
 #include <code/compstate/objectprocedure.h>
+#include <code/compstate/parammanager.h>
+#include <code/controller/controller.h>
+#include <code/utility/logger.h>
+#include <code/utility/vector.h>
+
+#include <opencv2/core/types.hpp>
 
 TEST(object_procedure, convert_move_node) {
 
 }
+
+TEST(object_procedure, fails_when_ready_move_fails) {
+    Logger::setSilent();
+    param_manager params(nullptr);
+    params.predict_latency = 0;
+    CompetitionState state(nullptr, &params);
+    nrg::control_scheduler::clock::time_point t0;
+    // The robot touches the top-left corner of the object
+    state.receive_robot_box({12, -24, 16, 16}, t0, t0);
+    state.receive_object_box({28, -8, 24, 16}, t0, t0);
+    // Without a controller the collision is resolved at once, which
+    // leaves the robot where it cannot get around the object
+    path2d path = {{100.0, 0.0}};
+    ObjectProcedure procedure(state, std::weak_ptr<Controller>(), path);
+    procedure.start();
+    state.receive_robot_box({12, -24, 16, 16}, t0, t0);
+    Logger::setStdout();
+    ASSERT_TRUE(procedure.is_done());
+    ASSERT_TRUE(procedure.is_failed());
+}
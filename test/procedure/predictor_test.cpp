@@ -0,0 +1,99 @@
+#include <gtest/gtest.h>
+#include <code/compstate/predictor.h>
+
+#include <chrono>
+
+typedef nrg::pose_predictor::clock pred_clock;
+
+static pred_clock::duration ms(int n) {
+    return std::chrono::milliseconds(n);
+}
+
+TEST(pose_predictor, still_body) {
+    nrg::pose_predictor predictor;
+    pred_clock::time_point t0;
+    ASSERT_FALSE(predictor.has_estimate());
+    for (int i = 0; i < 5; ++i) {
+        pred_clock::time_point captured = t0 + ms(33 * i);
+        predictor.observe({10.0, 20.0}, captured, captured + ms(100));
+    }
+    ASSERT_TRUE(predictor.has_estimate());
+    ASSERT_NEAR(100.0, predictor.latency_ms(), 1e-9);
+    ASSERT_NEAR(100.0, predictor.max_latency_ms(), 1e-9);
+    vector2d predicted = predictor.predict(t0 + ms(33 * 4 + 100), ms(250));
+    ASSERT_NEAR(10.0, predicted.x(), 1e-9);
+    ASSERT_NEAR(20.0, predicted.y(), 1e-9);
+}
+
+TEST(pose_predictor, extrapolates_velocity) {
+    nrg::pose_predictor predictor;
+    pred_clock::time_point t0;
+    // 60 px/s along x
+    for (int i = 0; i < 40; ++i) {
+        predictor.observe({2.0 * i, 0.0}, t0 + ms(33 * i), t0 + ms(33 * i + 100));
+    }
+    pred_clock::time_point last = t0 + ms(33 * 39);
+    ASSERT_NEAR(60.6, predictor.velocity().x(), 0.5);
+    vector2d predicted = predictor.predict(last + ms(100), ms(250));
+    ASSERT_NEAR(78.0 + 6.06, predicted.x(), 0.2);
+    // Extrapolation stops at the horizon
+    vector2d far = predictor.predict(last + ms(5000), ms(250));
+    ASSERT_NEAR(78.0 + 15.15, far.x(), 0.5);
+}
+
+TEST(pose_predictor, accounts_commands_in_flight) {
+    nrg::pose_predictor predictor;
+    pred_clock::time_point t0;
+    const int latency = 100;
+    const int frame = 20;
+    const double step = 2.5;
+    // The body moves a step on each command, one sent every frame,
+    // and the camera sees it five frames late
+    const int late = latency / frame;
+    double x = 0;
+    for (int i = 0; i < 60; ++i) {
+        pred_clock::time_point now = t0 + ms(frame * i);
+        pred_clock::time_point captured = now - ms(latency);
+        double seen_x = i >= late ? step * (i - late + 1) : 0;
+        predictor.observe({seen_x, 0.0}, captured, now);
+        vector2d predicted = predictor.predict_scored(now, ms(250));
+        if (i > 30) {
+            ASSERT_NEAR(x, predicted.x(), 0.5);
+        }
+        predictor.command({1.0, 0.0}, now);
+        x += step;
+    }
+    ASSERT_NEAR(step, predictor.command_gain(), 0.05);
+    ASSERT_GT(predictor.scored(), 0u);
+    ASSERT_LT(predictor.prediction_err(), predictor.unpredicted_err());
+}
+
+TEST(pose_predictor, close_frames_keep_velocity) {
+    nrg::pose_predictor predictor;
+    pred_clock::time_point t0;
+    predictor.observe({0.0, 0.0}, t0, t0);
+    predictor.observe({0.0, 0.0}, t0 + ms(33), t0 + ms(33));
+    // Tracker jitter on a frame captured right after the last one
+    pred_clock::time_point close = t0 + ms(33) + std::chrono::microseconds(1);
+    predictor.observe({1.0, -1.0}, close, close);
+    ASSERT_NEAR(0.0, predictor.velocity().x(), 1e-9);
+    ASSERT_NEAR(0.0, predictor.velocity().y(), 1e-9);
+    vector2d predicted = predictor.predict(close + ms(100), ms(250));
+    ASSERT_NEAR(1.0, predicted.x(), 1e-9);
+    ASSERT_NEAR(-1.0, predicted.y(), 1e-9);
+    // Frames further apart update the velocity again
+    predictor.observe({2.0, 0.0}, t0 + ms(66), t0 + ms(66));
+    ASSERT_GT(predictor.velocity().x(), 0.0);
+}
+
+TEST(pose_predictor, reset_keeps_gain) {
+    nrg::pose_predictor predictor;
+    pred_clock::time_point t0;
+    predictor.observe({0.0, 0.0}, t0, t0);
+    predictor.command({0.0, 1.0}, t0 + ms(10));
+    predictor.observe({0.0, 3.0}, t0 + ms(20), t0 + ms(20));
+    ASSERT_NEAR(3.0, predictor.command_gain(), 1e-9);
+    predictor.reset();
+    ASSERT_FALSE(predictor.has_estimate());
+    ASSERT_NEAR(3.0, predictor.command_gain(), 1e-9);
+}
@@ -0,0 +1,43 @@
+#include <gtest/gtest.h>
+#include <code/compstate/compstate.h>
+#include <code/compstate/parammanager.h>
+#include <code/compstate/readymove.h>
+#include <code/controller/controller.h>
+#include <code/utility/logger.h>
+#include <code/utility/rect.h>
+
+#include <opencv2/core/types.hpp>
+
+namespace {
+
+    typedef nrg::control_scheduler::clock control_clock;
+
+    class ReadyMoveTest : public ::testing::Test {
+    protected:
+        void SetUp() override {
+            Logger::setSilent();
+            params.predict_latency = 0;
+        }
+
+        void TearDown() override {
+            Logger::setStdout();
+        }
+
+        param_manager params{nullptr};
+        CompetitionState state{nullptr, &params};
+    };
+
+}
+
+TEST_F(ReadyMoveTest, fails_against_object_corner) {
+    // Without a controller the procedure resolving the collision ends
+    // at once, leaving the robot against the corner of the object
+    ReadyMove ready_move(state, std::weak_ptr<Controller>(), nrg::dir::LEFT);
+    ready_move.start();
+    control_clock::time_point t0;
+    state.receive_robot_box({12, -24, 16, 16}, t0, t0);
+    ASSERT_FALSE(ready_move.is_done());
+    state.receive_object_box({28, -8, 24, 16}, t0, t0);
+    ASSERT_TRUE(ready_move.is_done());
+    ASSERT_TRUE(ready_move.is_failed());
+}
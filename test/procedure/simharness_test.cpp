@@ -0,0 +1,131 @@
+#include <gtest/gtest.h>
+#include <code/simulator/simharness.h>
+#include <code/compstate/parammanager.h>
+#include <code/utility/flight_recorder.h>
+#include <code/utility/logger.h>
+
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+
+namespace {
+
+    class SimHarnessTest : public ::testing::Test {
+    protected:
+        void SetUp() override {
+            Logger::setSilent();
+        }
+
+        void TearDown() override {
+            Logger::setStdout();
+        }
+    };
+
+}
+
+TEST_F(SimHarnessTest, traversal_reaches_the_end) {
+    SimHarness harness;
+    path2d path = {{40.0, 40.0}, {-20.0, 40.0}, {-20.0, -30.0}};
+    SimHarness::Result result = harness.run_traversal(path);
+    ASSERT_TRUE(result.done);
+    ASSERT_GT(result.commands, 0u);
+    ASSERT_GT(result.frames, 0u);
+    // Within the default acceptance radius of the procedure
+    ASSERT_LT(result.final_err, 10.0);
+    ASSERT_LE(result.mean_path_err, result.max_path_err);
+}
+
+TEST_F(SimHarnessTest, runs_faster_than_real_time) {
+    SimHarness harness;
+    path2d path = {{60.0, 0.0}, {60.0, 60.0}};
+    SimHarness::Result result = harness.run_traversal(path);
+    ASSERT_TRUE(result.done);
+    ASSERT_LT(result.wall_ms, result.time_ms);
+}
+
+TEST_F(SimHarnessTest, same_seed_same_run) {
+    SimHarness::Config config;
+    config.noise = 1.5;
+    config.seed = 17;
+    path2d path = {{40.0, 40.0}, {-20.0, 40.0}};
+    SimHarness first(config);
+    SimHarness::Result a = first.run_traversal(path);
+    SimHarness::Result b = first.run_traversal(path);
+    ASSERT_EQ(a.frames, b.frames);
+    ASSERT_EQ(a.commands, b.commands);
+    ASSERT_DOUBLE_EQ(a.mean_path_err, b.mean_path_err);
+    ASSERT_DOUBLE_EQ(a.final_err, b.final_err);
+}
+
+TEST_F(SimHarnessTest, times_out_without_progress) {
+    SimHarness::Config config;
+    config.timeout_ms = 500;
+    SimHarness harness(config);
+    path2d path = {{4000.0, 0.0}};
+    SimHarness::Result result = harness.run_traversal(path);
+    ASSERT_FALSE(result.done);
+    ASSERT_GE(result.time_ms, 500.0);
+}
+
+TEST_F(SimHarnessTest, object_move_finishes) {
+    SimHarness::Config config;
+    config.robot = {-40.0, 0.0};
+    SimHarness harness(config);
+    path2d path = {{100.0, 0.0}, {100.0, 40.0}};
+    SimHarness::Result result = harness.run_object_move(path);
+    ASSERT_TRUE(result.done);
+    ASSERT_GT(result.commands, 0u);
+}
+
+TEST_F(SimHarnessTest, prediction_compensates_latency) {
+    SimHarness::Config config;
+    config.latency_ms = 100;
+    path2d path = {{40.0, 40.0}, {-20.0, 40.0}, {-20.0, -30.0}};
+    SimHarness predicted(config);
+    predicted.params().predict_latency = 1;
+    SimHarness::Result with = predicted.run_traversal(path);
+    SimHarness seen(config);
+    seen.params().predict_latency = 0;
+    SimHarness::Result without = seen.run_traversal(path);
+    ASSERT_TRUE(with.done);
+    ASSERT_LT(with.time_ms, without.time_ms);
+    ASSERT_LT(with.prediction_err, with.unpredicted_err);
+}
+
+TEST_F(SimHarnessTest, records_control_ticks) {
+    SimHarness::Config config;
+    config.flight_record = "simharness_test.bin";
+    SimHarness harness(config);
+    path2d path = {{60.0, 0.0}, {60.0, 60.0}};
+    SimHarness::Result result = harness.run_traversal(path);
+    ASSERT_TRUE(result.done);
+
+    std::ifstream in(config.flight_record, std::ios::binary);
+    std::vector<nrg::flight_record> records;
+    ASSERT_TRUE(nrg::read_flight_log(in, records));
+    std::remove(config.flight_record.c_str());
+    ASSERT_FALSE(records.empty());
+    std::size_t commands = 0;
+    for (std::size_t i = 0; i < records.size(); ++i) {
+        const nrg::flight_record &r = records[i];
+        ASSERT_EQ(i, r.seq);
+        ASSERT_LE(r.captured_ns, r.received_ns);
+        commands += r.commands;
+        // The procedure steps for each new robot box
+        if (r.source == nrg::flight_record::ROBOT_BOX) {
+            ASSERT_STREQ("Procedure", r.procedure);
+            ASSERT_STREQ("TRAVERSE", r.state);
+        }
+    }
+    ASSERT_EQ(result.commands, commands);
+    // The error closes in on the last node, and the last ticks of the
+    // traversal reach it with no error to give
+    float last_err = NAN;
+    for (const nrg::flight_record &r : records) {
+        if (!std::isnan(r.err)) { last_err = r.err; }
+    }
+    ASSERT_LT(last_err, 10.0f);
+    ASSERT_GT(records.front().err, 50.0f);
+    ASSERT_TRUE(std::isnan(records.back().err));
+    ASSERT_STREQ("Procedure", records.back().procedure);
+}
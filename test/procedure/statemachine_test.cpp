@@ -0,0 +1,181 @@
+#include <gtest/gtest.h>
+#include <code/compstate/statemachine.h>
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+typedef nrg::state_machine::clock sm_clock;
+
+namespace {
+
+    // Child that acts on each tick and finishes, or fails, after a
+    // number of them
+    class counter : public nrg::state_machine {
+    public:
+        counter(std::vector<std::string> &log, int ticks, bool fails) :
+            nrg::state_machine({"COUNT"}),
+            m_log(log),
+            m_left(ticks),
+            m_fails(fails) {}
+
+    protected:
+        void step(int) override {
+            m_log.push_back("child");
+            if (--m_left == 0) {
+                if (m_fails) { fail(); }
+                else { finish(); }
+            }
+        }
+
+    private:
+        std::vector<std::string> &m_log;
+        int m_left;
+        bool m_fails;
+    };
+
+    // Parent that starts a child, waits for it, then finishes
+    class parent : public nrg::state_machine {
+    public:
+        enum { REQUIRE_CHILD, DOING_CHILD, DONE_CHILD };
+
+        parent(std::vector<std::string> &log, int child_ticks, bool child_fails = false) :
+            nrg::state_machine({"REQUIRE_CHILD", "DOING_CHILD", "DONE_CHILD"}),
+            m_log(log),
+            m_child_ticks(child_ticks),
+            m_child_fails(child_fails) {}
+
+        // Whether the boxes the machine needs are fresh
+        bool fresh = true;
+
+    protected:
+        bool ready() const override {
+            return fresh;
+        }
+
+        void step(int state) override {
+            m_log.push_back(state_name(state));
+            switch (state) {
+                case REQUIRE_CHILD:
+                    m_child.reset(new counter(m_log, m_child_ticks, m_child_fails));
+                    transition(DOING_CHILD);
+                    break;
+                case DOING_CHILD:
+                    m_child->tick(now());
+                    if (m_child->is_failed()) {
+                        fail();
+                    } else if (m_child->is_done()) {
+                        m_child.reset();
+                        transition(DONE_CHILD);
+                    }
+                    break;
+                case DONE_CHILD:
+                    finish();
+                    break;
+                default:
+                    break;
+            }
+        }
+
+    private:
+        std::vector<std::string> &m_log;
+        int m_child_ticks;
+        bool m_child_fails;
+        std::unique_ptr<counter> m_child;
+    };
+
+    // Machine whose two states hand over to each other forever
+    class looping : public nrg::state_machine {
+    public:
+        looping() :
+            nrg::state_machine({"PING", "PONG"}),
+            steps(0) {}
+
+        int steps;
+
+    protected:
+        void step(int state) override {
+            ++steps;
+            transition(1 - state);
+        }
+    };
+
+}
+
+TEST(state_machine, parent_and_child_transition_in_one_tick) {
+    std::vector<std::string> log;
+    parent machine(log, 1);
+    machine.tick();
+    ASSERT_TRUE(machine.is_done());
+    ASSERT_FALSE(machine.is_failed());
+    ASSERT_EQ((std::vector<std::string>{
+        "REQUIRE_CHILD", "DOING_CHILD", "child", "DONE_CHILD"
+    }), log);
+    // Finished machines are not ticked again
+    machine.tick();
+    ASSERT_EQ(4u, log.size());
+}
+
+TEST(state_machine, waits_in_state_until_child_done) {
+    std::vector<std::string> log;
+    parent machine(log, 3);
+    machine.tick();
+    ASSERT_EQ(parent::DOING_CHILD, machine.state());
+    machine.fresh = false;
+    machine.tick();
+    ASSERT_EQ(3u, log.size());
+    machine.fresh = true;
+    machine.tick();
+    machine.tick();
+    ASSERT_TRUE(machine.is_done());
+    ASSERT_EQ((std::vector<std::string>{
+        "REQUIRE_CHILD", "DOING_CHILD", "child",
+        "DOING_CHILD", "child",
+        "DOING_CHILD", "child", "DONE_CHILD"
+    }), log);
+}
+
+TEST(state_machine, child_failure_fails_parent) {
+    std::vector<std::string> log;
+    parent machine(log, 2, true);
+    machine.tick();
+    ASSERT_FALSE(machine.is_done());
+    machine.tick();
+    ASSERT_TRUE(machine.is_done());
+    ASSERT_TRUE(machine.is_failed());
+    ASSERT_EQ(0u, machine.state_times()[parent::DONE_CHILD].entries);
+    machine.tick();
+    ASSERT_EQ(5u, log.size());
+}
+
+TEST(state_machine, accounts_time_in_states) {
+    std::vector<std::string> log;
+    parent machine(log, 3);
+    sm_clock::time_point t0 = sm_clock::now();
+    machine.tick(t0);
+    machine.tick(t0 + std::chrono::milliseconds(100));
+    machine.tick(t0 + std::chrono::milliseconds(250));
+    const std::vector<nrg::state_time> &times = machine.state_times();
+    ASSERT_EQ(1u, times[parent::REQUIRE_CHILD].entries);
+    ASSERT_EQ(1u, times[parent::REQUIRE_CHILD].ticks);
+    ASSERT_DOUBLE_EQ(0, times[parent::REQUIRE_CHILD].time_ms());
+    ASSERT_EQ(1u, times[parent::DOING_CHILD].entries);
+    ASSERT_EQ(3u, times[parent::DOING_CHILD].ticks);
+    ASSERT_DOUBLE_EQ(250, times[parent::DOING_CHILD].time_ms());
+    ASSERT_EQ(1u, times[parent::DONE_CHILD].ticks);
+    ASSERT_EQ((std::vector<std::string>{
+        "REQUIRE_CHILD: 1 entries 1 ticks 0.0 ms",
+        "DOING_CHILD: 1 entries 3 ticks 250.0 ms",
+        "DONE_CHILD: 1 entries 1 ticks 0.0 ms"
+    }), machine.state_rows());
+}
+
+TEST(state_machine, bounds_transitions_per_tick) {
+    looping machine;
+    machine.tick();
+    ASSERT_EQ(nrg::state_machine::MAX_TRANSITIONS, machine.steps);
+    machine.tick();
+    ASSERT_EQ(2 * nrg::state_machine::MAX_TRANSITIONS, machine.steps);
+    ASSERT_FALSE(machine.is_done());
+}
@@ -0,0 +1,53 @@
+#include <gtest/gtest.h>
+
+#include <code/utility/arena.h>
+#include <code/utility/indexed_heap.h>
+
+#include <cstdint>
+
+TEST(arena, aligned_bump_allocation) {
+    nrg::arena a(256);
+    char *c = a.array<char>(3);
+    auto *d = a.array<double>(4);
+    ASSERT_EQ(0u, reinterpret_cast<std::uintptr_t>(d) % alignof(double));
+    ASSERT_GE(reinterpret_cast<char *>(d), c + 3);
+    ASSERT_GE(a.used(), 3 + 4 * sizeof(double));
+    ASSERT_EQ(0u, a.chained());
+    a.reset();
+    ASSERT_EQ(0u, a.used());
+    // Memory is handed out again from the start of the block
+    ASSERT_EQ(c, a.array<char>(1));
+}
+
+TEST(arena, chains_then_coalesces) {
+    nrg::arena a(64);
+    a.array<int>(10);
+    a.array<int>(100);
+    ASSERT_EQ(1u, a.chained());
+    std::size_t peak = a.peak();
+    a.reset();
+    // One block now fits the whole query
+    a.array<int>(10);
+    a.array<int>(100);
+    ASSERT_EQ(1u, a.chained());
+    ASSERT_EQ(peak, a.peak());
+}
+
+TEST(arena, backs_containers) {
+    nrg::arena a;
+    nrg::arena_vector<int> v{nrg::arena_allocator<int>(a)};
+    for (int i = 0; i < 1000; ++i) {
+        v.push_back(i);
+    }
+    ASSERT_EQ(999, v.back());
+    ASSERT_GE(a.used(), 1000 * sizeof(int));
+
+    typedef nrg::arena_allocator<int> int_alloc;
+    nrg::indexed_heap<int, int_alloc> heap(8, int_alloc(a));
+    heap.push(3, 30);
+    heap.push(5, 10);
+    heap.push(1, 20);
+    ASSERT_EQ(5u, heap.pop());
+    ASSERT_EQ(1u, heap.pop());
+    ASSERT_EQ(3u, heap.pop());
+}
@@ -0,0 +1,124 @@
+#include <gtest/gtest.h>
+
+#include <code/utility/array2d.h>
+#include <code/utility/bit_grid.h>
+
+#include <cstdlib>
+#include <random>
+
+static nrg::bit_grid random_grid(std::size_t nx, std::size_t ny, double density, std::mt19937 &rng) {
+    std::bernoulli_distribution occupied(density);
+    nrg::bit_grid g(nx, ny);
+    for (int x = 0; x < static_cast<int>(nx); ++x) {
+        for (int y = 0; y < static_cast<int>(ny); ++y) {
+            g.set(x, y, occupied(rng));
+        }
+    }
+    return g;
+}
+
+static bool in_footprint(int dx, int dy, int radius, nrg::bit_grid::footprint shape) {
+    if (shape == nrg::bit_grid::SQUARE) {
+        return abs(dx) <= radius && abs(dy) <= radius;
+    }
+    return dx * dx + dy * dy <= radius * radius;
+}
+
+static nrg::bit_grid brute_dilate(const nrg::bit_grid &g, int radius, nrg::bit_grid::footprint shape) {
+    int nx = static_cast<int>(g.x());
+    int ny = static_cast<int>(g.y());
+    nrg::bit_grid out(g.x(), g.y());
+    for (int x = 0; x < nx; ++x) {
+        for (int y = 0; y < ny; ++y) {
+            bool hit = false;
+            for (int dx = -radius; dx <= radius && !hit; ++dx) {
+                for (int dy = -radius; dy <= radius && !hit; ++dy) {
+                    int tx = x + dx;
+                    int ty = y + dy;
+                    hit = in_footprint(dx, dy, radius, shape) &&
+                          tx >= 0 && ty >= 0 && tx < nx && ty < ny && g.get(tx, ty);
+                }
+            }
+            out.set(x, y, hit);
+        }
+    }
+    return out;
+}
+
+TEST(bit_grid, set_get_count) {
+    nrg::bit_grid g(3, 130);
+    ASSERT_EQ(3u, g.stride());
+    g.set(0, 0, true);
+    g.set(1, 63, true);
+    g.set(1, 64, true);
+    g.set(2, 129, true);
+    ASSERT_TRUE(g.get(1, 64));
+    ASSERT_FALSE(g.get(1, 65));
+    ASSERT_EQ(4u, g.count());
+    g.set(1, 63, false);
+    ASSERT_EQ(3u, g.count());
+    ASSERT_EQ(1, g.count_neighbors(1, 65));
+    ASSERT_EQ(1, g.count_window(1, 64, 1));
+    ASSERT_EQ(3, g.count_window(1, 64, 65));
+}
+
+TEST(bit_grid, dilation_matches_brute_force) {
+    std::mt19937 rng(5);
+    const nrg::bit_grid::footprint shapes[] = {nrg::bit_grid::SQUARE, nrg::bit_grid::DISC};
+    for (std::size_t ny : {30u, 64u, 150u}) {
+        nrg::bit_grid g = random_grid(40, ny, 0.02, rng);
+        for (int radius = 0; radius <= 70; radius += radius < 4 ? 1 : 33) {
+            for (nrg::bit_grid::footprint shape : shapes) {
+                ASSERT_TRUE(brute_dilate(g, radius, shape) == g.dilated(radius, shape))
+                    << "ny " << ny << " radius " << radius << " shape " << shape;
+            }
+        }
+    }
+}
+
+TEST(bit_grid, erosion_is_dual) {
+    std::mt19937 rng(9);
+    nrg::bit_grid g = random_grid(50, 100, 0.9, rng);
+    nrg::bit_grid e = g.eroded(2);
+    for (int x = 0; x < 50; ++x) {
+        for (int y = 0; y < 100; ++y) {
+            // Cells near the edge only need their in-grid window full
+            int x0 = std::max(0, x - 2);
+            int x1 = std::min(49, x + 2);
+            int y0 = std::max(0, y - 2);
+            int y1 = std::min(99, y + 2);
+            bool full = g.count_window(x, y, 2) == (x1 - x0 + 1) * (y1 - y0 + 1);
+            ASSERT_EQ(full, e.get(x, y));
+        }
+    }
+}
+
+TEST(bit_grid, window_counts) {
+    std::mt19937 rng(13);
+    nrg::bit_grid g = random_grid(20, 140, 0.3, rng);
+    for (int x = 0; x < 20; ++x) {
+        for (int y = 0; y < 140; ++y) {
+            int expected = 0;
+            for (int tx = x - 3; tx <= x + 3; ++tx) {
+                for (int ty = y - 3; ty <= y + 3; ++ty) {
+                    expected += tx >= 0 && ty >= 0 && tx < 20 && ty < 140 && g.get(tx, ty);
+                }
+            }
+            ASSERT_EQ(expected, g.count_window(x, y, 3));
+        }
+    }
+}
+
+TEST(bit_grid, converts_terrain) {
+    array2d<int> a = {{0, -1, 0},
+                      {5, 0, -1}};
+    nrg::bit_grid g = nrg::bit_grid::from_grid(a, -1);
+    ASSERT_EQ(2u, g.count());
+    ASSERT_TRUE(g.get(0, 1));
+    ASSERT_TRUE(g.get(1, 2));
+    array2d<int> b(2, 3);
+    g.to_grid(b, 7);
+    ASSERT_EQ(7, b[0][1]);
+    ASSERT_EQ(7, b[1][2]);
+    ASSERT_EQ(0, b[1][0]);
+}
@@ -0,0 +1,156 @@
+#include <gtest/gtest.h>
+#include <code/utility/flight_recorder.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+static const char *const LOG_PATH = "flight_recorder_test.bin";
+
+static nrg::flight_record make_record(int i) {
+    nrg::flight_record r{};
+    r.captured_ns = 1000000LL * i;
+    r.received_ns = 1000000LL * i + 500000;
+    r.robot[0] = static_cast<float>(i);
+    r.command[0] = 1;
+    r.commands = 1;
+    std::strncpy(r.procedure, "Procedure", sizeof(r.procedure));
+    std::strncpy(r.state, "TRAVERSE", sizeof(r.state));
+    return r;
+}
+
+static std::vector<nrg::flight_record> read_log() {
+    std::ifstream in(LOG_PATH, std::ios::binary);
+    std::vector<nrg::flight_record> records;
+    EXPECT_TRUE(nrg::read_flight_log(in, records));
+    return records;
+}
+
+TEST(flight_recorder, records_round_trip) {
+    nrg::flight_recorder recorder;
+    ASSERT_FALSE(recorder.record(make_record(0)));
+    ASSERT_TRUE(recorder.open(LOG_PATH));
+    for (int i = 0; i < 100; ++i) {
+        ASSERT_TRUE(recorder.record(make_record(i)));
+    }
+    recorder.close();
+    recorder.wait();
+    ASSERT_EQ(100u, recorder.flushed());
+    ASSERT_EQ(0u, recorder.dropped());
+
+    std::vector<nrg::flight_record> records = read_log();
+    ASSERT_EQ(100u, records.size());
+    for (int i = 0; i < 100; ++i) {
+        ASSERT_EQ(static_cast<std::uint64_t>(i), records[i].seq);
+        ASSERT_EQ(1000000LL * i, records[i].captured_ns);
+        ASSERT_FLOAT_EQ(static_cast<float>(i), records[i].robot[0]);
+        ASSERT_STREQ("TRAVERSE", records[i].state);
+    }
+    std::remove(LOG_PATH);
+}
+
+TEST(flight_recorder, grows_the_log) {
+    nrg::flight_recorder recorder;
+    ASSERT_TRUE(recorder.open(LOG_PATH));
+    const int n = nrg::flight_recorder::GROW_RECORDS + 10;
+    for (int i = 0; i < n; ++i) {
+        // Wait for the flush before the ring fills
+        while (recorder.recorded() - recorder.flushed() == nrg::flight_recorder::CAPACITY) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        ASSERT_TRUE(recorder.record(make_record(i)));
+    }
+    recorder.close();
+    recorder.wait();
+    ASSERT_EQ(static_cast<std::uint64_t>(n), recorder.flushed());
+
+    std::vector<nrg::flight_record> records = read_log();
+    ASSERT_EQ(static_cast<std::size_t>(n), records.size());
+    ASSERT_FLOAT_EQ(static_cast<float>(n - 1), records.back().robot[0]);
+    std::remove(LOG_PATH);
+}
+
+TEST(flight_recorder, drops_when_full) {
+    nrg::flight_recorder recorder;
+    ASSERT_TRUE(recorder.open(LOG_PATH));
+    const int n = 3 * nrg::flight_recorder::CAPACITY;
+    std::uint64_t kept = 0;
+    for (int i = 0; i < n; ++i) {
+        kept += recorder.record(make_record(i));
+    }
+    recorder.close();
+    recorder.wait();
+    ASSERT_EQ(static_cast<std::uint64_t>(n), recorder.recorded());
+    ASSERT_EQ(kept, recorder.flushed());
+    ASSERT_EQ(n - kept, recorder.dropped());
+
+    std::vector<nrg::flight_record> records = read_log();
+    ASSERT_EQ(kept, records.size());
+    // Dropped records leave gaps in the sequence
+    for (std::size_t i = 1; i < records.size(); ++i) {
+        ASSERT_LT(records[i - 1].seq, records[i].seq);
+    }
+    std::remove(LOG_PATH);
+}
+
+TEST(flight_recorder, reopens_while_closing) {
+    nrg::flight_recorder recorder;
+    ASSERT_TRUE(recorder.open(LOG_PATH));
+    for (int i = 0; i < 10; ++i) {
+        ASSERT_TRUE(recorder.record(make_record(i)));
+    }
+    // Closing returns at once, and opening waits for the old log
+    recorder.close();
+    ASSERT_FALSE(recorder.is_open());
+    ASSERT_FALSE(recorder.record(make_record(10)));
+    ASSERT_TRUE(recorder.open(LOG_PATH));
+    for (int i = 0; i < 5; ++i) {
+        ASSERT_TRUE(recorder.record(make_record(i)));
+    }
+    recorder.close();
+    recorder.wait();
+    ASSERT_EQ(5u, recorder.flushed());
+    ASSERT_EQ(5u, read_log().size());
+    std::remove(LOG_PATH);
+}
+
+TEST(flight_recorder, rejects_other_files) {
+    std::stringstream not_a_log("seq,captured_ms\n0,0\n");
+    std::vector<nrg::flight_record> records;
+    ASSERT_FALSE(nrg::read_flight_log(not_a_log, records));
+}
+
+TEST(flight_recorder, reads_cut_log) {
+    nrg::flight_header header{};
+    std::memcpy(header.magic, nrg::flight_recorder::MAGIC, sizeof(header.magic));
+    header.version = nrg::flight_recorder::VERSION;
+    header.record_size = sizeof(nrg::flight_record);
+    header.count = 3;
+    nrg::flight_record r = make_record(0);
+    std::stringstream log;
+    log.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    log.write(reinterpret_cast<const char *>(&r), sizeof(r));
+    log.write(reinterpret_cast<const char *>(&r), sizeof(r) / 2);
+    std::vector<nrg::flight_record> records;
+    ASSERT_TRUE(nrg::read_flight_log(log, records));
+    ASSERT_EQ(1u, records.size());
+}
+
+TEST(flight_recorder, writes_csv) {
+    std::vector<nrg::flight_record> records = {make_record(2), make_record(3)};
+    records[1].state[0] = 'X';
+    std::stringstream csv;
+    nrg::write_flight_csv(csv, records);
+    std::string line;
+    std::getline(csv, line);
+    ASSERT_EQ(0u, line.find("seq,captured_ms,received_ms,latency_ms"));
+    std::getline(csv, line);
+    ASSERT_EQ(0u, line.find("0,-0.500,0.000,0.500,0.000,robot,2.00,"));
+    ASSERT_NE(std::string::npos, line.find(",Procedure,TRAVERSE"));
+    std::getline(csv, line);
+    ASSERT_NE(std::string::npos, line.find(",Procedure,XRAVERSE"));
+    ASSERT_FALSE(std::getline(csv, line));
+}
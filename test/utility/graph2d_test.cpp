@@ -36,3 +36,39 @@ TEST(graph2d, astar_finds_path) {
         ASSERT_EQ(expected_traverse[i], path.at(i).id());
     }
 }
+
+TEST(graph2d, astar_large_grid) {
+    const int side = 60;
+    nrg::graph2d<double> g;
+    g.reserve(side * side, 2 * side * side);
+    for (int x = 0; x < side; ++x) {
+        for (int y = 0; y < side; ++y) {
+            g.add_node({static_cast<double>(x), static_cast<double>(y)});
+        }
+    }
+    auto node = [side](int x, int y) {
+        return nrg::node2d<double>(static_cast<std::size_t>(x * side + y), {static_cast<double>(x), static_cast<double>(y)});
+    };
+    for (int x = 0; x < side; ++x) {
+        for (int y = 0; y < side; ++y) {
+            // Leave a wall at x = 30 with a single gap at the bottom
+            if (x + 1 < side && (x != 29 || y == side - 1)) { g.connect(node(x, y), node(x + 1, y)); }
+            if (y + 1 < side) { g.connect(node(x, y), node(x, y + 1)); }
+        }
+    }
+    // Connecting twice does not duplicate edges
+    g.connect(node(0, 0), node(0, 1));
+    ASSERT_EQ(2u, g.connections_of(node(0, 0)).size());
+    ASSERT_EQ(4u, g.connections_of(node(10, 10)).size());
+
+    std::vector<nrg::node2d<double>> path = g.astar(node(0, 0), node(side - 1, 0));
+    ASSERT_FALSE(path.empty());
+    ASSERT_EQ(0u, path.front().id());
+    ASSERT_EQ(node(side - 1, 0).id(), path.back().id());
+    // Down to the gap, across, and back up
+    ASSERT_EQ(static_cast<std::size_t>(2 * (side - 1) + side - 1 + 1), path.size());
+
+    auto lone = g.add_node({-5, -5});
+    ASSERT_TRUE(g.astar(lone, node(0, 0)).empty());
+    ASSERT_EQ(0u, g.connections_of(lone).size());
+}
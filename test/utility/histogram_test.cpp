@@ -0,0 +1,54 @@
+#include <gtest/gtest.h>
+
+#include <code/utility/histogram.h>
+
+TEST(histogram, buckets_samples) {
+    nrg::histogram hist(1, 10);
+    ASSERT_EQ(11u, hist.size());
+    ASSERT_EQ(0, hist.percentile(50));
+    hist.add(0.5);
+    hist.add(2.0);
+    hist.add(2.9);
+    hist.add(9.99);
+    hist.add(10);
+    hist.add(250);
+    ASSERT_EQ(6u, hist.count());
+    ASSERT_EQ(1u, hist.bucket(0));
+    ASSERT_EQ(2u, hist.bucket(2));
+    ASSERT_EQ(1u, hist.bucket(9));
+    ASSERT_EQ(2u, hist.overflow());
+    ASSERT_DOUBLE_EQ(0.5, hist.min());
+    ASSERT_DOUBLE_EQ(250, hist.max());
+    ASSERT_NEAR(275.39 / 6, hist.mean(), 1e-9);
+    hist.clear();
+    ASSERT_EQ(0u, hist.count());
+    ASSERT_EQ(0u, hist.overflow());
+}
+
+TEST(histogram, percentiles) {
+    nrg::histogram hist(2, 50);
+    for (int i = 0; i < 100; ++i) {
+        hist.add(i % 10 == 0 ? 21 : 5);
+    }
+    // Upper edges of the buckets holding the ranks
+    ASSERT_DOUBLE_EQ(6, hist.percentile(50));
+    ASSERT_DOUBLE_EQ(6, hist.percentile(90));
+    ASSERT_DOUBLE_EQ(21, hist.percentile(91));
+    ASSERT_DOUBLE_EQ(21, hist.percentile(100));
+    hist.add(1000);
+    ASSERT_DOUBLE_EQ(1000, hist.percentile(100));
+}
+
+TEST(histogram, rows) {
+    nrg::histogram hist(1, 5);
+    for (int i = 0; i < 4; ++i) {
+        hist.add(1.5);
+    }
+    hist.add(3);
+    hist.add(7);
+    std::vector<std::string> rows = hist.rows(4);
+    ASSERT_EQ(3u, rows.size());
+    ASSERT_EQ("   1-2: 4 ####", rows[0]);
+    ASSERT_EQ("   3-4: 1 #", rows[1]);
+    ASSERT_EQ("   5+: 1 #", rows[2]);
+}
@@ -0,0 +1,51 @@
+#include <gtest/gtest.h>
+
+#include <code/utility/indexed_heap.h>
+
+#include <algorithm>
+#include <cstdlib>
+
+TEST(indexed_heap, decrease_key) {
+    nrg::indexed_heap<int> heap(5);
+    ASSERT_TRUE(heap.empty());
+    ASSERT_TRUE(heap.push(0, 50));
+    ASSERT_TRUE(heap.push(1, 40));
+    ASSERT_TRUE(heap.push(2, 30));
+    ASSERT_TRUE(heap.push(3, 20));
+    ASSERT_EQ(3u, heap.top());
+    // Lowering a key moves the id up, raising one is ignored
+    ASSERT_TRUE(heap.push(0, 10));
+    ASSERT_FALSE(heap.push(1, 45));
+    ASSERT_EQ(4u, heap.size());
+    ASSERT_EQ(0u, heap.top());
+    ASSERT_EQ(10, heap.top_key());
+    ASSERT_EQ(0u, heap.pop());
+    ASSERT_FALSE(heap.contains(0));
+    ASSERT_EQ(3u, heap.pop());
+    ASSERT_EQ(2u, heap.pop());
+    ASSERT_EQ(1u, heap.pop());
+    ASSERT_TRUE(heap.empty());
+}
+
+TEST(indexed_heap, sorts_random_keys) {
+    srand(3);
+    const std::size_t n = 500;
+    nrg::indexed_heap<int> heap;
+    heap.reset(n);
+    std::vector<int> keys(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        keys[i] = rand() % 1000;
+        heap.push(i, keys[i]);
+    }
+    for (int round = 0; round < 1000; ++round) {
+        std::size_t i = static_cast<std::size_t>(rand()) % n;
+        int key = rand() % 1000;
+        if (heap.push(i, key)) { keys[i] = key; }
+    }
+    std::vector<int> popped;
+    while (!heap.empty()) {
+        popped.push_back(keys[heap.pop()]);
+    }
+    std::sort(keys.begin(), keys.end());
+    ASSERT_EQ(keys, popped);
+}
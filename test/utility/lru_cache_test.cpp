@@ -0,0 +1,43 @@
+#include <gtest/gtest.h>
+
+#include <code/controller/plancache.h>
+#include <code/utility/lru_cache.h>
+
+#include <string>
+
+TEST(lru_cache, evicts_least_recently_used) {
+    nrg::lru_cache<int, std::string> cache(2);
+    cache.insert(1, "one");
+    cache.insert(2, "two");
+    ASSERT_EQ("one", *cache.find(1));
+    cache.insert(3, "three");
+    ASSERT_EQ(2u, cache.size());
+    ASSERT_EQ(nullptr, cache.find(2));
+    ASSERT_EQ("one", *cache.find(1));
+    ASSERT_EQ("three", *cache.find(3));
+    ASSERT_EQ(3u, cache.hits());
+    ASSERT_EQ(1u, cache.misses());
+    cache.insert(3, "drei");
+    ASSERT_EQ(2u, cache.size());
+    ASSERT_EQ("drei", *cache.find(3));
+}
+
+TEST(lru_cache, plan_cache_keys) {
+    nrg::plan_cache cache(2, 2);
+    nrg::terrain_key a = {1, 233, 16, 4};
+    nrg::terrain_key b = {1, 233, 16, 5};
+    nrg::terrain_key c = {2, 233, 16, 4};
+    cache.terrains().insert(a, array2d<int>(3, 2));
+    ASSERT_NE(nullptr, cache.terrains().find(a));
+    ASSERT_EQ(nullptr, cache.terrains().find(b));
+    ASSERT_EQ(nullptr, cache.terrains().find(c));
+    ASSERT_EQ(3u, cache.terrains().find(a)->x());
+    nrg::path_key p = {a, {0, 0}, {2, 1}};
+    nrg::path_key q = {a, {0, 0}, {1, 2}};
+    cache.paths().insert(p, {{0, 0}, {2, 1}});
+    ASSERT_EQ(2u, cache.paths().find(p)->size());
+    ASSERT_EQ(nullptr, cache.paths().find(q));
+    cache.clear();
+    ASSERT_EQ(0u, cache.terrains().size());
+    ASSERT_EQ(0u, cache.paths().size());
+}
@@ -0,0 +1,46 @@
+#include <gtest/gtest.h>
+
+#include <code/utility/mailbox.h>
+
+#include <thread>
+#include <vector>
+
+TEST(mailbox, runs_tasks_in_order) {
+    nrg::mailbox box;
+    std::vector<int> order;
+    ASSERT_TRUE(box.post([&order] { order.push_back(1); }));
+    // Only the first post needs to wake the draining thread
+    ASSERT_FALSE(box.post([&order, &box] {
+        order.push_back(2);
+        box.post([&order] { order.push_back(4); });
+    }));
+    box.post([&order] { order.push_back(3); });
+    ASSERT_EQ(3u, box.size());
+    ASSERT_EQ(3u, box.drain());
+    // Tasks posted while draining wait for the next drain
+    ASSERT_EQ((std::vector<int>{1, 2, 3}), order);
+    ASSERT_EQ(1u, box.drain());
+    ASSERT_EQ((std::vector<int>{1, 2, 3, 4}), order);
+    ASSERT_EQ(0u, box.drain());
+}
+
+TEST(mailbox, posts_from_threads) {
+    nrg::mailbox box;
+    int total = 0;
+    std::vector<std::thread> posters;
+    for (int t = 0; t < 4; ++t) {
+        posters.emplace_back([&box, &total] {
+            for (int i = 0; i < 1000; ++i) {
+                box.post([&total] { ++total; });
+            }
+        });
+    }
+    std::size_t ran = 0;
+    while (ran < 4000) {
+        ran += box.drain();
+    }
+    for (std::thread &poster : posters) {
+        poster.join();
+    }
+    ASSERT_EQ(4000, total);
+}
@@ -0,0 +1,17 @@
+#include <gtest/gtest.h>
+
+#include <code/utility/realtime.h>
+
+#include <thread>
+
+TEST(realtime, default_scheduling) {
+    bool ok = false;
+    // Run on a thread of its own, so the test runner is left untouched
+    std::thread([&ok] {
+        ok = nrg::set_realtime_priority(0) && nrg::set_cpu_affinity(-1);
+#ifdef __linux__
+        ok = ok && nrg::set_cpu_affinity(0) && !nrg::set_cpu_affinity(1 << 20);
+#endif
+    }).join();
+    ASSERT_TRUE(ok);
+}
@@ -0,0 +1,88 @@
+#include <gtest/gtest.h>
+
+#include <code/utility/seqlock.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace {
+
+    // Larger than a word, and not a whole number of words
+    struct sample {
+        double a;
+        std::int64_t b;
+        float c;
+        std::uint16_t d;
+        bool e;
+    };
+
+    sample make_sample(int i) {
+        return {static_cast<double>(i), i, static_cast<float>(i), static_cast<std::uint16_t>(i), i % 2 == 1};
+    }
+
+}
+
+TEST(seqlock, loads_stores) {
+    nrg::seqlock<sample> lock(make_sample(3));
+    ASSERT_EQ(0u, lock.version());
+    sample s = lock.load();
+    ASSERT_EQ(3, s.a);
+    ASSERT_EQ(3, s.b);
+    ASSERT_TRUE(s.e);
+
+    std::uint32_t seen = nrg::seqlock<sample>::UNSEEN;
+    ASSERT_TRUE(lock.load(s, seen));
+    ASSERT_FALSE(lock.load(s, seen));
+    lock.store(make_sample(4));
+    lock.store(make_sample(6));
+    ASSERT_EQ(4u, lock.version());
+    // Only the latest value is loaded
+    ASSERT_TRUE(lock.load(s, seen));
+    ASSERT_EQ(6, s.b);
+    ASSERT_FALSE(s.e);
+    ASSERT_FALSE(lock.load(s, seen));
+}
+
+TEST(seqlock, loads_whole_stores) {
+    nrg::seqlock<sample> lock;
+    std::atomic<bool> done(false);
+    std::thread writer([&lock, &done] {
+        for (int i = 1; i <= 200000; ++i) {
+            lock.store(make_sample(i));
+        }
+        done = true;
+    });
+    std::vector<std::thread> readers;
+    std::atomic<int> torn(0);
+    for (int r = 0; r < 3; ++r) {
+        readers.emplace_back([&lock, &done, &torn] {
+            std::uint32_t seen = nrg::seqlock<sample>::UNSEEN;
+            double last = 0;
+            sample s{};
+            for (;;) {
+                bool finished = done;
+                if (!lock.load(s, seen)) {
+                    if (finished) { break; }
+                    continue;
+                }
+                // Values never mix two stores, and never go back
+                bool whole = s.b == static_cast<std::int64_t>(s.a)
+                             && s.c == static_cast<float>(s.a)
+                             && s.d == static_cast<std::uint16_t>(s.b)
+                             && s.e == (s.b % 2 == 1);
+                if (!whole || s.a < last) { ++torn; }
+                last = s.a;
+                // Whole loads see at least the last value loaded
+                sample latest = lock.load();
+                if (latest.b != static_cast<std::int64_t>(latest.a) || latest.a < last) { ++torn; }
+            }
+        });
+    }
+    writer.join();
+    for (std::thread &reader : readers) {
+        reader.join();
+    }
+    ASSERT_EQ(0, torn);
+    ASSERT_EQ(200000, lock.load().b);
+}
@@ -0,0 +1,49 @@
+#include <gtest/gtest.h>
+
+#include <code/utility/spatial_grid.h>
+
+#include <cstdlib>
+
+TEST(spatial_grid, segment_aabb) {
+    rect2d r(0, 0, 2, 2);
+    ASSERT_TRUE(algo::segment_aabb_intersect(ray2d(-1, 1, 3, 1), r));
+    ASSERT_TRUE(algo::segment_aabb_intersect(ray2d(0.5, 0.5, 1, 1), r));
+    ASSERT_TRUE(algo::segment_aabb_intersect(ray2d(1, -1, 1, 0), r));
+    ASSERT_FALSE(algo::segment_aabb_intersect(ray2d(-3, 1, -1, 1), r));
+    ASSERT_FALSE(algo::segment_aabb_intersect(ray2d(3, -1, 3, 5), r));
+    ASSERT_FALSE(algo::segment_aabb_intersect(ray2d(1.5, 3, 3, 1.5), r));
+}
+
+TEST(spatial_grid, matches_brute_force) {
+    srand(13);
+    const int nx = 60;
+    const int ny = 30;
+    array2d<int> walls(nx, ny);
+    std::vector<rect2d> rects;
+    for (int x = 0; x < nx; ++x) {
+        for (int y = 0; y < ny; ++y) {
+            walls[x][y] = rand() % 12 == 0 ? 0 : -1;
+            if (walls[x][y] == 0) { rects.emplace_back(x - 0.5, y - 0.5, 1, 1); }
+        }
+    }
+    auto index = nrg::spatial_grid<double>::from_walls(walls, 0, 4);
+    ASSERT_EQ(rects.size(), index.size());
+    std::vector<ray2d> segs;
+    for (int i = 0; i < 2000; ++i) {
+        // Include axis-aligned segments and ones leaving the bounds
+        double ax = rand() % (nx + 10) - 5;
+        double ay = rand() % (ny + 10) - 5;
+        double bx = i % 5 == 0 ? ax : rand() % (nx + 10) - 5;
+        double by = i % 7 == 0 ? ay : rand() % (ny + 10) - 5;
+        segs.emplace_back(ax, ay, bx, by);
+    }
+    std::vector<bool> hits;
+    index.intersects(segs, hits);
+    for (std::size_t i = 0; i < segs.size(); ++i) {
+        bool expected = false;
+        for (const rect2d &r : rects) {
+            expected = expected || algo::segment_aabb_intersect(segs[i], r);
+        }
+        ASSERT_EQ(expected, hits[i]);
+    }
+}
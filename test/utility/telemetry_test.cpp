@@ -0,0 +1,60 @@
+#include <gtest/gtest.h>
+
+#include <code/utility/telemetry.h>
+
+#include <atomic>
+#include <thread>
+
+TEST(telemetry_slot, reads_changes) {
+    nrg::telemetry_slot slot;
+    nrg::telemetry_slot::values v{};
+    std::uint32_t seen = nrg::telemetry_slot::UNSEEN;
+    // The initial values are read once
+    ASSERT_TRUE(slot.read(v, seen));
+    ASSERT_EQ(0, v[0]);
+    ASSERT_FALSE(slot.read(v, seen));
+    slot.publish(1.5, -2);
+    ASSERT_TRUE(slot.read(v, seen));
+    ASSERT_EQ(1.5, v[0]);
+    ASSERT_EQ(-2, v[1]);
+    ASSERT_EQ(0, v[2]);
+    // Publishing the same values is not a change
+    std::uint32_t version = slot.version();
+    slot.publish(1.5, -2);
+    ASSERT_EQ(version, slot.version());
+    ASSERT_FALSE(slot.read(v, seen));
+    // Only the latest values are read
+    slot.publish(3);
+    slot.publish(4, 5, 6, 7);
+    ASSERT_TRUE(slot.read(v, seen));
+    ASSERT_EQ((nrg::telemetry_slot::values{4, 5, 6, 7}), v);
+}
+
+TEST(telemetry_slot, reads_whole_publishes) {
+    nrg::telemetry_slot slot;
+    std::atomic<bool> done(false);
+    std::thread producer([&slot, &done] {
+        for (int i = 1; i <= 200000; ++i) {
+            slot.publish(i, i, i, i);
+        }
+        done = true;
+    });
+    nrg::telemetry_slot::values v{};
+    std::uint32_t seen = nrg::telemetry_slot::UNSEEN;
+    double last = 0;
+    for (;;) {
+        bool finished = done;
+        if (!slot.read(v, seen)) {
+            if (finished) { break; }
+            continue;
+        }
+        // Values never mix two publishes, and never go back
+        ASSERT_EQ(v[0], v[1]);
+        ASSERT_EQ(v[0], v[2]);
+        ASSERT_EQ(v[0], v[3]);
+        ASSERT_GE(v[0], last);
+        last = v[0];
+    }
+    producer.join();
+    ASSERT_EQ(200000, last);
+}
@@ -0,0 +1,28 @@
+#include <gtest/gtest.h>
+
+#include <code/utility/thread_pool.h>
+
+#include <atomic>
+
+TEST(thread_pool, runs_all_tasks) {
+    std::atomic<int> ran(0);
+    std::vector<std::future<int>> results;
+    {
+        nrg::thread_pool pool(4);
+        ASSERT_EQ(4u, pool.size());
+        for (int i = 0; i < 100; ++i) {
+            results.push_back(pool.submit([i, &ran] {
+                ++ran;
+                return i * i;
+            }));
+        }
+        for (int i = 0; i < 50; ++i) {
+            pool.submit([&ran] { ++ran; });
+        }
+    }
+    // Queued tasks finish before the pool is destroyed
+    ASSERT_EQ(150, ran.load());
+    for (int i = 0; i < 100; ++i) {
+        ASSERT_EQ(i * i, results[i].get());
+    }
+}